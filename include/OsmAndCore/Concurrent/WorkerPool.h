@@ -32,6 +32,10 @@ namespace OsmAnd
             };
 
             typedef std::function<bool (QRunnable* const l, QRunnable* const r)> SortPredicate;
+            typedef int64_t Priority;
+            typedef std::function<Priority (QRunnable* const runnable)> PriorityFunction;
+            typedef std::function<void ()> Task;
+            typedef std::function<bool ()> AbortPredicate;
 
         private:
             PrivateImplementation<WorkerPool_P> _p;
@@ -49,13 +53,31 @@ namespace OsmAnd
 
             bool waitForDone(const int msecs = -1) const;
 
+            // Runnables with higher priority are taken first, and ones with equal priority are taken in pool order.
+            // Priority is evaluated once per runnable, so getPriority is never used to compare runnables.
+            void enqueueWithPriority(QRunnable* const runnable, const Priority priority);
+            void enqueueWithPriorities(const QVector<QRunnable*>& runnables, const PriorityFunction getPriority);
+            // Evaluates priorities of all queued runnables anew, e.g. once they depend on state that has changed
+            void reprioritize(const PriorityFunction getPriority);
+
+            // Sort predicate ranks all queued runnables, so with it enqueue() is as slow as sortQueue(). Without it,
+            // runnables are taken in reverse of pool order, as enqueue() always did: FIFO pool takes most recently
+            // enqueued one first, and LIFO pool takes oldest one first.
             void enqueue(QRunnable* const runnable, const SortPredicate predicate = nullptr);
             void enqueue(const QVector<QRunnable*>& runnables, const SortPredicate predicate = nullptr);
             bool dequeue(QRunnable* const runnable, const SortPredicate predicate = nullptr);
             void dequeueAll();
+            unsigned int queuedCount() const;
 
+            // Replaces priorities of all queued runnables with their ranks by predicate
             void sortQueue(const SortPredicate predicate);
 
+            // Runs tasks on threads of this pool and on calling thread, and returns once all of them are finished.
+            // Calling thread takes tasks as well, so batch is completed even if all threads of the pool are busy
+            // (e.g. when caller itself runs on this pool). Once abort predicate returns true, remaining tasks
+            // are skipped. Returns false if any task was skipped.
+            bool runAndWait(const QVector<Task>& tasks, const AbortPredicate isAborted = nullptr);
+
             void reset();
         };
     }
@@ -5,6 +5,10 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QStringList>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QMutex>
 #include <OsmAndCore/restore_internal_warnings.h>
 
 #include <OsmAndCore.h>
@@ -22,6 +26,16 @@ namespace OsmAnd
     {
         Q_DISABLE_COPY_AND_MOVE(BinaryMapObject);
     private:
+        // Data that was read, but is decoded only on first access (see ensureLazyDataDecoded())
+        mutable QAtomicInt _lazyDataDecoded;
+        mutable QMutex _lazyDataMutex;
+        QVector<uint32_t> _encodedCaptions;
+        QStringList _captionsTable;
+        PointI _encodedInnerPolygonsOrigin;
+        QList<QByteArray> _encodedInnerPolygons;
+
+        void resolveCaptions();
+        void decodeInnerPolygons();
     protected:
         BinaryMapObject(
             const std::shared_ptr<const ObfMapSectionInfo>& section,
@@ -41,6 +55,9 @@ namespace OsmAnd
         // Layers
         virtual LayerType getLayerType() const;
 
+        // Lazy data
+        virtual void ensureLazyDataDecoded() const;
+
     friend class OsmAnd::ObfMapSectionReader_P;
     };
 }
@@ -60,6 +60,7 @@ namespace OsmAnd
             uint32_t onewayAttributeId;
             uint32_t onewayReverseAttributeId;
             uint32_t layerLowestAttributeId;
+            QSet< uint32_t > highwayAttributeIds;
 
             virtual void registerMapping(const uint32_t id, const QString& tag, const QString& value);
             void verifyRequiredMappingRegistered();
@@ -113,7 +114,12 @@ namespace OsmAnd
         // Geometry information
         bool isArea;
         QVector< PointI > points31;
+        // May be still encoded (see ensureLazyDataDecoded()), so it's not exposed to bindings and is read
+        // via getInnerPolygonsPoints31() that decodes it if needed
+#if !defined(SWIG)
         QList< QVector< PointI > > innerPolygonsPoints31;
+#endif // !defined(SWIG)
+        const QList< QVector< PointI > >& getInnerPolygonsPoints31() const;
         AreaI bbox31;
         virtual bool isClosedFigure(bool checkInner = false) const;
         virtual void computeBBox31();
@@ -135,14 +141,22 @@ namespace OsmAnd
         // Layers
         virtual LayerType getLayerType() const;
 
-        // Captions
+        // Captions. May be still encoded (see ensureLazyDataDecoded()), so they're not exposed to bindings and
+        // are read via getCaptions() that decodes them if needed
+#if !defined(SWIG)
         QHash<uint32_t, QString> captions;
+#endif // !defined(SWIG)
         QList<uint32_t> captionsOrder;
+        const QHash<uint32_t, QString>& getCaptions() const;
         virtual QString getCaptionInNativeLanguage() const;
         virtual QString getCaptionInLanguage(const QString& lang) const;
         virtual QHash<QString, QString> getCaptionsInAllLanguages() const;
         virtual QString getName(const QString lang, bool transliterate) const;
 
+        // Lazy data: captions and inner polygons of some objects are decoded only on first access,
+        // so this has to be called before accessing those fields directly rather than via getters
+        virtual void ensureLazyDataDecoded() const;
+
         // Default encoding-decoding rules
         static std::shared_ptr<const AttributeMapping> defaultAttributeMapping;
     };
@@ -24,13 +24,16 @@ namespace OsmAnd
     protected:
     public:
         ObfFile(const QString& filePath);
-        ObfFile(const QString& filePath, const uint64_t fileSize);
+        ObfFile(const QString& filePath, const uint64_t fileSize, const QString& infoCacheFilePath = QString::null);
         virtual ~ObfFile();
 
         const QString filePath;
         const uint64_t fileSize;
+        const QString infoCacheFilePath;
         const std::shared_ptr<const ObfInfo>& obfInfo;
 
+        bool loadInfoFromCache() const;
+
         const QString getRegionName() const;
 
     friend class OsmAnd::ObfReader_P;
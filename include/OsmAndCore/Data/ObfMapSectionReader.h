@@ -11,6 +11,7 @@
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
 #include <OsmAndCore/SharedByZoomResourcesContainer.h>
+#include <OsmAndCore/StripedSharedResourcesContainer.h>
 #include <OsmAndCore/Data/DataCommonTypes.h>
 #include <OsmAndCore/Map/MapCommonTypes.h>
 
@@ -61,7 +62,10 @@ namespace OsmAnd
         friend class OsmAnd::ObfMapSectionReader_P;
         };
 
-        class OSMAND_CORE_API DataBlocksCache : public SharedByZoomResourcesContainer < DataBlockId, const DataBlock >
+        // Since data blocks are obtained concurrently by many threads, cache is striped. It's no longer
+        // a SharedByZoomResourcesContainer, but provides same operations
+        class OSMAND_CORE_API DataBlocksCache
+            : public StripedSharedResourcesContainer< SharedByZoomResourcesContainer<DataBlockId, const DataBlock> >
         {
         public:
             typedef ObfMapSectionReader::DataBlockId DataBlockId;
@@ -73,6 +77,10 @@ namespace OsmAnd
             virtual ~DataBlocksCache();
 
             virtual bool shouldCacheBlock(const DataBlockId id, const AreaI blockBBox31, const AreaI* const queryArea31 = nullptr) const;
+
+            // Cached blocks hold all objects of a block, most of which are never rendered. If this returns true,
+            // their captions and inner polygons are decoded only on BinaryMapObject::ensureLazyDataDecoded()
+            virtual bool shouldDecodeLazily() const;
         };
 
     private:
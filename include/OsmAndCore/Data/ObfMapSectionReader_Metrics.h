@@ -73,7 +73,22 @@ namespace OsmAnd
         FIELD_ACTION(float, elapsedTimeForNotSkippedMapObjectsPoints, "s");                     \
                                                                                                 \
         /* Number of points read from MapObjects that were not skipped */                       \
-        FIELD_ACTION(unsigned int, notSkippedMapObjectsPoints, "");
+        FIELD_ACTION(unsigned int, notSkippedMapObjectsPoints, "");                             \
+                                                                                                \
+        /* Elapsed time for resolving captions from string tables (in seconds) */               \
+        FIELD_ACTION(float, elapsedTimeForCaptions, "s");                                       \
+                                                                                                \
+        /* Number of captions resolved while reading */                                         \
+        FIELD_ACTION(unsigned int, decodedCaptions, "");                                        \
+                                                                                                \
+        /* Number of captions left encoded until accessed */                                    \
+        FIELD_ACTION(unsigned int, deferredCaptions, "");                                       \
+                                                                                                \
+        /* Number of inner polygons decoded while reading */                                    \
+        FIELD_ACTION(unsigned int, decodedInnerPolygons, "");                                   \
+                                                                                                \
+        /* Number of inner polygons left encoded until accessed */                              \
+        FIELD_ACTION(unsigned int, deferredInnerPolygons, "");
 
         struct OSMAND_CORE_API Metric_loadMapObjects : public Metric
         {
@@ -83,6 +98,9 @@ namespace OsmAnd
 
             OsmAnd__ObfMapSectionReader_Metrics__Metric_loadMapObjects__FIELDS(EMIT_METRIC_FIELD);
 
+            // Adds values of all fields of other metric (e.g. one that was collected by another thread)
+            void merge(const Metric_loadMapObjects& that);
+
             virtual QString toString(const bool shortFormat = false, const QString& prefix = QString::null) const;
         };
     }
@@ -29,6 +29,8 @@ namespace OsmAnd
     class ObfPoiSectionReader;
     class ObfTransportSectionReader;
 
+    class ObfMapObjectsProvider_P;
+
     class ObfReader_P;
     class OSMAND_CORE_API ObfReader
     {
@@ -37,11 +39,19 @@ namespace OsmAnd
         PrivateImplementation<ObfReader_P> _p;
     protected:
     public:
-        ObfReader(const std::shared_ptr<const ObfFile>& obfFile);
+        ObfReader(
+            const std::shared_ptr<const ObfFile>& obfFile,
+            const bool useMemoryMapping = false,
+            const bool threadSafe = false);
         ObfReader(const std::shared_ptr<QIODevice>& input);
         virtual ~ObfReader();
 
         const std::shared_ptr<const ObfFile> obfFile;
+        // Mapping is opt-in only: nothing in the library enables it, since mapped file that is replaced in-place
+        // crashes on next access, and it's up to caller to not let that happen while reader is opened
+        const bool useMemoryMapping;
+        // In thread-safe mode every thread reads via own cursor over shared mapping (or shared file handle)
+        const bool threadSafe;
 
         bool isOpened() const;
         bool open();
@@ -56,6 +66,7 @@ namespace OsmAnd
     friend class OsmAnd::ObfRoutingSectionReader;
     friend class OsmAnd::ObfPoiSectionReader;
     friend class OsmAnd::ObfTransportSectionReader;
+    friend class OsmAnd::ObfMapObjectsProvider_P;
     };
 }
 
@@ -11,6 +11,7 @@
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
 #include <OsmAndCore/SharedResourcesContainer.h>
+#include <OsmAndCore/StripedSharedResourcesContainer.h>
 #include <OsmAndCore/Data/DataCommonTypes.h>
 
 namespace OsmAnd
@@ -53,7 +54,10 @@ namespace OsmAnd
         friend class OsmAnd::ObfRoutingSectionReader_P;
         };
 
-        class OSMAND_CORE_API DataBlocksCache : public SharedResourcesContainer < DataBlockId, const DataBlock >
+        // Since data blocks are obtained concurrently by many threads, cache is striped. It's no longer
+        // a SharedResourcesContainer, but provides same operations
+        class OSMAND_CORE_API DataBlocksCache
+            : public StripedSharedResourcesContainer< SharedResourcesContainer<DataBlockId, const DataBlock> >
         {
         public:
             typedef ObfRoutingSectionReader::DataBlockId DataBlockId;
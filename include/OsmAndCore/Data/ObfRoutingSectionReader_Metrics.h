@@ -68,6 +68,9 @@ namespace OsmAnd
 
             OsmAnd__ObfRoutingSectionReader_Metrics__Metric_loadRoads__FIELDS(EMIT_METRIC_FIELD);
 
+            // Adds values of all fields of other metric (e.g. one that was collected by another thread)
+            void merge(const Metric_loadRoads& that);
+
             virtual QString toString(const bool shortFormat = false, const QString& prefix = QString::null) const;
         };
     }
@@ -13,6 +13,7 @@ namespace OsmAnd {
 
     class ObfTransportSectionReader_P;
     class ObfReader_P;
+    struct ObfInfoCache;
 
     class OSMAND_CORE_API ObfTransportSectionInfo : public ObfSectionInfo
     {
@@ -32,6 +33,7 @@ namespace OsmAnd {
 
         friend class OsmAnd::ObfTransportSectionReader_P;
         friend class OsmAnd::ObfReader_P;
+        friend struct OsmAnd::ObfInfoCache;
     };
 
 } // namespace OsmAnd
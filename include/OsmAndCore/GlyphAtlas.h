@@ -0,0 +1,182 @@
+#ifndef _OSMAND_CORE_GLYPH_ATLAS_H_
+#define _OSMAND_CORE_GLYPH_ATLAS_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <functional>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/Color.h>
+#include <OsmAndCore/PointsAndAreas.h>
+
+class SkBitmap;
+class SkCanvas;
+
+namespace OsmAnd
+{
+    // GlyphAtlas keeps rasterized glyphs (and halos of them) as cells of a few large pages, so that each glyph
+    // of given font, size and color is rasterized once, and texts reference cells of a page instead of owning
+    // bitmaps. Once all pages are full, atlas starts over, while glyph runs obtained earlier keep their pages.
+    class OSMAND_CORE_API GlyphAtlas Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(GlyphAtlas);
+    public:
+        enum : unsigned int {
+            DefaultPageSize = 512u,
+            DefaultMaxPagesCount = 4u,
+        };
+
+        // Packs rectangles into area of fixed size by shelves: rows that are filled from left to right,
+        // each as high as the first rectangle placed into it. Rectangles are separated by padding.
+        class OSMAND_CORE_API ShelfPacker Q_DECL_FINAL
+        {
+            Q_DISABLE_COPY_AND_MOVE(ShelfPacker);
+        private:
+            struct Shelf
+            {
+                int top;
+                int height;
+                int usedWidth;
+            };
+            QVector<Shelf> _shelves;
+            int _usedHeight;
+        protected:
+        public:
+            ShelfPacker(const PointI& size, const int padding = 1);
+            ~ShelfPacker();
+
+            const PointI size;
+            const int padding;
+
+            bool pack(const PointI& rectangleSize, AreaI& outArea);
+            // Height from top of area to bottom of last shelf, including padding
+            int getUsedHeight() const;
+            bool isEmpty() const;
+            void reset();
+        };
+
+        struct OSMAND_CORE_API GlyphKey Q_DECL_FINAL
+        {
+            GlyphKey();
+
+            uint32_t typefaceId;
+            uint16_t glyphId;
+            float size;
+            bool fakeBold;
+            ColorARGB color;
+            // Width of halo stroke, or zero for glyph itself
+            unsigned int haloRadius;
+            // Distance from top of cell to baseline and from baseline to bottom of cell
+            int cellAscent;
+            int cellDescent;
+
+            bool operator==(const GlyphKey& that) const;
+            inline bool operator!=(const GlyphKey& that) const
+            {
+                return !(*this == that);
+            }
+
+            friend inline uint qHash(const GlyphKey& key, uint seed = 0)
+            {
+                auto hash = qHash(key.typefaceId, seed);
+                hash = qHash((static_cast<uint>(key.glyphId) << 16) | (key.haloRadius << 1) | (key.fakeBold ? 1u : 0u), hash);
+                hash = qHash(key.size, hash);
+                hash = qHash(key.color.argb, hash);
+                hash = qHash((static_cast<uint>(key.cellAscent) << 16) ^ static_cast<uint>(key.cellDescent), hash);
+                return hash;
+            }
+        };
+
+        struct CellRequest Q_DECL_FINAL
+        {
+            GlyphKey key;
+            int glyphIndex;
+            int width;
+        };
+
+        struct Page;
+        struct OSMAND_CORE_API GlyphRun Q_DECL_FINAL
+        {
+            Q_DISABLE_COPY_AND_MOVE(GlyphRun);
+
+            GlyphRun();
+            ~GlyphRun();
+
+            struct Cell
+            {
+                int glyphIndex;
+                AreaI area;
+            };
+
+            // Advance widths of glyphs in visual order
+            QVector<float> glyphsWidth;
+            // Cells in order of drawing, each centered at its glyph. All cells are located on same page.
+            QVector<Cell> cells;
+            int cellHeight;
+            std::shared_ptr<Page> page;
+            PointI pageSize;
+
+            float getWidth() const;
+        };
+
+        // Canvas is translated to top-left corner of cell and clipped by it
+        typedef std::function<void (SkCanvas& canvas, const CellRequest& cell)> CellPainter;
+
+    private:
+        struct Cell
+        {
+            const Page* page;
+            AreaI area;
+        };
+
+        mutable QMutex _mutex;
+        QHash<GlyphKey, Cell> _cells;
+        QVector< std::shared_ptr<Page> > _pages;
+
+        std::shared_ptr<Page> addPage();
+        bool placeCells(
+            Page& page,
+            const QVector<CellRequest>& cells,
+            const int cellHeight,
+            const CellPainter& painter,
+            QVector<AreaI>& outAreas,
+            unsigned int& outDrawnCellsCount);
+    protected:
+    public:
+        GlyphAtlas(
+            const unsigned int pageSize = DefaultPageSize,
+            const unsigned int maxPagesCount = DefaultMaxPagesCount);
+        ~GlyphAtlas();
+
+        const unsigned int pageSize;
+        const unsigned int maxPagesCount;
+
+        // Returns run that has cells of all requests on single page. Cells that are not yet in atlas are drawn
+        // by painter. Returns nullptr if cells don't fit into a page.
+        std::shared_ptr<const GlyphRun> obtainGlyphRun(
+            const QVector<float>& glyphsWidth,
+            const int cellHeight,
+            const QVector<CellRequest>& cells,
+            const CellPainter& painter,
+            unsigned int* const outDrawnCellsCount = nullptr);
+
+        // Returns bitmap of page of given run. Bitmap is shared by all runs of that page until new cells are
+        // drawn into it, so runs that were obtained one after another should request bitmaps after that.
+        // Bitmap covers only rows of page that have cells, so it may be lower than page. Returns nullptr and
+        // caches nothing if bitmap can't be copied.
+        std::shared_ptr<const SkBitmap> obtainPageBitmap(const GlyphRun& run) const;
+
+        unsigned int getPagesCount() const;
+        unsigned int getCellsCount() const;
+        void clear();
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_GLYPH_ATLAS_H_)
@@ -45,6 +45,7 @@ namespace OsmAnd
         FIELD_ACTION(unsigned int, rejectedByVisibilityFiltering, "");                                          \
         FIELD_ACTION(float, elapsedTimeForApplyIntersectionWithOtherSymbolsFilteringCalls, "s");                \
         FIELD_ACTION(unsigned int, applyIntersectionWithOtherSymbolsFilteringCalls, "");                        \
+        FIELD_ACTION(unsigned int, intersectionClassesTests, "");                                               \
         FIELD_ACTION(unsigned int, acceptedByIntersectionWithOtherSymbolsFiltering, "");                        \
         FIELD_ACTION(unsigned int, rejectedByIntersectionWithOtherSymbolsFiltering, "");                        \
         FIELD_ACTION(float, elapsedTimeForApplyMinDistanceToSameContentFromOtherSymbolFilteringCalls, "s");     \
@@ -56,6 +57,9 @@ namespace OsmAnd
         FIELD_ACTION(unsigned int, acceptedByAddToIntersections, "");                                           \
         FIELD_ACTION(unsigned int, rejectedByAddToIntersections, "");                                           \
         FIELD_ACTION(float, elapsedTimeForSymbolsPresentationModeCheck, "s");                                   \
+        FIELD_ACTION(unsigned int, incrementalSymbolsPlacements, "");                                           \
+        FIELD_ACTION(unsigned int, symbolsGroupInstancesPlaced, "");                                            \
+        FIELD_ACTION(unsigned int, symbolsGroupInstancesReused, "");                                            \
         FIELD_ACTION(float, elapsedTimeForBillboardSymbolsRendering, "s");                                      \
         FIELD_ACTION(unsigned int, billboardSymbolsRendered, "");                                               \
         FIELD_ACTION(float, elapsedTimeForOnPathSymbolsRendering, "s");                                         \
@@ -22,7 +22,15 @@ namespace OsmAnd
         FIELD_ACTION(float, elapsedTimeForUpdatesProcessing, "s");                      \
                                                                                         \
         /* Time elapsed to process all scheduled calls in render thread */              \
-        FIELD_ACTION(float, elapsedTimeForRenderThreadDispatcher, "s");
+        FIELD_ACTION(float, elapsedTimeForRenderThreadDispatcher, "s");                 \
+                                                                                        \
+        /* Number of tiles that were newly predicted to become active and prefetched */ \
+        FIELD_ACTION(unsigned int, prefetchedTiles, "");                                \
+                                                                                        \
+        /* Number of prefetched tiles that became active. Tiles prefetched in one */    \
+        /* update become active in later ones, so hit rate is meaningful only for */    \
+        /* both counters summed over many updates */                                    \
+        FIELD_ACTION(unsigned int, prefetchedTilesHits, "");
         struct OSMAND_CORE_API Metric_update : public Metric
         {
             Metric_update();
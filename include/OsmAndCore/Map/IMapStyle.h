@@ -18,6 +18,7 @@
 namespace OsmAnd
 {
     class MapStyleValueDefinition;
+    class MapStyleProgram;
 
     class OSMAND_CORE_API IMapStyle
     {
@@ -153,6 +154,12 @@ namespace OsmAnd
             const MapStyleRulesetType rulesetType) const = 0;
 
         virtual QString getStringById(const SWIG_CLARIFY(IMapStyle, StringId) id) const = 0;
+
+#if !defined(SWIG)
+        // Compiled form of rulesets and attributes, that MapStyleEvaluator runs instead of walking rule nodes.
+        // Styles that provide no program are evaluated by walking rule nodes
+        virtual std::shared_ptr<const MapStyleProgram> getProgram() const;
+#endif // !defined(SWIG)
     };
 }
 
@@ -0,0 +1,39 @@
+#ifndef _OSMAND_CORE_MAP_OBJECTS_SYMBOLS_PROVIDER_METRICS_H_
+#define _OSMAND_CORE_MAP_OBJECTS_SYMBOLS_PROVIDER_METRICS_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <functional>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QString>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Metrics.h>
+
+namespace OsmAnd
+{
+    namespace MapObjectsSymbolsProvider_Metrics
+    {
+#define OsmAnd__MapObjectsSymbolsProvider_Metrics__Metric_obtainData__FIELDS(FIELD_ACTION)          \
+        /* Total elapsed time */                                                                    \
+        FIELD_ACTION(float, elapsedTime, "s");                                                      \
+                                                                                                    \
+        /* Time spent on rasterization of symbols */                                                \
+        FIELD_ACTION(float, elapsedTimeForRasterization, "s");                                      \
+                                                                                                    \
+        /* Number of obtained symbols */                                                            \
+        FIELD_ACTION(unsigned int, symbols, "");
+        struct OSMAND_CORE_API Metric_obtainData : public Metric
+        {
+            Metric_obtainData();
+            virtual ~Metric_obtainData();
+            virtual void reset();
+
+            OsmAnd__MapObjectsSymbolsProvider_Metrics__Metric_obtainData__FIELDS(EMIT_METRIC_FIELD);
+
+            virtual QString toString(const bool shortFormat = false, const QString& prefix = QString::null) const;
+        };
+    }
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_OBJECTS_SYMBOLS_PROVIDER_METRICS_H_)
@@ -21,6 +21,7 @@ class SkBitmap;
 namespace OsmAnd
 {
     class MapStyleEvaluator;
+    class MapStyleEvaluationCache;
     class MapStyleValueDefinition;
     class MapStyleBuiltinValueDefinitions;
     struct MapStyleConstantValue;
@@ -92,6 +93,11 @@ namespace OsmAnd
         void setSettings(const QHash< QString, QString >& newSettings);
 
         void applyTo(MapStyleEvaluator& evaluator) const;
+#if !defined(SWIG)
+        // Cache is replaced each time settings change, so it has to be obtained before settings are applied
+        // to evaluators that use it
+        std::shared_ptr<MapStyleEvaluationCache> getEvaluationCache() const;
+#endif // !defined(SWIG)
 
         bool obtainShaderBitmap(const QString& name, std::shared_ptr<const SkBitmap>& outShaderBitmap) const;
         bool obtainMapIcon(const QString& name, std::shared_ptr<const SkBitmap>& outIcon) const;
@@ -4,15 +4,19 @@
 #include <OsmAndCore/stdlib_common.h>
 #include <functional>
 #include <array>
+#include <vector>
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QVector>
+#include <QReadWriteLock>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
 #include <OsmAndCore/PrivateImplementation.h>
 #include <OsmAndCore/IQueryController.h>
 #include <OsmAndCore/SharedResourcesContainer.h>
+#include <OsmAndCore/StripedSharedResourcesContainer.h>
 #include <OsmAndCore/Data/MapObject.h>
 #include <OsmAndCore/Map/MapCommonTypes.h>
 #include <OsmAndCore/Map/MapStyleEvaluationResult.h>
@@ -22,6 +26,10 @@ namespace OsmAnd
 {
     class MapObject;
     class MapPresentationEnvironment;
+    namespace Concurrent
+    {
+        class WorkerPool;
+    }
 
     class MapPrimitiviser_P;
     class OSMAND_CORE_API MapPrimitiviser
@@ -38,7 +46,9 @@ namespace OsmAnd
         enum {
             LastZoomToUseBasemap = ZoomLevel11,
             DetailedLandDataMinZoom = ZoomLevel14,
-            DefaultTextLabelWrappingLengthInCharacters = 20
+            DefaultTextLabelWrappingLengthInCharacters = 20,
+            MinObjectsPerPartition = 1024,
+            MinPrimitivesPerSortPartition = 4096,
         };
 
         class OSMAND_CORE_API CoastlineMapObject : public MapObject
@@ -84,6 +94,13 @@ namespace OsmAnd
             PrimitivesCollection polylines;
             PrimitivesCollection points;
 
+            // Outer points of source object, simplified with tolerance of rasterization at zoom of this group.
+            // Empty if group has no polygons or polylines, or if simplification did not remove any point.
+            QVector<PointI> simplifiedPoints31;
+
+            // Returns simplified points if there are any, otherwise points of source object
+            const QVector<PointI>& getPoints31() const;
+
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
         };
@@ -120,6 +137,60 @@ namespace OsmAnd
         friend class OsmAnd::MapPrimitiviser_P;
         };
 
+        // PrimitivesArrays stores primitives of a tile as contiguous arrays, one per field of a record. Sort keys
+        // are computed once, when record is appended. Records only reference primitives, their source objects and
+        // points to rasterize, which are owned by primitives groups.
+        class OSMAND_CORE_API PrimitivesArrays Q_DECL_FINAL
+        {
+        public:
+            // Orders records same way as they are rasterized: by zOrder, by area (larger first), by attribute
+            // (only inside same object), by number of points and finally by sorting key of source object
+            struct OSMAND_CORE_API Comparator Q_DECL_FINAL
+            {
+                Comparator(const PrimitivesArrays& arrays);
+
+                const PrimitivesArrays& arrays;
+
+                bool operator()(const uint32_t l, const uint32_t r) const;
+            };
+
+        private:
+            template<typename T>
+            static void reorderArray(std::vector<T>& array, const std::vector<uint32_t>& order);
+        protected:
+        public:
+            // No destructor is declared, so that arrays are moved rather than copied (e.g. when merging results)
+            PrimitivesArrays();
+
+            std::vector<const Primitive*> primitives;
+            std::vector<const MapObject*> sourceObjects;
+            std::vector<int> zOrders;
+            std::vector<int64_t> doubledAreas;
+            std::vector<uint32_t> attributeIdIndices;
+            std::vector<int> pointsCounts;
+            std::vector<MapObject::SortingKey> objectSortingKeys;
+            std::vector<uint8_t> objectHasSortingKey;
+            std::vector<const QVector<PointI>*> points31;
+
+            int size() const;
+            bool isEmpty() const;
+            void reserve(const int capacity);
+            void clear();
+
+            // Points to rasterize default to points of source object
+            void append(const Primitive& primitive, const QVector<PointI>* const points31 = nullptr);
+            void append(const PrimitivesCollection& primitives, const QVector<PointI>* const points31 = nullptr);
+            void append(const PrimitivesArrays& that);
+
+            // Removes records that have non-zero flag in given array (one flag per record)
+            void remove(const std::vector<uint8_t>& removeFlags);
+
+            // Reorders records, so that record at index i is the one that was at index order[i]
+            void reorder(const std::vector<uint32_t>& order);
+
+            void sort();
+        };
+
         class Symbol;
         typedef QList< std::shared_ptr<const Symbol> > SymbolsCollection;
 
@@ -237,24 +308,43 @@ namespace OsmAnd
         {
             Q_DISABLE_COPY_AND_MOVE(Cache);
         public:
-            typedef SharedResourcesContainer<MapObject::SharingKey, const PrimitivesGroup> SharedPrimitivesGroupsContainer;
-            typedef SharedResourcesContainer<MapObject::SharingKey, const SymbolsGroup> SharedSymbolsGroupsContainer;
+            // Containers are striped, so they're not SharedResourcesContainer anymore, but provide same operations
+            typedef StripedSharedResourcesContainer< SharedResourcesContainer<MapObject::SharingKey, const PrimitivesGroup> >
+                SharedPrimitivesGroupsContainer;
+            typedef StripedSharedResourcesContainer< SharedResourcesContainer<MapObject::SharingKey, const SymbolsGroup> >
+                SharedSymbolsGroupsContainer;
 
         private:
         protected:
-            std::array<SharedPrimitivesGroupsContainer, ZoomLevelsCount> _sharedPrimitivesGroups;
+            // Primitives groups depend on scale as well (simplified points, polygons filtered by area in pixels),
+            // so they're shared only between tiles of same zoom and same scale
+            struct ScaledPrimitivesGroups
+            {
+                PointD scaleDivisor31ToPixel;
+                std::shared_ptr<SharedPrimitivesGroupsContainer> sharedGroups;
+            };
+            const size_t _retainedGroupsPerZoom;
+            mutable QReadWriteLock _sharedPrimitivesGroupsLock;
+            std::array<QList<ScaledPrimitivesGroups>, ZoomLevelsCount> _sharedPrimitivesGroups;
             std::array<SharedSymbolsGroupsContainer, ZoomLevelsCount> _sharedSymbolsGroups;
         public:
-            Cache();
+            // Groups of objects that are not referenced by any tile anymore may be retained (per zoom level,
+            // and per scale for primitives groups), so that they are not primitivised again when same area is
+            // shown again
+            Cache(const size_t retainedGroupsPerZoom = 0);
             virtual ~Cache();
 
-            virtual SharedPrimitivesGroupsContainer& getPrimitivesGroups(const ZoomLevel zoom);
-            virtual const SharedPrimitivesGroupsContainer& getPrimitivesGroups(const ZoomLevel zoom) const;
+            void clearRetained();
+
+            virtual SharedPrimitivesGroupsContainer& getPrimitivesGroups(
+                const ZoomLevel zoom,
+                const PointD scaleDivisor31ToPixel);
             virtual SharedSymbolsGroupsContainer& getSymbolsGroups(const ZoomLevel zoom);
             virtual const SharedSymbolsGroupsContainer& getSymbolsGroups(const ZoomLevel zoom) const;
             
-            SharedPrimitivesGroupsContainer* getPrimitivesGroupsPtr(const ZoomLevel zoom);
-            const SharedPrimitivesGroupsContainer* getPrimitivesGroupsPtr(const ZoomLevel zoom) const;
+            SharedPrimitivesGroupsContainer* getPrimitivesGroupsPtr(
+                const ZoomLevel zoom,
+                const PointD scaleDivisor31ToPixel);
             SharedSymbolsGroupsContainer* getSymbolsGroupsPtr(const ZoomLevel zoom);
             const SharedSymbolsGroupsContainer* getSymbolsGroupsPtr(const ZoomLevel zoom) const;
         };
@@ -278,9 +368,11 @@ namespace OsmAnd
             const PointD scaleDivisor31ToPixel;
 
             PrimitivesGroupsCollection primitivesGroups;
-            PrimitivesCollection polygons;
-            PrimitivesCollection polylines;
-            PrimitivesCollection points;
+
+            // Primitives of all groups, in order of rasterization
+            PrimitivesArrays polygons;
+            PrimitivesArrays polylines;
+            PrimitivesArrays points;
 
             SymbolsGroupsCollection symbolsGroups;
 
@@ -298,6 +390,13 @@ namespace OsmAnd
 
         const std::shared_ptr<const MapPresentationEnvironment> environment;
 
+        // If worker pool is set, map objects of single call are split into partitions of at least
+        // MinObjectsPerPartition objects that are primitivised in parallel on it (calling thread participates
+        // as well), and large collections of primitives are sorted in parallel. Result is same as without pool.
+        // Worker pool has to be set before any primitivisation is started.
+        void setWorkerPool(const std::shared_ptr<Concurrent::WorkerPool>& workerPool);
+        std::shared_ptr<Concurrent::WorkerPool> getWorkerPool() const;
+
         std::shared_ptr<PrimitivisedObjects> primitiviseAllMapObjects(
             const ZoomLevel zoom,
             const QList< std::shared_ptr<const MapObject> >& objects,
@@ -87,6 +87,24 @@ namespace OsmAnd
         /* Time spent on Point processing */                                                        \
         FIELD_ACTION(float, elapsedTimeForPointProcessing, "s");                                    \
                                                                                                     \
+        /* Number of evaluations that reused result of map object with same attributes */           \
+        FIELD_ACTION(unsigned int, evaluationCacheHits, "");                                        \
+                                                                                                    \
+        /* Number of evaluations that were performed and cached */                                  \
+        FIELD_ACTION(unsigned int, evaluationCacheMisses, "");                                      \
+                                                                                                    \
+        /* Number of evaluations of rules that depend on map object, thus not cached */             \
+        FIELD_ACTION(unsigned int, evaluationCacheBypasses, "");                                    \
+                                                                                                    \
+        /* Time spent on simplification of polygons and polylines */                                \
+        FIELD_ACTION(float, elapsedTimeForSimplification, "s");                                     \
+                                                                                                    \
+        /* Number of points removed by simplification of polygons and polylines */                  \
+        FIELD_ACTION(unsigned int, simplificationRemovedPoints, "");                                \
+                                                                                                    \
+        /* Number of partitions that map objects were primitivised in parallel in */                \
+        FIELD_ACTION(unsigned int, parallelPartitions, "");                                         \
+                                                                                                    \
         /* Time spent on sorting and filtering primitives */                                        \
         FIELD_ACTION(float, elapsedTimeForSortingAndFilteringPrimitives, "s");                      \
                                                                                                     \
@@ -136,6 +154,9 @@ namespace OsmAnd
 
             OsmAnd__MapPrimitiviser_Metrics__Metric_primitivise__FIELDS(EMIT_METRIC_FIELD);
 
+            // Adds values of all fields of other metric (e.g. one that was collected by another thread)
+            void merge(const Metric_primitivise& that);
+
             virtual QString toString(const bool shortFormat = false, const QString& prefix = QString::null) const;
         };
 
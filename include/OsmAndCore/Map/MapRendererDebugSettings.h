@@ -39,6 +39,8 @@ namespace OsmAnd
         bool disableJunkResourcesCleanup;
         bool disableNeededResourcesRequests;
         bool disableSymbolsFastCheckByFrustum;
+        bool disableIncrementalSymbolsPlacement;
+        bool disableTilesPrefetch;
         bool disableSkyStage;
         bool disableMapLayersStage;
         bool disableSymbolsStage;
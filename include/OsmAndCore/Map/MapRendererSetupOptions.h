@@ -88,6 +88,20 @@ namespace OsmAnd
         }
 #endif // !defined(SWIG)
 
+        // Size limit (in bytes) of CPU-side data of tiles that is retained per each provider after tiles leave
+        // visible area, so that revisited tiles only need to be uploaded to GPU. 0 means "retain nothing".
+        // Limit applies to each bound provider, so by default nothing is retained on mobile platforms
+        unsigned int retainedTilesCacheSizeLimit;
+#if !defined(SWIG)
+        inline MapRendererSetupOptions& setRetainedTilesCacheSizeLimit(
+            const unsigned int newRetainedTilesCacheSizeLimit)
+        {
+            retainedTilesCacheSizeLimit = newRetainedTilesCacheSizeLimit;
+
+            return *this;
+        }
+#endif // !defined(SWIG)
+
         inline bool isValid() const
         {
             return
@@ -0,0 +1,114 @@
+#ifndef _OSMAND_CORE_MAP_STYLE_EVALUATION_CACHE_H_
+#define _OSMAND_CORE_MAP_STYLE_EVALUATION_CACHE_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QHash>
+#include <QVector>
+#include <QReadWriteLock>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/Map/MapCommonTypes.h>
+#include <OsmAndCore/Map/IMapStyle.h>
+#include <OsmAndCore/Map/MapStyleEvaluationResult.h>
+#include <OsmAndCore/Data/MapObject.h>
+
+namespace OsmAnd
+{
+    class MapStyleEvaluator;
+    class MapStyleProgram;
+
+    // MapStyleEvaluationCache keeps results of ruleset evaluation for map objects that share same attributes,
+    // additional attributes, layer and shape at same zoom, since most objects of a tile share a few such
+    // signatures. Rules that read inputs specific to a single map object (like name tag or text length)
+    // are never cached and are evaluated each time. Cache requires style to provide a compiled program,
+    // otherwise all evaluations bypass it.
+    class OSMAND_CORE_API MapStyleEvaluationCache Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleEvaluationCache);
+    public:
+        enum class Lookup
+        {
+            Hit,
+            Miss,
+            Bypass,
+        };
+
+        enum : unsigned int {
+            DefaultCapacity = 16384u,
+        };
+
+    private:
+        struct Key Q_DECL_FINAL
+        {
+            Key(
+                const MapObject& mapObject,
+                const uint32_t attributeId,
+                const MapStyleRulesetType rulesetType,
+                const ZoomLevel zoom);
+
+            const MapObject::AttributeMapping* attributeMapping;
+            uint32_t attributeId;
+            MapStyleRulesetType rulesetType;
+            ZoomLevel zoom;
+            uint32_t shape;
+            QVector<uint32_t> attributeIds;
+            QVector<uint32_t> additionalAttributeIds;
+            uint hash;
+
+            bool operator==(const Key& that) const;
+        };
+        friend inline uint qHash(const Key& key, uint seed = 0)
+        {
+            return key.hash ^ seed;
+        }
+
+        struct Entry Q_DECL_FINAL
+        {
+            // Holds attribute mapping, so that address of it is not reused while entry exists
+            std::shared_ptr<const MapObject::AttributeMapping> attributeMapping;
+            bool dependsOnObject;
+            bool success;
+            MapStyleEvaluationResult::Packed result;
+        };
+
+        const std::shared_ptr<const MapStyleProgram> _program;
+        mutable QReadWriteLock _entriesLock;
+        QHash<Key, Entry> _entries;
+
+        bool isRuleDependentOnObject(
+            const MapStyleRulesetType rulesetType,
+            const MapObject::AttributeMapping::TagValue& decodedAttribute) const;
+    protected:
+    public:
+        MapStyleEvaluationCache(
+            const std::shared_ptr<const IMapStyle>& mapStyle,
+            const unsigned int capacity = DefaultCapacity);
+        ~MapStyleEvaluationCache();
+
+        const std::shared_ptr<const IMapStyle> mapStyle;
+        const unsigned int capacity;
+
+        // Evaluates rules of given ruleset for attribute of map object at given index, same way as
+        // MapStyleEvaluator::evaluate() does after INPUT_TAG and INPUT_VALUE are set to that attribute.
+        // Zoom must be the one evaluator was set up with. Inputs other than layer and shape of map object
+        // must be same for all evaluators that use this cache.
+        bool evaluate(
+            MapStyleEvaluator& evaluator,
+            const std::shared_ptr<const MapObject>& mapObject,
+            const int attributeIdIndex,
+            const MapStyleRulesetType rulesetType,
+            const ZoomLevel zoom,
+            MapStyleEvaluationResult& outResult,
+            Lookup* const outLookup = nullptr);
+
+        void clear();
+        unsigned int getSize() const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_STYLE_EVALUATION_CACHE_H_)
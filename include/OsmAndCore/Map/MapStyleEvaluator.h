@@ -24,11 +24,14 @@ namespace OsmAnd
     public:
         MapStyleEvaluator(
             const std::shared_ptr<const IMapStyle>& mapStyle,
-            const float ptScaleFactor);
+            const float ptScaleFactor,
+            const bool useCompiledProgram = true);
         virtual ~MapStyleEvaluator();
 
         const std::shared_ptr<const IMapStyle> mapStyle;
         const float ptScaleFactor;
+        // If disabled (or style provides no program), rule nodes of style are walked directly
+        const bool useCompiledProgram;
 
         void setBooleanValue(const IMapStyle::ValueDefinitionId valueDefId, const bool value);
         void setIntegerValue(const IMapStyle::ValueDefinitionId valueDefId, const int value);
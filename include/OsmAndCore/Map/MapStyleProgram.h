@@ -0,0 +1,165 @@
+#ifndef _OSMAND_CORE_MAP_STYLE_PROGRAM_H_
+#define _OSMAND_CORE_MAP_STYLE_PROGRAM_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <array>
+#include <vector>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QString>
+#include <QHash>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Map/MapCommonTypes.h>
+#include <OsmAndCore/Map/MapStyleConstantValue.h>
+#include <OsmAndCore/Map/IMapStyle.h>
+
+namespace OsmAnd
+{
+    // MapStyleProgram is a flat form of all rulesets and attributes of a map style, that is evaluated by
+    // MapStyleEvaluator instead of walking IMapStyle::IRuleNode trees. All nodes, conditions and outputs are
+    // stored in contiguous arrays and reference each other by index. Conditions are pre-classified and
+    // ordered from cheapest to most expensive, constant zoom bounds are folded into nodes, and INPUT_ADDITIONAL
+    // values are pre-split into tag and value.
+    class OSMAND_CORE_API MapStyleProgram Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleProgram);
+    public:
+        typedef uint32_t Index;
+        enum : uint32_t {
+            InvalidIndex = 0xFFFFFFFFu,
+        };
+
+        // Conditions of a node are checked in order of this enumeration, so it goes from cheapest to most expensive
+        enum class ConditionType : uint8_t
+        {
+            // Input value (as int) is compared with inlined constant
+            IntegerEquals,
+            // Input value (as float) is compared with inlined constant
+            FloatEquals,
+            // Input value has to be 1
+            Test,
+            // Rule value is complex or dynamic, so it's evaluated first
+            EvaluatedMinZoom,
+            EvaluatedMaxZoom,
+            EvaluatedIntegerEquals,
+            EvaluatedFloatEquals,
+            // Map object has to contain additional attribute or tag
+            AdditionalAttribute,
+            AdditionalTag,
+            // INPUT_ADDITIONAL that is not a constant
+            EvaluatedAdditional,
+        };
+
+        struct OSMAND_CORE_API Condition Q_DECL_FINAL
+        {
+            Condition();
+            ~Condition();
+
+            ConditionType type;
+            IMapStyle::ValueDefinitionId valueDefId;
+            MapStyleValueDataType dataType;
+            union {
+                int32_t asInt;
+                float asFloat;
+                Index additionalAttributeIndex;
+            } constant;
+            IMapStyle::Value value;
+        };
+
+        struct OSMAND_CORE_API Output Q_DECL_FINAL
+        {
+            Output();
+            ~Output();
+
+            IMapStyle::ValueDefinitionId valueDefId;
+            IMapStyle::Value value;
+        };
+
+        // Zoom bounds of each subnode are stored next to its index, so that subnodes that do not match
+        // zoom are skipped without touching their nodes
+        struct Subnode Q_DECL_FINAL
+        {
+            Index nodeIndex;
+            int32_t minZoom;
+            int32_t maxZoom;
+        };
+
+        struct OSMAND_CORE_API Node Q_DECL_FINAL
+        {
+            Node();
+
+            bool isSwitch;
+            // Node, any of its subnodes or attributes referenced by their values read input that describes
+            // single map object rather than its attributes (see isObjectSpecificInput())
+            bool dependsOnObject;
+            int32_t minZoom;
+            int32_t maxZoom;
+            Index firstCondition;
+            Index conditionsCount;
+            Index disableOutput;
+            Index firstOutput;
+            Index outputsCount;
+            Index firstOneOfConditionalSubnode;
+            Index oneOfConditionalSubnodesCount;
+            Index firstApplySubnode;
+            Index applySubnodesCount;
+        };
+
+        struct AdditionalAttribute Q_DECL_FINAL
+        {
+            QString tag;
+            QString value;
+        };
+
+    private:
+        enum class ResolvingState : uint8_t
+        {
+            Unresolved,
+            Resolving,
+            Resolved,
+        };
+
+        Index compileNode(const IMapStyle& mapStyle, const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode);
+        bool compileCondition(
+            const IMapStyle& mapStyle,
+            const IMapStyle::ValueDefinitionId valueDefId,
+            const IMapStyle::Value& value,
+            Node& node,
+            Condition& outCondition);
+        Index registerAdditionalAttribute(const QString& additional);
+        bool resolveDependsOnObject(const Index nodeIndex, std::vector<ResolvingState>& states);
+        bool resolveDependsOnObject(const IMapStyle::Value& value, std::vector<ResolvingState>& states);
+    protected:
+        MapStyleProgram();
+    public:
+        ~MapStyleProgram();
+
+        std::vector<Node> nodes;
+        std::vector<Condition> conditions;
+        std::vector<Output> outputs;
+        std::vector<Subnode> subnodes;
+        std::vector<AdditionalAttribute> additionalAttributes;
+        QHash<QString, Index> additionalAttributesIndices;
+
+        std::array< QHash<TagValueId, Index>, MapStyleRulesetTypesCount > rulesets;
+        QHash<const IMapStyle::IAttribute*, Index> attributes;
+
+        Index getRuleRootNode(const MapStyleRulesetType rulesetType, const TagValueId tagValueId) const;
+        Index getAttributeRootNode(const IMapStyle::IAttribute* const attribute) const;
+
+        // Returns true if any rule that may be evaluated for given tag and value (including fallbacks to
+        // tag-only and default rules) depends on map object beyond its attributes, layer and shape
+        bool isRuleDependentOnObject(
+            const MapStyleRulesetType rulesetType,
+            const IMapStyle::StringId tagStringId,
+            const IMapStyle::StringId valueStringId) const;
+        static bool isObjectSpecificInput(const IMapStyle::ValueDefinitionId valueDefId);
+
+        static std::shared_ptr<const MapStyleProgram> compile(const IMapStyle& mapStyle);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_STYLE_PROGRAM_H_)
@@ -5,7 +5,6 @@
 #include <functional>
 
 #include <OsmAndCore/QtExtensions.h>
-#include <QSet>
 
 class SkBitmap;
 
@@ -15,6 +14,7 @@ class SkBitmap;
 #include <OsmAndCore/Color.h>
 #include <OsmAndCore/Callable.h>
 #include <OsmAndCore/Map/MapCommonTypes.h>
+#include <OsmAndCore/Map/MapSymbolIntersectionClassesSet.h>
 
 namespace OsmAnd
 {
@@ -45,7 +45,7 @@ namespace OsmAnd
 
         int order;
         ContentClass contentClass;
-        QSet<MapSymbolIntersectionClassId> intersectsWithClasses;
+        MapSymbolIntersectionClassesSet intersectsWithClasses;
 
         bool isHidden;
         FColorARGB modulationColor;
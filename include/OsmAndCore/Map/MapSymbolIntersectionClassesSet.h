@@ -0,0 +1,206 @@
+#ifndef _OSMAND_CORE_MAP_SYMBOL_INTERSECTION_CLASSES_SET_H_
+#define _OSMAND_CORE_MAP_SYMBOL_INTERSECTION_CLASSES_SET_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <cstdint>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QVector>
+#include <QSet>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Map/MapCommonTypes.h>
+
+namespace OsmAnd
+{
+    // Set of intersection classes stored as bits indexed by class id. Classes registered first (which are most
+    // of classes used by a style) fit into fixed-width inline words, others go to overflow words allocated on
+    // demand, so that test of two sets is a few AND instructions in common case.
+    class OSMAND_CORE_API MapSymbolIntersectionClassesSet Q_DECL_FINAL
+    {
+    public:
+        typedef MapSymbolIntersectionClassId ClassId;
+        typedef uint64_t Word;
+
+        enum : unsigned int {
+            WordBitsCount = 64u,
+            InlineWordsCount = 2u,
+            InlineClassesCount = InlineWordsCount * WordBitsCount,
+        };
+
+    private:
+        Word _inlineWords[InlineWordsCount];
+        // Words for classes starting from InlineClassesCount, without trailing empty words
+        QVector<Word> _overflowWords;
+
+        inline void trimOverflowWords()
+        {
+            auto wordsCount = _overflowWords.size();
+            while (wordsCount > 0 && _overflowWords[wordsCount - 1] == 0)
+                wordsCount--;
+            if (wordsCount != _overflowWords.size())
+                _overflowWords.resize(wordsCount);
+        }
+    protected:
+    public:
+        inline MapSymbolIntersectionClassesSet()
+        {
+            clear();
+        }
+
+        inline ~MapSymbolIntersectionClassesSet()
+        {
+        }
+
+        inline bool contains(const ClassId classId) const
+        {
+            if (classId < 0)
+                return false;
+
+            const auto index = static_cast<unsigned int>(classId);
+            const auto bit = Word(1) << (index % WordBitsCount);
+            if (index < InlineClassesCount)
+                return (_inlineWords[index / WordBitsCount] & bit) != 0;
+
+            const auto overflowWordIndex = static_cast<int>((index - InlineClassesCount) / WordBitsCount);
+            if (overflowWordIndex >= _overflowWords.size())
+                return false;
+            return (_overflowWords[overflowWordIndex] & bit) != 0;
+        }
+
+        inline void insert(const ClassId classId)
+        {
+            if (classId < 0)
+                return;
+
+            const auto index = static_cast<unsigned int>(classId);
+            const auto bit = Word(1) << (index % WordBitsCount);
+            if (index < InlineClassesCount)
+            {
+                _inlineWords[index / WordBitsCount] |= bit;
+                return;
+            }
+
+            const auto overflowWordIndex = static_cast<int>((index - InlineClassesCount) / WordBitsCount);
+            if (overflowWordIndex >= _overflowWords.size())
+                _overflowWords.resize(overflowWordIndex + 1);
+            _overflowWords[overflowWordIndex] |= bit;
+        }
+
+        inline bool remove(const ClassId classId)
+        {
+            if (!contains(classId))
+                return false;
+
+            const auto index = static_cast<unsigned int>(classId);
+            const auto bit = Word(1) << (index % WordBitsCount);
+            if (index < InlineClassesCount)
+            {
+                _inlineWords[index / WordBitsCount] &= ~bit;
+                return true;
+            }
+
+            _overflowWords[(index - InlineClassesCount) / WordBitsCount] &= ~bit;
+            trimOverflowWords();
+            return true;
+        }
+
+        inline bool isEmpty() const
+        {
+            for (auto wordIndex = 0u; wordIndex < InlineWordsCount; wordIndex++)
+            {
+                if (_inlineWords[wordIndex] != 0)
+                    return false;
+            }
+            return _overflowWords.isEmpty();
+        }
+
+        inline void clear()
+        {
+            for (auto wordIndex = 0u; wordIndex < InlineWordsCount; wordIndex++)
+                _inlineWords[wordIndex] = 0;
+            _overflowWords.clear();
+        }
+
+        // Returns true if both sets have at least one common class
+        inline bool intersects(const MapSymbolIntersectionClassesSet& that) const
+        {
+            for (auto wordIndex = 0u; wordIndex < InlineWordsCount; wordIndex++)
+            {
+                if ((_inlineWords[wordIndex] & that._inlineWords[wordIndex]) != 0)
+                    return true;
+            }
+
+            if (Q_LIKELY(_overflowWords.isEmpty() || that._overflowWords.isEmpty()))
+                return false;
+
+            const auto commonOverflowWordsCount = qMin(_overflowWords.size(), that._overflowWords.size());
+            const auto pOverflowWords = _overflowWords.constData();
+            const auto pThatOverflowWords = that._overflowWords.constData();
+            for (auto wordIndex = 0; wordIndex < commonOverflowWordsCount; wordIndex++)
+            {
+                if ((pOverflowWords[wordIndex] & pThatOverflowWords[wordIndex]) != 0)
+                    return true;
+            }
+
+            return false;
+        }
+
+        inline bool hasOverflow() const
+        {
+            return !_overflowWords.isEmpty();
+        }
+
+        inline int count() const
+        {
+            auto classesCount = 0;
+            for (auto wordIndex = 0u; wordIndex < InlineWordsCount; wordIndex++)
+                classesCount += countBits(_inlineWords[wordIndex]);
+            for (const auto word : _overflowWords)
+                classesCount += countBits(word);
+            return classesCount;
+        }
+
+        QSet<ClassId> toSet() const
+        {
+            QSet<ClassId> result;
+            const auto classesCount = static_cast<ClassId>(InlineClassesCount + _overflowWords.size() * WordBitsCount);
+            for (auto classId = 0; classId < classesCount; classId++)
+            {
+                if (contains(classId))
+                    result.insert(classId);
+            }
+            return result;
+        }
+
+        inline bool operator==(const MapSymbolIntersectionClassesSet& that) const
+        {
+            for (auto wordIndex = 0u; wordIndex < InlineWordsCount; wordIndex++)
+            {
+                if (_inlineWords[wordIndex] != that._inlineWords[wordIndex])
+                    return false;
+            }
+            return _overflowWords == that._overflowWords;
+        }
+
+        inline bool operator!=(const MapSymbolIntersectionClassesSet& that) const
+        {
+            return !(*this == that);
+        }
+
+        static inline int countBits(Word word)
+        {
+            auto bitsCount = 0;
+            while (word != 0)
+            {
+                word &= word - 1;
+                bitsCount++;
+            }
+            return bitsCount;
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_SYMBOL_INTERSECTION_CLASSES_SET_H_)
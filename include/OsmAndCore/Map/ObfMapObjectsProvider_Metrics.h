@@ -18,6 +18,15 @@ namespace OsmAnd
         /* Elapsed time on obtaining OBF interface */                                           \
         FIELD_ACTION(float, elapsedTimeForObtainingObfInterface, "s");                          \
                                                                                                 \
+        /* Elapsed time on selecting candidate OBF files from spatial index */                  \
+        FIELD_ACTION(float, elapsedTimeForObfsSelection, "s");                                  \
+                                                                                                \
+        /* Number of OBF files selected as candidates */                                        \
+        FIELD_ACTION(unsigned int, obfFilesSelected, "");                                       \
+                                                                                                \
+        /* Number of OBF files opened (not reused) while obtaining and reading data */          \
+        FIELD_ACTION(unsigned int, obfFilesOpened, "");                                         \
+                                                                                                \
         /* Elapsed time on filtering BinaryMapObjects by their ID to skip loaded ones */        \
         FIELD_ACTION(float, elapsedTimeForObjectsFiltering, "s");                               \
                                                                                                 \
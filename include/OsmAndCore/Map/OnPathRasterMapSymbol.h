@@ -10,6 +10,7 @@
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/GlyphAtlas.h>
 #include <OsmAndCore/Map/RasterMapSymbol.h>
 #include <OsmAndCore/Map/IOnPathMapSymbol.h>
 
@@ -29,6 +30,8 @@ namespace OsmAnd
         virtual ~OnPathRasterMapSymbol();
 
         QVector<float> glyphsWidth;
+        // If set, bitmap is a page of glyph atlas and glyphs are drawn from cells of that page
+        std::shared_ptr<const GlyphAtlas::GlyphRun> glyphRun;
         std::shared_ptr< const QVector<PointI> > shareablePath31;
         PinPoint pinPointOnPath;
 
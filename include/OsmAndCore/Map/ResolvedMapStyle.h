@@ -214,6 +214,10 @@ namespace OsmAnd
 
         virtual QString getStringById(const SWIG_CLARIFY(IMapStyle, StringId) id) const Q_DECL_OVERRIDE;
 
+#if !defined(SWIG)
+        virtual std::shared_ptr<const MapStyleProgram> getProgram() const Q_DECL_OVERRIDE;
+#endif // !defined(SWIG)
+
         static std::shared_ptr<const ResolvedMapStyle> resolveMapStylesChain(
             const QList< std::shared_ptr<const UnresolvedMapStyle> >& unresolvedMapStylesChain);
     };
@@ -14,6 +14,7 @@
 #include <OsmAndCore/TextRasterizer.h>
 #include <OsmAndCore/Map/MapCommonTypes.h>
 #include <OsmAndCore/Map/MapPrimitiviser.h>
+#include <OsmAndCore/Map/SymbolRasterizer_Metrics.h>
 
 class SkCanvas;
 class SkBitmap;
@@ -101,6 +102,9 @@ namespace OsmAnd
             virtual ~RasterizedOnPathSymbol();
 
             QVector<SkScalar> glyphsWidth;
+
+            // If set, bitmap is a page of glyph atlas and glyphs are drawn from cells of that page
+            std::shared_ptr<const GlyphAtlas::GlyphRun> glyphRun;
         };
 
         //NOTE: This won't work due to directors+shared_ptr are not supported. To summarize: it's currently impossible to use any %shared_ptr-marked type in a director declaration
@@ -123,6 +127,7 @@ namespace OsmAnd
             const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
             QList< std::shared_ptr<const RasterizedSymbolsGroup> >& outSymbolsGroups,
             const FilterByMapObject filter = nullptr,
+            SymbolRasterizer_Metrics::Metric_rasterize* const metric = nullptr,
             const std::shared_ptr<const IQueryController>& queryController = nullptr) const;
     };
 }
@@ -0,0 +1,60 @@
+#ifndef _OSMAND_CORE_SYMBOL_RASTERIZER_METRICS_H_
+#define _OSMAND_CORE_SYMBOL_RASTERIZER_METRICS_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <functional>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QString>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Metrics.h>
+
+namespace OsmAnd
+{
+    namespace SymbolRasterizer_Metrics
+    {
+#define OsmAnd__SymbolRasterizer_Metrics__Metric_rasterize__FIELDS(FIELD_ACTION)                    \
+        /* Total elapsed time */                                                                    \
+        FIELD_ACTION(float, elapsedTime, "s");                                                      \
+                                                                                                    \
+        /* Number of rasterized texts */                                                            \
+        FIELD_ACTION(unsigned int, texts, "");                                                      \
+                                                                                                    \
+        /* Time spent on rasterization of texts */                                                  \
+        FIELD_ACTION(float, elapsedTimeForTexts, "s");                                              \
+                                                                                                    \
+        /* Number of texts which rasterized bitmap was reused */                                    \
+        FIELD_ACTION(unsigned int, textCacheBitmapHits, "");                                        \
+                                                                                                    \
+        /* Number of texts which shaping was reused, but that were rasterized again */              \
+        FIELD_ACTION(unsigned int, textCacheShapedTextHits, "");                                    \
+                                                                                                    \
+        /* Number of texts that were shaped and rasterized */                                       \
+        FIELD_ACTION(unsigned int, textCacheMisses, "");                                            \
+                                                                                                    \
+        /* Number of texts rasterized while caches of text rasterizer are disabled */               \
+        FIELD_ACTION(unsigned int, textCacheBypasses, "");                                          \
+                                                                                                    \
+        /* Number of texts laid out as runs of glyphs from glyph atlas */                           \
+        FIELD_ACTION(unsigned int, glyphRuns, "");                                                  \
+                                                                                                    \
+        /* Number of glyph atlas cells referenced by glyph runs */                                  \
+        FIELD_ACTION(unsigned int, glyphCells, "");                                                 \
+                                                                                                    \
+        /* Number of glyph atlas cells that were drawn, since atlas didn't have them */             \
+        FIELD_ACTION(unsigned int, glyphCellsDrawn, "");
+        struct OSMAND_CORE_API Metric_rasterize : public Metric
+        {
+            Metric_rasterize();
+            virtual ~Metric_rasterize();
+            virtual void reset();
+
+            OsmAnd__SymbolRasterizer_Metrics__Metric_rasterize__FIELDS(EMIT_METRIC_FIELD);
+
+            virtual QString toString(const bool shortFormat = false, const QString& prefix = QString::null) const;
+        };
+    }
+}
+
+#endif // !defined(_OSMAND_CORE_SYMBOL_RASTERIZER_METRICS_H_)
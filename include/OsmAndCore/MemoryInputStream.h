@@ -0,0 +1,48 @@
+#ifndef _OSMAND_CORE_MEMORY_INPUT_STREAM_H_
+#define _OSMAND_CORE_MEMORY_INPUT_STREAM_H_
+
+#include <memory>
+
+#include <OsmAndCore/QtExtensions.h>
+
+#include "ignore_warnings_on_external_includes.h"
+#include <google/protobuf/io/zero_copy_stream.h>
+#include "restore_internal_warnings.h"
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd
+{
+    namespace gpb = google::obf_protobuf;
+
+    /**
+    Implementation of input stream for Google Protobuf over memory region owned by someone else.
+    Unlike gpb::io::ArrayInputStream, it's allowed to back up to any position. Several instances
+    may share same memory region, each keeping own position.
+    */
+    class OSMAND_CORE_API MemoryInputStream : public gpb::io::ZeroCopyInputStream
+    {
+    private:
+        GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MemoryInputStream);
+
+        //! Pointer to memory
+        const uint8_t* const _data;
+
+        //! Memory size
+        const qint64 _size;
+
+        //! Current position
+        qint64 _currentPosition;
+    protected:
+    public:
+        MemoryInputStream(const uint8_t* const data, const qint64 size);
+        virtual ~MemoryInputStream();
+
+        virtual bool Next(const void** data, int* size);
+        virtual void BackUp(int count);
+        virtual bool Skip(int count);
+        virtual gpb::int64 ByteCount() const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MEMORY_INPUT_STREAM_H_)
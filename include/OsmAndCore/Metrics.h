@@ -18,6 +18,8 @@
     type name
 #define RESET_METRIC_FIELD(type, name, measurement)                                                                             \
     name = 0
+#define MERGE_METRIC_FIELD(type, name, measurement)                                                                             \
+    name += that.name
 #define PRINT_METRIC_FIELD(type, name, measurement)                                                                             \
     output +=                                                                                                                   \
         (output.isEmpty() ? QString() : QString(QLatin1String("\n"))) +                                                         \
@@ -7,6 +7,9 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QVector>
+#include <QSet>
+#include <QHash>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -16,18 +19,63 @@
 #include <OsmAndCore/Data/ObfPoiSectionReader.h>
 #include <OsmAndCore/Data/ObfAddressSectionReader.h>
 #include <OsmAndCore/CollatorStringMatcher.h>
+#include <OsmAndCore/ObfDataInterface_Metrics.h>
 
 namespace OsmAnd
 {
     class ObfReader;
     class ObfFile;
     class ObfMapObject;
+    class ObfPoiSectionInfo;
     class IQueryController;
+    namespace Concurrent
+    {
+        class WorkerPool;
+    }
 
     class OSMAND_CORE_API ObfDataInterface
     {
         Q_DISABLE_COPY_AND_MOVE(ObfDataInterface);
+    public:
+        typedef std::function<void ()> SectionTask;
+
     private:
+        std::shared_ptr<Concurrent::WorkerPool> _workerPool;
+
+        bool shouldRunInParallel(const int sectionsCount) const;
+        bool runSectionTasks(
+            const QVector<SectionTask>& tasks,
+            const std::shared_ptr<const IQueryController>& queryController) const;
+
+        // In parallel mode each section is read into its own output, and outputs are merged in order of sections
+        template<typename T>
+        static T* selectSectionOutput(T* const output, T* const sectionOutput, const bool parallel)
+        {
+            return (output && parallel) ? sectionOutput : output;
+        }
+        template<typename T>
+        static void mergeSectionOutput(QList<T>* const output, QList<T>& sectionOutput)
+        {
+            if (!output || sectionOutput.isEmpty())
+                return;
+
+            if (output->isEmpty())
+                *output = qMove(sectionOutput);
+            else
+                output->append(sectionOutput);
+        }
+
+        template<typename RESULT_TYPE>
+        struct NearestResults;
+        struct StreamingQuery;
+        static double getSquaredDistanceToArea(const PointI& point31, const AreaI& area31);
+
+        static bool resolvePoiCategoriesFilter(
+            const std::shared_ptr<const ObfReader>& obfReader,
+            const std::shared_ptr<const ObfPoiSectionInfo>& poiSection,
+            const QHash<QString, QStringList>& categoriesFilter,
+            QSet<ObfPoiCategoryId>& outCategoriesFilterById,
+            const std::shared_ptr<const IQueryController>& queryController);
     protected:
     public:
         ObfDataInterface(const QList< std::shared_ptr<const ObfReader> >& obfReaders);
@@ -35,6 +83,12 @@ namespace OsmAnd
 
         const QList< std::shared_ptr<const ObfReader> > obfReaders;
 
+        // If worker pool is set, loadMapObjects(), loadAmenities(), scanAmenitiesByName() and scanAddressesByName()
+        // read sections of all files in parallel on it (calling thread participates as well). Results are still
+        // returned in order of sections, but visitors and filters may be called concurrently from different threads.
+        void setWorkerPool(const std::shared_ptr<Concurrent::WorkerPool>& workerPool);
+        std::shared_ptr<Concurrent::WorkerPool> getWorkerPool() const;
+
         bool loadObfFiles(
             QList< std::shared_ptr<const ObfFile> >* outFiles = nullptr,
             const std::shared_ptr<const IQueryController>& queryController = nullptr);
@@ -124,6 +178,47 @@ namespace OsmAnd
             const ObfAddressSectionReader::VisitorFunction visitor = nullptr,
             const std::shared_ptr<const IQueryController>& queryController = nullptr);
 
+        // Streaming queries pass each result to visitor as soon as it's read (visitor is never called concurrently),
+        // and stop reading boxes and sections once limit of accepted results is reached or query controller is
+        // aborted, which is also the way to stop such query from visitor. Limit of 0 means no limit.
+        // If nearestTo31 is given, limit results nearest to it are returned, sorted by distance to it. Sections are
+        // read in order of distance and reading stops at first section that is farther than all kept results. In that
+        // mode visitor acts as a filter: result it accepts may be still displaced by nearer one read later.
+        bool streamBinaryMapObjects(
+            QList< std::shared_ptr<const OsmAnd::BinaryMapObject> >* outMapObjects,
+            const unsigned int limit,
+            const ZoomLevel zoom,
+            const PointI* const nearestTo31 = nullptr,
+            const AreaI* const bbox31 = nullptr,
+            const ObfMapSectionReader::FilterByIdFunction filterById = nullptr,
+            const ObfMapSectionReader::VisitorFunction visitor = nullptr,
+            const std::shared_ptr<const IQueryController>& queryController = nullptr,
+            ObfDataInterface_Metrics::Metric_streamQuery* const metric = nullptr);
+
+        bool streamAmenities(
+            QList< std::shared_ptr<const OsmAnd::Amenity> >* outAmenities,
+            const unsigned int limit,
+            const PointI* const nearestTo31 = nullptr,
+            const AreaI* const bbox31 = nullptr,
+            const QString& nameQuery = QString::null,
+            const QHash<QString, QStringList>* const categoriesFilter = nullptr,
+            const ObfPoiSectionReader::VisitorFunction visitor = nullptr,
+            const std::shared_ptr<const IQueryController>& queryController = nullptr,
+            ObfDataInterface_Metrics::Metric_streamQuery* const metric = nullptr);
+
+        bool streamAddressesByName(
+            const QString& query,
+            const StringMatcherMode matcherMode,
+            QList< std::shared_ptr<const OsmAnd::Address> >* outAddresses,
+            const unsigned int limit,
+            const PointI* const nearestTo31 = nullptr,
+            const AreaI* const bbox31 = nullptr,
+            const ObfAddressStreetGroupTypesMask streetGroupTypesFilter = fullObfAddressStreetGroupTypesMask(),
+            const bool includeStreets = true,
+            const ObfAddressSectionReader::VisitorFunction visitor = nullptr,
+            const std::shared_ptr<const IQueryController>& queryController = nullptr,
+            ObfDataInterface_Metrics::Metric_streamQuery* const metric = nullptr);
+
         bool loadStreetGroups(
             QList< std::shared_ptr<const StreetGroup> >* resultOut = nullptr,
             const AreaI* const bbox31 = nullptr,
@@ -0,0 +1,49 @@
+#ifndef _OSMAND_CORE_OBF_DATA_INTERFACE_METRICS_H_
+#define _OSMAND_CORE_OBF_DATA_INTERFACE_METRICS_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <functional>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QString>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Metrics.h>
+
+namespace OsmAnd
+{
+    namespace ObfDataInterface_Metrics
+    {
+#define OsmAnd__ObfDataInterface_Metrics__Metric_streamQuery__FIELDS(FIELD_ACTION)                  \
+        /* Number of sections that were read (entirely or until limit was reached) */               \
+        FIELD_ACTION(unsigned int, visitedSections, "");                                            \
+                                                                                                    \
+        /* Number of sections not read at all: limit was reached, too far or query was stopped */   \
+        FIELD_ACTION(unsigned int, skippedSections, "");                                            \
+                                                                                                    \
+        /* Number of results accepted by visitor and limit */                                       \
+        FIELD_ACTION(unsigned int, acceptedResults, "");                                            \
+                                                                                                    \
+        /* Number of results rejected by visitor */                                                 \
+        FIELD_ACTION(unsigned int, rejectedResults, "");                                            \
+                                                                                                    \
+        /* Number of results read after limit was reached, or not among nearest ones */             \
+        FIELD_ACTION(unsigned int, droppedResults, "");                                             \
+                                                                                                    \
+        /* Elapsed time of entire query (in seconds) */                                             \
+        FIELD_ACTION(float, elapsedTime, "s");
+
+        struct OSMAND_CORE_API Metric_streamQuery : public Metric
+        {
+            Metric_streamQuery();
+            virtual ~Metric_streamQuery();
+            virtual void reset();
+
+            OsmAnd__ObfDataInterface_Metrics__Metric_streamQuery__FIELDS(EMIT_METRIC_FIELD);
+
+            virtual QString toString(const bool shortFormat = false, const QString& prefix = QString::null) const;
+        };
+    }
+}
+
+#endif // !defined(_OSMAND_CORE_OBF_DATA_INTERFACE_METRICS_H_)
@@ -30,9 +30,12 @@ namespace OsmAnd
     protected:
         PrivateImplementation<ObfsCollection_P> _p;
     public:
-        ObfsCollection();
+        ObfsCollection(const QString& obfInfoCachePath = QString::null);
         virtual ~ObfsCollection();
 
+        // Directory where sidecar copies of OBF headers are kept, so that collected files do not need to be opened
+        const QString obfInfoCachePath;
+
         QList<SourceOriginId> getSourceOriginIds() const;
         SourceOriginId addDirectory(const QDir& dir, bool recursive = true);
         SourceOriginId addDirectory(const QString& dirPath, bool recursive = true);
@@ -0,0 +1,61 @@
+#ifndef _OSMAND_CORE_Q_FILE_DEVICE_MAPPED_INPUT_STREAM_H_
+#define _OSMAND_CORE_Q_FILE_DEVICE_MAPPED_INPUT_STREAM_H_
+
+#include <memory>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QFileDevice>
+
+#include "ignore_warnings_on_external_includes.h"
+#include <google/protobuf/io/zero_copy_stream.h>
+#include "restore_internal_warnings.h"
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd
+{
+    namespace gpb = google::obf_protobuf;
+
+    /**
+    Implementation of input stream for Google Protobuf via QFileDevice that is entirely mapped into memory.
+    Unlike gpb::io::ArrayInputStream, it's allowed to back up to any position, so CodedInputStream::Seek()
+    works in both directions without remapping or copying.
+    */
+    class OSMAND_CORE_API QFileDeviceMappedInputStream : public gpb::io::ZeroCopyInputStream
+    {
+    private:
+        GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(QFileDeviceMappedInputStream);
+
+        //! Pointer to I/O device
+        const std::shared_ptr<QFileDevice> _file;
+
+        //! File size
+        const qint64 _fileSize;
+
+        //! Pointer to mapped memory
+        uint8_t* _mappedMemory;
+
+        //! Current position
+        qint64 _currentPosition;
+
+        //! Should close on destruction?
+        bool _closeOnDestruction;
+    protected:
+    public:
+        QFileDeviceMappedInputStream(const std::shared_ptr<QFileDevice>& file);
+        virtual ~QFileDeviceMappedInputStream();
+
+        const std::shared_ptr<const QFileDevice> file;
+
+        bool isMapped() const;
+        const uint8_t* getMappedMemory() const;
+        qint64 getMappedSize() const;
+
+        virtual bool Next(const void** data, int* size);
+        virtual void BackUp(int count);
+        virtual bool Skip(int count);
+        virtual gpb::int64 ByteCount() const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_Q_FILE_DEVICE_MAPPED_INPUT_STREAM_H_)
@@ -0,0 +1,74 @@
+#ifndef _OSMAND_CORE_Q_FILE_DEVICE_SHARED_INPUT_STREAM_H_
+#define _OSMAND_CORE_Q_FILE_DEVICE_SHARED_INPUT_STREAM_H_
+
+#include <memory>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QFileDevice>
+#include <QMutex>
+#include <QByteArray>
+
+#include "ignore_warnings_on_external_includes.h"
+#include <google/protobuf/io/zero_copy_stream.h>
+#include "restore_internal_warnings.h"
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd
+{
+    namespace gpb = google::obf_protobuf;
+
+    /**
+    Implementation of input stream for Google Protobuf via QFileDevice that is shared by several streams.
+    Each stream keeps own position and buffer, and reads data at that position while holding the mutex
+    shared by all streams of the same device. No memory is mapped, so data is copied, but several threads
+    can read single file handle, and file being replaced on disk can't crash the process.
+    Streams never open or close the device: it has to be opened by its owner, and once owner closes it,
+    reads fail.
+    */
+    class OSMAND_CORE_API QFileDeviceSharedInputStream : public gpb::io::ZeroCopyInputStream
+    {
+    public:
+        enum {
+            DefaultBufferSize = 64 * 1024, // 64Kb
+        };
+
+    private:
+        GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(QFileDeviceSharedInputStream);
+
+        //! Pointer to I/O device
+        const std::shared_ptr<QFileDevice> _file;
+
+        //! Mutex that guards I/O device position
+        const std::shared_ptr<QMutex> _fileMutex;
+
+        //! File size
+        const qint64 _fileSize;
+
+        //! Buffer that holds last read portion of data
+        QByteArray _buffer;
+
+        //! Offset and length of data in buffer
+        qint64 _bufferOffset;
+        int _bufferLength;
+
+        //! Current position
+        qint64 _currentPosition;
+    protected:
+    public:
+        QFileDeviceSharedInputStream(
+            const std::shared_ptr<QFileDevice>& file,
+            const std::shared_ptr<QMutex>& fileMutex,
+            const size_t bufferSize = DefaultBufferSize);
+        virtual ~QFileDeviceSharedInputStream();
+
+        const std::shared_ptr<const QFileDevice> file;
+
+        virtual bool Next(const void** data, int* size);
+        virtual void BackUp(int count);
+        virtual bool Skip(int count);
+        virtual gpb::int64 ByteCount() const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_Q_FILE_DEVICE_SHARED_INPUT_STREAM_H_)
@@ -30,7 +30,10 @@ namespace OsmAnd
     {
         Q_DISABLE_COPY_AND_MOVE(SharedByZoomResourcesContainer);
     public:
+        typedef KEY_TYPE Key;
         typedef typename SharedResourcesContainer<KEY_TYPE, RESOURCE_TYPE>::ResourcePtr ResourcePtr;
+        typedef typename SharedResourcesContainer<KEY_TYPE, RESOURCE_TYPE>::SizeEstimator SizeEstimator;
+        typedef typename SharedResourcesContainer<KEY_TYPE, RESOURCE_TYPE>::RetentionStatistics RetentionStatistics;
     protected:
         struct AvailableResourceEntry : public SharedResourcesContainer<KEY_TYPE, RESOURCE_TYPE>::AvailableResourceEntry
         {
@@ -81,7 +84,32 @@ namespace OsmAnd
         typedef std::shared_ptr<PromisedResourceEntry> PromisedResourceEntryPtr;
         QSet< PromisedResourceEntryPtr > _promisedResourceEntriesStorage;
         std::array< QHash< KEY_TYPE, PromisedResourceEntryPtr >, ZoomLevelsCount> _promisedResources;
+
+        void discardRetained(const KEY_TYPE& key, const QSet<ZoomLevel>& levels)
+        {
+            for (const auto& level : constOf(levels))
+            {
+                const auto& availableResources = _availableResources[level];
+                const auto citAvailableResourceEntry = availableResources.constFind(key);
+                if (citAvailableResourceEntry == availableResources.cend())
+                    continue;
+
+                const auto retentionStamp = (*citAvailableResourceEntry)->retentionStamp;
+                if (retentionStamp != 0)
+                    this->evictRetained(retentionStamp);
+            }
+        }
     protected:
+        virtual void removeEvictedResource(
+            const KEY_TYPE& key,
+            const std::shared_ptr<typename base::AvailableResourceEntry>& entry_)
+        {
+            const auto entry = std::static_pointer_cast<AvailableResourceEntry>(entry_);
+
+            for (const auto& level : constOf(entry->zoomLevels))
+                _availableResources[level].remove(key);
+            _availableResourceEntriesStorage.remove(entry);
+        }
     public:
         SharedByZoomResourcesContainer()
         {
@@ -90,6 +118,12 @@ namespace OsmAnd
         {
         }
 
+        using base::setRetentionBudget;
+        using base::getRetentionBudget;
+        using base::clearRetained;
+        using base::getRetentionStatistics;
+        using base::resetRetentionStatistics;
+
         void insert(const KEY_TYPE& key, const QSet<ZoomLevel>& levels, ResourcePtr& resourcePtr)
         {
             QWriteLocker scopedLocker(&this->_lock);
@@ -103,6 +137,9 @@ namespace OsmAnd
                 resourcePtr.get());
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key, levels);
+
             const AvailableResourceEntryPtr newEntryPtr(new AvailableResourceEntry(0, qMove(resourcePtr), levels));
 #ifndef Q_COMPILER_RVALUE_REFS
             resourcePtr.reset();
@@ -137,6 +174,9 @@ namespace OsmAnd
                 resourcePtr.get());
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key, levels);
+
             const AvailableResourceEntryPtr newEntryPtr(new AvailableResourceEntry(0, qMove(resourcePtr), levels));
             assert(resourcePtr.use_count() == 0);
 
@@ -167,6 +207,9 @@ namespace OsmAnd
                 resourcePtr.get());
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key, levels);
+
             const AvailableResourceEntryPtr newEntryPtr(new AvailableResourceEntry(1, resourcePtr, levels));
 
             for(const auto& level : constOf(levels))
@@ -217,9 +260,13 @@ namespace OsmAnd
             auto& availableResources = _availableResources[level];
             const auto& itAvailableResourceEntry = availableResources.find(key);
             if (itAvailableResourceEntry == availableResources.end())
+            {
+                this->_retentionStatistics.misses++;
                 return false;
+            }
             const auto& availableResourceEntry = *itAvailableResourceEntry;
 
+            this->unretain(*availableResourceEntry);
             availableResourceEntry->refCounter++;
             outResourcePtr = availableResourceEntry->resourcePtr;
 
@@ -255,7 +302,7 @@ namespace OsmAnd
                 *outRemainingReferences = availableResourceEntry->refCounter;
             if (autoClean && outWasCleaned)
                 *outWasCleaned = false;
-            if (autoClean && availableResourceEntry->refCounter == 0)
+            if (autoClean && availableResourceEntry->refCounter == 0 && !this->retain(key, availableResourceEntry))
             {
                 for(const auto& otherLevel : constOf(availableResourceEntry->zoomLevels))
                 {
@@ -289,6 +336,9 @@ namespace OsmAnd
                 qPrintable(Utilities::stringifyZoomLevels(levels)));
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key, levels);
+
             const PromisedResourceEntryPtr newEntryPtr(new PromisedResourceEntry(levels));
 
             for(const auto& level : constOf(levels))
@@ -561,6 +611,7 @@ namespace OsmAnd
             {
                 const auto& availableResourceEntry = *itAvailableResourceEntry;
 
+                this->unretain(*availableResourceEntry);
                 availableResourceEntry->refCounter++;
                 outResourcePtr = availableResourceEntry->resourcePtr;
 
@@ -581,6 +632,7 @@ namespace OsmAnd
             if (futureReferenceAvailable)
                 return true;
 
+            this->_retentionStatistics.misses++;
             makePromise(key, levels);
             return false;
         }
@@ -2,10 +2,12 @@
 #define _OSMAND_CORE_SHARED_RESOURCES_CONTAINER_H_
 
 #include <OsmAndCore/stdlib_common.h>
+#include <functional>
 #include <proper/future.h>
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QHash>
+#include <QMap>
 #include <QReadWriteLock>
 #include <QThread>
 
@@ -27,7 +29,34 @@ namespace OsmAnd
         Q_DISABLE_COPY_AND_MOVE(SharedResourcesContainer);
 
     public:
+        typedef KEY_TYPE Key;
         typedef std::shared_ptr<RESOURCE_TYPE> ResourcePtr;
+        typedef std::function<size_t (const ResourcePtr& resourcePtr)> SizeEstimator;
+
+        struct RetentionStatistics
+        {
+            RetentionStatistics()
+                : hits(0)
+                , misses(0)
+                , evictions(0)
+                , retainedCount(0)
+                , retainedSize(0)
+            {
+            }
+
+            // Number of references obtained to resources that were retained after release
+            uintmax_t hits;
+
+            // Number of references that were not obtained, so that resource had to be created
+            uintmax_t misses;
+
+            // Number of retained resources that were dropped
+            uintmax_t evictions;
+
+            // Number of currently retained resources and their estimated size
+            uintmax_t retainedCount;
+            uintmax_t retainedSize;
+        };
     protected:
         mutable QReadWriteLock _lock;
 
@@ -35,6 +64,7 @@ namespace OsmAnd
         {
             AvailableResourceEntry(const uintmax_t refCounter_, const ResourcePtr& resourcePtr_)
                 : refCounter(refCounter_)
+                , retentionStamp(0)
                 , resourcePtr(resourcePtr_)
             {
             }
@@ -42,6 +72,7 @@ namespace OsmAnd
 #ifdef Q_COMPILER_RVALUE_REFS
             AvailableResourceEntry(const uintmax_t refCounter_, ResourcePtr&& resourcePtr_)
                 : refCounter(refCounter_)
+                , retentionStamp(0)
                 , resourcePtr(resourcePtr_)
             {
             }
@@ -52,6 +83,10 @@ namespace OsmAnd
             }
 
             uintmax_t refCounter;
+
+            // Non-zero if resource has no references, but is retained
+            uint64_t retentionStamp;
+
             const ResourcePtr resourcePtr;
 
         private:
@@ -81,6 +116,102 @@ namespace OsmAnd
         private:
             Q_DISABLE_COPY_AND_MOVE(PromisedResourceEntry);
         };
+
+        // Retention tier: resources that lost all references are kept while they fit into budget,
+        // and are dropped in order they were released (least recently used first).
+        // Retained resources remain available, so obtaining a reference to one of them just stops retention.
+        struct RetainedResourceEntry
+        {
+            KEY_TYPE key;
+            std::shared_ptr<AvailableResourceEntry> entry;
+            size_t size;
+        };
+        QMap< uint64_t, RetainedResourceEntry > _retainedResources;
+        uint64_t _lastRetentionStamp;
+        size_t _retentionBudget;
+        SizeEstimator _retentionSizeEstimator;
+        RetentionStatistics _retentionStatistics;
+
+        bool retain(const KEY_TYPE& key, const std::shared_ptr<AvailableResourceEntry> entry)
+        {
+            if (_retentionBudget == 0)
+                return false;
+
+            const size_t size = _retentionSizeEstimator ? _retentionSizeEstimator(entry->resourcePtr) : 1;
+            if (size > _retentionBudget)
+                return false;
+
+            assert(entry->refCounter == 0);
+            assert(entry->retentionStamp == 0);
+            entry->retentionStamp = ++_lastRetentionStamp;
+
+            RetainedResourceEntry retainedEntry;
+            retainedEntry.key = key;
+            retainedEntry.entry = entry;
+            retainedEntry.size = size;
+            _retainedResources.insert(entry->retentionStamp, retainedEntry);
+            _retentionStatistics.retainedCount++;
+            _retentionStatistics.retainedSize += size;
+
+            shrinkRetained(_retentionBudget);
+
+            return true;
+        }
+
+        void unretain(AvailableResourceEntry& entry)
+        {
+            if (entry.retentionStamp == 0)
+                return;
+
+            const auto itRetainedEntry = _retainedResources.find(entry.retentionStamp);
+            assert(itRetainedEntry != _retainedResources.end());
+            _retentionStatistics.retainedCount--;
+            _retentionStatistics.retainedSize -= itRetainedEntry->size;
+            _retentionStatistics.hits++;
+            _retainedResources.erase(itRetainedEntry);
+
+            entry.retentionStamp = 0;
+        }
+
+        void evictRetained(const uint64_t retentionStamp)
+        {
+            const auto itRetainedEntry = _retainedResources.find(retentionStamp);
+            if (itRetainedEntry == _retainedResources.end())
+                return;
+            const auto retainedEntry = *itRetainedEntry;
+            _retainedResources.erase(itRetainedEntry);
+
+            _retentionStatistics.retainedCount--;
+            _retentionStatistics.retainedSize -= retainedEntry.size;
+            _retentionStatistics.evictions++;
+
+            retainedEntry.entry->retentionStamp = 0;
+            removeEvictedResource(retainedEntry.key, retainedEntry.entry);
+        }
+
+        void shrinkRetained(const size_t maxRetainedSize)
+        {
+            while (!_retainedResources.isEmpty() && _retentionStatistics.retainedSize > maxRetainedSize)
+                evictRetained(_retainedResources.firstKey());
+        }
+
+        virtual void removeEvictedResource(const KEY_TYPE& key, const std::shared_ptr<AvailableResourceEntry>& entry)
+        {
+            Q_UNUSED(entry);
+
+            _availableResources.remove(key);
+        }
+
+        void discardRetained(const KEY_TYPE& key)
+        {
+            const auto citAvailableResourceEntry = _availableResources.constFind(key);
+            if (citAvailableResourceEntry == _availableResources.cend())
+                return;
+
+            const auto retentionStamp = (*citAvailableResourceEntry)->retentionStamp;
+            if (retentionStamp != 0)
+                evictRetained(retentionStamp);
+        }
     private:
         QHash< KEY_TYPE, std::shared_ptr< AvailableResourceEntry > > _availableResources;
         QHash< KEY_TYPE, std::shared_ptr< PromisedResourceEntry > > _promisedResources;
@@ -88,12 +219,55 @@ namespace OsmAnd
     public:
         SharedResourcesContainer()
             : _lock(QReadWriteLock::Recursive)
+            , _lastRetentionStamp(0)
+            , _retentionBudget(0)
         {
         }
         virtual ~SharedResourcesContainer()
         {
         }
 
+        // Enables retention of resources that lost all references. Budget is measured by sizeEstimator,
+        // or in number of resources if there's none. Zero budget disables retention.
+        void setRetentionBudget(const size_t budget, const SizeEstimator sizeEstimator = nullptr)
+        {
+            QWriteLocker scopedLocker(&_lock);
+
+            _retentionBudget = budget;
+            _retentionSizeEstimator = sizeEstimator;
+            shrinkRetained(_retentionBudget);
+        }
+
+        size_t getRetentionBudget() const
+        {
+            QReadLocker scopedLocker(&_lock);
+
+            return _retentionBudget;
+        }
+
+        void clearRetained()
+        {
+            QWriteLocker scopedLocker(&_lock);
+
+            shrinkRetained(0);
+        }
+
+        RetentionStatistics getRetentionStatistics() const
+        {
+            QReadLocker scopedLocker(&_lock);
+
+            return _retentionStatistics;
+        }
+
+        void resetRetentionStatistics()
+        {
+            QWriteLocker scopedLocker(&_lock);
+
+            _retentionStatistics.hits = 0;
+            _retentionStatistics.misses = 0;
+            _retentionStatistics.evictions = 0;
+        }
+
         void insert(const KEY_TYPE& key, ResourcePtr& resourcePtr)
         {
             QWriteLocker scopedLocker(&_lock);
@@ -106,6 +280,9 @@ namespace OsmAnd
                 resourcePtr.get());
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key);
+
             // Resource must not be promised and must not be already available.
             // Otherwise behavior is undefined
             assert(!_promisedResources.contains(key));
@@ -133,6 +310,9 @@ namespace OsmAnd
                 resourcePtr.get());
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key);
+
             // Resource must not be promised and must not be already available.
             // Otherwise behavior is undefined
             assert(!_promisedResources.contains(key));
@@ -156,6 +336,9 @@ namespace OsmAnd
                 resourcePtr.get());
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key);
+
             // Resource must not be promised and must not be already available.
             // Otherwise behavior is undefined
             assert(!_promisedResources.contains(key));
@@ -197,9 +380,13 @@ namespace OsmAnd
 
             const auto itAvailableResourceEntry = _availableResources.find(key);
             if (itAvailableResourceEntry == _availableResources.end())
+            {
+                _retentionStatistics.misses++;
                 return false;
+            }
             const auto& availableResourceEntry = *itAvailableResourceEntry;
 
+            unretain(*availableResourceEntry);
             availableResourceEntry->refCounter++;
             outResourcePtr = availableResourceEntry->resourcePtr;
 
@@ -235,7 +422,7 @@ namespace OsmAnd
                 *outRemainingReferences = availableResourceEntry->refCounter;
             if (autoClean && outWasCleaned)
                 *outWasCleaned = false;
-            if (autoClean && availableResourceEntry->refCounter == 0)
+            if (autoClean && availableResourceEntry->refCounter == 0 && !retain(key, availableResourceEntry))
             {
                 _availableResources.erase(itAvailableResourceEntry);
 
@@ -258,6 +445,9 @@ namespace OsmAnd
                 qPrintable(QString::fromLatin1("%1").arg(key)));
 #endif
 
+            // Retained resource is replaced by new one
+            discardRetained(key);
+
             // Resource must not be promised and must not be already available.
             // Otherwise behavior is undefined
             assert(!_promisedResources.contains(key));
@@ -496,6 +686,7 @@ namespace OsmAnd
                     static_cast<uint64_t>(availableResourceEntry->refCounter) + 1);
 #endif
 
+                unretain(*availableResourceEntry);
                 availableResourceEntry->refCounter++;
                 outResourcePtr = availableResourceEntry->resourcePtr;
 
@@ -522,6 +713,7 @@ namespace OsmAnd
                 qPrintable(QString::fromLatin1("%1").arg(key)));
 #endif
 
+            _retentionStatistics.misses++;
             makePromise(key);
             return false;
         }
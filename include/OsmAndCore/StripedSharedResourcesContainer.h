@@ -0,0 +1,190 @@
+#ifndef _OSMAND_CORE_STRIPED_SHARED_RESOURCES_CONTAINER_H_
+#define _OSMAND_CORE_STRIPED_SHARED_RESOURCES_CONTAINER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <array>
+#include <utility>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QHash>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/SharedResourcesContainer.h>
+#include <OsmAndCore/SharedByZoomResourcesContainer.h>
+
+namespace OsmAnd
+{
+    // StripedSharedResourcesContainer splits keys of SharedResourcesContainer (or SharedByZoomResourcesContainer)
+    // between STRIPES_COUNT independent containers by hash of the key, so that threads working with different
+    // keys do not wait for each other on a single lock. Every operation is performed on the stripe that owns
+    // the key, so promise/future semantics of each key are exactly the ones of the underlying container.
+    // It offers same operations as the underlying container, but is not derived from it, so it can't be passed
+    // where reference to SharedResourcesContainer or SharedByZoomResourcesContainer is expected.
+    template<typename CONTAINER_TYPE, unsigned int STRIPES_COUNT = 16>
+    class StripedSharedResourcesContainer
+    {
+        Q_DISABLE_COPY_AND_MOVE(StripedSharedResourcesContainer);
+
+        static_assert(STRIPES_COUNT > 0, "STRIPES_COUNT must be positive");
+    public:
+        typedef CONTAINER_TYPE Container;
+        typedef typename Container::Key Key;
+        typedef typename Container::ResourcePtr ResourcePtr;
+        typedef typename Container::SizeEstimator SizeEstimator;
+        typedef typename Container::RetentionStatistics RetentionStatistics;
+
+        enum : unsigned int {
+            StripesCount = STRIPES_COUNT,
+        };
+
+    private:
+        std::array<Container, STRIPES_COUNT> _stripes;
+    protected:
+        // Hashes of most keys (ids, sharing keys) have poor low bits, so they are mixed before being reduced
+        static unsigned int getStripeIndex(const Key& key)
+        {
+            const auto hash = static_cast<uint32_t>(qHash(key)) * 2654435761u;
+            return (hash >> 16) % STRIPES_COUNT;
+        }
+
+        Container& getStripe(const Key& key)
+        {
+            return _stripes[getStripeIndex(key)];
+        }
+
+        const Container& getStripe(const Key& key) const
+        {
+            return _stripes[getStripeIndex(key)];
+        }
+    public:
+        StripedSharedResourcesContainer()
+        {
+        }
+
+        virtual ~StripedSharedResourcesContainer()
+        {
+        }
+
+        // Budget is split evenly between stripes
+        void setRetentionBudget(const size_t budget, const SizeEstimator sizeEstimator = nullptr)
+        {
+            const auto stripeBudget = (budget + STRIPES_COUNT - 1) / STRIPES_COUNT;
+            for (auto& stripe : _stripes)
+                stripe.setRetentionBudget(stripeBudget, sizeEstimator);
+        }
+
+        size_t getRetentionBudget() const
+        {
+            size_t result = 0;
+            for (const auto& stripe : _stripes)
+                result += stripe.getRetentionBudget();
+            return result;
+        }
+
+        void clearRetained()
+        {
+            for (auto& stripe : _stripes)
+                stripe.clearRetained();
+        }
+
+        RetentionStatistics getRetentionStatistics() const
+        {
+            RetentionStatistics result;
+            for (const auto& stripe : _stripes)
+            {
+                const auto stripeStatistics = stripe.getRetentionStatistics();
+
+                result.hits += stripeStatistics.hits;
+                result.misses += stripeStatistics.misses;
+                result.evictions += stripeStatistics.evictions;
+                result.retainedCount += stripeStatistics.retainedCount;
+                result.retainedSize += stripeStatistics.retainedSize;
+            }
+            return result;
+        }
+
+        void resetRetentionStatistics()
+        {
+            for (auto& stripe : _stripes)
+                stripe.resetRetentionStatistics();
+        }
+
+        // All operations below take key as first argument, and pass rest of arguments as-is to the stripe
+        // that owns the key. See SharedResourcesContainer and SharedByZoomResourcesContainer for details.
+
+        template<typename... ARGS>
+        void insert(const Key& key, ARGS&&... args)
+        {
+            getStripe(key).insert(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        void insertAndReference(const Key& key, ARGS&&... args)
+        {
+            getStripe(key).insertAndReference(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        bool obtainReference(const Key& key, ARGS&&... args)
+        {
+            return getStripe(key).obtainReference(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        bool releaseReference(const Key& key, ARGS&&... args)
+        {
+            return getStripe(key).releaseReference(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        void makePromise(const Key& key, ARGS&&... args)
+        {
+            getStripe(key).makePromise(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        void breakPromise(const Key& key, ARGS&&... args)
+        {
+            getStripe(key).breakPromise(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        void fulfilPromise(const Key& key, ARGS&&... args)
+        {
+            getStripe(key).fulfilPromise(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        void fulfilPromiseAndReference(const Key& key, ARGS&&... args)
+        {
+            getStripe(key).fulfilPromiseAndReference(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        bool obtainFutureReference(const Key& key, ARGS&&... args)
+        {
+            return getStripe(key).obtainFutureReference(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        bool releaseFutureReference(const Key& key, ARGS&&... args)
+        {
+            return getStripe(key).releaseFutureReference(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        bool obtainReferenceOrFutureReferenceOrMakePromise(const Key& key, ARGS&&... args)
+        {
+            return getStripe(key).obtainReferenceOrFutureReferenceOrMakePromise(key, std::forward<ARGS>(args)...);
+        }
+
+        template<typename... ARGS>
+        uintmax_t getReferencesCount(const Key& key, ARGS&&... args) const
+        {
+            return getStripe(key).getReferencesCount(key, std::forward<ARGS>(args)...);
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_STRIPED_SHARED_RESOURCES_CONTAINER_H_)
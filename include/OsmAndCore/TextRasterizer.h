@@ -12,6 +12,7 @@
 #include <OsmAndCore/CommonSWIG.h>
 #include <OsmAndCore/PrivateImplementation.h>
 #include <OsmAndCore/IFontFinder.h>
+#include <OsmAndCore/GlyphAtlas.h>
 #include <OsmAndCore/Map/MapCommonTypes.h>
 #include <OsmAndCore/Map/MapPrimitiviser.h>
 
@@ -135,16 +136,46 @@ namespace OsmAnd
 #endif // !defined(SWIG)
         };
 
+        enum class CacheLookup
+        {
+            // Text was shaped and rasterized
+            Miss,
+            // Shaped text was reused, but it was rasterized again
+            ShapedTextHit,
+            // Rasterized text was reused
+            BitmapHit,
+            // Caches are disabled
+            Bypass,
+        };
+
+        enum : unsigned int {
+            DefaultShapedTextsCacheSizeLimit = 4u * 1024u * 1024u,
+            DefaultBitmapsCacheSizeLimit = 16u * 1024u * 1024u,
+        };
+
     private:
         PrivateImplementation<TextRasterizer_P> _p;
     protected:
     public:
         TextRasterizer(
-            const std::shared_ptr<const IFontFinder>& fontFinder);
+            const std::shared_ptr<const IFontFinder>& fontFinder,
+            const unsigned int shapedTextsCacheSizeLimit = DefaultShapedTextsCacheSizeLimit,
+            const unsigned int bitmapsCacheSizeLimit = DefaultBitmapsCacheSizeLimit);
         virtual ~TextRasterizer();
 
         const std::shared_ptr<const IFontFinder> fontFinder;
 
+        // Texts that were shaped (ordered, wrapped, matched with fonts and measured) are kept until total
+        // size of them exceeds this limit in bytes, least recently used first. Zero disables the cache.
+        const unsigned int shapedTextsCacheSizeLimit;
+
+        // Texts rasterized by obtainRasterized() without background bitmap are kept until total size of
+        // them exceeds this limit in bytes, least recently used first. Zero disables the cache.
+        const unsigned int bitmapsCacheSizeLimit;
+
+        // Glyphs of texts obtained by obtainGlyphRun()
+        const std::shared_ptr<GlyphAtlas> glyphAtlas;
+
         std::shared_ptr<SkBitmap> rasterize(
             const QString& text,
             const Style& style = Style(),
@@ -162,6 +193,27 @@ namespace OsmAnd
             float* const outExtraBottomSpace = nullptr,
             float* const outLineSpacing = nullptr) const;
 
+        // Same as rasterize(), but resulting bitmap may be shared with other callers that rasterized
+        // same text with same style, so it must not be modified
+        std::shared_ptr<const SkBitmap> obtainRasterized(
+            const QString& text,
+            const Style& style = Style(),
+            QVector<SkScalar>* const outGlyphWidths = nullptr,
+            float* const outExtraTopSpace = nullptr,
+            float* const outExtraBottomSpace = nullptr,
+            float* const outLineSpacing = nullptr,
+            CacheLookup* const outCacheLookup = nullptr) const;
+
+        // Lays out single-line text as a run of glyphs, each drawn once into glyph atlas along with its halo.
+        // Wrapped texts and texts with background bitmap can't be represented by glyph run, so nullptr is
+        // returned for them, as well as for texts that have nothing to draw.
+        std::shared_ptr<const GlyphAtlas::GlyphRun> obtainGlyphRun(
+            const QString& text,
+            const Style& style = Style(),
+            unsigned int* const outDrawnCellsCount = nullptr) const;
+
+        void clearCaches() const;
+
         static std::shared_ptr<const TextRasterizer> getDefault();
         static std::shared_ptr<const TextRasterizer> getOnlySystemFonts();
     };
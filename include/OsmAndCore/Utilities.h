@@ -884,6 +884,19 @@ namespace OsmAnd
             return value;
         }
 
+        // Clips segment p0-p1 by given area using Cohen-Sutherland algorithm. Returns false if segment is completely
+        // outside of area, otherwise points that are outside of area are moved onto its boundary.
+        static bool clipSegment(PointI& p0, PointI& p1, const AreaI& area);
+
+        // Clips ring of polygon by given area using Sutherland-Hodgman algorithm. Ring may be closed or not,
+        // resulting ring is not closed. Result is empty if ring is completely outside of area.
+        static QVector<PointI> clipPolygon(const QVector<PointI>& ring, const AreaI& area);
+
+        // Simplifies polyline or ring of polygon with given tolerance. First, points that are closer than tolerance
+        // to previous kept point are snapped to it, then remaining points are simplified using Douglas-Peucker
+        // algorithm. First and last points are always kept.
+        static QVector<PointI> simplifyPolyline(const QVector<PointI>& points, const double tolerance);
+
         static int extractFirstInteger(const QString& s);
         static bool extractFirstNumberPosition(const QString& value, int& first, int& last, bool allowSigned, bool allowDot);
         static double parseSpeed(const QString& value, const double defValue, bool* wasParsed = nullptr);
@@ -1,6 +1,65 @@
 #include "WorkerPool.h"
 #include "WorkerPool_P.h"
 
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include "restore_internal_warnings.h"
+
+#include "Common.h"
+#include "QRunnableFunctor.h"
+
+namespace OsmAnd
+{
+    namespace Concurrent
+    {
+        struct WorkerPoolTasksBatch
+        {
+            WorkerPoolTasksBatch(
+                const QVector<WorkerPool::Task>& tasks_,
+                const WorkerPool::AbortPredicate isAborted_)
+                : tasks(tasks_)
+                , isAborted(isAborted_)
+                , nextTaskIndex(0)
+                , skippedTasksCount(0)
+                , finishedTasksCount(0)
+            {
+            }
+
+            const QVector<WorkerPool::Task> tasks;
+            const WorkerPool::AbortPredicate isAborted;
+            QAtomicInt nextTaskIndex;
+            QAtomicInt skippedTasksCount;
+
+            QMutex finishedTasksMutex;
+            QWaitCondition finishedTasksCondition;
+            int finishedTasksCount;
+
+            // Runs tasks that were not yet taken by other threads. Once aborted, tasks are only marked as finished
+            void runPendingTasks()
+            {
+                for (;;)
+                {
+                    const auto taskIndex = nextTaskIndex.fetchAndAddOrdered(1);
+                    if (taskIndex >= tasks.size())
+                        return;
+
+                    if (!isAborted || !isAborted())
+                        tasks[taskIndex]();
+                    else
+                        skippedTasksCount.fetchAndAddOrdered(1);
+
+                    QMutexLocker scopedLocker(&finishedTasksMutex);
+                    if (++finishedTasksCount == tasks.size())
+                        finishedTasksCondition.wakeAll();
+                }
+            }
+        };
+    }
+}
+
 OsmAnd::Concurrent::WorkerPool::WorkerPool(
     const Order order /*= Order::FIFO*/,
     const int maxThreadCount /*= QThread::idealThreadCount()*/)
@@ -43,6 +102,21 @@ bool OsmAnd::Concurrent::WorkerPool::waitForDone(const int msecs /*= -1*/) const
     return _p->waitForDone(msecs);
 }
 
+void OsmAnd::Concurrent::WorkerPool::enqueueWithPriority(QRunnable* const runnable, const Priority priority)
+{
+    _p->enqueueWithPriority(runnable, priority);
+}
+
+void OsmAnd::Concurrent::WorkerPool::enqueueWithPriorities(const QVector<QRunnable*>& runnables, const PriorityFunction getPriority)
+{
+    _p->enqueueWithPriorities(runnables, getPriority);
+}
+
+void OsmAnd::Concurrent::WorkerPool::reprioritize(const PriorityFunction getPriority)
+{
+    _p->reprioritize(getPriority);
+}
+
 void OsmAnd::Concurrent::WorkerPool::enqueue(QRunnable* const runnable, const SortPredicate predicate /*= nullptr*/)
 {
     _p->enqueue(runnable, predicate);
@@ -63,6 +137,11 @@ void OsmAnd::Concurrent::WorkerPool::dequeueAll()
     _p->dequeueAll();
 }
 
+unsigned int OsmAnd::Concurrent::WorkerPool::queuedCount() const
+{
+    return _p->queuedCount();
+}
+
 void OsmAnd::Concurrent::WorkerPool::sortQueue(const SortPredicate predicate)
 {
     _p->sortQueue(predicate);
@@ -72,3 +151,37 @@ void OsmAnd::Concurrent::WorkerPool::reset()
 {
     _p->reset();
 }
+
+bool OsmAnd::Concurrent::WorkerPool::runAndWait(const QVector<Task>& tasks, const AbortPredicate isAborted /*= nullptr*/)
+{
+    if (tasks.isEmpty())
+        return true;
+
+    // Runnables that start after all tasks were taken exit immediately, and the batch is kept alive by them until then
+    const std::shared_ptr<WorkerPoolTasksBatch> batch(new WorkerPoolTasksBatch(tasks, isAborted));
+    auto helpersCount = tasks.size() - 1;
+    if (maxThreadCount() > 0)
+        helpersCount = qMin(helpersCount, maxThreadCount());
+    QVector<QRunnable*> runnables;
+    runnables.reserve(helpersCount);
+    for (auto helperIndex = 0; helperIndex < helpersCount; helperIndex++)
+    {
+        runnables.push_back(new QRunnableFunctor(
+            [batch]
+            (const QRunnableFunctor* const runnable)
+            {
+                batch->runPendingTasks();
+            }));
+    }
+    if (!runnables.isEmpty())
+        enqueue(runnables);
+
+    batch->runPendingTasks();
+    {
+        QMutexLocker scopedLocker(&batch->finishedTasksMutex);
+        while (batch->finishedTasksCount < tasks.size())
+            REPEAT_UNTIL(batch->finishedTasksCondition.wait(&batch->finishedTasksMutex));
+    }
+
+    return batch->skippedTasksCount.loadAcquire() == 0;
+}
@@ -1,18 +1,31 @@
 #include "WorkerPool_P.h"
 #include "WorkerPool.h"
 
+#include "stdlib_common.h"
+#include <algorithm>
+
 #include "QtExtensions.h"
 #include <QElapsedTimer>
 
+#include "Common.h"
+#include "QtCommon.h"
 #include "Logging.h"
 
 OsmAnd::Concurrent::WorkerPool_P::WorkerPool_P(WorkerPool* const owner_, const Order order_, const int maxThreadCount_)
     : _order(static_cast<int>(order_))
     , _maxThreadCount(maxThreadCount_)
+    , _nextInjectionQueueIndex(0)
+    , _queuedCount(0)
+    , _activeThreadCount(0)
+    , _nextThreadQueueIndex(0)
+    , _sleepingThreadsCount(0)
     , _isBeingReset(false)
     , owner(owner_)
 {
-    _queue.reserve(1024);
+    const auto queuesCount = qMax(1, maxThreadCount_ > 0 ? maxThreadCount_ : QThread::idealThreadCount());
+    _queues.reserve(queuesCount);
+    for (auto queueIndex = 0; queueIndex < queuesCount; queueIndex++)
+        _queues.push_back(std::shared_ptr<Queue>(new Queue()));
 }
 
 OsmAnd::Concurrent::WorkerPool_P::~WorkerPool_P()
@@ -37,188 +50,434 @@ int OsmAnd::Concurrent::WorkerPool_P::maxThreadCount() const
 void OsmAnd::Concurrent::WorkerPool_P::setMaxThreadCount(int maxThreadCount)
 {
     const auto oldMaxThreadCount = _maxThreadCount.fetchAndStoreOrdered(maxThreadCount);
-    if (maxThreadCount > 0 && oldMaxThreadCount <= maxThreadCount)
+    if (oldMaxThreadCount == maxThreadCount)
         return;
 
-    QMutexLocker scopedLocker(&_mutex);
-    tryLaunchNextRunnables();
+    // Threads that were put asleep by previous limit have to check new one
+    {
+        QMutexLocker scopedLocker(&_mutex);
+        _workAvailable.wakeAll();
+    }
+    notifyRunnablesEnqueued(qMax(0, _queuedCount.loadAcquire()));
 }
 
 unsigned int OsmAnd::Concurrent::WorkerPool_P::activeThreadCount() const
 {
-    QMutexLocker scopedLocker(&_mutex);
-
-    return activeThreadCountNoLock();
+    return qMax(0, _activeThreadCount.loadAcquire());
 }
 
 bool OsmAnd::Concurrent::WorkerPool_P::waitForDone(const int msecs) const
 {
     QMutexLocker scopedLocker(&_mutex);
-    
+
     return waitForDoneNoLock(msecs);
 }
 
-void OsmAnd::Concurrent::WorkerPool_P::enqueue(QRunnable* const runnable, const SortPredicate predicate)
+void OsmAnd::Concurrent::WorkerPool_P::enqueueWithPriority(QRunnable* const runnable, const Priority priority)
 {
-    QMutexLocker scopedLocker(&_mutex);
-    
-    _queue.push_front(runnable);
-    if (predicate)
-        sortQueueNoLock(predicate);
+    pushEntries(QVector<QRunnable*>() << runnable,
+        [priority]
+        (QRunnable* const) -> Priority
+        {
+            return priority;
+        });
+    notifyRunnablesEnqueued(1);
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::enqueueWithPriorities(
+    const QVector<QRunnable*>& runnables,
+    const PriorityFunction getPriority)
+{
+    if (runnables.isEmpty())
+        return;
+
+    pushEntries(runnables, getPriority);
+    notifyRunnablesEnqueued(runnables.size());
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::reprioritize(const PriorityFunction getPriority)
+{
+    for (const auto& queue : constOf(_queues))
+    {
+        QMutexLocker scopedLocker(&queue->mutex);
 
-    tryLaunchNextRunnable();
+        if (queue->heap.empty())
+            continue;
+
+        for (auto& entry : queue->heap)
+            entry.priority = getPriority(entry.runnable);
+        std::make_heap(queue->heap.begin(), queue->heap.end());
+    }
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::enqueue(QRunnable* const runnable, const SortPredicate predicate)
+{
+    enqueue(QVector<QRunnable*>() << runnable, predicate);
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::enqueue(const QVector<QRunnable*>& runnables, const SortPredicate predicate)
 {
-    QMutexLocker scopedLocker(&_mutex);
+    if (runnables.isEmpty())
+        return;
 
-    for (const auto& runnable : constOf(runnables))
-        _queue.push_front(runnable);
+    // Unsorted runnables are taken in order they were always taken by this method, see makeEntry()
+    pushEntries(runnables,
+        []
+        (QRunnable* const) -> Priority
+        {
+            return 0;
+        },
+        true);
     if (predicate)
-        sortQueueNoLock(predicate);
-
-    tryLaunchNextRunnable();
+        sortQueue(predicate);
+    notifyRunnablesEnqueued(runnables.size());
 }
 
 bool OsmAnd::Concurrent::WorkerPool_P::dequeue(QRunnable* const runnable, const SortPredicate predicate)
 {
-    QMutexLocker scopedLocker(&_mutex);
-    
-    const auto result = _queue.removeOne(runnable);
-    if (result && predicate)
-        sortQueueNoLock(predicate);
+    // Removal doesn't change order of remaining runnables, so predicate is not needed
+    Q_UNUSED(predicate);
+
+    auto dequeued = false;
+    for (const auto& queue : constOf(_queues))
+    {
+        if (queue->size.loadAcquire() == 0)
+            continue;
+
+        QMutexLocker scopedLocker(&queue->mutex);
+
+        auto& heap = queue->heap;
+        const auto itEntry = std::find_if(heap.begin(), heap.end(),
+            [runnable]
+            (const QueueEntry& entry) -> bool
+            {
+                return entry.runnable == runnable;
+            });
+        if (itEntry == heap.end())
+            continue;
+
+        *itEntry = heap.back();
+        heap.pop_back();
+        std::make_heap(heap.begin(), heap.end());
+        queue->size.storeRelease(static_cast<int>(heap.size()));
+        dequeued = true;
+        break;
+    }
+    if (!dequeued)
+        return false;
+
+    if (_queuedCount.fetchAndAddOrdered(-1) == 1)
+    {
+        QMutexLocker scopedLocker(&_mutex);
+        _threadFreed.wakeAll();
+    }
 
-    return result;
+    return true;
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::dequeueAll()
 {
-    QMutexLocker scopedLocker(&_mutex);
+    std::vector<QueueEntry> entries;
+    for (const auto& queue : constOf(_queues))
+    {
+        QMutexLocker scopedLocker(&queue->mutex);
+
+        entries.insert(entries.end(), queue->heap.cbegin(), queue->heap.cend());
+        queue->heap.clear();
+        queue->size.storeRelease(0);
+    }
+    if (entries.empty())
+        return;
+
+    for (const auto& entry : entries)
+    {
+        if (entry.runnable->autoDelete())
+            delete entry.runnable;
+    }
 
-    dequeueAllNoLock();
+    if (_queuedCount.fetchAndAddOrdered(-static_cast<int>(entries.size())) == static_cast<int>(entries.size()))
+    {
+        QMutexLocker scopedLocker(&_mutex);
+        _threadFreed.wakeAll();
+    }
+}
+
+unsigned int OsmAnd::Concurrent::WorkerPool_P::queuedCount() const
+{
+    return qMax(0, _queuedCount.loadAcquire());
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::sortQueue(const SortPredicate predicate)
 {
-    QMutexLocker scopedLocker(&_mutex);
+    // Queues are always locked in same order, and no other place locks more than one queue at a time
+    for (const auto& queue : constOf(_queues))
+        queue->mutex.lock();
+
+    std::vector<QueueEntry> entries;
+    for (const auto& queue : constOf(_queues))
+    {
+        entries.insert(entries.end(), queue->heap.cbegin(), queue->heap.cend());
+        queue->heap.clear();
+    }
+
+    // Sorted queue used to be taken from the front in FIFO order and from the back otherwise
+    std::stable_sort(entries.begin(), entries.end(),
+        [predicate]
+        (const QueueEntry& l, const QueueEntry& r) -> bool
+        {
+            return predicate(l.runnable, r.runnable);
+        });
+    const auto takenFromFront = (order() == Order::FIFO);
+    const auto injectionQueuesCount = getInjectionQueuesCount();
+    for (auto entryIndex = 0u; entryIndex < entries.size(); entryIndex++)
+    {
+        auto& entry = entries[entryIndex];
+        entry.priority = takenFromFront ? -static_cast<Priority>(entryIndex) : static_cast<Priority>(entryIndex);
+        _queues[entryIndex % injectionQueuesCount]->heap.push_back(entry);
+    }
 
-    sortQueueNoLock(predicate);
+    for (const auto& queue : constOf(_queues))
+    {
+        std::make_heap(queue->heap.begin(), queue->heap.end());
+        queue->size.storeRelease(static_cast<int>(queue->heap.size()));
+        queue->mutex.unlock();
+    }
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::reset()
 {
+    dequeueAll();
+
     QMutexLocker scopedLocker(&_mutex);
 
-    dequeueAllNoLock();
     REPEAT_UNTIL(waitForDoneNoLock(-1));
     _isBeingReset = true;
-    while (!_allThreads.isEmpty())
-    {
-        const auto thread = _freeThreads.head();
-        scopedLocker.unlock();
+    const auto threads = _allThreads;
+    _workAvailable.wakeAll();
+    scopedLocker.unlock();
 
-        thread->wakeup.wakeOne();
+    for (const auto thread : constOf(threads))
+    {
         thread->wait();
         delete thread;
-
-        scopedLocker.relock();
     }
+
+    scopedLocker.relock();
     _isBeingReset = false;
 }
 
-unsigned int OsmAnd::Concurrent::WorkerPool_P::activeThreadCountNoLock() const
+int OsmAnd::Concurrent::WorkerPool_P::getOwnQueueIndex() const
 {
-    return _allThreads.count() - _freeThreads.count() - _inactiveThreads.count();
+    const auto workerThread = dynamic_cast<const WorkerThread*>(QThread::currentThread());
+    if (!workerThread || workerThread->pool != this)
+        return -1;
+
+    return workerThread->queueIndex;
 }
 
-void OsmAnd::Concurrent::WorkerPool_P::createNewThread()
+int OsmAnd::Concurrent::WorkerPool_P::getInjectionQueuesCount() const
 {
-    const auto thread = new WorkerThread(this);
-
-    thread->setObjectName(QLatin1String("Worker (pooled)"));
-    _allThreads.insert(thread);
-    _freeThreads.enqueue(thread);
-
-    thread->start();
+    // Runnables from other threads are spread only over as many queues as many threads may run at once, so that
+    // with a low limit, threads don't steal from queues that are not drained in order of priority
+    const auto maxThreadCount = this->maxThreadCount();
+    if (maxThreadCount > 0 && maxThreadCount < _queues.size())
+        return maxThreadCount;
+    return _queues.size();
 }
 
-bool OsmAnd::Concurrent::WorkerPool_P::tryLaunchNextRunnable()
+OsmAnd::Concurrent::WorkerPool_P::QueueEntry OsmAnd::Concurrent::WorkerPool_P::makeEntry(
+    Queue& queue,
+    QRunnable* const runnable,
+    const Priority priority,
+    const bool inLegacyOrder) const
 {
-    // In case there are no threads, create new one
-    if (_allThreads.isEmpty())
+    QueueEntry entry;
+    entry.priority = priority;
+    entry.runnable = runnable;
+
+    // Before priorities, enqueue() put runnables to the front of the queue, and FIFO pool took them from the front
+    // while LIFO pool took them from the back. So in legacy order FIFO pool takes most recent runnable first and
+    // LIFO pool takes oldest one first, and code that enqueues without priorities keeps behaving as it did.
+    const auto sequenceNumber = queue.enqueuedCount++;
+    switch (order())
     {
-        createNewThread();
-        return true;
+        case Order::FIFO:
+            entry.tieBreaker = inLegacyOrder ? sequenceNumber : -sequenceNumber;
+            break;
+        case Order::LIFO:
+            entry.tieBreaker = inLegacyOrder ? -sequenceNumber : sequenceNumber;
+            break;
+        case Order::Random:
+        default:
+            entry.tieBreaker = qrand();
+            break;
     }
 
-    // Check if max threads limit is not reached
-    if (tooManyThreadsActive())
-        return false;
+    return entry;
+}
 
-    // If free thread is available, use it
-    if (!_freeThreads.isEmpty())
+void OsmAnd::Concurrent::WorkerPool_P::pushEntries(
+    const QVector<QRunnable*>& runnables,
+    const PriorityFunction& getPriority,
+    const bool inLegacyOrder /*= false*/)
+{
+    // Priorities are evaluated before any queue is locked
+    QVector<Priority> priorities;
+    priorities.reserve(runnables.size());
+    for (const auto runnable : constOf(runnables))
+        priorities.push_back(getPriority(runnable));
+
+    // Count is increased first, so that it's never less than number of runnables in queues
+    _queuedCount.fetchAndAddOrdered(runnables.size());
+
+    // Runnables enqueued by worker thread go to own queue of that thread, others are spread over queues
+    const auto ownQueueIndex = getOwnQueueIndex();
+    const auto injectionQueuesCount = getInjectionQueuesCount();
+    const auto queuesCount = ownQueueIndex >= 0 ? 1 : qMin(injectionQueuesCount, runnables.size());
+    const auto firstQueueIndex = ownQueueIndex >= 0
+        ? ownQueueIndex
+        : static_cast<int>(static_cast<unsigned int>(_nextInjectionQueueIndex.fetchAndAddRelaxed(1)) % injectionQueuesCount);
+    for (auto queueOffset = 0; queueOffset < queuesCount; queueOffset++)
     {
-        _freeThreads.head()->wakeup.wakeOne();
-        return true;
+        const auto queueIndex = ownQueueIndex >= 0
+            ? ownQueueIndex
+            : (firstQueueIndex + queueOffset) % injectionQueuesCount;
+        auto& queue = *_queues[queueIndex];
+
+        QMutexLocker scopedLocker(&queue.mutex);
+
+        for (auto runnableIndex = queueOffset; runnableIndex < runnables.size(); runnableIndex += queuesCount)
+        {
+            queue.heap.push_back(makeEntry(queue, runnables[runnableIndex], priorities[runnableIndex], inLegacyOrder));
+            std::push_heap(queue.heap.begin(), queue.heap.end());
+        }
+        queue.size.storeRelease(static_cast<int>(queue.heap.size()));
     }
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::notifyRunnablesEnqueued(const int count)
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    if (_isBeingReset)
+        return;
+
+    const auto threadsToWakeCount = qMin(count, _sleepingThreadsCount);
+    for (auto threadIndex = 0; threadIndex < threadsToWakeCount; threadIndex++)
+        _workAvailable.wakeOne();
+
+    // Busy threads take remaining runnables once they're done, but more threads are started while limit allows
+    const auto maxThreadCount = this->maxThreadCount();
+    const auto threadsLimit = maxThreadCount > 0 ? maxThreadCount : _queues.size();
+    auto threadsToStartCount = count - threadsToWakeCount;
+    while (threadsToStartCount-- > 0 && _allThreads.size() < threadsLimit)
+        createNewThread();
+}
+
+QRunnable* OsmAnd::Concurrent::WorkerPool_P::popRunnable(Queue& queue)
+{
+    std::pop_heap(queue.heap.begin(), queue.heap.end());
+    const auto runnable = queue.heap.back().runnable;
+    queue.heap.pop_back();
+    queue.size.storeRelease(static_cast<int>(queue.heap.size()));
+    _queuedCount.fetchAndAddOrdered(-1);
+
+    return runnable;
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::createNewThread()
+{
+    const auto thread = new WorkerThread(this, _nextThreadQueueIndex);
+    _nextThreadQueueIndex = (_nextThreadQueueIndex + 1) % _queues.size();
+
+    thread->setObjectName(QLatin1String("Worker (pooled)"));
+    _allThreads.insert(thread);
+
+    thread->start();
+}
 
-    // If inactive thread is available, use it
-    if (!_inactiveThreads.isEmpty())
+bool OsmAnd::Concurrent::WorkerPool_P::tryActivateThread()
+{
+    const auto maxThreadCount = this->maxThreadCount();
+    for (;;)
     {
-        _inactiveThreads.head()->wakeup.wakeOne();
-        return true;
+        const auto activeThreadCount = _activeThreadCount.loadAcquire();
+        if (maxThreadCount > 0 && activeThreadCount >= maxThreadCount)
+            return false;
+        if (_activeThreadCount.testAndSetOrdered(activeThreadCount, activeThreadCount + 1))
+            return true;
     }
-
-    // Otherwise, just start new thread
-    createNewThread();
-    return true;
 }
 
-void OsmAnd::Concurrent::WorkerPool_P::tryLaunchNextRunnables()
+void OsmAnd::Concurrent::WorkerPool_P::deactivateThread()
 {
-    while (!_queue.isEmpty() && tryLaunchNextRunnable());
+    // Pool mutex is locked only once pool is done, to wake threads waiting for that
+    if (_activeThreadCount.fetchAndAddOrdered(-1) == 1 && _queuedCount.loadAcquire() == 0)
+    {
+        QMutexLocker scopedLocker(&_mutex);
+        _threadFreed.wakeAll();
+    }
 }
 
-QRunnable* OsmAnd::Concurrent::WorkerPool_P::takeNextRunnable()
+QRunnable* OsmAnd::Concurrent::WorkerPool_P::takeNextRunnable(const int ownQueueIndex)
 {
-    if (_queue.isEmpty())
-        return nullptr;
+    auto& ownQueue = *_queues[ownQueueIndex];
+    if (ownQueue.size.loadAcquire() > 0)
+    {
+        QMutexLocker scopedLocker(&ownQueue.mutex);
 
-    switch (order())
+        if (!ownQueue.heap.empty())
+            return popRunnable(ownQueue);
+    }
+
+    // Steal most important runnable from other queues
+    const auto queuesCount = _queues.size();
+    for (;;)
     {
-        case Order::FIFO:
-            return _queue.takeFirst();
-        case Order::LIFO:
-            return _queue.takeLast();
-        case Order::Random:
-            return _queue.takeAt(qrand() % _queue.size());
-        default:
+        Queue* victimQueue = nullptr;
+        QueueEntry victimTopEntry;
+        for (auto queueOffset = 1; queueOffset < queuesCount; queueOffset++)
+        {
+            const auto queue = _queues[(ownQueueIndex + queueOffset) % queuesCount].get();
+            if (queue->size.loadAcquire() == 0)
+                continue;
+
+            QMutexLocker scopedLocker(&queue->mutex);
+
+            if (queue->heap.empty())
+                continue;
+            if (!victimQueue || victimTopEntry < queue->heap.front())
+            {
+                victimQueue = queue;
+                victimTopEntry = queue->heap.front();
+            }
+        }
+        if (!victimQueue)
             return nullptr;
+
+        // Victim may have been drained by other threads meanwhile, then queues are checked again
+        QMutexLocker scopedLocker(&victimQueue->mutex);
+        if (!victimQueue->heap.empty())
+            return popRunnable(*victimQueue);
     }
 }
 
 bool OsmAnd::Concurrent::WorkerPool_P::tooManyThreadsActive() const
 {
     const auto maxThreadCount = this->maxThreadCount();
-    return maxThreadCount > 0 && activeThreadCountNoLock() >= maxThreadCount;
+    return maxThreadCount > 0 && _activeThreadCount.loadAcquire() >= maxThreadCount;
 }
 
-void OsmAnd::Concurrent::WorkerPool_P::dequeueAllNoLock()
+bool OsmAnd::Concurrent::WorkerPool_P::isDone() const
 {
-    for (auto runnable : _queue)
-    {
-        if (runnable->autoDelete())
-            delete runnable;
-    }
-    _queue.clear();
+    return _activeThreadCount.loadAcquire() == 0 && _queuedCount.loadAcquire() == 0;
 }
 
 bool OsmAnd::Concurrent::WorkerPool_P::waitForDoneNoLock(const int msecs) const
 {
     if (msecs < 0)
     {
-        while (activeThreadCountNoLock() != 0 || !_queue.isEmpty())
+        while (!isDone())
             REPEAT_UNTIL(_threadFreed.wait(&_mutex));
     }
     else
@@ -226,20 +485,22 @@ bool OsmAnd::Concurrent::WorkerPool_P::waitForDoneNoLock(const int msecs) const
         QElapsedTimer waitTimer;
         waitTimer.start();
         int timeLeft;
-        while ((activeThreadCountNoLock() != 0 || !_queue.isEmpty()) && ((timeLeft = msecs - waitTimer.elapsed()) > 0))
+        while (!isDone() && ((timeLeft = msecs - waitTimer.elapsed()) > 0))
             _threadFreed.wait(&_mutex, timeLeft);
     }
 
-    return activeThreadCountNoLock() == 0 && _queue.isEmpty();
+    return isDone();
 }
 
-void OsmAnd::Concurrent::WorkerPool_P::sortQueueNoLock(const SortPredicate predicate)
+OsmAnd::Concurrent::WorkerPool_P::Queue::Queue()
+    : enqueuedCount(0)
+    , size(0)
 {
-    std::sort(_queue, predicate);
 }
 
-OsmAnd::Concurrent::WorkerPool_P::WorkerThread::WorkerThread(WorkerPool_P* const pool_)
+OsmAnd::Concurrent::WorkerPool_P::WorkerThread::WorkerThread(WorkerPool_P* const pool_, const int queueIndex_)
     : pool(pool_)
+    , queueIndex(queueIndex_)
 {
 }
 
@@ -251,44 +512,38 @@ void OsmAnd::Concurrent::WorkerPool_P::WorkerThread::run()
 {
     for (;;)
     {
-        // Get the runnable
+        // Get the runnable, unless limit of active threads is reached
         QRunnable* runnable = nullptr;
+        if (pool->tryActivateThread())
+        {
+            runnable = pool->takeNextRunnable(queueIndex);
+            if (!runnable)
+                pool->deactivateThread();
+        }
+
+        // Sleep if there's nothing to do for this thread
+        if (!runnable)
         {
             QMutexLocker scopedLocker(&pool->_mutex);
 
             // In case everything is being reset, self-destroy
             if (pool->_isBeingReset)
             {
-                pool->_freeThreads.removeOne(this);
                 pool->_allThreads.remove(this);
                 return;
             }
 
-            // Check if not out of limit or sleep
-            if (pool->tooManyThreadsActive())
-            {
-                pool->_freeThreads.removeOne(this);
-                pool->_inactiveThreads.enqueue(this);
-
-                REPEAT_UNTIL(wakeup.wait(&pool->_mutex));
-
-                pool->_inactiveThreads.removeOne(this);
-                pool->_freeThreads.enqueue(this);
-                continue;
-            }
-
-            // Take runnable or sleep
-            runnable = pool->takeNextRunnable();
-            if (!runnable)
+            // Runnables enqueued after queues were checked are noticed here, since their count is increased before
+            // pool mutex is locked to wake threads up
+            if (pool->_queuedCount.loadAcquire() <= 0 || pool->tooManyThreadsActive())
             {
-                REPEAT_UNTIL(wakeup.wait(&pool->_mutex));
-                continue;
+                pool->_sleepingThreadsCount++;
+                REPEAT_UNTIL(pool->_workAvailable.wait(&pool->_mutex));
+                pool->_sleepingThreadsCount--;
             }
-
-            // Since runnable was obtained, this thread is no longer free
-            pool->_freeThreads.removeOne(this);
+            continue;
         }
-        
+
         // Execute the runnable
 #ifndef QT_NO_EXCEPTIONS
         try
@@ -309,11 +564,6 @@ void OsmAnd::Concurrent::WorkerPool_P::WorkerThread::run()
 #endif
 
         // After runnable execution is complete, free this thread
-        {
-            QMutexLocker scopedLocker(&pool->_mutex);
-
-            pool->_freeThreads.enqueue(this);
-            pool->_threadFreed.wakeOne();
-        }
+        pool->deactivateThread();
     }
 }
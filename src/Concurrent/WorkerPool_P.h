@@ -2,6 +2,7 @@
 #define _OSMAND_CORE_CONCURRENT_WORKER_POOL_P_H_
 
 #include "stdlib_common.h"
+#include <vector>
 
 #include "QtExtensions.h"
 #include "ignore_warnings_on_external_includes.h"
@@ -11,7 +12,6 @@
 #include <QMutex>
 #include <QThread>
 #include <QSet>
-#include <QQueue>
 #include <QVector>
 #include "restore_internal_warnings.h"
 
@@ -23,6 +23,9 @@ namespace OsmAnd
 {
     namespace Concurrent
     {
+        // Each worker thread has own queue of runnables, which is a heap ordered by priority that was evaluated
+        // on enqueue. Worker takes runnables from own queue first, and steals most important runnable of other
+        // queues once own queue is empty. Pool mutex is used only to put threads asleep and wake them up.
         class WorkerPool_P Q_DECL_FINAL
         {
             Q_DISABLE_COPY_AND_MOVE(WorkerPool_P);
@@ -30,6 +33,8 @@ namespace OsmAnd
         public:
             typedef WorkerPool::Order Order;
             typedef WorkerPool::SortPredicate SortPredicate;
+            typedef WorkerPool::Priority Priority;
+            typedef WorkerPool::PriorityFunction PriorityFunction;
 
         private:
             class WorkerThread Q_DECL_FINAL : public QThread
@@ -38,39 +43,78 @@ namespace OsmAnd
 
             private:
             protected:
-                WorkerThread(WorkerPool_P* const pool);
+                WorkerThread(WorkerPool_P* const pool, const int queueIndex);
             public:
                 virtual ~WorkerThread();
 
                 WorkerPool_P* const pool;
+                const int queueIndex;
 
                 virtual void run();
 
-                QWaitCondition wakeup;
-
             friend class OsmAnd::Concurrent::WorkerPool_P;
             };
 
+            struct QueueEntry
+            {
+                Priority priority;
+                // Resolves ties between equal priorities according to order of pool
+                int64_t tieBreaker;
+                QRunnable* runnable;
+
+                inline bool operator<(const QueueEntry& that) const
+                {
+                    return priority < that.priority || (priority == that.priority && tieBreaker < that.tieBreaker);
+                }
+            };
+
+            struct Queue
+            {
+                Queue();
+
+                mutable QMutex mutex;
+                std::vector<QueueEntry> heap;
+                int64_t enqueuedCount;
+                // Copy of heap size that is checked without locking
+                QAtomicInt size;
+            };
+
             QAtomicInt _order;
             QAtomicInt _maxThreadCount;
 
+            QVector< std::shared_ptr<Queue> > _queues;
+            QAtomicInt _nextInjectionQueueIndex;
+            QAtomicInt _queuedCount;
+            QAtomicInt _activeThreadCount;
+
             mutable QMutex _mutex;
-            QVector<QRunnable*> _queue;
             QSet<WorkerThread*> _allThreads;
-            QQueue<WorkerThread*> _freeThreads;
-            QQueue<WorkerThread*> _inactiveThreads;
-            volatile bool _isBeingReset;
+            int _nextThreadQueueIndex;
+            int _sleepingThreadsCount;
+            bool _isBeingReset;
+            QWaitCondition _workAvailable;
             mutable QWaitCondition _threadFreed;
 
-            unsigned int activeThreadCountNoLock() const;
+            int getOwnQueueIndex() const;
+            int getInjectionQueuesCount() const;
+            QueueEntry makeEntry(
+                Queue& queue,
+                QRunnable* const runnable,
+                const Priority priority,
+                const bool inLegacyOrder) const;
+            void pushEntries(
+                const QVector<QRunnable*>& runnables,
+                const PriorityFunction& getPriority,
+                const bool inLegacyOrder = false);
+            void notifyRunnablesEnqueued(const int count);
+            QRunnable* popRunnable(Queue& queue);
             void createNewThread();
-            bool tryLaunchNextRunnable();
-            void tryLaunchNextRunnables();
-            QRunnable* takeNextRunnable();
+            bool tryActivateThread();
+            void deactivateThread();
+            QRunnable* takeNextRunnable(const int ownQueueIndex);
             bool tooManyThreadsActive() const;
-            void dequeueAllNoLock();
+            bool isDone() const;
             bool waitForDoneNoLock(const int msecs) const;
-            void sortQueueNoLock(const SortPredicate predicate);
         protected:
             WorkerPool_P(WorkerPool* const owner, const Order order, const int maxThreadCount);
         public:
@@ -87,10 +131,15 @@ namespace OsmAnd
 
             bool waitForDone(const int msecs) const;
 
+            void enqueueWithPriority(QRunnable* const runnable, const Priority priority);
+            void enqueueWithPriorities(const QVector<QRunnable*>& runnables, const PriorityFunction getPriority);
+            void reprioritize(const PriorityFunction getPriority);
+
             void enqueue(QRunnable* const runnable, const SortPredicate predicate);
             void enqueue(const QVector<QRunnable*>& runnables, const SortPredicate predicate);
             bool dequeue(QRunnable* const runnable, const SortPredicate predicate);
             void dequeueAll();
+            unsigned int queuedCount() const;
 
             void sortQueue(const SortPredicate predicate);
 
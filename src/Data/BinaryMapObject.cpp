@@ -1,12 +1,16 @@
 #include "BinaryMapObject.h"
 
 #include "ObfMapSectionReader.h"
+#include "ObfMapSectionReader_P.h"
 #include "ObfMapSectionInfo.h"
+#include "ObfReaderUtilities.h"
+#include "Logging.h"
 
 OsmAnd::BinaryMapObject::BinaryMapObject(
     const std::shared_ptr<const ObfMapSectionInfo>& section_,
     const std::shared_ptr<const ObfMapSectionLevel>& level_)
     : ObfMapObject(section_)
+    , _lazyDataDecoded(1)
     , section(section_)
     , level(level_)
 {
@@ -60,3 +64,74 @@ OsmAnd::MapObject::LayerType OsmAnd::BinaryMapObject::getLayerType() const
 
     return LayerType::Zero;
 }
+
+void OsmAnd::BinaryMapObject::ensureLazyDataDecoded() const
+{
+    if (_lazyDataDecoded.loadAcquire() != 0)
+        return;
+
+    QMutexLocker scopedLocker(&_lazyDataMutex);
+    if (_lazyDataDecoded.load() != 0)
+        return;
+
+    // Object is shared, but decoding is done exactly once and only fills fields that nobody
+    // could have accessed before that
+    const auto _this = const_cast<BinaryMapObject*>(this);
+    _this->resolveCaptions();
+    _this->decodeInnerPolygons();
+
+    _lazyDataDecoded.storeRelease(1);
+}
+
+void OsmAnd::BinaryMapObject::resolveCaptions()
+{
+    for (auto itEncodedCaption = _encodedCaptions.cbegin(); itEncodedCaption != _encodedCaptions.cend(); itEncodedCaption += 2)
+    {
+        const auto captionRuleId = *itEncodedCaption;
+        const auto stringId = *(itEncodedCaption + 1);
+
+        if (stringId >= static_cast<uint32_t>(_captionsTable.size()))
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Data mismatch: string #%d (map object %s not found in string table (size %d) in section '%s'",
+                stringId,
+                qPrintable(id.toString()),
+                _captionsTable.size(),
+                qPrintable(section->name));
+            captions.insert(captionRuleId, QString::fromLatin1("#%1 NOT FOUND").arg(stringId));
+            continue;
+        }
+        captions.insert(captionRuleId, _captionsTable[stringId]);
+    }
+
+    _encodedCaptions.clear();
+    _encodedCaptions.squeeze();
+    _captionsTable.clear();
+}
+
+void OsmAnd::BinaryMapObject::decodeInnerPolygons()
+{
+    for (const auto& encodedPolygon : constOf(_encodedInnerPolygons))
+    {
+        const auto data = reinterpret_cast<const uint8_t*>(encodedPolygon.constData());
+        const auto size = static_cast<size_t>(encodedPolygon.size());
+
+        // Each vertex takes at least 2 bytes
+        QVector< PointI > polygon(static_cast<int>(size / 2));
+        AreaI polygonBBox;
+        polygonBBox.top() = polygonBBox.left() = std::numeric_limits<int32_t>::max();
+        polygonBBox.bottom() = polygonBBox.right() = 0;
+        const auto pointsCount = ObfReaderUtilities::decodeDeltaCoordinates(
+            data,
+            size,
+            _encodedInnerPolygonsOrigin,
+            ObfMapSectionReader_P::ShiftCoordinates,
+            polygon.data(),
+            polygonBBox);
+        polygon.resize(pointsCount);
+
+        innerPolygonsPoints31.push_back(qMove(polygon));
+    }
+
+    _encodedInnerPolygons.clear();
+}
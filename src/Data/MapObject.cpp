@@ -62,6 +62,8 @@ bool OsmAnd::MapObject::isClosedFigure(bool checkInner /*= false*/) const
 {
     if (checkInner)
     {
+        ensureLazyDataDecoded();
+
         for (const auto& polygon : constOf(innerPolygonsPoints31))
         {
             if (polygon.isEmpty())
@@ -200,6 +202,8 @@ OsmAnd::MapObject::LayerType OsmAnd::MapObject::getLayerType() const
 
 QString OsmAnd::MapObject::getCaptionInNativeLanguage() const
 {
+    ensureLazyDataDecoded();
+
     const auto citName = captions.constFind(attributeMapping->nativeNameAttributeId);
     if (citName == captions.cend())
         return QString::null;
@@ -208,6 +212,8 @@ QString OsmAnd::MapObject::getCaptionInNativeLanguage() const
 
 QString OsmAnd::MapObject::getCaptionInLanguage(const QString& lang) const
 {
+    ensureLazyDataDecoded();
+
     const auto citNameAttributeId = attributeMapping->localizedNameAttributes.constFind(&lang);
     if (citNameAttributeId == attributeMapping->localizedNameAttributes.cend())
         return QString::null;
@@ -220,8 +226,9 @@ QString OsmAnd::MapObject::getCaptionInLanguage(const QString& lang) const
 
 QHash<QString, QString> OsmAnd::MapObject::getCaptionsInAllLanguages() const
 {
-    QHash<QString, QString> result;
+    ensureLazyDataDecoded();
 
+    QHash<QString, QString> result;
     for (const auto& localizedNameAttributeEntry : rangeOf(constOf(attributeMapping->localizedNameAttributes)))
     {
         const auto& attributeId = localizedNameAttributeEntry.value();
@@ -251,6 +258,24 @@ QString OsmAnd::MapObject::getName(const QString lang, bool transliterate) const
         return name;
 }
 
+void OsmAnd::MapObject::ensureLazyDataDecoded() const
+{
+}
+
+const QList< QVector< OsmAnd::PointI > >& OsmAnd::MapObject::getInnerPolygonsPoints31() const
+{
+    ensureLazyDataDecoded();
+
+    return innerPolygonsPoints31;
+}
+
+const QHash<uint32_t, QString>& OsmAnd::MapObject::getCaptions() const
+{
+    ensureLazyDataDecoded();
+
+    return captions;
+}
+
 OsmAnd::MapObject::AttributeMapping::AttributeMapping()
     : nativeNameAttributeId(std::numeric_limits<uint32_t>::max())
     , refAttributeId(std::numeric_limits<uint32_t>::max())
@@ -436,6 +461,8 @@ void OsmAnd::MapObject::AttributeMapping::registerMapping(
         onewayAttributeId = id;
     else if (QLatin1String("oneway") == tag && QLatin1String("-1") == value)
         onewayReverseAttributeId = id;
+    else if (QLatin1String("highway") == tag)
+        highwayAttributeIds.insert(id);
 }
 
 OsmAnd::MapObject::AttributeMapping::TagValue::TagValue()
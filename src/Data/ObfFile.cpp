@@ -6,18 +6,25 @@
 #include <OsmAndCore/Data/ObfInfo.h>
 #include <OsmAndCore/Utilities.h>
 
+#include "ObfInfoCache.h"
+
 OsmAnd::ObfFile::ObfFile(const QString& filePath_)
     : _p(new ObfFile_P(this))
     , filePath(filePath_)
     , fileSize(QFile(filePath).size())
+    , infoCacheFilePath(QString::null)
     , obfInfo(_p->_obfInfo)
 {
 }
 
-OsmAnd::ObfFile::ObfFile(const QString& filePath_, const uint64_t fileSize_)
+OsmAnd::ObfFile::ObfFile(
+    const QString& filePath_,
+    const uint64_t fileSize_,
+    const QString& infoCacheFilePath_ /*= QString::null*/)
     : _p(new ObfFile_P(this))
     , filePath(filePath_)
     , fileSize(fileSize_)
+    , infoCacheFilePath(infoCacheFilePath_)
     , obfInfo(_p->_obfInfo)
 {
 }
@@ -26,6 +33,24 @@ OsmAnd::ObfFile::~ObfFile()
 {
 }
 
+bool OsmAnd::ObfFile::loadInfoFromCache() const
+{
+    if (infoCacheFilePath.isEmpty())
+        return false;
+
+    QMutexLocker scopedLocker(&_p->_obfInfoMutex);
+
+    if (_p->_obfInfo)
+        return true;
+
+    std::shared_ptr<ObfInfo> cachedObfInfo;
+    if (!ObfInfoCache::load(infoCacheFilePath, filePath, cachedObfInfo))
+        return false;
+    _p->_obfInfo = cachedObfInfo;
+
+    return true;
+}
+
 const QString OsmAnd::ObfFile::getRegionName() const
 {
     QStringList rg = obfInfo->getRegionNames();
@@ -0,0 +1,290 @@
+#include "ObfInfoCache.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include "restore_internal_warnings.h"
+
+#include "ObfInfo.h"
+#include "ObfSectionInfo.h"
+#include "ObfMapSectionInfo.h"
+#include "ObfAddressSectionInfo.h"
+#include "ObfRoutingSectionInfo.h"
+#include "ObfPoiSectionInfo.h"
+#include "ObfTransportSectionInfo.h"
+#include "Logging.h"
+
+namespace
+{
+    const quint32 ObfInfoCacheMagic = 0x4F424649; // 'OBFI'
+}
+
+QString OsmAnd::ObfInfoCache::getCacheFilePath(const QString& cacheDirectoryPath, const QString& obfFilePath)
+{
+    if (cacheDirectoryPath.isEmpty())
+        return QString::null;
+
+    const auto pathHash = QCryptographicHash::hash(obfFilePath.toUtf8(), QCryptographicHash::Md5).toHex();
+    return QDir(cacheDirectoryPath).absoluteFilePath(QString::fromLatin1(pathHash) + QLatin1String(".obfinfo"));
+}
+
+bool OsmAnd::ObfInfoCache::load(
+    const QString& cacheFilePath,
+    const QString& obfFilePath,
+    std::shared_ptr<ObfInfo>& outInfo)
+{
+    QFile cacheFile(cacheFilePath);
+    if (!cacheFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&cacheFile);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    // Verify that sidecar was written for exactly this file
+    const QFileInfo obfFileInfo(obfFilePath);
+    quint32 magic;
+    quint32 formatVersion;
+    QString filePath;
+    quint64 fileSize;
+    qint64 fileModificationTime;
+    stream >> magic >> formatVersion >> filePath >> fileSize >> fileModificationTime;
+    if (stream.status() != QDataStream::Ok ||
+        magic != ObfInfoCacheMagic ||
+        formatVersion != FormatVersion ||
+        filePath != obfFilePath ||
+        fileSize != static_cast<quint64>(obfFileInfo.size()) ||
+        fileModificationTime != obfFileInfo.lastModified().toMSecsSinceEpoch())
+    {
+        return false;
+    }
+
+    const std::shared_ptr<ObfInfo> info(new ObfInfo());
+    qint32 version;
+    quint64 creationTimestamp;
+    stream >> version >> creationTimestamp >> info->isBasemap >> info->isBasemapWithCoastlines;
+    info->version = version;
+    info->creationTimestamp = creationTimestamp;
+
+    quint32 count;
+
+    stream >> count;
+    for (auto sectionIdx = 0u; sectionIdx < count && stream.status() == QDataStream::Ok; sectionIdx++)
+    {
+        const std::shared_ptr<ObfMapSectionInfo> section(new ObfMapSectionInfo(info));
+        readSectionInfo(stream, *section);
+        stream >> section->isBasemap >> section->isBasemapWithCoastlines;
+
+        quint32 levelsCount;
+        stream >> levelsCount;
+        for (auto levelIdx = 0u; levelIdx < levelsCount && stream.status() == QDataStream::Ok; levelIdx++)
+        {
+            Ref<ObfMapSectionLevel> level(new ObfMapSectionLevel());
+            qint32 minZoom;
+            qint32 maxZoom;
+            stream >> level->offset >> level->length >> minZoom >> maxZoom >> level->firstDataBoxInnerOffset;
+            level->minZoom = static_cast<ZoomLevel>(minZoom);
+            level->maxZoom = static_cast<ZoomLevel>(maxZoom);
+            readArea(stream, level->area31);
+
+            section->levels.push_back(qMove(level));
+        }
+
+        info->mapSections.push_back(section);
+    }
+
+    stream >> count;
+    for (auto sectionIdx = 0u; sectionIdx < count && stream.status() == QDataStream::Ok; sectionIdx++)
+    {
+        const std::shared_ptr<ObfAddressSectionInfo> section(new ObfAddressSectionInfo(info));
+        readSectionInfo(stream, *section);
+        readArea(stream, section->area31);
+        stream >> section->localizedNames >> section->attributeTagsTable;
+        stream >> section->nameIndexInnerOffset >> section->firstStreetGroupInnerOffset;
+
+        info->addressSections.push_back(section);
+    }
+
+    stream >> count;
+    for (auto sectionIdx = 0u; sectionIdx < count && stream.status() == QDataStream::Ok; sectionIdx++)
+    {
+        const std::shared_ptr<ObfRoutingSectionInfo> section(new ObfRoutingSectionInfo(info));
+        readSectionInfo(stream, *section);
+        readArea(stream, section->area31);
+
+        info->routingSections.push_back(section);
+    }
+
+    stream >> count;
+    for (auto sectionIdx = 0u; sectionIdx < count && stream.status() == QDataStream::Ok; sectionIdx++)
+    {
+        const std::shared_ptr<ObfPoiSectionInfo> section(new ObfPoiSectionInfo(info));
+        readSectionInfo(stream, *section);
+        readArea(stream, section->area31);
+        stream
+            >> section->firstCategoryInnerOffset
+            >> section->nameIndexInnerOffset
+            >> section->subtypesInnerOffset
+            >> section->firstBoxInnerOffset;
+
+        info->poiSections.push_back(section);
+    }
+
+    stream >> count;
+    for (auto sectionIdx = 0u; sectionIdx < count && stream.status() == QDataStream::Ok; sectionIdx++)
+    {
+        const std::shared_ptr<ObfTransportSectionInfo> section(new ObfTransportSectionInfo(info));
+        readSectionInfo(stream, *section);
+        readArea(stream, section->_area24);
+        stream >> section->_stopsOffset >> section->_stopsLength;
+
+        info->transportSections.push_back(section);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "OBF info cache '%s' of '%s' is corrupted",
+            qPrintable(cacheFilePath),
+            qPrintable(obfFilePath));
+        return false;
+    }
+
+    info->calculateCenterPointForRegions();
+    outInfo = info;
+    return true;
+}
+
+bool OsmAnd::ObfInfoCache::save(
+    const QString& cacheFilePath,
+    const QString& obfFilePath,
+    const std::shared_ptr<const ObfInfo>& info)
+{
+    QDir().mkpath(QFileInfo(cacheFilePath).absolutePath());
+
+    // Sidecar is written to temporary file and then committed, so that concurrent readers never see it partially
+    QSaveFile cacheFile(cacheFilePath);
+    if (!cacheFile.open(QIODevice::WriteOnly))
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to create OBF info cache '%s' of '%s'",
+            qPrintable(cacheFilePath),
+            qPrintable(obfFilePath));
+        return false;
+    }
+
+    QDataStream stream(&cacheFile);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    const QFileInfo obfFileInfo(obfFilePath);
+    stream
+        << ObfInfoCacheMagic
+        << static_cast<quint32>(FormatVersion)
+        << obfFilePath
+        << static_cast<quint64>(obfFileInfo.size())
+        << static_cast<qint64>(obfFileInfo.lastModified().toMSecsSinceEpoch());
+
+    stream
+        << static_cast<qint32>(info->version)
+        << static_cast<quint64>(info->creationTimestamp)
+        << info->isBasemap
+        << info->isBasemapWithCoastlines;
+
+    stream << static_cast<quint32>(info->mapSections.size());
+    for (const auto& section : constOf(info->mapSections))
+    {
+        writeSectionInfo(stream, *section);
+        stream << section->isBasemap << section->isBasemapWithCoastlines;
+
+        stream << static_cast<quint32>(section->levels.size());
+        for (const auto& level : constOf(section->levels))
+        {
+            stream
+                << level->offset
+                << level->length
+                << static_cast<qint32>(level->minZoom)
+                << static_cast<qint32>(level->maxZoom)
+                << level->firstDataBoxInnerOffset;
+            writeArea(stream, level->area31);
+        }
+    }
+
+    stream << static_cast<quint32>(info->addressSections.size());
+    for (const auto& section : constOf(info->addressSections))
+    {
+        writeSectionInfo(stream, *section);
+        writeArea(stream, section->area31);
+        stream << section->localizedNames << section->attributeTagsTable;
+        stream << section->nameIndexInnerOffset << section->firstStreetGroupInnerOffset;
+    }
+
+    stream << static_cast<quint32>(info->routingSections.size());
+    for (const auto& section : constOf(info->routingSections))
+    {
+        writeSectionInfo(stream, *section);
+        writeArea(stream, section->area31);
+    }
+
+    stream << static_cast<quint32>(info->poiSections.size());
+    for (const auto& section : constOf(info->poiSections))
+    {
+        writeSectionInfo(stream, *section);
+        writeArea(stream, section->area31);
+        stream
+            << section->firstCategoryInnerOffset
+            << section->nameIndexInnerOffset
+            << section->subtypesInnerOffset
+            << section->firstBoxInnerOffset;
+    }
+
+    stream << static_cast<quint32>(info->transportSections.size());
+    for (const auto& section : constOf(info->transportSections))
+    {
+        writeSectionInfo(stream, *section);
+        writeArea(stream, section->_area24);
+        stream << section->_stopsOffset << section->_stopsLength;
+    }
+
+    if (stream.status() != QDataStream::Ok || !cacheFile.commit())
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to write OBF info cache '%s' of '%s'",
+            qPrintable(cacheFilePath),
+            qPrintable(obfFilePath));
+        return false;
+    }
+
+    return true;
+}
+
+bool OsmAnd::ObfInfoCache::remove(const QString& cacheFilePath)
+{
+    if (cacheFilePath.isEmpty() || !QFile::exists(cacheFilePath))
+        return false;
+
+    return QFile::remove(cacheFilePath);
+}
+
+void OsmAnd::ObfInfoCache::writeSectionInfo(QDataStream& stream, const ObfSectionInfo& section)
+{
+    stream << section.name << section.length << section.offset;
+}
+
+void OsmAnd::ObfInfoCache::readSectionInfo(QDataStream& stream, ObfSectionInfo& section)
+{
+    stream >> section.name >> section.length >> section.offset;
+}
+
+void OsmAnd::ObfInfoCache::writeArea(QDataStream& stream, const AreaI& area)
+{
+    stream << area.top() << area.left() << area.bottom() << area.right();
+}
+
+void OsmAnd::ObfInfoCache::readArea(QDataStream& stream, AreaI& area)
+{
+    stream >> area.top() >> area.left() >> area.bottom() >> area.right();
+}
@@ -0,0 +1,49 @@
+#ifndef _OSMAND_CORE_OBF_INFO_CACHE_H_
+#define _OSMAND_CORE_OBF_INFO_CACHE_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QString>
+#include <QDataStream>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "PointsAndAreas.h"
+
+namespace OsmAnd
+{
+    class ObfInfo;
+    class ObfSectionInfo;
+
+    // Sidecar files that hold ObfInfo (with all section infos that ObfReader_P::readInfo() produces),
+    // so that OBF headers are not walked again on next startup. Each sidecar is bound to path, size and
+    // modification time of the OBF file, and is ignored in case any of those does not match.
+    struct ObfInfoCache Q_DECL_FINAL
+    {
+        enum {
+            FormatVersion = 1,
+        };
+
+        static QString getCacheFilePath(const QString& cacheDirectoryPath, const QString& obfFilePath);
+
+        static bool load(
+            const QString& cacheFilePath,
+            const QString& obfFilePath,
+            std::shared_ptr<ObfInfo>& outInfo);
+        static bool save(
+            const QString& cacheFilePath,
+            const QString& obfFilePath,
+            const std::shared_ptr<const ObfInfo>& info);
+        static bool remove(const QString& cacheFilePath);
+
+    private:
+        static void writeSectionInfo(QDataStream& stream, const ObfSectionInfo& section);
+        static void readSectionInfo(QDataStream& stream, ObfSectionInfo& section);
+        static void writeArea(QDataStream& stream, const AreaI& area);
+        static void readArea(QDataStream& stream, AreaI& area);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_OBF_INFO_CACHE_H_)
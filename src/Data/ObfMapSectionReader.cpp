@@ -71,3 +71,8 @@ bool OsmAnd::ObfMapSectionReader::DataBlocksCache::shouldCacheBlock(
 {
     return true;
 }
+
+bool OsmAnd::ObfMapSectionReader::DataBlocksCache::shouldDecodeLazily() const
+{
+    return false;
+}
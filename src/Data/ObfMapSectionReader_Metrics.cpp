@@ -16,6 +16,11 @@ void OsmAnd::ObfMapSectionReader_Metrics::Metric_loadMapObjects::reset()
     Metric::reset();
 }
 
+void OsmAnd::ObfMapSectionReader_Metrics::Metric_loadMapObjects::merge(const Metric_loadMapObjects& that)
+{
+    OsmAnd__ObfMapSectionReader_Metrics__Metric_loadMapObjects__FIELDS(MERGE_METRIC_FIELD);
+}
+
 QString OsmAnd::ObfMapSectionReader_Metrics::Metric_loadMapObjects::toString(const bool shortFormat /*= false*/, const QString& prefix /*= QString::null*/) const
 {
     QString output;
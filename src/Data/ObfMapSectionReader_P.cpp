@@ -486,6 +486,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
     const AreaI* bbox31,
     const FilterReadingByIdFunction filterById,
     const VisitorFunction visitor,
+    const bool decodeLazily,
     const std::shared_ptr<const IQueryController>& queryController,
     ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric)
 {
@@ -506,22 +507,32 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
 
                 for (const auto& mapObject : constOf(intermediateResult))
                 {
-                    // Fill mapObject captions from string-table
-                    for (auto& caption : mapObject->captions)
+                    // Fill mapObject captions from string-table, or leave that until they're accessed.
+                    // String table is implicitly shared, so keeping a reference to it is cheap
+                    const auto captionsCount = mapObject->_encodedCaptions.size() / 2;
+                    if (decodeLazily)
                     {
-                        const auto stringId = ObfReaderUtilities::decodeIntegerFromString(caption);
+                        if (captionsCount > 0)
+                        {
+                            mapObject->_captionsTable = mapObjectsCaptionsTable;
+                            mapObject->_lazyDataDecoded.store(0);
+                        }
+
+                        if (metric)
+                            metric->deferredCaptions += captionsCount;
+                    }
+                    else if (captionsCount > 0)
+                    {
+                        const Stopwatch captionsStopwatch(metric != nullptr);
 
-                        if (stringId >= mapObjectsCaptionsTable.size())
+                        mapObject->_captionsTable = mapObjectsCaptionsTable;
+                        mapObject->resolveCaptions();
+
+                        if (metric)
                         {
-                            LogPrintf(LogSeverityLevel::Error,
-                                "Data mismatch: string #%d (map object %s not found in string table (size %d) in section '%s'",
-                                stringId,
-                                qPrintable(mapObject->id.toString()),
-                                mapObjectsCaptionsTable.size(), qPrintable(section->name));
-                            caption = QString::fromLatin1("#%1 NOT FOUND").arg(stringId);
-                            continue;
+                            metric->elapsedTimeForCaptions += captionsStopwatch.elapsed();
+                            metric->decodedCaptions += captionsCount;
                         }
-                        caption = mapObjectsCaptionsTable[stringId];
                     }
 
                     //////////////////////////////////////////////////////////////////////////
@@ -560,7 +571,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
                 std::shared_ptr<OsmAnd::BinaryMapObject> mapObject;
                 auto oldLimit = cis->PushLimit(length);
                 
-                readMapObject(reader, section, baseId, tree, mapObject, bbox31, metric);
+                readMapObject(reader, section, baseId, tree, mapObject, bbox31, decodeLazily, metric);
 
                 ObfReaderUtilities::ensureAllDataWasRead(cis);
                 cis->PopLimit(oldLimit);
@@ -642,6 +653,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
     const std::shared_ptr<const ObfMapSectionLevelTreeNode>& treeNode,
     std::shared_ptr<OsmAnd::BinaryMapObject>& mapObject,
     const AreaI* bbox31,
+    const bool decodeLazily,
     ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric)
 {
     const auto cis = reader.getCodedInputStream().get();
@@ -674,65 +686,17 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
             {
                 const Stopwatch mapObjectPointsStopwatch(metric != nullptr);
 
-                gpb::uint32 length;
-                cis->ReadVarint32(&length);
-                const auto oldLimit = cis->PushLimit(length);
-
-                PointI p;
-                p.x = treeNode->area31.left() & MaskToRead;
-                p.y = treeNode->area31.top() & MaskToRead;
-
+                // Decode all vertices (and their bbox) at once
+                PointI origin;
+                origin.x = treeNode->area31.left() & MaskToRead;
+                origin.y = treeNode->area31.top() & MaskToRead;
+                QVector< PointI > points31;
                 AreaI objectBBox;
-                objectBBox.top() = objectBBox.left() = std::numeric_limits<int32_t>::max();
-                objectBBox.bottom() = objectBBox.right() = 0;
-                auto lastUnprocessedVertexForBBox = 0;
-
-                // In protobuf, a sint32 can be encoded using [1..4] bytes,
-                // so try to guess size of array, and preallocate it.
-                // (BytesUntilLimit/2) is ~= number of vertices, and is always larger than needed.
-                // So it's impossible that a buffer overflow will ever happen. But assert on that.
-                const auto probableVerticesCount = (cis->BytesUntilLimit() / 2);
-                QVector< PointI > points31(probableVerticesCount);
-
-                auto pPoint = points31.data();
-                auto verticesCount = 0;
-                bool shouldNotSkip = (bbox31 == nullptr);
-                while (cis->BytesUntilLimit() > 0)
-                {
-                    PointI d;
-                    d.x = (ObfReaderUtilities::readSInt32(cis) << ShiftCoordinates);
-                    d.y = (ObfReaderUtilities::readSInt32(cis) << ShiftCoordinates);
-
-                    p += d;
-
-                    // Save point into storage
-                    assert(points31.size() > verticesCount);
-                    *(pPoint++) = p;
-                    verticesCount++;
-
-                    // Check if map object should be maintained
-                    if (!shouldNotSkip && bbox31)
-                    {
-                        const Stopwatch mapObjectBboxStopwatch(metric != nullptr);
-
-                        shouldNotSkip = bbox31->contains(p);
-                        objectBBox.enlargeToInclude(p);
-
-                        if (metric)
-                            metric->elapsedTimeForMapObjectsBbox += mapObjectBboxStopwatch.elapsed();
-
-                        lastUnprocessedVertexForBBox = verticesCount;
-                    }
-                }
-
-                cis->PopLimit(oldLimit);
-
-                // Since reserved space may be larger than actual amount of data,
-                // shrink the vertices array
-                points31.resize(verticesCount);
+                ObfReaderUtilities::readDeltaCoordinates(cis, origin, ShiftCoordinates, points31, objectBBox);
 
                 // If map object has no vertices, retain it in a special way to report later, when
                 // it's identifier will be known
+                bool shouldNotSkip = (bbox31 == nullptr);
                 if (points31.isEmpty())
                 {
                     // Fake that this object is inside bbox
@@ -740,18 +704,21 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     objectBBox = treeNode->area31;
                 }
 
-                // Even if no vertex lays inside bbox, an edge
-                // may intersect the bbox
+                // Since bbox of all vertices is known, it's enough to check it: a vertex inside bbox
+                // as well as an edge crossing it both make bboxes intersect
                 if (!shouldNotSkip && bbox31)
                 {
-                    assert(lastUnprocessedVertexForBBox == points31.size());
+                    const Stopwatch mapObjectBboxStopwatch(metric != nullptr);
 
                     shouldNotSkip =
                         objectBBox.contains(*bbox31) ||
                         bbox31->intersects(objectBBox);
+
+                    if (metric)
+                        metric->elapsedTimeForMapObjectsBbox += mapObjectBboxStopwatch.elapsed();
                 }
 
-                // If map object didn't fit, skip it's entire content
+                // If map object didn't fit, skip it
                 if (!shouldNotSkip)
                 {
                     if (metric)
@@ -760,7 +727,6 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                         metric->skippedMapObjectsPoints += points31.size();
                     }
 
-                    cis->Skip(cis->BytesUntilLimit());
                     break;
                 }
 
@@ -771,21 +737,6 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     metric->notSkippedMapObjectsPoints += points31.size();
                 }
 
-                // In case bbox is not fully calculated, complete this task
-                auto pPointForBBox = points31.data() + lastUnprocessedVertexForBBox;
-                while (lastUnprocessedVertexForBBox < points31.size())
-                {
-                    const Stopwatch mapObjectBboxStopwatch(metric != nullptr);
-
-                    objectBBox.enlargeToInclude(*pPointForBBox);
-
-                    if (metric)
-                        metric->elapsedTimeForMapObjectsBbox += mapObjectBboxStopwatch.elapsed();
-
-                    lastUnprocessedVertexForBBox++;
-                    pPointForBBox++;
-                }
-
                 // Finally, create the object
                 if (!mapObject)
                     mapObject.reset(new OsmAnd::BinaryMapObject(section, treeNode->level));
@@ -806,39 +757,35 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                 if (!mapObject)
                     mapObject.reset(new OsmAnd::BinaryMapObject(section, treeNode->level));
 
-                gpb::uint32 length;
-                cis->ReadVarint32(&length);
-                auto oldLimit = cis->PushLimit(length);
+                PointI origin;
+                origin.x = treeNode->area31.left() & MaskToRead;
+                origin.y = treeNode->area31.top() & MaskToRead;
 
-                PointI p;
-                p.x = treeNode->area31.left() & MaskToRead;
-                p.y = treeNode->area31.top() & MaskToRead;
-
-                // Preallocate memory
-                const auto probableVerticesCount = (cis->BytesUntilLimit() / 2);
-                mapObject->innerPolygonsPoints31.push_back(qMove(QVector< PointI >(probableVerticesCount)));
-                auto& polygon = mapObject->innerPolygonsPoints31.last();
-
-                auto pPoint = polygon.data();
-                auto verticesCount = 0;
-                while (cis->BytesUntilLimit() > 0)
+                // Inner polygons are needed only to render the object, so keep them encoded if allowed
+                if (decodeLazily)
                 {
-                    PointI d;
-                    d.x = (ObfReaderUtilities::readSInt32(cis) << ShiftCoordinates);
-                    d.y = (ObfReaderUtilities::readSInt32(cis) << ShiftCoordinates);
+                    gpb::uint32 length;
+                    cis->ReadVarint32(&length);
+                    QByteArray encodedPolygon(static_cast<int>(length), Qt::Uninitialized);
+                    cis->ReadRaw(encodedPolygon.data(), length);
 
-                    p += d;
+                    mapObject->_encodedInnerPolygonsOrigin = origin;
+                    mapObject->_encodedInnerPolygons.push_back(qMove(encodedPolygon));
+                    mapObject->_lazyDataDecoded.store(0);
+
+                    if (metric)
+                        metric->deferredInnerPolygons++;
 
-                    // Save point into storage
-                    assert(polygon.size() > verticesCount);
-                    *(pPoint++) = p;
-                    verticesCount++;
+                    break;
                 }
 
-                // Shrink memory
-                polygon.resize(verticesCount);
+                QVector< PointI > polygon;
+                AreaI polygonBBox;
+                ObfReaderUtilities::readDeltaCoordinates(cis, origin, ShiftCoordinates, polygon, polygonBBox);
+                mapObject->innerPolygonsPoints31.push_back(qMove(polygon));
 
-                cis->PopLimit(oldLimit);
+                if (metric)
+                    metric->decodedInnerPolygons++;
 
                 break;
             }
@@ -891,7 +838,9 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     ok = cis->ReadVarint32(&stringId);
                     assert(ok);
 
-                    mapObject->captions.insert(stringRuleId, qMove(ObfReaderUtilities::encodeIntegerToString(stringId)));
+                    // Captions are resolved once string table of the block is read
+                    mapObject->_encodedCaptions.push_back(stringRuleId);
+                    mapObject->_encodedCaptions.push_back(stringId);
                     mapObject->captionsOrder.push_back(stringRuleId);
                 }
 
@@ -1150,6 +1099,7 @@ void OsmAnd::ObfMapSectionReader_P::loadMapObjects(
                         nullptr,
                         nullptr,
                         nullptr,
+                        cache->shouldDecodeLazily(),
                         nullptr,
                         metric ? &localMetric : nullptr);
 
@@ -1236,6 +1186,7 @@ void OsmAnd::ObfMapSectionReader_P::loadMapObjects(
                     bbox31,
                     filterById != nullptr ? filterReadById : FilterReadingByIdFunction(),
                     visitor,
+                    false,
                     queryController,
                     metric);
 
@@ -1273,5 +1224,10 @@ void OsmAnd::ObfMapSectionReader_P::loadMapObjects(
     if (cache && metric)
     {
         metric->elapsedTimeForOnlyAcceptedMapObjects += localMetric.elapsedTimeForOnlyAcceptedMapObjects;
+        metric->elapsedTimeForCaptions += localMetric.elapsedTimeForCaptions;
+        metric->decodedCaptions += localMetric.decodedCaptions;
+        metric->deferredCaptions += localMetric.deferredCaptions;
+        metric->decodedInnerPolygons += localMetric.decodedInnerPolygons;
+        metric->deferredInnerPolygons += localMetric.deferredInnerPolygons;
     }
 }
@@ -99,6 +99,7 @@ namespace OsmAnd
             const AreaI* bbox31,
             const FilterReadingByIdFunction filterById,
             const VisitorFunction visitor,
+            const bool decodeLazily,
             const std::shared_ptr<const IQueryController>& queryController,
             ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric);
 
@@ -115,6 +116,7 @@ namespace OsmAnd
             const std::shared_ptr<const ObfMapSectionLevelTreeNode>& treeNode,
             std::shared_ptr<OsmAnd::BinaryMapObject>& mapObjectOut,
             const AreaI* bbox31,
+            const bool decodeLazily,
             ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric);
 
         enum : uint32_t {
@@ -138,6 +140,7 @@ namespace OsmAnd
             ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric);
 
     friend class OsmAnd::ObfMapSectionReader;
+    friend class OsmAnd::BinaryMapObject;
     friend class OsmAnd::ObfReader_P;
     };
 }
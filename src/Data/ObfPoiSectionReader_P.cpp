@@ -1366,14 +1366,16 @@ void OsmAnd::ObfPoiSectionReader_P::readNameIndexDataAtom(
                 if (accept && tileFilter)
                     accept = tileFilter(tileId, zoom);
 
+                // Position is needed both for bbox check and for ordering by distance to xy31
                 PointI position31;
                 uint32_t d = 0;
-                if (accept && bbox31)
+                if (accept && (bbox31 || xy31))
                 {
                     position31.x = tileId.x << (31 - zoom);
                     position31.y = tileId.y << (31 - zoom);
-                    accept = bbox31->contains(position31);
                 }
+                if (accept && bbox31)
+                    accept = bbox31->contains(position31);
 
                 if (accept)
                 {
@@ -5,15 +5,22 @@
 
 #include "ObfFile.h"
 
-OsmAnd::ObfReader::ObfReader(const std::shared_ptr<const ObfFile>& obfFile_)
+OsmAnd::ObfReader::ObfReader(
+    const std::shared_ptr<const ObfFile>& obfFile_,
+    const bool useMemoryMapping_ /*= false*/,
+    const bool threadSafe_ /*= false*/)
     : _p(new ObfReader_P(this, std::shared_ptr<QIODevice>(new QFile(obfFile_->filePath))))
     , obfFile(obfFile_)
+    , useMemoryMapping(useMemoryMapping_)
+    , threadSafe(threadSafe_)
 {
     open();
 }
 
 OsmAnd::ObfReader::ObfReader(const std::shared_ptr<QIODevice>& input)
     : _p(new ObfReader_P(this, input))
+    , useMemoryMapping(false)
+    , threadSafe(false)
 {
     open();
 }
@@ -14,6 +14,23 @@
 #include "ObfSectionInfo.h"
 #include "Logging.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define OSMAND_OBF_COORDINATES_SSE2 1
+#   define OSMAND_OBF_COORDINATES_NEON 0
+#   include "ignore_warnings_on_external_includes.h"
+#   include <emmintrin.h>
+#   include "restore_internal_warnings.h"
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define OSMAND_OBF_COORDINATES_SSE2 0
+#   define OSMAND_OBF_COORDINATES_NEON 1
+#   include "ignore_warnings_on_external_includes.h"
+#   include <arm_neon.h>
+#   include "restore_internal_warnings.h"
+#else
+#   define OSMAND_OBF_COORDINATES_SSE2 0
+#   define OSMAND_OBF_COORDINATES_NEON 0
+#endif
+
 bool OsmAnd::ObfReaderUtilities::readQString(gpb::io::CodedInputStream* cis, QString& output)
 {
     std::string value;
@@ -42,6 +59,273 @@ int64_t OsmAnd::ObfReaderUtilities::readSInt64(gpb::io::CodedInputStream* cis)
     return decodedValue;
 }
 
+namespace
+{
+    inline uint32_t zigZagDecodeDelta(const uint32_t value, const unsigned int shift)
+    {
+        return ((value >> 1) ^ (0u - (value & 1u))) << shift;
+    }
+
+    inline bool readRawVarint32(const uint8_t*& p, const uint8_t* const pEnd, uint32_t& outValue)
+    {
+        if (Q_LIKELY(p < pEnd && *p < 0x80u))
+        {
+            outValue = *(p++);
+            return true;
+        }
+
+        uint32_t value = 0;
+        for (auto bitsShift = 0u; bitsShift <= 28u && p < pEnd; bitsShift += 7u)
+        {
+            const uint32_t byte = *(p++);
+            value |= (byte & 0x7Fu) << bitsShift;
+            if (byte < 0x80u)
+            {
+                outValue = value;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+#if OSMAND_OBF_COORDINATES_SSE2
+    inline __m128i selectMin(const __m128i a, const __m128i b)
+    {
+        const auto aIsGreater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(aIsGreater, b), _mm_andnot_si128(aIsGreater, a));
+    }
+
+    inline __m128i selectMax(const __m128i a, const __m128i b)
+    {
+        const auto aIsGreater = _mm_cmpgt_epi32(a, b);
+        return _mm_or_si128(_mm_and_si128(aIsGreater, a), _mm_andnot_si128(aIsGreater, b));
+    }
+
+    // Decodes 16 single-byte varints (8 points) at once: zigzag, shift, prefix sum and bbox are all vectorized.
+    // Each 128-bit lane holds 2 interleaved points (x0, y0, x1, y1).
+    inline void decode8SingleByteDeltas(
+        const __m128i bytes,
+        const __m128i shiftCount,
+        __m128i& point,
+        int32_t* const pOutPoints,
+        __m128i& bboxMin,
+        __m128i& bboxMax)
+    {
+        const auto zero = _mm_setzero_si128();
+        const auto one = _mm_set1_epi16(1);
+
+        const __m128i words[2] = {
+            _mm_unpacklo_epi8(bytes, zero),
+            _mm_unpackhi_epi8(bytes, zero),
+        };
+        for (auto wordsIdx = 0; wordsIdx < 2; wordsIdx++)
+        {
+            const auto& w = words[wordsIdx];
+            const auto zigZagDecoded = _mm_xor_si128(
+                _mm_srli_epi16(w, 1),
+                _mm_sub_epi16(zero, _mm_and_si128(w, one)));
+
+            const __m128i deltas[2] = {
+                _mm_sll_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(zigZagDecoded, zigZagDecoded), 16), shiftCount),
+                _mm_sll_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(zigZagDecoded, zigZagDecoded), 16), shiftCount),
+            };
+            for (auto deltasIdx = 0; deltasIdx < 2; deltasIdx++)
+            {
+                // (dx0, dy0, dx1, dy1) -> (x + dx0, y + dy0, x + dx0 + dx1, y + dy0 + dy1)
+                const auto& delta = deltas[deltasIdx];
+                const auto points = _mm_add_epi32(point, _mm_add_epi32(delta, _mm_slli_si128(delta, 8)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pOutPoints + (wordsIdx * 2 + deltasIdx) * 4), points);
+
+                bboxMin = selectMin(bboxMin, points);
+                bboxMax = selectMax(bboxMax, points);
+                point = _mm_shuffle_epi32(points, _MM_SHUFFLE(3, 2, 3, 2));
+            }
+        }
+    }
+#endif // OSMAND_OBF_COORDINATES_SSE2
+}
+
+int OsmAnd::ObfReaderUtilities::decodeDeltaCoordinates(
+    const uint8_t* const data,
+    const size_t size,
+    const PointI& origin,
+    const unsigned int shift,
+    PointI* const outPoints,
+    AreaI& inOutBBox)
+{
+    auto p = data;
+    const auto pEnd = data + size;
+    auto pOutPoint = outPoints;
+
+    // Coordinates are accumulated as unsigned, since deltas are allowed to wrap
+    auto x = static_cast<uint32_t>(origin.x);
+    auto y = static_cast<uint32_t>(origin.y);
+    auto minX = inOutBBox.left();
+    auto minY = inOutBBox.top();
+    auto maxX = inOutBBox.right();
+    auto maxY = inOutBBox.bottom();
+
+#if OSMAND_OBF_COORDINATES_SSE2
+    const auto shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+    auto bboxMin = _mm_setr_epi32(minX, minY, minX, minY);
+    auto bboxMax = _mm_setr_epi32(maxX, maxY, maxX, maxY);
+#endif // OSMAND_OBF_COORDINATES_SSE2
+
+    while (p < pEnd)
+    {
+#if OSMAND_OBF_COORDINATES_SSE2
+        // Most deltas fit into a single byte, so process such runs 16 bytes at once
+        if (pEnd - p >= 16)
+        {
+            const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(bytes) == 0)
+            {
+                auto point = _mm_setr_epi32(
+                    static_cast<int32_t>(x), static_cast<int32_t>(y),
+                    static_cast<int32_t>(x), static_cast<int32_t>(y));
+                decode8SingleByteDeltas(
+                    bytes,
+                    shiftCount,
+                    point,
+                    reinterpret_cast<int32_t*>(pOutPoint),
+                    bboxMin,
+                    bboxMax);
+                x = static_cast<uint32_t>(_mm_cvtsi128_si32(point));
+                y = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(point, 4)));
+
+                p += 16;
+                pOutPoint += 8;
+                continue;
+            }
+        }
+#elif OSMAND_OBF_COORDINATES_NEON
+        // Most deltas fit into a single byte, so process such runs 16 bytes at once without per-byte checks
+        if (pEnd - p >= 16)
+        {
+            const auto bytes = vld1q_u8(p);
+            const auto highBits = vshrq_n_u8(bytes, 7);
+            const auto highBitsPairs = vpmax_u8(vget_low_u8(highBits), vget_high_u8(highBits));
+            if (vget_lane_u64(vreinterpret_u64_u8(highBitsPairs), 0) == 0)
+            {
+                auto bboxMin = vcreate_s32(0);
+                bboxMin = vset_lane_s32(minX, bboxMin, 0);
+                bboxMin = vset_lane_s32(minY, bboxMin, 1);
+                auto bboxMax = vcreate_s32(0);
+                bboxMax = vset_lane_s32(maxX, bboxMax, 0);
+                bboxMax = vset_lane_s32(maxY, bboxMax, 1);
+
+                for (auto pointIdx = 0; pointIdx < 8; pointIdx++)
+                {
+                    x += zigZagDecodeDelta(p[pointIdx * 2 + 0], shift);
+                    y += zigZagDecodeDelta(p[pointIdx * 2 + 1], shift);
+                    pOutPoint->x = static_cast<int32_t>(x);
+                    pOutPoint->y = static_cast<int32_t>(y);
+
+                    const auto point = vld1_s32(reinterpret_cast<const int32_t*>(pOutPoint));
+                    bboxMin = vmin_s32(bboxMin, point);
+                    bboxMax = vmax_s32(bboxMax, point);
+                    pOutPoint++;
+                }
+
+                minX = vget_lane_s32(bboxMin, 0);
+                minY = vget_lane_s32(bboxMin, 1);
+                maxX = vget_lane_s32(bboxMax, 0);
+                maxY = vget_lane_s32(bboxMax, 1);
+
+                p += 16;
+                continue;
+            }
+        }
+#endif
+
+        uint32_t dx;
+        uint32_t dy;
+        if (!readRawVarint32(p, pEnd, dx) || !readRawVarint32(p, pEnd, dy))
+            break;
+
+        x += zigZagDecodeDelta(dx, shift);
+        y += zigZagDecodeDelta(dy, shift);
+        pOutPoint->x = static_cast<int32_t>(x);
+        pOutPoint->y = static_cast<int32_t>(y);
+        pOutPoint++;
+
+        minX = std::min(minX, static_cast<int32_t>(x));
+        minY = std::min(minY, static_cast<int32_t>(y));
+        maxX = std::max(maxX, static_cast<int32_t>(x));
+        maxY = std::max(maxY, static_cast<int32_t>(y));
+    }
+
+#if OSMAND_OBF_COORDINATES_SSE2
+    // Reduce both interleaved points of vector bbox and merge it with scalar one
+    bboxMin = selectMin(bboxMin, _mm_srli_si128(bboxMin, 8));
+    bboxMax = selectMax(bboxMax, _mm_srli_si128(bboxMax, 8));
+    minX = std::min(minX, _mm_cvtsi128_si32(bboxMin));
+    minY = std::min(minY, _mm_cvtsi128_si32(_mm_srli_si128(bboxMin, 4)));
+    maxX = std::max(maxX, _mm_cvtsi128_si32(bboxMax));
+    maxY = std::max(maxY, _mm_cvtsi128_si32(_mm_srli_si128(bboxMax, 4)));
+#endif // OSMAND_OBF_COORDINATES_SSE2
+
+    inOutBBox.left() = minX;
+    inOutBBox.top() = minY;
+    inOutBBox.right() = maxX;
+    inOutBBox.bottom() = maxY;
+
+    return static_cast<int>(pOutPoint - outPoints);
+}
+
+bool OsmAnd::ObfReaderUtilities::readDeltaCoordinates(
+    gpb::io::CodedInputStream* cis,
+    const PointI& origin,
+    const unsigned int shift,
+    QVector<PointI>& outPoints,
+    AreaI& outBBox)
+{
+    gpb::uint32 length;
+    if (!cis->ReadVarint32(&length))
+        return false;
+
+    // Each coordinate takes at least 1 byte, so that's the upper bound of vertices count
+    outPoints.resize(length / 2);
+    outBBox.top() = outBBox.left() = std::numeric_limits<int32_t>::max();
+    outBBox.bottom() = outBBox.right() = 0;
+
+    // Decode directly from stream buffer if entire field is there (always the case with mapped files),
+    // otherwise copy it out
+    const void* buffer = nullptr;
+    int bufferSize = 0;
+    if (cis->GetDirectBufferPointer(&buffer, &bufferSize) && static_cast<gpb::uint32>(bufferSize) >= length)
+    {
+        const auto pointsCount = decodeDeltaCoordinates(
+            reinterpret_cast<const uint8_t*>(buffer),
+            length,
+            origin,
+            shift,
+            outPoints.data(),
+            outBBox);
+        outPoints.resize(pointsCount);
+
+        return cis->Skip(length);
+    }
+
+    QByteArray data(static_cast<int>(length), Qt::Uninitialized);
+    if (!cis->ReadRaw(data.data(), length))
+    {
+        outPoints.clear();
+        return false;
+    }
+    const auto pointsCount = decodeDeltaCoordinates(
+        reinterpret_cast<const uint8_t*>(data.constData()),
+        length,
+        origin,
+        shift,
+        outPoints.data(),
+        outBBox);
+    outPoints.resize(pointsCount);
+
+    return true;
+}
+
 uint32_t OsmAnd::ObfReaderUtilities::readBigEndianInt(gpb::io::CodedInputStream* cis)
 {
     gpb::uint32 be;
@@ -8,6 +8,7 @@
 #include <QString>
 #include <QStringList>
 #include <QVector>
+#include <QByteArray>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -30,6 +31,22 @@ namespace OsmAnd
         static int32_t readSInt32(gpb::io::CodedInputStream* cis);
         static int64_t readSInt64(gpb::io::CodedInputStream* cis);
         static uint32_t readBigEndianInt(gpb::io::CodedInputStream* cis);
+
+        // Packed pairs of zigzag-encoded deltas (geometry of map objects and roads) are decoded
+        // from raw bytes in one pass, that also calculates bbox of decoded points
+        static int decodeDeltaCoordinates(
+            const uint8_t* const data,
+            const size_t size,
+            const PointI& origin,
+            const unsigned int shift,
+            PointI* const outPoints,
+            AreaI& inOutBBox);
+        static bool readDeltaCoordinates(
+            gpb::io::CodedInputStream* cis,
+            const PointI& origin,
+            const unsigned int shift,
+            QVector<PointI>& outPoints,
+            AreaI& outBBox);
         static uint32_t readLength(gpb::io::CodedInputStream* cis);
         static void readStringTable(gpb::io::CodedInputStream* cis, QStringList& stringTableOut);
         static int scanIndexedStringTable(
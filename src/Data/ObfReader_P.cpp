@@ -3,6 +3,7 @@
 
 #include "QtExtensions.h"
 #include <QFile>
+#include "QtCommon.h"
 
 #include "ignore_warnings_on_external_includes.h"
 #include "OBF.pb.h"
@@ -11,9 +12,13 @@
 
 #include "QIODeviceInputStream.h"
 #include "QFileDeviceInputStream.h"
+#include "QFileDeviceMappedInputStream.h"
+#include "QFileDeviceSharedInputStream.h"
+#include "MemoryInputStream.h"
 #include "ObfFile.h"
 #include "ObfFile_P.h"
 #include "ObfInfo.h"
+#include "ObfInfoCache.h"
 #include "ObfMapSectionInfo.h"
 #include "ObfMapSectionReader_P.h"
 #include "ObfAddressSectionInfo.h"
@@ -32,10 +37,15 @@
 #   define OSMAND_TRACE_OBF_READERS 0
 #endif // !defined(OSMAND_TRACE_OBF_READERS)
 
+QThreadStorage<OsmAnd::ObfReader_P::ThreadCursors> OsmAnd::ObfReader_P::_threadCursors;
+
 OsmAnd::ObfReader_P::ObfReader_P(
     ObfReader* const owner_,
     const std::shared_ptr<QIODevice>& input_)
     : _input(input_)
+    , _closeInputOnClose(false)
+    , _obfInfoLoaded(0)
+    , _unreportedFileOpensCount(0)
 #if OSMAND_VERIFY_OBF_READER_THREAD
     , _threadId(QThread::currentThreadId())
 #endif // OSMAND_VERIFY_OBF_READER_THREAD
@@ -47,15 +57,10 @@ OsmAnd::ObfReader_P::~ObfReader_P()
 {
 }
 
-bool OsmAnd::ObfReader_P::isOpened() const
-{
-    return static_cast<bool>(_codedInputStream);
-}
-
-bool OsmAnd::ObfReader_P::open()
+void OsmAnd::ObfReader_P::verifyThread() const
 {
 #if OSMAND_VERIFY_OBF_READER_THREAD
-    if (_threadId != QThread::currentThreadId())
+    if (!owner->threadSafe && _threadId != QThread::currentThreadId())
     {
         LogPrintf(LogSeverityLevel::Warning,
             "ObfReader(%p) was accessed from thread %p, but created in thread %p",
@@ -67,14 +72,83 @@ bool OsmAnd::ObfReader_P::open()
 #   endif // OSMAND_VERIFY_OBF_READER_THREAD > 1
     }
 #endif // OSMAND_VERIFY_OBF_READER_THREAD
+}
+
+unsigned int OsmAnd::ObfReader_P::takeFileOpensCount() const
+{
+    return static_cast<unsigned int>(_unreportedFileOpensCount.fetchAndStoreOrdered(0));
+}
+
+bool OsmAnd::ObfReader_P::isOpened() const
+{
+    return static_cast<bool>(_codedInputStream);
+}
 
+bool OsmAnd::ObfReader_P::open()
+{
+    verifyThread();
+
+    QMutexLocker scopedLocker(&_inputStreamsMutex);
     if (isOpened())
         return false;
 
     // Create zero-copy input stream
     gpb::io::ZeroCopyInputStream* zcis = nullptr;
     if (const auto inputFileDevice = std::dynamic_pointer_cast<QFileDevice>(_input))
-        zcis = new QFileDeviceInputStream(inputFileDevice);
+    {
+        // If requested, map entire file so that section readers decode directly from mapped pages. Mapped stream
+        // opens file on its own, since file may be closed only after it's unmapped
+        if (owner->useMemoryMapping)
+        {
+            const auto wasInputOpened = inputFileDevice->isOpen();
+            const auto mappedInputStream = new QFileDeviceMappedInputStream(inputFileDevice);
+            if (!wasInputOpened && inputFileDevice->isOpen())
+                _unreportedFileOpensCount.fetchAndAddOrdered(1);
+
+            if (mappedInputStream->isMapped())
+                zcis = mappedInputStream;
+            else
+            {
+                LogPrintf(LogSeverityLevel::Warning,
+                    "ObfReader(%p) failed to map '%s', falling back to windowed reading",
+                    owner.get(),
+                    qPrintable(inputFileDevice->fileName()));
+                delete mappedInputStream;
+            }
+        }
+
+        // In thread-safe mode without mapping, all threads read same file handle, each at own position. Handle is
+        // opened and closed only by reader itself, so that cursor of one thread never closes it under another
+        if (!zcis && owner->threadSafe)
+        {
+            if (!inputFileDevice->isOpen())
+            {
+                if (!inputFileDevice->open(QIODevice::ReadOnly))
+                {
+                    LogPrintf(LogSeverityLevel::Error,
+                        "ObfReader(%p) failed to open '%s': (%d) %s",
+                        owner.get(),
+                        qPrintable(inputFileDevice->fileName()),
+                        static_cast<int>(inputFileDevice->error()),
+                        qPrintable(inputFileDevice->errorString()));
+                    return false;
+                }
+                _unreportedFileOpensCount.fetchAndAddOrdered(1);
+                _closeInputOnClose = true;
+            }
+
+            _inputMutex.reset(new QMutex());
+            zcis = new QFileDeviceSharedInputStream(inputFileDevice, _inputMutex);
+        }
+
+        // Windowed stream opens file on first read and keeps it opened till it's released
+        if (!zcis)
+        {
+            if (!inputFileDevice->isOpen())
+                _unreportedFileOpensCount.fetchAndAddOrdered(1);
+            zcis = new QFileDeviceInputStream(inputFileDevice);
+        }
+    }
     else
         zcis = new QIODeviceInputStream(_input);
     _zeroCopyInputStream.reset(zcis);
@@ -101,20 +175,9 @@ bool OsmAnd::ObfReader_P::open()
 
 bool OsmAnd::ObfReader_P::close()
 {
-#if OSMAND_VERIFY_OBF_READER_THREAD
-    if (_threadId != QThread::currentThreadId())
-    {
-        LogPrintf(LogSeverityLevel::Warning,
-            "ObfReader(%p) was accessed from thread %p, but created in thread %p",
-            owner.get(),
-            QThread::currentThreadId(),
-            _threadId);
-#   if OSMAND_VERIFY_OBF_READER_THREAD > 1
-        assert(false);
-#   endif // OSMAND_VERIFY_OBF_READER_THREAD > 1
-    }
-#endif // OSMAND_VERIFY_OBF_READER_THREAD
+    verifyThread();
 
+    QMutexLocker scopedLocker(&_inputStreamsMutex);
     if (!isOpened())
         return false;
 
@@ -132,49 +195,58 @@ bool OsmAnd::ObfReader_P::close()
     }
 #endif // OSMAND_TRACE_OBF_READERS
 
+    // Cursors of all threads become invalid as soon as coded input stream of reader is released
+    const auto inputMutex = _inputMutex;
     _codedInputStream.reset();
     _zeroCopyInputStream.reset();
+    _inputMutex.reset();
+
+    // Shared file handle is closed while no cursor reads it, and cursors that are still alive fail to read further
+    if (_closeInputOnClose)
+    {
+        QMutexLocker scopedInputLocker(inputMutex.get());
+        std::static_pointer_cast<QFileDevice>(_input)->close();
+        _closeInputOnClose = false;
+    }
 
     return true;
 }
 
 std::shared_ptr<const OsmAnd::ObfInfo> OsmAnd::ObfReader_P::obtainInfo() const
 {
-#if OSMAND_VERIFY_OBF_READER_THREAD
-    if (_threadId != QThread::currentThreadId())
-    {
-        LogPrintf(LogSeverityLevel::Warning,
-            "ObfReader(%p) was accessed from thread %p, but created in thread %p",
-            owner.get(),
-            QThread::currentThreadId(),
-            _threadId);
-#   if OSMAND_VERIFY_OBF_READER_THREAD > 1
-        assert(false);
-#   endif // OSMAND_VERIFY_OBF_READER_THREAD > 1
-    }
-#endif // OSMAND_VERIFY_OBF_READER_THREAD
+    verifyThread();
 
     // Check if information is already available
-    if (_obfInfo)
+    if (_obfInfoLoaded.loadAcquire() != 0)
         return _obfInfo;
 
     if (!isOpened())
         return nullptr;
 
+    QMutexLocker scopedLocker1(&_obfInfoMutex);
+    if (_obfInfo)
+        return _obfInfo;
+
     if (owner->obfFile)
     {
-        QMutexLocker scopedLocker(&owner->obfFile->_p->_obfInfoMutex);
+        QMutexLocker scopedLocker2(&owner->obfFile->_p->_obfInfoMutex);
 
         if (!owner->obfFile->_p->_obfInfo)
         {
+            const auto& infoCacheFilePath = owner->obfFile->infoCacheFilePath;
+
+            // Try sidecar first, and only if it's missing or stale, walk the OBF headers
             std::shared_ptr<ObfInfo> obfInfo;
-            if (!readInfo(*this, obfInfo))
-                return nullptr;
+            if (infoCacheFilePath.isEmpty() || !ObfInfoCache::load(infoCacheFilePath, owner->obfFile->filePath, obfInfo))
+            {
+                if (!readInfo(*this, obfInfo))
+                    return nullptr;
+                if (!infoCacheFilePath.isEmpty())
+                    ObfInfoCache::save(infoCacheFilePath, owner->obfFile->filePath, obfInfo);
+            }
             owner->obfFile->_p->_obfInfo = obfInfo;
         }
         _obfInfo = owner->obfFile->_p->_obfInfo;
-
-        return _obfInfo;
     }
     else
     {
@@ -182,28 +254,70 @@ std::shared_ptr<const OsmAnd::ObfInfo> OsmAnd::ObfReader_P::obtainInfo() const
         if (!readInfo(*this, obfInfo))
             return nullptr;
         _obfInfo = obfInfo;
-
-        return _obfInfo;
     }
+    _obfInfoLoaded.storeRelease(1);
+
+    return _obfInfo;
 }
 
 std::shared_ptr<OsmAnd::gpb::io::CodedInputStream> OsmAnd::ObfReader_P::getCodedInputStream() const
 {
-#if OSMAND_VERIFY_OBF_READER_THREAD
-    if (_threadId != QThread::currentThreadId())
+    verifyThread();
+
+    if (!owner->threadSafe)
+        return _codedInputStream;
+
+    // Each thread gets own cursor, created on first access
+    auto& threadCursors = _threadCursors.localData();
+    const auto citThreadCursor = threadCursors.constFind(this);
+    if (citThreadCursor != threadCursors.cend() && !citThreadCursor->sourceInputStream.expired())
+        return citThreadCursor->codedInputStream;
+
+    QMutexLocker scopedLocker(&_inputStreamsMutex);
+    if (!isOpened())
+        return nullptr;
+
+    ThreadCursor threadCursor;
+    threadCursor.sourceInputStream = _codedInputStream;
+    if (const auto mappedInputStream = std::dynamic_pointer_cast<QFileDeviceMappedInputStream>(_zeroCopyInputStream))
     {
-        LogPrintf(LogSeverityLevel::Warning,
-            "ObfReader(%p) was accessed from thread %p, but created in thread %p",
+        // Share same mapping, only position is per-thread. Cursor keeps mapped stream alive, so that mapping
+        // outlives reading that may be still in progress when reader is closed
+        threadCursor.mappedInputStream = mappedInputStream;
+        threadCursor.zeroCopyInputStream.reset(new MemoryInputStream(
+            mappedInputStream->getMappedMemory(),
+            mappedInputStream->getMappedSize()));
+    }
+    else if (_inputMutex)
+    {
+        // Share same file handle, only position and buffer are per-thread
+        threadCursor.zeroCopyInputStream.reset(new QFileDeviceSharedInputStream(
+            std::static_pointer_cast<QFileDevice>(_input),
+            _inputMutex));
+    }
+    else
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "ObfReader(%p) can not provide separate cursor for thread %p over generic I/O device",
             owner.get(),
-            QThread::currentThreadId(),
-            _threadId);
-#   if OSMAND_VERIFY_OBF_READER_THREAD > 1
-        assert(false);
-#   endif // OSMAND_VERIFY_OBF_READER_THREAD > 1
+            QThread::currentThreadId());
+        return nullptr;
     }
-#endif // OSMAND_VERIFY_OBF_READER_THREAD
 
-    return _codedInputStream;
+    const auto cis = new gpb::io::CodedInputStream(threadCursor.zeroCopyInputStream.get());
+    cis->SetTotalBytesLimit(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+    threadCursor.codedInputStream.reset(cis);
+
+    // Drop cursors of readers that were closed since, so that they don't pile up in long-living threads
+    auto itThreadCursor = mutableIteratorOf(threadCursors);
+    while (itThreadCursor.hasNext())
+    {
+        if (itThreadCursor.next().value().sourceInputStream.expired())
+            itThreadCursor.remove();
+    }
+    threadCursors.insert(this, threadCursor);
+
+    return threadCursor.codedInputStream;
 }
 
 bool OsmAnd::ObfReader_P::readInfo(const ObfReader_P& reader, std::shared_ptr<ObfInfo>& outInfo)
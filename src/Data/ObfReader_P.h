@@ -9,6 +9,10 @@
 #include <QString>
 #include <QIODevice>
 #include <QThread>
+#include <QThreadStorage>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -40,12 +44,40 @@ namespace OsmAnd
         std::shared_ptr<gpb::io::ZeroCopyInputStream> _zeroCopyInputStream;
         std::shared_ptr<gpb::io::CodedInputStream> _codedInputStream;
 
+        // Guards input streams while reader is opened, closed or cursor is created
+        mutable QMutex _inputStreamsMutex;
+
+        // In thread-safe mode without mapping, all cursors read same file handle that is guarded by this mutex
+        std::shared_ptr<QMutex> _inputMutex;
+
+        // File handle was opened by reader, so it's closed by reader as well
+        bool _closeInputOnClose;
+
+        // Cursors are stored per thread, so they're released as soon as thread exits. Since another reader may
+        // later get same address, each cursor refers to coded input stream of reader at the moment of creation,
+        // and it's valid only while that stream is alive (until reader is closed)
+        struct ThreadCursor
+        {
+            std::weak_ptr<gpb::io::CodedInputStream> sourceInputStream;
+            std::shared_ptr<gpb::io::ZeroCopyInputStream> mappedInputStream;
+            std::shared_ptr<gpb::io::ZeroCopyInputStream> zeroCopyInputStream;
+            std::shared_ptr<gpb::io::CodedInputStream> codedInputStream;
+        };
+        typedef QHash< const ObfReader_P*, ThreadCursor > ThreadCursors;
+        static QThreadStorage<ThreadCursors> _threadCursors;
+
+        mutable QAtomicInt _obfInfoLoaded;
+        mutable QMutex _obfInfoMutex;
         mutable std::shared_ptr<const ObfInfo> _obfInfo;
         static bool readInfo(const ObfReader_P& reader, std::shared_ptr<ObfInfo>& info);
 
+        // Number of file opens that were not yet taken by metrics
+        mutable QAtomicInt _unreportedFileOpensCount;
+
 #if OSMAND_VERIFY_OBF_READER_THREAD
         const Qt::HANDLE _threadId;
 #endif // OSMAND_VERIFY_OBF_READER_THREAD
+        void verifyThread() const;
     protected:
         ObfReader_P(ObfReader* const owner, const std::shared_ptr<QIODevice>& input);
     public:
@@ -61,6 +93,9 @@ namespace OsmAnd
 
         std::shared_ptr<gpb::io::CodedInputStream> getCodedInputStream() const;
 
+        // Number of times file was opened since last call, to be used by metrics
+        unsigned int takeFileOpensCount() const;
+
     friend class OsmAnd::ObfReader;
     };
 }
@@ -16,6 +16,11 @@ void OsmAnd::ObfRoutingSectionReader_Metrics::Metric_loadRoads::reset()
     Metric::reset();
 }
 
+void OsmAnd::ObfRoutingSectionReader_Metrics::Metric_loadRoads::merge(const Metric_loadRoads& that)
+{
+    OsmAnd__ObfRoutingSectionReader_Metrics__Metric_loadRoads__FIELDS(MERGE_METRIC_FIELD);
+}
+
 QString OsmAnd::ObfRoutingSectionReader_Metrics::Metric_loadRoads::toString(const bool shortFormat /*= false*/, const QString& prefix /*= QString::null*/) const
 {
     QString output;
@@ -694,82 +694,36 @@ void OsmAnd::ObfRoutingSectionReader_P::readRoad(
             {
                 const Stopwatch roadPointsStopwatch(metric != nullptr);
 
-                gpb::uint32 length;
-                cis->ReadVarint32(&length);
-                auto oldLimit = cis->PushLimit(length);
-
+                // Decode all points (and their bbox) at once
+                PointI origin;
+                origin.x = (treeNode->area31.left() >> ShiftCoordinates) << ShiftCoordinates;
+                origin.y = (treeNode->area31.top() >> ShiftCoordinates) << ShiftCoordinates;
+                QVector< PointI > points31;
                 AreaI roadBBox;
-                roadBBox.top() = roadBBox.left() = std::numeric_limits<int32_t>::max();
-                roadBBox.bottom() = roadBBox.right() = 0;
-                auto lastUnprocessedPointForBBox = 0;
-
-                // In protobuf, a sint32 can be encoded using [1..4] bytes,
-                // so try to guess size of array, and preallocate it.
-                // (BytesUntilLimit/2) is ~= number of vertices, and is always larger than needed.
-                // So it's impossible that a buffer overflow will ever happen. But assert on that.
-                const auto probableVerticesCount = (cis->BytesUntilLimit() / 2);
-                QVector< PointI > points31(probableVerticesCount);
+                ObfReaderUtilities::readDeltaCoordinates(cis, origin, ShiftCoordinates, points31, roadBBox);
 
+                // Since bbox of all points is known, it's enough to check it: a point inside bbox
+                // as well as an edge crossing it both make bboxes intersect
                 bool shouldNotSkip = (bbox31 == nullptr);
-                auto pointsCount = 0;
-                auto dx = treeNode->area31.left() >> ShiftCoordinates;
-                auto dy = treeNode->area31.top() >> ShiftCoordinates;
-                auto pPoint = points31.data();
-                while (cis->BytesUntilLimit() > 0)
-                {
-                    const uint32_t x = ObfReaderUtilities::readSInt32(cis) + dx;
-                    const uint32_t y = ObfReaderUtilities::readSInt32(cis) + dy;
-
-                    PointI point31(
-                        x << ShiftCoordinates,
-                        y << ShiftCoordinates);
-                    // Save point into storage
-                    assert(points31.size() > pointsCount);
-                    *(pPoint++) = point31;
-                    pointsCount++;
-
-                    dx = x;
-                    dy = y;
-
-                    // Check if road should be maintained
-                    if (!shouldNotSkip && bbox31)
-                    {
-                        const Stopwatch roadBboxStopwatch(metric != nullptr);
-
-                        shouldNotSkip = bbox31->contains(point31);
-                        roadBBox.enlargeToInclude(point31);
-
-                        if (metric)
-                            metric->elapsedTimeForRoadsBbox += roadBboxStopwatch.elapsed();
-
-                        lastUnprocessedPointForBBox = pointsCount;
-                    }
-                }
-                cis->PopLimit(oldLimit);
-
-                // Since reserved space may be larger than actual amount of data,
-                // shrink the vertices array
-                points31.resize(pointsCount);
-
-                // Even if no point lays inside bbox, an edge
-                // may intersect the bbox
                 if (!shouldNotSkip && bbox31)
                 {
-                    assert(lastUnprocessedPointForBBox == points31.size());
+                    const Stopwatch roadBboxStopwatch(metric != nullptr);
 
                     shouldNotSkip =
                         roadBBox.contains(*bbox31) ||
                         bbox31->intersects(roadBBox);
+
+                    if (metric)
+                        metric->elapsedTimeForRoadsBbox += roadBboxStopwatch.elapsed();
                 }
 
-                // If map object didn't fit, skip it's entire content
+                // If road didn't fit, skip it
                 if (!shouldNotSkip)
                 {
                     // Update metric
                     if (metric)
                         metric->elapsedTimeForSkippedRoadsPoints += roadPointsStopwatch.elapsed();
 
-                    cis->Skip(cis->BytesUntilLimit());
                     break;
                 }
 
@@ -777,21 +731,6 @@ void OsmAnd::ObfRoutingSectionReader_P::readRoad(
                 if (metric)
                     metric->elapsedTimeForNotSkippedRoadsPoints += roadPointsStopwatch.elapsed();
 
-                // In case bbox is not fully calculated, complete this task
-                auto pPointForBBox = points31.data() + lastUnprocessedPointForBBox;
-                while (lastUnprocessedPointForBBox < points31.size())
-                {
-                    const Stopwatch roadBboxStopwatch(metric != nullptr);
-
-                    roadBBox.enlargeToInclude(*pPointForBBox);
-
-                    if (metric)
-                        metric->elapsedTimeForRoadsBbox += roadBboxStopwatch.elapsed();
-
-                    lastUnprocessedPointForBBox++;
-                    pPointForBBox++;
-                }
-
                 // Finally, create the object
                 if (!road)
                     road.reset(new OsmAnd::Road(section));
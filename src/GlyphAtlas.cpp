@@ -0,0 +1,374 @@
+#include "GlyphAtlas.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <SkBitmap.h>
+#include <SkBitmapDevice.h>
+#include <SkCanvas.h>
+#include "restore_internal_warnings.h"
+
+#include "QtCommon.h"
+#include "Logging.h"
+
+namespace OsmAnd
+{
+    struct GlyphAtlas::Page Q_DECL_FINAL
+    {
+        Page(const PointI& size)
+            : packer(size)
+        {
+        }
+
+        ShelfPacker packer;
+        SkBitmap bitmap;
+        // Copy of bitmap shared with runs, reset once new cells are drawn into bitmap
+        std::shared_ptr<const SkBitmap> snapshot;
+    };
+}
+
+OsmAnd::GlyphAtlas::GlyphAtlas(
+    const unsigned int pageSize_ /*= DefaultPageSize*/,
+    const unsigned int maxPagesCount_ /*= DefaultMaxPagesCount*/)
+    : pageSize(pageSize_)
+    , maxPagesCount(qMax(maxPagesCount_, 1u))
+{
+}
+
+OsmAnd::GlyphAtlas::~GlyphAtlas()
+{
+}
+
+std::shared_ptr<OsmAnd::GlyphAtlas::Page> OsmAnd::GlyphAtlas::addPage()
+{
+    const std::shared_ptr<Page> page(new Page(PointI(pageSize, pageSize)));
+    if (!page->bitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(pageSize, pageSize)))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to allocate glyph atlas page of size %dx%d",
+            pageSize,
+            pageSize);
+        return nullptr;
+    }
+    page->bitmap.eraseColor(SK_ColorTRANSPARENT);
+
+    _pages.push_back(page);
+    return page;
+}
+
+bool OsmAnd::GlyphAtlas::placeCells(
+    Page& page,
+    const QVector<CellRequest>& cells,
+    const int cellHeight,
+    const CellPainter& painter,
+    QVector<AreaI>& outAreas,
+    unsigned int& outDrawnCellsCount)
+{
+    std::unique_ptr<SkBitmapDevice> target;
+    std::unique_ptr<SkCanvas> canvas;
+
+    auto pArea = outAreas.data();
+    for (const auto& cell : constOf(cells))
+    {
+        auto& area = *(pArea++);
+
+        // Same glyph may occur in a run several times, so it's looked up after previous cells were added
+        const auto citCell = _cells.constFind(cell.key);
+        if (citCell != _cells.cend() && citCell->page == &page)
+        {
+            area = citCell->area;
+            continue;
+        }
+
+        if (!page.packer.pack(PointI(cell.width, cellHeight), area))
+            return false;
+
+        if (!canvas)
+        {
+            target.reset(new SkBitmapDevice(page.bitmap));
+            canvas.reset(new SkCanvas(target.get()));
+        }
+        canvas->save();
+        canvas->translate(area.left(), area.top());
+        canvas->clipRect(SkRect::MakeWH(area.width(), area.height()));
+        painter(*canvas, cell);
+        canvas->restore();
+
+        Cell newCell;
+        newCell.page = &page;
+        newCell.area = area;
+        _cells.insert(cell.key, newCell);
+        page.snapshot.reset();
+        outDrawnCellsCount++;
+    }
+
+    if (canvas)
+        canvas->flush();
+
+    return true;
+}
+
+std::shared_ptr<const OsmAnd::GlyphAtlas::GlyphRun> OsmAnd::GlyphAtlas::obtainGlyphRun(
+    const QVector<float>& glyphsWidth,
+    const int cellHeight,
+    const QVector<CellRequest>& cells,
+    const CellPainter& painter,
+    unsigned int* const outDrawnCellsCount /*= nullptr*/)
+{
+    if (outDrawnCellsCount)
+        *outDrawnCellsCount = 0;
+
+    // Cells that can't fit into an empty page are never placed
+    const auto maxCellSize = static_cast<int>(pageSize) - 2;
+    if (cellHeight <= 0 || cellHeight > maxCellSize)
+        return nullptr;
+    for (const auto& cell : constOf(cells))
+    {
+        if (cell.width <= 0 || cell.width > maxCellSize)
+            return nullptr;
+    }
+
+    QVector<AreaI> areas(cells.size());
+
+    QMutexLocker scopedLocker(&_mutex);
+
+    // If all cells are already on the same page, nothing has to be drawn
+    std::shared_ptr<Page> page;
+    const Page* commonPage = nullptr;
+    auto pArea = areas.data();
+    for (const auto& cell : constOf(cells))
+    {
+        const auto citCell = _cells.constFind(cell.key);
+        if (citCell == _cells.cend() || (commonPage && citCell->page != commonPage))
+        {
+            commonPage = nullptr;
+            break;
+        }
+
+        commonPage = citCell->page;
+        *(pArea++) = citCell->area;
+    }
+    if (commonPage)
+    {
+        for (const auto& existingPage : constOf(_pages))
+        {
+            if (existingPage.get() == commonPage)
+            {
+                page = existingPage;
+                break;
+            }
+        }
+    }
+
+    // Otherwise run is placed to last page. If it doesn't fit there, it's placed to a new page entirely, so that
+    // each run references only one page. Atlas is cleared once all pages are used.
+    unsigned int drawnCellsCount = 0;
+    while (!page)
+    {
+        page = _pages.isEmpty() ? addPage() : _pages.last();
+        if (!page)
+            return nullptr;
+
+        const auto wasEmpty = page->packer.isEmpty();
+        if (placeCells(*page, cells, cellHeight, painter, areas, drawnCellsCount))
+            break;
+        page.reset();
+
+        if (wasEmpty)
+            return nullptr;
+
+        if (static_cast<unsigned int>(_pages.size()) >= maxPagesCount)
+        {
+            _cells.clear();
+            _pages.clear();
+        }
+        if (!addPage())
+            return nullptr;
+    }
+
+    const std::shared_ptr<GlyphRun> run(new GlyphRun());
+    run->glyphsWidth = glyphsWidth;
+    run->cellHeight = cellHeight;
+    run->page = page;
+    run->pageSize = page->packer.size;
+    run->cells.resize(cells.size());
+    auto pRunCell = run->cells.data();
+    pArea = areas.data();
+    for (const auto& cell : constOf(cells))
+    {
+        auto& runCell = *(pRunCell++);
+        runCell.glyphIndex = cell.glyphIndex;
+        runCell.area = *(pArea++);
+    }
+
+    if (outDrawnCellsCount)
+        *outDrawnCellsCount = drawnCellsCount;
+    return run;
+}
+
+std::shared_ptr<const SkBitmap> OsmAnd::GlyphAtlas::obtainPageBitmap(const GlyphRun& run) const
+{
+    if (!run.page)
+        return nullptr;
+
+    QMutexLocker scopedLocker(&_mutex);
+
+    auto& page = *run.page;
+    if (!page.snapshot)
+    {
+        // Only rows that have cells are copied, since new cells invalidate snapshot and pages are filled top-down.
+        // Cells keep their coordinates, as snapshot starts at the top of the page.
+        const auto usedHeight = qBound(1, page.packer.getUsedHeight(), page.bitmap.height());
+        SkBitmap usedRows;
+        if (!page.bitmap.extractSubset(&usedRows, SkIRect::MakeWH(page.bitmap.width(), usedHeight)))
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Failed to extract %dx%d used area of glyph atlas page",
+                page.bitmap.width(),
+                usedHeight);
+            return nullptr;
+        }
+
+        const std::shared_ptr<SkBitmap> snapshot(new SkBitmap());
+        if (!usedRows.copyTo(snapshot.get(), page.bitmap.colorType()) || snapshot->isNull())
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Failed to copy %dx%d used area of glyph atlas page",
+                page.bitmap.width(),
+                usedHeight);
+            return nullptr;
+        }
+        page.snapshot = snapshot;
+    }
+
+    return page.snapshot;
+}
+
+unsigned int OsmAnd::GlyphAtlas::getPagesCount() const
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    return _pages.size();
+}
+
+unsigned int OsmAnd::GlyphAtlas::getCellsCount() const
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    return _cells.size();
+}
+
+void OsmAnd::GlyphAtlas::clear()
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    _cells.clear();
+    _pages.clear();
+}
+
+OsmAnd::GlyphAtlas::ShelfPacker::ShelfPacker(const PointI& size_, const int padding_ /*= 1*/)
+    : _usedHeight(padding_)
+    , size(size_)
+    , padding(padding_)
+{
+}
+
+OsmAnd::GlyphAtlas::ShelfPacker::~ShelfPacker()
+{
+}
+
+bool OsmAnd::GlyphAtlas::ShelfPacker::pack(const PointI& rectangleSize, AreaI& outArea)
+{
+    if (rectangleSize.x <= 0 || rectangleSize.y <= 0)
+        return false;
+
+    // Prefer shelf that wastes least height, unless it's too high for this rectangle and new shelf fits
+    const auto canAddShelf = _usedHeight + rectangleSize.y + padding <= size.y;
+    Shelf* pBestShelf = nullptr;
+    for (auto& shelf : _shelves)
+    {
+        if (shelf.height < rectangleSize.y || shelf.usedWidth + rectangleSize.x + padding > size.x)
+            continue;
+        if (canAddShelf && 2 * shelf.height > 3 * rectangleSize.y)
+            continue;
+        if (!pBestShelf || shelf.height < pBestShelf->height)
+            pBestShelf = &shelf;
+    }
+
+    if (!pBestShelf)
+    {
+        if (!canAddShelf || padding + rectangleSize.x + padding > size.x)
+            return false;
+
+        Shelf shelf;
+        shelf.top = _usedHeight;
+        shelf.height = rectangleSize.y;
+        shelf.usedWidth = padding;
+        _shelves.push_back(shelf);
+        _usedHeight += rectangleSize.y + padding;
+        pBestShelf = &_shelves.last();
+    }
+
+    outArea.top() = pBestShelf->top;
+    outArea.left() = pBestShelf->usedWidth;
+    outArea.bottom() = outArea.top() + rectangleSize.y;
+    outArea.right() = outArea.left() + rectangleSize.x;
+    pBestShelf->usedWidth += rectangleSize.x + padding;
+
+    return true;
+}
+
+int OsmAnd::GlyphAtlas::ShelfPacker::getUsedHeight() const
+{
+    return _usedHeight;
+}
+
+bool OsmAnd::GlyphAtlas::ShelfPacker::isEmpty() const
+{
+    return _shelves.isEmpty();
+}
+
+void OsmAnd::GlyphAtlas::ShelfPacker::reset()
+{
+    _shelves.clear();
+    _usedHeight = padding;
+}
+
+OsmAnd::GlyphAtlas::GlyphKey::GlyphKey()
+    : typefaceId(0)
+    , glyphId(0)
+    , size(0.0f)
+    , fakeBold(false)
+    , haloRadius(0)
+    , cellAscent(0)
+    , cellDescent(0)
+{
+}
+
+bool OsmAnd::GlyphAtlas::GlyphKey::operator==(const GlyphKey& that) const
+{
+    return
+        typefaceId == that.typefaceId &&
+        glyphId == that.glyphId &&
+        size == that.size &&
+        fakeBold == that.fakeBold &&
+        color == that.color &&
+        haloRadius == that.haloRadius &&
+        cellAscent == that.cellAscent &&
+        cellDescent == that.cellDescent;
+}
+
+OsmAnd::GlyphAtlas::GlyphRun::GlyphRun()
+    : cellHeight(0)
+{
+}
+
+OsmAnd::GlyphAtlas::GlyphRun::~GlyphRun()
+{
+}
+
+float OsmAnd::GlyphAtlas::GlyphRun::getWidth() const
+{
+    auto width = 0.0f;
+    for (const auto glyphWidth : constOf(glyphsWidth))
+        width += glyphWidth;
+    return width;
+}
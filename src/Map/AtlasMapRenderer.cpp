@@ -67,8 +67,16 @@ bool OsmAnd::AtlasMapRenderer::postPrepareFrame()
     if (!MapRenderer::postPrepareFrame())
         return false;
 
-    // Notify resources manager about new active zone
-    getResources().updateActiveZone(internalState->targetTileId, internalState->uniqueTiles, currentState.zoomLevel);
+    // Notify resources manager about new active zone. Continuous zoom is passed to predict zoom level change
+    const auto zoom = currentState.zoomLevel + (currentState.visualZoom >= 1.0f
+        ? currentState.visualZoom - 1.0f
+        : (currentState.visualZoom - 1.0f) * 2.0f);
+    getResources().updateActiveZone(
+        internalState->targetTileId,
+        internalState->uniqueTiles,
+        currentState.zoomLevel,
+        currentState.target31,
+        zoom);
 
     return true;
 }
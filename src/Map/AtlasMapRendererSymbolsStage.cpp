@@ -29,6 +29,7 @@
 #include "BillboardRasterMapSymbol.h"
 #include "OnSurfaceRasterMapSymbol.h"
 #include "MapSymbolsGroup.h"
+#include "IUpdatableMapSymbolsGroup.h"
 #include "QKeyValueIterator.h"
 #include "MapSymbolIntersectionClassesRegistry.h"
 #include "Stopwatch.h"
@@ -43,6 +44,12 @@ OsmAnd::AtlasMapRendererSymbolsStage::~AtlasMapRendererSymbolsStage()
 {
 }
 
+OsmAnd::AtlasMapRendererSymbolsStage::PlacedSymbolsGroupInstance::PlacedSymbolsGroupInstance()
+    : publishedSymbolsCount(0)
+    , hasRejectedSymbols(false)
+{
+}
+
 void OsmAnd::AtlasMapRendererSymbolsStage::prepare(AtlasMapRenderer_Metrics::Metric_renderFrame* const metric)
 {
     Stopwatch stopwatch(metric != nullptr);
@@ -325,6 +332,17 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
     const auto treeDepth = 32u - SkCLZ(viewportMaxDimension >> 6);
     outIntersections = qMove(ScreenQuadTree(currentState.viewport, qMax(treeDepth, 1u)));
     ComputedPathsDataCache computedPathsDataCache;
+
+    // Symbols placed in previous frames are not placed again while only target of camera changes, unless they
+    // were moved too far on screen, republished or intersect symbols placed in this frame. Symbols of newly
+    // published groups are placed as usual.
+    const auto symbolsPlacementView = getSymbolsPlacementView();
+    const auto incrementalPlacement = !debugSettings->disableIncrementalSymbolsPlacement &&
+        IncrementalSymbolsPlacement::canPlaceIncrementally(_lastSymbolsPlacement.view, symbolsPlacementView);
+    if (metric && incrementalPlacement)
+        metric->incrementalSymbolsPlacements++;
+    PlacedSymbolsByOrder placedSymbolsByOrder;
+
     for (const auto& mapSymbolsByOrderEntry : rangeOf(constOf(mapSymbolsByOrder)))
     {
         const auto order = mapSymbolsByOrderEntry.key();
@@ -333,6 +351,15 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
 
         const auto itPlottedSymbolsInsertPosition = plottedSymbols.begin();
 
+        const PlacedSymbolsByGroup* pLastPlacedSymbolsByGroup = nullptr;
+        if (incrementalPlacement)
+        {
+            const auto citLastPlacedSymbolsByGroup = _lastSymbolsPlacement.placedSymbolsByOrder.constFind(order);
+            if (citLastPlacedSymbolsByGroup != _lastSymbolsPlacement.placedSymbolsByOrder.cend())
+                pLastPlacedSymbolsByGroup = &(*citLastPlacedSymbolsByGroup);
+        }
+        auto& placedSymbolsByGroup = placedSymbolsByOrder[order];
+
         // Iterate over all groups in proper order (proper order is maintained during publishing)
         for (const auto& mapSymbolsEntry : constOf(mapSymbols))
         {
@@ -369,69 +396,79 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
                 }
             }
 
-            // Check if original was discarded
-            if (!mapSymbolsGroup->additionalInstancesDiscardOriginal)
+            // Symbols of updatable groups may change without being republished, so they're always placed again
+            const PlacedSymbolsGroupInstances* pLastPlacedSymbolsGroupInstances = nullptr;
+            if (pLastPlacedSymbolsByGroup && !std::dynamic_pointer_cast<const IUpdatableMapSymbolsGroup>(mapSymbolsGroup))
             {
-                // Process symbols from this group in order as they are stored in group
-                for (const auto& mapSymbol : constOf(mapSymbolsGroup->symbols))
-                {
-                    if (mapSymbol->isHidden)
-                        continue;
+                const auto citLastPlacedSymbolsGroupInstances = pLastPlacedSymbolsByGroup->constFind(mapSymbolsGroup);
+                if (citLastPlacedSymbolsGroupInstances != pLastPlacedSymbolsByGroup->cend())
+                    pLastPlacedSymbolsGroupInstances = &(*citLastPlacedSymbolsGroupInstances);
+            }
+            auto& placedSymbolsGroupInstances = placedSymbolsByGroup[mapSymbolsGroup];
 
-                    // If this map symbol is not published yet or is located at different order, skip
-                    const auto citReferencesOrigins = mapSymbolsFromGroup.constFind(mapSymbol);
-                    if (citReferencesOrigins == mapSymbolsFromGroup.cend())
-                        continue;
-                    const auto& referencesOrigins = *citReferencesOrigins;
+            // Original (unless it was discarded) goes first, then rest of the instances in order as they are
+            // defined in original group
+            QList< std::shared_ptr<const MapSymbolsGroup::AdditionalInstance> > groupInstances;
+            if (!mapSymbolsGroup->additionalInstancesDiscardOriginal)
+                groupInstances.push_back(nullptr);
+            for (const auto& additionalGroupInstance : constOf(mapSymbolsGroup->additionalInstances))
+                groupInstances.push_back(additionalGroupInstance);
 
-                    QList< std::shared_ptr<RenderableSymbol> > renderableSymbols;
-                    obtainRenderablesFromSymbol(
-                        mapSymbolsGroup,
-                        mapSymbol,
-                        nullptr,
-                        referencesOrigins,
-                        computedPathsDataCache,
-                        renderableSymbols,
-                        metric);
+            for (const auto& groupInstance : constOf(groupInstances))
+            {
+                auto& placedSymbolsGroupInstance = placedSymbolsGroupInstances[groupInstance];
+                placedSymbolsGroupInstance.publishedSymbolsCount = mapSymbolsFromGroup.size();
 
-                    bool atLeastOnePlotted = false;
-                    for (const auto& renderableSymbol : constOf(renderableSymbols))
+                // Reuse symbols of this group instance placed in previous frames, if possible
+                QList<PlacedSymbol> reusedSymbols;
+                bool reused = false;
+                if (pLastPlacedSymbolsGroupInstances)
+                {
+                    const auto citLastPlacedSymbolsGroupInstance = pLastPlacedSymbolsGroupInstances->constFind(groupInstance);
+                    reused = citLastPlacedSymbolsGroupInstance != pLastPlacedSymbolsGroupInstances->cend() &&
+                        reusePlacedSymbols(*citLastPlacedSymbolsGroupInstance, mapSymbolsFromGroup, reusedSymbols) &&
+                        plotReusedSymbols(reusedSymbols, outIntersections, metric);
+                }
+                if (reused)
+                {
+                    for (const auto& reusedSymbol : constOf(reusedSymbols))
                     {
-                        if (!plotSymbol(renderableSymbol, outIntersections, metric))
-                            continue;
+                        const auto& renderableSymbol = reusedSymbol.renderable;
+                        const auto& mapSymbol = renderableSymbol->mapSymbol;
 
-                        if (!atLeastOnePlotted)
+                        if (pOutAcceptedMapSymbolsByOrder)
                         {
-                            // In case renderable symbol was obtained and accepted map symbols were requested,
-                            // add this symbol to accepted
-                            if (pOutAcceptedMapSymbolsByOrder)
-                            {
-                                if (pAcceptedMapSymbols == nullptr)
-                                    pAcceptedMapSymbols = &(*pOutAcceptedMapSymbolsByOrder)[order];
+                            if (pAcceptedMapSymbols == nullptr)
+                                pAcceptedMapSymbols = &(*pOutAcceptedMapSymbolsByOrder)[order];
 
-                                (*pAcceptedMapSymbols)[mapSymbolsGroup].insert(mapSymbol, referencesOrigins);
-                            }
-                            atLeastOnePlotted = true;
+                            (*pAcceptedMapSymbols)[mapSymbolsGroup].insert(mapSymbol, mapSymbolsFromGroup[mapSymbol]);
                         }
 
                         const auto itPlottedSymbol = plottedSymbols.insert(itPlottedSymbolsInsertPosition, renderableSymbol);
                         PlottedSymbolRef plottedSymbolRef = { itPlottedSymbol, renderableSymbol };
 
                         plottedSymbolsMapByGroupAndInstance[mapSymbolsGroup]
-                            .instancesRefs[nullptr]
+                            .instancesRefs[groupInstance]
                             .symbolsRefs.push_back(qMove(plottedSymbolRef));
                     }
+                    placedSymbolsGroupInstance.placedSymbols = reusedSymbols;
+
+                    if (metric)
+                        metric->symbolsGroupInstancesReused++;
+                    continue;
                 }
-            }
+                if (metric)
+                    metric->symbolsGroupInstancesPlaced++;
 
-            // Now process rest of the instances in order as they are defined in original group
-            for (const auto& additionalGroupInstance : constOf(mapSymbolsGroup->additionalInstances))
-            {
                 // Process symbols from this group in order as they are stored in original group
                 for (const auto& mapSymbol : constOf(mapSymbolsGroup->symbols))
                 {
+                    // Hidden symbol may be shown without being republished, so placement without it isn't reused
                     if (mapSymbol->isHidden)
+                    {
+                        placedSymbolsGroupInstance.hasRejectedSymbols = true;
                         continue;
+                    }
 
                     // If this map symbol is not published yet or is located at different order, skip
                     const auto citReferencesOrigins = mapSymbolsFromGroup.constFind(mapSymbol);
@@ -439,11 +476,15 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
                         continue;
                     const auto& referencesOrigins = *citReferencesOrigins;
 
-                    // If symbol is not references in additional group reference, also skip
-                    const auto citAdditionalSymbolInstance = additionalGroupInstance->symbols.constFind(mapSymbol);
-                    if (citAdditionalSymbolInstance == additionalGroupInstance->symbols.cend())
-                        continue;
-                    const auto& additionalSymbolInstance = *citAdditionalSymbolInstance;
+                    // If symbol is not referenced in additional group instance, also skip
+                    std::shared_ptr<const MapSymbolsGroup::AdditionalSymbolInstanceParameters> additionalSymbolInstance;
+                    if (groupInstance)
+                    {
+                        const auto citAdditionalSymbolInstance = groupInstance->symbols.constFind(mapSymbol);
+                        if (citAdditionalSymbolInstance == groupInstance->symbols.cend())
+                            continue;
+                        additionalSymbolInstance = *citAdditionalSymbolInstance;
+                    }
 
                     QList< std::shared_ptr<RenderableSymbol> > renderableSymbols;
                     obtainRenderablesFromSymbol(
@@ -479,9 +520,17 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
                         PlottedSymbolRef plottedSymbolRef = { itPlottedSymbol, renderableSymbol };
 
                         plottedSymbolsMapByGroupAndInstance[mapSymbolsGroup]
-                            .instancesRefs[additionalGroupInstance]
+                            .instancesRefs[groupInstance]
                             .symbolsRefs.push_back(qMove(plottedSymbolRef));
+
+                        PlacedSymbol placedSymbol;
+                        placedSymbol.renderable = renderableSymbol;
+                        placedSymbol.anchor31 = getRenderableAnchor31(renderableSymbol, currentState.target31);
+                        placedSymbol.anchorOnScreen = projectFromWorldToScreen(placedSymbol.anchor31, currentState.target31);
+                        placedSymbolsGroupInstance.placedSymbols.push_back(qMove(placedSymbol));
                     }
+                    if (!atLeastOnePlotted)
+                        placedSymbolsGroupInstance.hasRejectedSymbols = true;
                 }
             }
         }
@@ -664,6 +713,33 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
             metric->elapsedTimeForSymbolsPresentationModeCheck = symbolsPresentationModeCheckStopwatch.elapsed();
     }
 
+    // Remember placement for following frames, without symbols that were discarded due to presentation mode
+    QSet<const RenderableSymbol*> plottedRenderables;
+    plottedRenderables.reserve(plottedSymbols.size());
+    for (const auto& plottedSymbol : constOf(plottedSymbols))
+        plottedRenderables.insert(plottedSymbol.get());
+    for (auto& placedSymbolsByGroup : placedSymbolsByOrder)
+    {
+        for (auto& placedSymbolsGroupInstances : placedSymbolsByGroup)
+        {
+            for (auto& placedSymbolsGroupInstance : placedSymbolsGroupInstances)
+            {
+                auto itPlacedSymbol = mutableIteratorOf(placedSymbolsGroupInstance.placedSymbols);
+                while (itPlacedSymbol.hasNext())
+                {
+                    if (plottedRenderables.contains(itPlacedSymbol.next().renderable.get()))
+                        continue;
+
+                    itPlacedSymbol.remove();
+                    placedSymbolsGroupInstance.hasRejectedSymbols = true;
+                }
+            }
+        }
+    }
+    _lastSymbolsPlacement.view = symbolsPlacementView;
+    _lastSymbolsPlacement.target31 = currentState.target31;
+    _lastSymbolsPlacement.placedSymbolsByOrder = qMove(placedSymbolsByOrder);
+
     // Publish the result
     outRenderableSymbols.clear();
     outRenderableSymbols.reserve(plottedSymbols.size());
@@ -681,6 +757,198 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
     return true;
 }
 
+OsmAnd::IncrementalSymbolsPlacement::View OsmAnd::AtlasMapRendererSymbolsStage::getSymbolsPlacementView() const
+{
+    const auto& internalState = getInternalState();
+
+    IncrementalSymbolsPlacement::View view;
+    view.isValid = true;
+    view.mPerspectiveProjectionView = internalState.mPerspectiveProjectionView;
+    view.glmViewport = internalState.glmViewport;
+    view.windowSize = currentState.windowSize;
+    view.zoomLevel = currentState.zoomLevel;
+    return view;
+}
+
+bool OsmAnd::AtlasMapRendererSymbolsStage::reusePlacedSymbols(
+    const PlacedSymbolsGroupInstance& placedSymbolsGroupInstance,
+    const MapRenderer::PublishedMapSymbols& mapSymbolsFromGroup,
+    QList<PlacedSymbol>& outReusedSymbols) const
+{
+    if (!IncrementalSymbolsPlacement::canReuseGroupInstance(
+        placedSymbolsGroupInstance.publishedSymbolsCount,
+        placedSymbolsGroupInstance.placedSymbols.size(),
+        placedSymbolsGroupInstance.hasRejectedSymbols,
+        mapSymbolsFromGroup.size()))
+    {
+        return false;
+    }
+
+    for (const auto& placedSymbol : constOf(placedSymbolsGroupInstance.placedSymbols))
+    {
+        const auto& renderable = placedSymbol.renderable;
+        if (renderable->mapSymbol->isHidden)
+            return false;
+
+        const auto citReferencesOrigins = mapSymbolsFromGroup.constFind(renderable->mapSymbol);
+        if (citReferencesOrigins == mapSymbolsFromGroup.cend())
+            return false;
+        if (captureGpuResource(*citReferencesOrigins, renderable->mapSymbol) != renderable->gpuResource)
+            return false;
+
+        // Bounding boxes are kept as they were at placement, so they're valid only near that position
+        const auto anchorOnScreen = projectFromWorldToScreen(placedSymbol.anchor31, currentState.target31);
+        if (!IncrementalSymbolsPlacement::canReuseSymbol(placedSymbol.anchorOnScreen, anchorOnScreen))
+            return false;
+    }
+
+    outReusedSymbols.reserve(placedSymbolsGroupInstance.placedSymbols.size());
+    for (const auto& placedSymbol : constOf(placedSymbolsGroupInstance.placedSymbols))
+    {
+        PlacedSymbol reusedSymbol = placedSymbol;
+        reusedSymbol.renderable = moveRenderableToCurrentTarget(placedSymbol.renderable, placedSymbol.anchor31);
+        outReusedSymbols.push_back(qMove(reusedSymbol));
+    }
+
+    return true;
+}
+
+bool OsmAnd::AtlasMapRendererSymbolsStage::plotReusedSymbols(
+    const QList<PlacedSymbol>& reusedSymbols,
+    ScreenQuadTree& intersections,
+    AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
+{
+    // Symbols placed earlier in this frame may overlap reused ones, so each of them is tested as a newly placed
+    // one. Group instance is either reused entirely or placed again, so if any of symbols doesn't fit anymore,
+    // the ones already added are removed.
+    QList< std::shared_ptr<const RenderableSymbol> > addedRenderables;
+    bool plotted = true;
+    for (const auto& reusedSymbol : constOf(reusedSymbols))
+    {
+        const auto& renderable = reusedSymbol.renderable;
+
+        // On-surface symbols are not tested for intersections during placement either
+        if (std::dynamic_pointer_cast<const RenderableOnSurfaceSymbol>(renderable))
+            continue;
+
+        if (!applyVisibilityFiltering(renderable->visibleBBox, intersections, metric) ||
+            !applyIntersectionWithOtherSymbolsFiltering(renderable, intersections, metric) ||
+            !applyMinDistanceToSameContentFromOtherSymbolFiltering(renderable, intersections, metric) ||
+            !addToIntersections(renderable, intersections, metric))
+        {
+            plotted = false;
+            break;
+        }
+        addedRenderables.push_back(renderable);
+    }
+    if (plotted)
+        return true;
+
+    if (!debugSettings->allSymbolsTransparentForIntersectionLookup)
+    {
+        for (const auto& renderable : constOf(addedRenderables))
+        {
+            if (!renderable->mapSymbol->intersectsWithClasses.isEmpty())
+                intersections.removeOne(renderable, renderable->intersectionBBox);
+        }
+    }
+
+    return false;
+}
+
+std::shared_ptr<const OsmAnd::AtlasMapRendererSymbolsStage::RenderableSymbol>
+OsmAnd::AtlasMapRendererSymbolsStage::moveRenderableToCurrentTarget(
+    const std::shared_ptr<const RenderableSymbol>& renderable,
+    const PointI& anchor31) const
+{
+    const auto& internalState = getInternalState();
+
+    const auto targetShift31 = currentState.target31 - _lastSymbolsPlacement.target31;
+    if (targetShift31.x == 0 && targetShift31.y == 0)
+        return renderable;
+
+    // Bounding boxes are kept as they were at placement, only data used for rendering is updated
+    if (const auto renderableBillboard = std::dynamic_pointer_cast<const RenderableBillboardSymbol>(renderable))
+    {
+        const std::shared_ptr<RenderableBillboardSymbol> movedRenderable(
+            new RenderableBillboardSymbol(*renderableBillboard));
+        movedRenderable->offsetFromTarget31 = renderableBillboard->offsetFromTarget31 - targetShift31;
+        movedRenderable->offsetFromTarget = Utilities::convert31toFloat(
+            movedRenderable->offsetFromTarget31,
+            currentState.zoomLevel);
+        movedRenderable->positionInWorld = glm::vec3(
+            movedRenderable->offsetFromTarget.x * AtlasMapRenderer::TileSize3D,
+            0.0f,
+            movedRenderable->offsetFromTarget.y * AtlasMapRenderer::TileSize3D);
+        movedRenderable->distanceToCamera = glm::distance(
+            internalState.worldCameraPosition,
+            movedRenderable->positionInWorld);
+        return movedRenderable;
+    }
+    else if (const auto renderableOnSurface = std::dynamic_pointer_cast<const RenderableOnSurfaceSymbol>(renderable))
+    {
+        const std::shared_ptr<RenderableOnSurfaceSymbol> movedRenderable(
+            new RenderableOnSurfaceSymbol(*renderableOnSurface));
+        movedRenderable->offsetFromTarget31 = renderableOnSurface->offsetFromTarget31 - targetShift31;
+        movedRenderable->offsetFromTarget = Utilities::convert31toFloat(
+            movedRenderable->offsetFromTarget31,
+            currentState.zoomLevel);
+        movedRenderable->positionInWorld = glm::vec3(
+            movedRenderable->offsetFromTarget.x * AtlasMapRenderer::TileSize3D,
+            0.0f,
+            movedRenderable->offsetFromTarget.y * AtlasMapRenderer::TileSize3D);
+        movedRenderable->distanceToCamera = glm::distance(
+            internalState.worldCameraPosition,
+            movedRenderable->positionInWorld);
+        return movedRenderable;
+    }
+    else if (const auto renderableOnPath = std::dynamic_pointer_cast<const RenderableOnPathSymbol>(renderable))
+    {
+        const std::shared_ptr<RenderableOnPathSymbol> movedRenderable(
+            new RenderableOnPathSymbol(*renderableOnPath));
+        if (renderableOnPath->is2D)
+        {
+            // Glyphs of 2D symbol are placed on screen
+            const auto shiftOnScreen =
+                projectFromWorldToScreen(anchor31, currentState.target31) -
+                projectFromWorldToScreen(anchor31, _lastSymbolsPlacement.target31);
+            for (auto& glyphPlacement : movedRenderable->glyphsPlacement)
+                glyphPlacement.anchorPoint += shiftOnScreen;
+        }
+        else
+        {
+            // Glyphs of 3D symbol are placed in world, relative to target
+            const auto shiftInWorld =
+                Utilities::convert31toFloat(targetShift31, currentState.zoomLevel) *
+                static_cast<float>(AtlasMapRenderer::TileSize3D);
+            for (auto& glyphPlacement : movedRenderable->glyphsPlacement)
+                glyphPlacement.anchorPoint -= shiftInWorld;
+        }
+        return movedRenderable;
+    }
+
+    return renderable;
+}
+
+OsmAnd::PointI OsmAnd::AtlasMapRendererSymbolsStage::getRenderableAnchor31(
+    const std::shared_ptr<const RenderableSymbol>& renderable,
+    const PointI& target31)
+{
+    if (const auto renderableBillboard = std::dynamic_pointer_cast<const RenderableBillboardSymbol>(renderable))
+        return target31 + renderableBillboard->offsetFromTarget31;
+    else if (const auto renderableOnSurface = std::dynamic_pointer_cast<const RenderableOnSurfaceSymbol>(renderable))
+        return target31 + renderableOnSurface->offsetFromTarget31;
+    else if (const auto renderableOnPath = std::dynamic_pointer_cast<const RenderableOnPathSymbol>(renderable))
+    {
+        const auto& instanceParameters = renderableOnPath->instanceParameters;
+        if (instanceParameters && instanceParameters->overridesPinPointOnPath)
+            return instanceParameters->pinPointOnPath.point31;
+        return std::static_pointer_cast<const OnPathRasterMapSymbol>(renderable->mapSymbol)->pinPointOnPath.point31;
+    }
+
+    return target31;
+}
+
 void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromSymbol(
     const std::shared_ptr<const MapSymbolsGroup>& mapSymbolGroup,
     const std::shared_ptr<const MapSymbol>& mapSymbol,
@@ -1502,15 +1770,16 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFilt
     const auto checkIntersectionsWithinGroup = renderable->mapSymbolGroup->intersectionProcessingMode.isSet(
         MapSymbolsGroup::IntersectionProcessingModeFlag::CheckIntersectionsWithinGroup);
     const auto& intersectionClassesRegistry = MapSymbolIntersectionClassesRegistry::globalInstance();
-    const auto& symbolIntersectsWithClasses = symbol->intersectsWithClasses;
+    const auto pSymbolIntersectsWithClasses = &symbol->intersectsWithClasses;
     const auto anyIntersectionClass = intersectionClassesRegistry.anyClass;
-    const auto symbolIntersectsWithAnyClass = symbolIntersectsWithClasses.contains(intersectionClassesRegistry.anyClass);
+    const auto symbolIntersectsWithAnyClass = pSymbolIntersectsWithClasses->contains(anyIntersectionClass);
     const auto symbolGroupPtr = symbol->groupPtr;
     const auto symbolGroupInstancePtr = renderable->genericInstanceParameters
         ? renderable->genericInstanceParameters->groupInstancePtr
         : nullptr;
+    unsigned int intersectionClassesTests = 0;
     const auto intersects = intersections.test(renderable->intersectionBBox, false,
-        [symbolGroupPtr, symbolIntersectsWithClasses, symbolIntersectsWithAnyClass, anyIntersectionClass, symbolGroupInstancePtr, checkIntersectionsWithinGroup]
+        [symbolGroupPtr, pSymbolIntersectsWithClasses, symbolIntersectsWithAnyClass, anyIntersectionClass, symbolGroupInstancePtr, checkIntersectionsWithinGroup, &intersectionClassesTests]
         (const std::shared_ptr<const RenderableSymbol>& otherRenderable, const ScreenQuadTree::BBox& otherBBox) -> bool
         {
             const auto& otherSymbol = otherRenderable->mapSymbol;
@@ -1525,24 +1794,26 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFilt
                     return false;
             }
 
+            intersectionClassesTests++;
+            const auto& otherSymbolIntersectsWithClasses = otherSymbol->intersectsWithClasses;
+
             // Special case: tested symbol intersects any other symbol with at least 1 any class
-            if (symbolIntersectsWithAnyClass && !otherSymbol->intersectsWithClasses.isEmpty())
+            if (symbolIntersectsWithAnyClass && !otherSymbolIntersectsWithClasses.isEmpty())
                 return true;
 
             // Special case: other symbol intersects tested symbol with at least 1 any class (which is true already)
-            if (otherSymbol->intersectsWithClasses.contains(anyIntersectionClass))
+            if (otherSymbolIntersectsWithClasses.contains(anyIntersectionClass))
                 return true;
 
             // General case:
-            const auto commonIntersectionClasses = symbolIntersectsWithClasses & otherSymbol->intersectsWithClasses;
-            const auto hasCommonIntersectionClasses = !commonIntersectionClasses.isEmpty();
-            return hasCommonIntersectionClasses;
+            return pSymbolIntersectsWithClasses->intersects(otherSymbolIntersectsWithClasses);
         });
 
     if (metric)
     {
         metric->elapsedTimeForApplyIntersectionWithOtherSymbolsFilteringCalls += stopwatch.elapsed();
         metric->applyIntersectionWithOtherSymbolsFilteringCalls++;
+        metric->intersectionClassesTests += intersectionClassesTests;
         if (intersects)
             metric->rejectedByIntersectionWithOtherSymbolsFiltering++;
         else
@@ -1718,6 +1989,21 @@ QVector<glm::vec2> OsmAnd::AtlasMapRendererSymbolsStage::projectFromWorldToScree
     return result;
 }
 
+glm::vec2 OsmAnd::AtlasMapRendererSymbolsStage::projectFromWorldToScreen(
+    const PointI& point31,
+    const PointI& target31) const
+{
+    const auto& internalState = getInternalState();
+
+    const auto pointInWorld =
+        Utilities::convert31toFloat(point31 - target31, currentState.zoomLevel) *
+        static_cast<float>(AtlasMapRenderer::TileSize3D);
+    return glm_extensions::fastProject(
+        glm::vec3(pointInWorld.x, 0.0f, pointInWorld.y),
+        internalState.mPerspectiveProjectionView,
+        internalState.glmViewport).xy;
+}
+
 std::shared_ptr<const OsmAnd::GPUAPI::ResourceInGPU> OsmAnd::AtlasMapRendererSymbolsStage::captureGpuResource(
     const MapRenderer::MapSymbolReferenceOrigins& resources,
     const std::shared_ptr<const MapSymbol>& mapSymbol)
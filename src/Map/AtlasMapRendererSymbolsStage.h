@@ -17,6 +17,7 @@
 #include "QuadTree.h"
 #include "AtlasMapRendererStage.h"
 #include "GPUAPI.h"
+#include "IncrementalSymbolsPlacement.h"
 
 namespace OsmAnd
 {
@@ -120,6 +121,54 @@ namespace OsmAnd
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         mutable MapRenderer::PublishedMapSymbolsByOrder _lastAcceptedMapSymbolsByOrder;
 
+        // Incremental placement:
+        struct PlacedSymbol
+        {
+            std::shared_ptr<const RenderableSymbol> renderable;
+            PointI anchor31;
+            // Position of anchor on screen at the moment symbol was placed
+            glm::vec2 anchorOnScreen;
+        };
+        struct PlacedSymbolsGroupInstance
+        {
+            PlacedSymbolsGroupInstance();
+
+            int publishedSymbolsCount;
+            QList<PlacedSymbol> placedSymbols;
+            // Some of published symbols of instance were not placed or were discarded
+            bool hasRejectedSymbols;
+        };
+        typedef QHash< std::shared_ptr<const MapSymbolsGroup::AdditionalInstance>, PlacedSymbolsGroupInstance > PlacedSymbolsGroupInstances;
+        typedef QHash< std::shared_ptr<const MapSymbolsGroup>, PlacedSymbolsGroupInstances > PlacedSymbolsByGroup;
+        typedef QMap< int, PlacedSymbolsByGroup > PlacedSymbolsByOrder;
+        struct SymbolsPlacement
+        {
+            IncrementalSymbolsPlacement::View view;
+            // Target that renderables of placed symbols are relative to
+            PointI target31;
+            PlacedSymbolsByOrder placedSymbolsByOrder;
+        };
+        mutable SymbolsPlacement _lastSymbolsPlacement;
+
+        IncrementalSymbolsPlacement::View getSymbolsPlacementView() const;
+        bool reusePlacedSymbols(
+            const PlacedSymbolsGroupInstance& placedSymbolsGroupInstance,
+            const MapRenderer::PublishedMapSymbols& mapSymbolsFromGroup,
+            QList<PlacedSymbol>& outReusedSymbols) const;
+        bool plotReusedSymbols(
+            const QList<PlacedSymbol>& reusedSymbols,
+            ScreenQuadTree& intersections,
+            AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
+        std::shared_ptr<const RenderableSymbol> moveRenderableToCurrentTarget(
+            const std::shared_ptr<const RenderableSymbol>& renderable,
+            const PointI& anchor31) const;
+        static PointI getRenderableAnchor31(
+            const std::shared_ptr<const RenderableSymbol>& renderable,
+            const PointI& target31);
+        glm::vec2 projectFromWorldToScreen(
+            const PointI& point31,
+            const PointI& target31) const;
+
         mutable QReadWriteLock _lastPreparedIntersectionsLock;
         ScreenQuadTree _lastPreparedIntersections;
 
@@ -25,6 +25,8 @@ QString OsmAnd::AtlasMapRenderer_Metrics::Metric_renderFrame::toString(const boo
     output += QLatin1String("\n") + prefix + QString(QLatin1String("~time/billboard-symbol-render = %1ms")).arg((elapsedTimeForBillboardSymbolsRendering / static_cast<float>(billboardSymbolsRendered)) * 1000.0f);
     output += QLatin1String("\n") + prefix + QString(QLatin1String("~time/on-path-symbol-render = %1ms")).arg((elapsedTimeForOnPathSymbolsRendering / static_cast<float>(onPathSymbolsRendered)) * 1000.0f);
     output += QLatin1String("\n") + prefix + QString(QLatin1String("~time/on-surface-symbol-render = %1ms")).arg((elapsedTimeForOnSurfaceSymbolsRendering / static_cast<float>(onSurfaceSymbolsRendered)) * 1000.0f);
+    output += QLatin1String("\n") + prefix + QString(QLatin1String("~intersection-classes-tests/s = %1")).arg(intersectionClassesTests / elapsedTimeForApplyIntersectionWithOtherSymbolsFilteringCalls);
+    output += QLatin1String("\n") + prefix + QString(QLatin1String("~symbols-placement-reuse-rate = %1%")).arg((symbolsGroupInstancesReused * 100.0f) / static_cast<float>(symbolsGroupInstancesPlaced + symbolsGroupInstancesReused));
     output += QLatin1String("\n") + IMapRenderer_Metrics::Metric_renderFrame::toString(shortFormat, prefix);
 
     return output;
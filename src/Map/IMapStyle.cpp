@@ -8,6 +8,11 @@ OsmAnd::IMapStyle::~IMapStyle()
 {
 }
 
+std::shared_ptr<const OsmAnd::MapStyleProgram> OsmAnd::IMapStyle::getProgram() const
+{
+    return nullptr;
+}
+
 OsmAnd::IMapStyle::Value::Value()
     : isDynamic(false)
 {
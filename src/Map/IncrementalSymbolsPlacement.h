@@ -0,0 +1,78 @@
+#ifndef _OSMAND_CORE_INCREMENTAL_SYMBOLS_PLACEMENT_H_
+#define _OSMAND_CORE_INCREMENTAL_SYMBOLS_PLACEMENT_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <glm/glm.hpp>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PointsAndAreas.h"
+
+namespace OsmAnd
+{
+    // Decides whether symbols placed in one of previous frames may be reused instead of being placed again.
+    // Bounding boxes of a placed symbol are computed at its placement and are not moved afterwards, so symbol is
+    // reused only while it stays close to where it was placed. Reused symbols are still tested for intersections
+    // with symbols placed in current frame.
+    struct IncrementalSymbolsPlacement Q_DECL_FINAL
+    {
+        enum : unsigned int {
+            // Symbol isn't reused once it moves on screen by more than this number of pixels since its placement
+            MaxShift = 2u,
+        };
+
+        // Everything except target that defines where renderables are on screen
+        struct View
+        {
+            inline View()
+                : isValid(false)
+                , zoomLevel(InvalidZoomLevel)
+            {
+            }
+
+            bool isValid;
+            glm::mat4 mPerspectiveProjectionView;
+            glm::vec4 glmViewport;
+            PointI windowSize;
+            ZoomLevel zoomLevel;
+        };
+
+        // Renderables are relative to target, so only change of target keeps them valid
+        static inline bool canPlaceIncrementally(const View& lastView, const View& view)
+        {
+            return
+                lastView.isValid &&
+                view.isValid &&
+                lastView.zoomLevel == view.zoomLevel &&
+                lastView.windowSize == view.windowSize &&
+                lastView.glmViewport == view.glmViewport &&
+                lastView.mPerspectiveProjectionView == view.mPerspectiveProjectionView;
+        }
+
+        // Group instance is placed again if some of its symbols were rejected, since they may fit now, and if
+        // symbols were published or unpublished since placement, since that may change placement of entire instance
+        static inline bool canReuseGroupInstance(
+            const int publishedSymbolsCountAtPlacement,
+            const int placedSymbolsCount,
+            const bool hasRejectedSymbols,
+            const int publishedSymbolsCount)
+        {
+            return
+                placedSymbolsCount > 0 &&
+                !hasRejectedSymbols &&
+                publishedSymbolsCountAtPlacement == publishedSymbolsCount;
+        }
+
+        static inline bool canReuseSymbol(const glm::vec2& anchorOnScreenAtPlacement, const glm::vec2& anchorOnScreen)
+        {
+            return glm::distance(anchorOnScreenAtPlacement, anchorOnScreen) <= static_cast<float>(MaxShift);
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_INCREMENTAL_SYMBOLS_PLACEMENT_H_)
@@ -0,0 +1,29 @@
+#include "MapObjectsSymbolsProvider_Metrics.h"
+
+OsmAnd::MapObjectsSymbolsProvider_Metrics::Metric_obtainData::Metric_obtainData()
+{
+    reset();
+}
+
+OsmAnd::MapObjectsSymbolsProvider_Metrics::Metric_obtainData::~Metric_obtainData()
+{
+}
+
+void OsmAnd::MapObjectsSymbolsProvider_Metrics::Metric_obtainData::reset()
+{
+    OsmAnd__MapObjectsSymbolsProvider_Metrics__Metric_obtainData__FIELDS(RESET_METRIC_FIELD);
+
+    Metric::reset();
+}
+
+QString OsmAnd::MapObjectsSymbolsProvider_Metrics::Metric_obtainData::toString(const bool shortFormat /*= false*/, const QString& prefix /*= QString::null*/) const
+{
+    QString output;
+
+    OsmAnd__MapObjectsSymbolsProvider_Metrics__Metric_obtainData__FIELDS(PRINT_METRIC_FIELD);
+    const auto submetricsString = Metric::toString(shortFormat, prefix);
+    if (!submetricsString.isEmpty())
+        output += QLatin1String("\n") + Metric::toString(shortFormat, prefix);
+
+    return output;
+}
@@ -11,6 +11,8 @@
 #include "restore_internal_warnings.h"
 
 #include "MapDataProviderHelpers.h"
+#include "MapObjectsSymbolsProvider_Metrics.h"
+#include "SymbolRasterizer_Metrics.h"
 #include "MapSymbolIntersectionClassesRegistry.h"
 #include "MapPrimitivesProvider.h"
 #include "MapPresentationEnvironment.h"
@@ -20,6 +22,7 @@
 #include "OnPathRasterMapSymbol.h"
 #include "MapObject.h"
 #include "ObfMapSectionInfo.h"
+#include "Stopwatch.h"
 #include "Utilities.h"
 
 OsmAnd::MapObjectsSymbolsProvider_P::MapObjectsSymbolsProvider_P(MapObjectsSymbolsProvider* owner_)
@@ -37,7 +40,18 @@ bool OsmAnd::MapObjectsSymbolsProvider_P::obtainData(
     std::shared_ptr<Metric>* const pOutMetric)
 {
     if (pOutMetric)
-        pOutMetric->reset();
+    {
+        if (!pOutMetric->get() || !dynamic_cast<MapObjectsSymbolsProvider_Metrics::Metric_obtainData*>(pOutMetric->get()))
+            pOutMetric->reset(new MapObjectsSymbolsProvider_Metrics::Metric_obtainData());
+        else
+            pOutMetric->get()->reset();
+    }
+    const auto metric = pOutMetric
+        ? static_cast<MapObjectsSymbolsProvider_Metrics::Metric_obtainData*>(pOutMetric->get())
+        : nullptr;
+
+    const Stopwatch totalStopwatch(metric != nullptr);
+
     const auto& request = MapDataProviderHelpers::castRequest<MapObjectsSymbolsProvider::Request>(request_);
     const auto tileBBox31 = Utilities::tileBoundingBox31(request.tileId, request.zoom);
 
@@ -50,6 +64,9 @@ bool OsmAnd::MapObjectsSymbolsProvider_P::obtainData(
     {
         // Mark tile as empty
         outData.reset();
+
+        if (metric)
+            metric->elapsedTime += totalStopwatch.elapsed();
         return true;
     }
 
@@ -70,11 +87,15 @@ bool OsmAnd::MapObjectsSymbolsProvider_P::obtainData(
             }
             return false;
         };
+    const Stopwatch rasterizationStopwatch(metric != nullptr);
     owner->symbolRasterizer->rasterize(
         primitivesTile->primitivisedObjects,
         rasterizedSymbolsGroups,
         rasterizationFilter,
+        metric ? metric->findOrAddSubmetricOfType<SymbolRasterizer_Metrics::Metric_rasterize>().get() : nullptr,
         nullptr);
+    if (metric)
+        metric->elapsedTimeForRasterization += rasterizationStopwatch.elapsed();
 
     // Convert results
     auto& mapSymbolIntersectionClassesRegistry = MapSymbolIntersectionClassesRegistry::globalInstance();
@@ -148,7 +169,14 @@ bool OsmAnd::MapObjectsSymbolsProvider_P::obtainData(
                 const auto onPathSymbol = new OnPathRasterMapSymbol(group);
                 onPathSymbol->order = rasterizedOnPathSymbol->order;
                 onPathSymbol->bitmap = rasterizedOnPathSymbol->bitmap;
-                onPathSymbol->size = PointI(rasterizedOnPathSymbol->bitmap->width(), rasterizedOnPathSymbol->bitmap->height());
+                if (const auto& glyphRun = rasterizedOnPathSymbol->glyphRun)
+                {
+                    // Bitmap is a page of glyph atlas, so size is one of the run itself
+                    onPathSymbol->size = PointI(qCeil(glyphRun->getWidth()), glyphRun->cellHeight);
+                    onPathSymbol->glyphRun = glyphRun;
+                }
+                else
+                    onPathSymbol->size = PointI(rasterizedOnPathSymbol->bitmap->width(), rasterizedOnPathSymbol->bitmap->height());
                 onPathSymbol->content = rasterizedOnPathSymbol->content;
                 onPathSymbol->languageId = rasterizedOnPathSymbol->languageId;
                 onPathSymbol->minDistance = rasterizedOnPathSymbol->minDistance;
@@ -289,6 +317,9 @@ bool OsmAnd::MapObjectsSymbolsProvider_P::obtainData(
             }
         }
 
+        if (metric)
+            metric->symbols += group->symbols.size();
+
         // Add constructed group to output
         symbolsGroups.push_back(qMove(group));
     }
@@ -301,6 +332,8 @@ bool OsmAnd::MapObjectsSymbolsProvider_P::obtainData(
         primitivesTile,
         new RetainableCacheMetadata(primitivesTile->retainableCacheMetadata)));
 
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
     return true;
 }
 
@@ -50,6 +50,11 @@ void OsmAnd::MapPresentationEnvironment::applyTo(MapStyleEvaluator& evaluator) c
     _p->applyTo(evaluator);
 }
 
+std::shared_ptr<OsmAnd::MapStyleEvaluationCache> OsmAnd::MapPresentationEnvironment::getEvaluationCache() const
+{
+    return _p->getEvaluationCache();
+}
+
 bool OsmAnd::MapPresentationEnvironment::obtainShaderBitmap(
     const QString& name,
     std::shared_ptr<const SkBitmap>& outShaderBitmap) const
@@ -12,6 +12,7 @@
 
 #include "MapStyleEvaluator.h"
 #include "MapStyleEvaluationResult.h"
+#include "MapStyleEvaluationCache.h"
 #include "MapStyleValueDefinition.h"
 #include "MapStyleConstantValue.h"
 #include "MapStyleBuiltinValueDefinitions.h"
@@ -59,6 +60,8 @@ void OsmAnd::MapPresentationEnvironment_P::initialize()
     _globalPathPadding = 0.0f;
 
     _desiredStubsStyle = MapStubStyle::Unspecified;
+
+    _evaluationCache.reset(new MapStyleEvaluationCache(owner->mapStyle));
 }
 
 QHash< OsmAnd::IMapStyle::ValueDefinitionId, OsmAnd::MapStyleConstantValue > OsmAnd::MapPresentationEnvironment_P::getSettings() const
@@ -73,6 +76,10 @@ void OsmAnd::MapPresentationEnvironment_P::setSettings(const QHash< OsmAnd::IMap
     QMutexLocker scopedLocker(&_settingsChangeMutex);
 
     _settings = newSettings;
+
+    // Results evaluated with previous settings are not valid anymore. Cache is replaced rather than cleared,
+    // since evaluators that were set up with previous settings may still use it
+    _evaluationCache.reset(new MapStyleEvaluationCache(owner->mapStyle));
 }
 
 void OsmAnd::MapPresentationEnvironment_P::setSettings(const QHash< QString, QString >& newSettings)
@@ -122,6 +129,13 @@ void OsmAnd::MapPresentationEnvironment_P::setSettings(const QHash< QString, QSt
     setSettings(resolvedSettings);
 }
 
+std::shared_ptr<OsmAnd::MapStyleEvaluationCache> OsmAnd::MapPresentationEnvironment_P::getEvaluationCache() const
+{
+    QMutexLocker scopedLocker(&_settingsChangeMutex);
+
+    return _evaluationCache;
+}
+
 void OsmAnd::MapPresentationEnvironment_P::applyTo(MapStyleEvaluator& evaluator) const
 {
     QMutexLocker scopedLocker(&_settingsChangeMutex);
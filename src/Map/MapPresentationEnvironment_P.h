@@ -28,6 +28,7 @@ namespace OsmAnd
     class UnresolvedMapStyle;
     class MapStyleEvaluator;
     class MapStyleEvaluator_P;
+    class MapStyleEvaluationCache;
 
     class MapPresentationEnvironment_P Q_DECL_FINAL
     {
@@ -45,6 +46,7 @@ namespace OsmAnd
 
         mutable QMutex _settingsChangeMutex;
         QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue > _settings;
+        std::shared_ptr<MapStyleEvaluationCache> _evaluationCache;
 
         std::shared_ptr<const IMapStyle::IAttribute> _defaultBackgroundColorAttribute;
         ColorARGB _defaultBackgroundColor;
@@ -96,6 +98,7 @@ namespace OsmAnd
         void setSettings(const QHash< QString, QString >& newSettings);
 
         void applyTo(MapStyleEvaluator& evaluator) const;
+        std::shared_ptr<MapStyleEvaluationCache> getEvaluationCache() const;
 
         bool obtainShaderBitmap(const QString& name, std::shared_ptr<const SkBitmap>& outBitmap) const;
         bool obtainMapIcon(const QString& name, std::shared_ptr<const SkBitmap>& outIcon) const;
@@ -12,7 +12,7 @@
 #include "Logging.h"
 
 OsmAnd::MapPrimitivesProvider_P::MapPrimitivesProvider_P(MapPrimitivesProvider* owner_)
-    : _primitiviserCache(new MapPrimitiviser::Cache())
+    : _primitiviserCache(new MapPrimitiviser::Cache(RetainedPrimitivesGroupsPerZoom))
     , owner(owner_)
 {
 }
@@ -145,9 +145,7 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainTiledPrimitives(
         primitivisedObjects = owner->primitiviser->primitiviseAllMapObjects(
             request.zoom,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            _primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects>().get() : nullptr);
     }
@@ -157,9 +155,7 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainTiledPrimitives(
             Utilities::getScaleDivisor31ToPixel(PointI(owner->tileSize, owner->tileSize), request.zoom),
             request.zoom,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            _primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects>().get() : nullptr);
     }
@@ -169,9 +165,7 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainTiledPrimitives(
             Utilities::getScaleDivisor31ToPixel(PointI(owner->tileSize, owner->tileSize), request.zoom),
             request.zoom,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            _primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseWithoutSurface>().get() : nullptr);
     }
@@ -184,9 +178,7 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainTiledPrimitives(
             request.zoom,
             dataTile->tileSurfaceType,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            _primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseWithSurface>().get() : nullptr);
     }
@@ -62,6 +62,12 @@ namespace OsmAnd
         };
         mutable TiledEntriesCollection<TileEntry> _tileReferences;
 
+        // Groups of objects are shared by tiles via cache. Its containers are striped, so tiles that are
+        // primitivised concurrently don't contend for single lock. Number of groups per zoom level that are kept
+        // after last tile that referenced them is released is limited
+        enum : size_t {
+            RetainedPrimitivesGroupsPerZoom = 8192,
+        };
         const std::shared_ptr<MapPrimitiviser::Cache> _primitiviserCache;
 
         struct RetainableCacheMetadata : public IMapDataProvider::RetainableCacheMetadata
@@ -14,6 +14,16 @@ OsmAnd::MapPrimitiviser::~MapPrimitiviser()
 {
 }
 
+void OsmAnd::MapPrimitiviser::setWorkerPool(const std::shared_ptr<Concurrent::WorkerPool>& workerPool)
+{
+    _p->setWorkerPool(workerPool);
+}
+
+std::shared_ptr<OsmAnd::Concurrent::WorkerPool> OsmAnd::MapPrimitiviser::getWorkerPool() const
+{
+    return _p->getWorkerPool();
+}
+
 std::shared_ptr<OsmAnd::MapPrimitiviser::PrimitivisedObjects> OsmAnd::MapPrimitiviser::primitiviseAllMapObjects(
     const ZoomLevel zoom,
     const QList< std::shared_ptr<const MapObject> >& objects,
@@ -84,6 +94,13 @@ OsmAnd::MapPrimitiviser::PrimitivesGroup::~PrimitivesGroup()
 {
 }
 
+const QVector<OsmAnd::PointI>& OsmAnd::MapPrimitiviser::PrimitivesGroup::getPoints31() const
+{
+    if (!simplifiedPoints31.isEmpty())
+        return simplifiedPoints31;
+    return sourceObject->points31;
+}
+
 OsmAnd::MapPrimitiviser::Primitive::Primitive(
     const std::shared_ptr<const PrimitivesGroup>& group_,
     const PrimitiveType type_,
@@ -116,6 +133,214 @@ OsmAnd::MapPrimitiviser::Primitive::~Primitive()
 {
 }
 
+OsmAnd::MapPrimitiviser::PrimitivesArrays::PrimitivesArrays()
+{
+}
+
+int OsmAnd::MapPrimitiviser::PrimitivesArrays::size() const
+{
+    return static_cast<int>(primitives.size());
+}
+
+bool OsmAnd::MapPrimitiviser::PrimitivesArrays::isEmpty() const
+{
+    return primitives.empty();
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::reserve(const int capacity)
+{
+    primitives.reserve(capacity);
+    sourceObjects.reserve(capacity);
+    zOrders.reserve(capacity);
+    doubledAreas.reserve(capacity);
+    attributeIdIndices.reserve(capacity);
+    pointsCounts.reserve(capacity);
+    objectSortingKeys.reserve(capacity);
+    objectHasSortingKey.reserve(capacity);
+    points31.reserve(capacity);
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::clear()
+{
+    primitives.clear();
+    sourceObjects.clear();
+    zOrders.clear();
+    doubledAreas.clear();
+    attributeIdIndices.clear();
+    pointsCounts.clear();
+    objectSortingKeys.clear();
+    objectHasSortingKey.clear();
+    points31.clear();
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::append(
+    const Primitive& primitive,
+    const QVector<PointI>* const points31_ /*= nullptr*/)
+{
+    const auto sourceObject = primitive.sourceObject.get();
+
+    MapObject::SortingKey sortingKey = 0;
+    const auto hasSortingKey = sourceObject->obtainSortingKey(sortingKey);
+
+    primitives.push_back(&primitive);
+    sourceObjects.push_back(sourceObject);
+    zOrders.push_back(primitive.zOrder);
+    doubledAreas.push_back(primitive.doubledArea);
+    attributeIdIndices.push_back(primitive.attributeIdIndex);
+    pointsCounts.push_back(sourceObject->points31.size());
+    objectSortingKeys.push_back(hasSortingKey ? sortingKey : 0);
+    objectHasSortingKey.push_back(hasSortingKey ? 1 : 0);
+    points31.push_back(points31_ ? points31_ : &sourceObject->points31);
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::append(
+    const PrimitivesCollection& primitives_,
+    const QVector<PointI>* const points31_ /*= nullptr*/)
+{
+    reserve(size() + primitives_.size());
+    for (const auto& primitive : primitives_)
+        append(*primitive, points31_);
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::append(const PrimitivesArrays& that)
+{
+    primitives.insert(primitives.end(), that.primitives.cbegin(), that.primitives.cend());
+    sourceObjects.insert(sourceObjects.end(), that.sourceObjects.cbegin(), that.sourceObjects.cend());
+    zOrders.insert(zOrders.end(), that.zOrders.cbegin(), that.zOrders.cend());
+    doubledAreas.insert(doubledAreas.end(), that.doubledAreas.cbegin(), that.doubledAreas.cend());
+    attributeIdIndices.insert(attributeIdIndices.end(), that.attributeIdIndices.cbegin(), that.attributeIdIndices.cend());
+    pointsCounts.insert(pointsCounts.end(), that.pointsCounts.cbegin(), that.pointsCounts.cend());
+    objectSortingKeys.insert(objectSortingKeys.end(), that.objectSortingKeys.cbegin(), that.objectSortingKeys.cend());
+    objectHasSortingKey.insert(
+        objectHasSortingKey.end(),
+        that.objectHasSortingKey.cbegin(),
+        that.objectHasSortingKey.cend());
+    points31.insert(points31.end(), that.points31.cbegin(), that.points31.cend());
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::remove(const std::vector<uint8_t>& removeFlags)
+{
+    assert(removeFlags.size() == primitives.size());
+
+    const auto count = primitives.size();
+    size_t keptCount = 0;
+    for (size_t index = 0; index < count; index++)
+    {
+        if (removeFlags[index])
+            continue;
+
+        if (keptCount != index)
+        {
+            primitives[keptCount] = primitives[index];
+            sourceObjects[keptCount] = sourceObjects[index];
+            zOrders[keptCount] = zOrders[index];
+            doubledAreas[keptCount] = doubledAreas[index];
+            attributeIdIndices[keptCount] = attributeIdIndices[index];
+            pointsCounts[keptCount] = pointsCounts[index];
+            objectSortingKeys[keptCount] = objectSortingKeys[index];
+            objectHasSortingKey[keptCount] = objectHasSortingKey[index];
+            points31[keptCount] = points31[index];
+        }
+        keptCount++;
+    }
+
+    primitives.resize(keptCount);
+    sourceObjects.resize(keptCount);
+    zOrders.resize(keptCount);
+    doubledAreas.resize(keptCount);
+    attributeIdIndices.resize(keptCount);
+    pointsCounts.resize(keptCount);
+    objectSortingKeys.resize(keptCount);
+    objectHasSortingKey.resize(keptCount);
+    points31.resize(keptCount);
+}
+
+template<typename T>
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::reorderArray(std::vector<T>& array, const std::vector<uint32_t>& order)
+{
+    std::vector<T> reordered;
+    reordered.reserve(order.size());
+    for (const auto index : order)
+        reordered.push_back(array[index]);
+    array.swap(reordered);
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::reorder(const std::vector<uint32_t>& order)
+{
+    assert(order.size() == primitives.size());
+
+    reorderArray(primitives, order);
+    reorderArray(sourceObjects, order);
+    reorderArray(zOrders, order);
+    reorderArray(doubledAreas, order);
+    reorderArray(attributeIdIndices, order);
+    reorderArray(pointsCounts, order);
+    reorderArray(objectSortingKeys, order);
+    reorderArray(objectHasSortingKey, order);
+    reorderArray(points31, order);
+}
+
+void OsmAnd::MapPrimitiviser::PrimitivesArrays::sort()
+{
+    std::vector<uint32_t> order(primitives.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), Comparator(*this));
+    reorder(order);
+}
+
+OsmAnd::MapPrimitiviser::PrimitivesArrays::Comparator::Comparator(const PrimitivesArrays& arrays_)
+    : arrays(arrays_)
+{
+}
+
+bool OsmAnd::MapPrimitiviser::PrimitivesArrays::Comparator::operator()(const uint32_t l, const uint32_t r) const
+{
+    // Sort by zOrder first
+    const auto lZOrder = arrays.zOrders[l];
+    const auto rZOrder = arrays.zOrders[r];
+    if (lZOrder != rZOrder)
+        return lZOrder < rZOrder;
+
+    // Then sort by area
+    const auto lDoubledArea = arrays.doubledAreas[l];
+    const auto rDoubledArea = arrays.doubledAreas[r];
+    if (lDoubledArea != rDoubledArea)
+        return lDoubledArea > rDoubledArea;
+
+    // Then sort by tag=value ordering (this is possible only inside same object)
+    const auto lSourceObject = arrays.sourceObjects[l];
+    const auto rSourceObject = arrays.sourceObjects[r];
+    const auto lAttributeIdIndex = arrays.attributeIdIndices[l];
+    const auto rAttributeIdIndex = arrays.attributeIdIndices[r];
+    if (lAttributeIdIndex != rAttributeIdIndex && lSourceObject == rSourceObject)
+    {
+        if (arrays.primitives[l]->type == PrimitiveType::Polygon)
+            return lAttributeIdIndex > rAttributeIdIndex;
+        return lAttributeIdIndex < rAttributeIdIndex;
+    }
+
+    // Then sort by number of points
+    const auto lPointsCount = arrays.pointsCounts[l];
+    const auto rPointsCount = arrays.pointsCounts[r];
+    if (lPointsCount != rPointsCount)
+        return lPointsCount < rPointsCount;
+
+    // Sort by map object sorting key, same way as MapObject::Comparator does
+    const auto lHasSortingKey = (arrays.objectHasSortingKey[l] != 0);
+    const auto rHasSortingKey = (arrays.objectHasSortingKey[r] != 0);
+    if (lHasSortingKey && rHasSortingKey)
+    {
+        const auto lSortingKey = arrays.objectSortingKeys[l];
+        const auto rSortingKey = arrays.objectSortingKeys[r];
+        if (lSortingKey != rSortingKey)
+            return lSortingKey < rSortingKey;
+    }
+    else if (lHasSortingKey != rHasSortingKey)
+        return lHasSortingKey;
+
+    return lSourceObject < rSourceObject;
+}
+
 OsmAnd::MapPrimitiviser::SymbolsGroup::SymbolsGroup(
     const std::shared_ptr<const MapObject>& sourceObject_)
     : sourceObject(sourceObject_)
@@ -327,22 +552,64 @@ bool OsmAnd::MapPrimitiviser::IconSymbol::hasDifferentContentAs(const IconSymbol
         this->shieldResourceName != that.shieldResourceName;
 }
 
-OsmAnd::MapPrimitiviser::Cache::Cache()
+OsmAnd::MapPrimitiviser::Cache::Cache(const size_t retainedGroupsPerZoom /*= 0*/)
+    : _retainedGroupsPerZoom(retainedGroupsPerZoom)
 {
+    for (auto& sharedSymbolsGroups : _sharedSymbolsGroups)
+        sharedSymbolsGroups.setRetentionBudget(retainedGroupsPerZoom);
 }
 
 OsmAnd::MapPrimitiviser::Cache::~Cache()
 {
 }
 
-OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroups(const ZoomLevel zoom)
+void OsmAnd::MapPrimitiviser::Cache::clearRetained()
 {
-    return _sharedPrimitivesGroups[zoom];
+    {
+        QReadLocker scopedLocker(&_sharedPrimitivesGroupsLock);
+
+        for (const auto& scaledPrimitivesGroupsList : _sharedPrimitivesGroups)
+        {
+            for (const auto& scaledPrimitivesGroups : constOf(scaledPrimitivesGroupsList))
+                scaledPrimitivesGroups.sharedGroups->clearRetained();
+        }
+    }
+    for (auto& sharedSymbolsGroups : _sharedSymbolsGroups)
+        sharedSymbolsGroups.clearRetained();
 }
 
-const OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroups(const ZoomLevel zoom) const
+OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroups(
+    const ZoomLevel zoom,
+    const PointD scaleDivisor31ToPixel)
 {
-    return _sharedPrimitivesGroups[zoom];
+    // Usually there's just one scale per zoom, so look up is done in a list
+    {
+        QReadLocker scopedLocker(&_sharedPrimitivesGroupsLock);
+
+        for (const auto& scaledPrimitivesGroups : constOf(_sharedPrimitivesGroups[zoom]))
+        {
+            if (scaledPrimitivesGroups.scaleDivisor31ToPixel == scaleDivisor31ToPixel)
+                return *scaledPrimitivesGroups.sharedGroups;
+        }
+    }
+
+    QWriteLocker scopedLocker(&_sharedPrimitivesGroupsLock);
+
+    // Check again, since other thread may have added same scale
+    auto& scaledPrimitivesGroupsList = _sharedPrimitivesGroups[zoom];
+    for (const auto& scaledPrimitivesGroups : constOf(scaledPrimitivesGroupsList))
+    {
+        if (scaledPrimitivesGroups.scaleDivisor31ToPixel == scaleDivisor31ToPixel)
+            return *scaledPrimitivesGroups.sharedGroups;
+    }
+
+    ScaledPrimitivesGroups scaledPrimitivesGroups;
+    scaledPrimitivesGroups.scaleDivisor31ToPixel = scaleDivisor31ToPixel;
+    scaledPrimitivesGroups.sharedGroups.reset(new SharedPrimitivesGroupsContainer());
+    scaledPrimitivesGroups.sharedGroups->setRetentionBudget(_retainedGroupsPerZoom);
+    scaledPrimitivesGroupsList.push_back(scaledPrimitivesGroups);
+
+    return *scaledPrimitivesGroups.sharedGroups;
 }
 
 OsmAnd::MapPrimitiviser::Cache::SharedSymbolsGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getSymbolsGroups(const ZoomLevel zoom)
@@ -355,14 +622,11 @@ const OsmAnd::MapPrimitiviser::Cache::SharedSymbolsGroupsContainer& OsmAnd::MapP
     return _sharedSymbolsGroups[zoom];
 }
 
-OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroupsPtr(const ZoomLevel zoom)
-{
-    return &getPrimitivesGroups(zoom);
-}
-
-const OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroupsPtr(const ZoomLevel zoom) const
+OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroupsPtr(
+    const ZoomLevel zoom,
+    const PointD scaleDivisor31ToPixel)
 {
-    return &getPrimitivesGroups(zoom);
+    return &getPrimitivesGroups(zoom, scaleDivisor31ToPixel);
 }
 
 OsmAnd::MapPrimitiviser::Cache::SharedSymbolsGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getSymbolsGroupsPtr(const ZoomLevel zoom)
@@ -395,7 +659,7 @@ OsmAnd::MapPrimitiviser::PrimitivisedObjects::~PrimitivisedObjects()
     // that are owned only current context
     if (cache)
     {
-        auto& sharedGroups = cache->getPrimitivesGroups(zoom);
+        auto& sharedGroups = cache->getPrimitivesGroups(zoom, scaleDivisor31ToPixel);
         for (auto& group : primitivesGroups)
         {
             MapObject::SharingKey sharingKey;
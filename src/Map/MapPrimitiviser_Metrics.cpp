@@ -16,6 +16,11 @@ void OsmAnd::MapPrimitiviser_Metrics::Metric_primitivise::reset()
     Metric::reset();
 }
 
+void OsmAnd::MapPrimitiviser_Metrics::Metric_primitivise::merge(const Metric_primitivise& that)
+{
+    OsmAnd__MapPrimitiviser_Metrics__Metric_primitivise__FIELDS(MERGE_METRIC_FIELD);
+}
+
 QString OsmAnd::MapPrimitiviser_Metrics::Metric_primitivise::toString(
     const bool shortFormat /*= false*/,
     const QString& prefix /*= QString::null*/) const
@@ -32,6 +37,9 @@ QString OsmAnd::MapPrimitiviser_Metrics::Metric_primitivise::toString(
         .arg((elapsedTimeForPolylineEvaluation * 1000.0f / static_cast<float>(polylineEvaluations)) * 1000.0f);
     output += QLatin1String("\n") + prefix + QString(QLatin1String("~time/1k-points = %1ms"))
         .arg((elapsedTimeForPointEvaluation * 1000.0f / static_cast<float>(pointEvaluations)) * 1000.0f);
+    output += QLatin1String("\n") + prefix + QString(QLatin1String("~evaluation-cache-hit-rate = %1%"))
+        .arg(100.0f * static_cast<float>(evaluationCacheHits) /
+            static_cast<float>(evaluationCacheHits + evaluationCacheMisses + evaluationCacheBypasses));
     const auto submetricsString = Metric::toString(shortFormat, prefix);
     if (!submetricsString.isEmpty())
         output += QLatin1String("\n") + Metric::toString(shortFormat, prefix);
@@ -7,6 +7,7 @@
 #include <algorithm>
 
 #include "QtExtensions.h"
+#include <QThread>
 #include "QtCommon.h"
 
 #include "Nullable.h"
@@ -18,6 +19,7 @@
 #include "MapObject.h"
 #include "BinaryMapObject.h"
 #include "Road.h"
+#include "RoadsDensityFilter.h"
 #include "Stopwatch.h"
 #include "Utilities.h"
 #include "QKeyValueIterator.h"
@@ -38,6 +40,16 @@ OsmAnd::MapPrimitiviser_P::~MapPrimitiviser_P()
 {
 }
 
+void OsmAnd::MapPrimitiviser_P::setWorkerPool(const std::shared_ptr<Concurrent::WorkerPool>& workerPool)
+{
+    _workerPool = workerPool;
+}
+
+std::shared_ptr<OsmAnd::Concurrent::WorkerPool> OsmAnd::MapPrimitiviser_P::getWorkerPool() const
+{
+    return _workerPool;
+}
+
 std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimitiviser_P::primitiviseAllMapObjects(
     const ZoomLevel zoom,
     const QList< std::shared_ptr<const MapObject> >& objects,
@@ -64,7 +76,7 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
 {
     const Stopwatch totalStopwatch(metric != nullptr);
 
-    const Context context(owner->environment, zoom);
+    const Context context(owner->environment, zoom, _workerPool);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache,
@@ -131,7 +143,7 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
     //}
     //////////////////////////////////////////////////////////////////////////
 
-    const Context context(owner->environment, zoom);
+    const Context context(owner->environment, zoom, _workerPool);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache,
@@ -479,7 +491,7 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
 {
     const Stopwatch totalStopwatch(metric != nullptr);
 
-    const Context context(owner->environment, zoom);
+    const Context context(owner->environment, zoom, _workerPool);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache, 
@@ -1231,10 +1243,132 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
     const auto& env = context.env;
-    const auto zoom = primitivisedObjects->zoom;
 
     const Stopwatch obtainPrimitivesStopwatch(metric != nullptr);
 
+    // Evaluation cache has to be obtained before settings are applied to evaluators
+    const auto evaluationCache = env->getEvaluationCache();
+
+    // Objects are split into contiguous partitions, and primitives of each partition are merged in order of partitions,
+    // so that result is same as if all objects were processed sequentially
+    const auto partitionsCount = getPartitionsCount(context, source.size(), MapPrimitiviser::MinObjectsPerPartition);
+    QVector<ObtainedPrimitives> partitions(partitionsCount);
+    if (partitionsCount <= 1)
+    {
+        obtainPrimitivesFromPartition(
+            context,
+            primitivisedObjects,
+            source,
+            0,
+            source.size(),
+            evaluationResult,
+            *evaluationCache,
+            cache,
+            queryController,
+            partitions[0],
+            metric);
+    }
+    else
+    {
+        QVector< std::shared_ptr<MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects> > partitionsMetrics(
+            partitionsCount);
+        QVector<Concurrent::WorkerPool::Task> tasks;
+        tasks.reserve(partitionsCount);
+        for (auto partitionIndex = 0; partitionIndex < partitionsCount; partitionIndex++)
+        {
+            if (metric)
+                partitionsMetrics[partitionIndex].reset(new MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects());
+
+            const auto pPartition = &partitions[partitionIndex];
+            const auto partitionMetric = partitionsMetrics[partitionIndex].get();
+            tasks.push_back(
+                [&, partitionIndex, pPartition, partitionMetric]
+                ()
+                {
+                    // Each partition has own evaluators and evaluation result, since they hold state
+                    MapStyleEvaluationResult partitionEvaluationResult(env->mapStyle->getValueDefinitionsCount());
+                    obtainPrimitivesFromPartition(
+                        context,
+                        primitivisedObjects,
+                        source,
+                        (source.size() * partitionIndex) / partitionsCount,
+                        (source.size() * (partitionIndex + 1)) / partitionsCount,
+                        partitionEvaluationResult,
+                        *evaluationCache,
+                        cache,
+                        queryController,
+                        *pPartition,
+                        partitionMetric);
+                });
+        }
+        context.workerPool->runAndWait(
+            tasks,
+            [queryController]
+            () -> bool
+            {
+                return queryController && queryController->isAborted();
+            });
+
+        if (metric)
+        {
+            for (const auto& partitionMetric : constOf(partitionsMetrics))
+                metric->merge(*partitionMetric);
+            metric->parallelPartitions += partitionsCount;
+        }
+    }
+    if (queryController && queryController->isAborted())
+        return;
+
+    // Add polygons, polylines, points and groups from all partitions to current context
+    for (auto& partition : partitions)
+    {
+        appendPrimitives(primitivisedObjects->polygons, partition.polygons);
+        appendPrimitives(primitivisedObjects->polylines, partition.polylines);
+        appendPrimitives(primitivisedObjects->points, partition.points);
+        appendPrimitives(primitivisedObjects->primitivesGroups, partition.primitivesGroups);
+    }
+
+    // Wait for future primitives groups. Groups promised by other partitions of this context are already
+    // fulfilled at this point, since all partitions are finished
+    Stopwatch futureSharedPrimitivesGroupsStopwatch(metric != nullptr);
+    for (auto& partition : partitions)
+    {
+        for (auto& futureSharedGroup : partition.futureSharedPrimitivesGroups)
+        {
+            auto group = futureSharedGroup.get();
+
+            // Add polygons, polylines and points from group to current context
+            primitivisedObjects->polygons.append(group->polygons, &group->getPoints31());
+            primitivisedObjects->polylines.append(group->polylines, &group->getPoints31());
+            primitivisedObjects->points.append(group->points);
+
+            // Add shared group to current context
+            primitivisedObjects->primitivesGroups.push_back(qMove(group));
+        }
+    }
+    if (metric)
+        metric->elapsedTimeForFutureSharedPrimitivesGroups += futureSharedPrimitivesGroupsStopwatch.elapsed();
+
+    if (metric)
+        metric->elapsedTimeForPrimitives += obtainPrimitivesStopwatch.elapsed();
+}
+
+void OsmAnd::MapPrimitiviser_P::obtainPrimitivesFromPartition(
+    const Context& context,
+    const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+    const QList< std::shared_ptr<const OsmAnd::MapObject> >& source,
+    const int firstObjectIndex,
+    const int endObjectIndex,
+    MapStyleEvaluationResult& evaluationResult,
+    MapStyleEvaluationCache& evaluationCache,
+    const std::shared_ptr<Cache>& cache,
+    const std::shared_ptr<const IQueryController>& queryController,
+    ObtainedPrimitives& outPrimitives,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    const auto& env = context.env;
+    const auto zoom = primitivisedObjects->zoom;
+
     // Initialize shared settings for order evaluation
     MapStyleEvaluator orderEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
     env->applyTo(orderEvaluator);
@@ -1259,10 +1393,13 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
     pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
     pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
 
-    const auto pSharedPrimitivesGroups = cache ? cache->getPrimitivesGroupsPtr(zoom) : nullptr;
-    QList< proper::shared_future< std::shared_ptr<const PrimitivesGroup> > > futureSharedPrimitivesGroups;
-    for (const auto& mapObject : constOf(source))
+    const auto pSharedPrimitivesGroups = cache
+        ? cache->getPrimitivesGroupsPtr(zoom, primitivisedObjects->scaleDivisor31ToPixel)
+        : nullptr;
+    for (auto objectIndex = firstObjectIndex; objectIndex < endObjectIndex; objectIndex++)
     {
+        const auto& mapObject = source.at(objectIndex);
+
         //////////////////////////////////////////////////////////////////////////
         //if (mapObject->toString().contains("1333827773"))
         //{
@@ -1287,17 +1424,17 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
             {
                 if (group)
                 {
-                    // Add polygons, polylines and points from group to current context
-                    primitivisedObjects->polygons.append(group->polygons);
-                    primitivisedObjects->polylines.append(group->polylines);
-                    primitivisedObjects->points.append(group->points);
+                    // Add polygons, polylines and points from group to current partition
+                    outPrimitives.polygons.append(group->polygons, &group->getPoints31());
+                    outPrimitives.polylines.append(group->polylines, &group->getPoints31());
+                    outPrimitives.points.append(group->points);
 
-                    // Add shared group to current context
-                    primitivisedObjects->primitivesGroups.push_back(qMove(group));
+                    // Add shared group to current partition
+                    outPrimitives.primitivesGroups.push_back(qMove(group));
                 }
                 else
                 {
-                    futureSharedPrimitivesGroups.push_back(qMove(futureGroup));
+                    outPrimitives.futureSharedPrimitivesGroups.push_back(qMove(futureGroup));
                 }
 
                 continue;
@@ -1315,6 +1452,7 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
             polygonEvaluator,
             polylineEvaluator,
             pointEvaluator,
+            evaluationCache,
             metric);
         if (metric)
             metric->elapsedTimeForObtainingPrimitivesGroups += obtainPrimitivesGroupStopwatch.elapsed();
@@ -1323,34 +1461,29 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
         if (pSharedPrimitivesGroups && isShareable)
             pSharedPrimitivesGroups->fulfilPromiseAndReference(sharingKey, group);
 
-        // Add polygons, polylines and points from group to current context
-        primitivisedObjects->polygons.append(group->polygons);
-        primitivisedObjects->polylines.append(group->polylines);
-        primitivisedObjects->points.append(group->points);
+        // Add polygons, polylines and points from group to current partition
+        outPrimitives.polygons.append(group->polygons, &group->getPoints31());
+        outPrimitives.polylines.append(group->polylines, &group->getPoints31());
+        outPrimitives.points.append(group->points);
 
         // Empty groups are also inserted, to indicate that they are empty
-        primitivisedObjects->primitivesGroups.push_back(qMove(group));
+        outPrimitives.primitivesGroups.push_back(qMove(group));
     }
+}
 
-    // Wait for future primitives groups
-    Stopwatch futureSharedPrimitivesGroupsStopwatch(metric != nullptr);
-    for (auto& futureSharedGroup : futureSharedPrimitivesGroups)
-    {
-        auto group = futureSharedGroup.get();
-
-        // Add polygons, polylines and points from group to current context
-        primitivisedObjects->polygons.append(group->polygons);
-        primitivisedObjects->polylines.append(group->polylines);
-        primitivisedObjects->points.append(group->points);
+int OsmAnd::MapPrimitiviser_P::getPartitionsCount(
+    const Context& context,
+    const int itemsCount,
+    const int minItemsPerPartition)
+{
+    if (!context.workerPool || itemsCount < 2 * minItemsPerPartition)
+        return 1;
 
-        // Add shared group to current context
-        primitivisedObjects->primitivesGroups.push_back(qMove(group));
-    }
-    if (metric)
-        metric->elapsedTimeForFutureSharedPrimitivesGroups += futureSharedPrimitivesGroupsStopwatch.elapsed();
+    // Calling thread processes partitions as well
+    auto threadsCount = context.workerPool->maxThreadCount();
+    threadsCount = (threadsCount > 0) ? threadsCount + 1 : QThread::idealThreadCount();
 
-    if (metric)
-        metric->elapsedTimeForPrimitives += obtainPrimitivesStopwatch.elapsed();
+    return qBound(1, itemsCount / minItemsPerPartition, threadsCount);
 }
 
 std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPrimitiviser_P::obtainPrimitivesGroup(
@@ -1362,11 +1495,14 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     MapStyleEvaluator& polygonEvaluator,
     MapStyleEvaluator& polylineEvaluator,
     MapStyleEvaluator& pointEvaluator,
+    MapStyleEvaluationCache& evaluationCache,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
     const auto& env = context.env;
+    const auto zoom = primitivisedObjects->zoom;
 
     bool ok;
+    MapStyleEvaluationCache::Lookup evaluationCacheLookup;
 
     const auto constructedGroup = new PrimitivesGroup(mapObject);
     std::shared_ptr<const PrimitivesGroup> group(constructedGroup);
@@ -1389,13 +1525,9 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     orderEvaluator.setBooleanValue(env->styleBuiltinValueDefs->id_INPUT_CYCLE, mapObject->isClosedFigure());
     polylineEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_LAYER, static_cast<int>(layerType));
 
-    const auto& decRules = mapObject->attributeMapping->decodeMap;
-    auto pAttributeId = mapObject->attributeIds.constData();
     const auto attributeIdsCount = mapObject->attributeIds.size();
-    for (auto attributeIdIndex = 0; attributeIdIndex < attributeIdsCount; attributeIdIndex++, pAttributeId++)
+    for (auto attributeIdIndex = 0; attributeIdIndex < attributeIdsCount; attributeIdIndex++)
     {
-        const auto& decodedAttribute = decRules[*pAttributeId];
-
         //////////////////////////////////////////////////////////////////////////
         //if (mapObject->toString().contains("49048972"))
         //{
@@ -1406,17 +1538,21 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
 
         const Stopwatch orderEvaluationStopwatch(metric != nullptr);
 
-        // Setup tag+value-specific input data
-        orderEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-        orderEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
-        evaluationResult.clear();
-        ok = orderEvaluator.evaluate(mapObject, MapStyleRulesetType::Order, &evaluationResult);
+        // Tag+value-specific input data is set up by cache, if evaluation is actually performed
+        ok = evaluationCache.evaluate(
+            orderEvaluator,
+            mapObject,
+            attributeIdIndex,
+            MapStyleRulesetType::Order,
+            zoom,
+            evaluationResult,
+            &evaluationCacheLookup);
 
         if (metric)
         {
             metric->elapsedTimeForOrderEvaluation += orderEvaluationStopwatch.elapsed();
             metric->orderEvaluations++;
+            countEvaluationCacheLookup(evaluationCacheLookup, metric);
         }
 
         const Stopwatch orderProcessingStopwatch(metric != nullptr);
@@ -1543,18 +1679,21 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             {
                 const Stopwatch polygonEvaluationStopwatch(metric != nullptr);
 
-                // Setup tag+value-specific input data (for Polygon)
-                polygonEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-                polygonEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
                 // Evaluate style for this primitive to check if it passes (for Polygon)
-                evaluationResult.clear();
-                ok = polygonEvaluator.evaluate(mapObject, MapStyleRulesetType::Polygon, &evaluationResult);
+                ok = evaluationCache.evaluate(
+                    polygonEvaluator,
+                    mapObject,
+                    attributeIdIndex,
+                    MapStyleRulesetType::Polygon,
+                    zoom,
+                    evaluationResult,
+                    &evaluationCacheLookup);
 
                 if (metric)
                 {
                     metric->elapsedTimeForPolygonEvaluation += polygonEvaluationStopwatch.elapsed();
                     metric->polygonEvaluations++;
+                    countEvaluationCacheLookup(evaluationCacheLookup, metric);
                 }
 
                 // Add as polygon if accepted as polygon
@@ -1597,25 +1736,28 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             {
                 const Stopwatch pointEvaluationStopwatch(metric != nullptr);
 
-                // Setup tag+value-specific input data (for Point)
-                pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-                pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
                 // Evaluate Point rules
-                evaluationResult.clear();
-                const auto hasIcon = pointEvaluator.evaluate(mapObject, MapStyleRulesetType::Point, &evaluationResult);
+                const auto hasIcon = evaluationCache.evaluate(
+                    pointEvaluator,
+                    mapObject,
+                    attributeIdIndex,
+                    MapStyleRulesetType::Point,
+                    zoom,
+                    evaluationResult,
+                    &evaluationCacheLookup);
 
                 // Update metric
                 if (metric)
                 {
                     metric->elapsedTimeForPointEvaluation += pointEvaluationStopwatch.elapsed();
                     metric->pointEvaluations++;
+                    countEvaluationCacheLookup(evaluationCacheLookup, metric);
                 }
 
                 const Stopwatch pointProcessingStopwatch(metric != nullptr);
 
                 // Create point primitive only in case polygon has any content
-                if (!mapObject->captions.isEmpty() || hasIcon)
+                if (!mapObject->captionsOrder.isEmpty() || hasIcon)
                 {
                     // Duplicate primitive as point
                     std::shared_ptr<Primitive> pointPrimitive;
@@ -1667,18 +1809,21 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
 
             const Stopwatch polylineEvaluationStopwatch(metric != nullptr);
 
-            // Setup tag+value-specific input data
-            polylineEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-            polylineEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
             // Evaluate style for this primitive to check if it passes
-            evaluationResult.clear();
-            ok = polylineEvaluator.evaluate(mapObject, MapStyleRulesetType::Polyline, &evaluationResult);
+            ok = evaluationCache.evaluate(
+                polylineEvaluator,
+                mapObject,
+                attributeIdIndex,
+                MapStyleRulesetType::Polyline,
+                zoom,
+                evaluationResult,
+                &evaluationCacheLookup);
 
             if (metric)
             {
                 metric->elapsedTimeForPolylineEvaluation += polylineEvaluationStopwatch.elapsed();
                 metric->polylineEvaluations++;
+                countEvaluationCacheLookup(evaluationCacheLookup, metric);
             }
 
             const Stopwatch polylineProcessingStopwatch(metric != nullptr);
@@ -1728,25 +1873,28 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
 
             const Stopwatch pointEvaluationStopwatch(metric != nullptr);
 
-            // Setup tag+value-specific input data
-            pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-            pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
             // Evaluate Point rules
-            evaluationResult.clear();
-            const bool hasIcon = pointEvaluator.evaluate(mapObject, MapStyleRulesetType::Point, &evaluationResult);
+            const bool hasIcon = evaluationCache.evaluate(
+                pointEvaluator,
+                mapObject,
+                attributeIdIndex,
+                MapStyleRulesetType::Point,
+                zoom,
+                evaluationResult,
+                &evaluationCacheLookup);
 
             // Update metric
             if (metric)
             {
                 metric->elapsedTimeForPointEvaluation += pointEvaluationStopwatch.elapsed();
                 metric->pointEvaluations++;
+                countEvaluationCacheLookup(evaluationCacheLookup, metric);
             }
 
             const Stopwatch pointProcessingStopwatch(metric != nullptr);
 
             // Create point primitive only in case polygon has any content
-            if (mapObject->captions.isEmpty() && !hasIcon)
+            if (mapObject->captionsOrder.isEmpty() && !hasIcon)
             {
                 if (metric)
                 {
@@ -1800,49 +1948,124 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
         //}
     }
 
+    // Simplify geometry of polygons and polylines for rasterization at this zoom. Since group may be shared
+    // via cache, this is done once for all tiles that contain same map object.
+    const auto& scaleDivisor31ToPixel = primitivisedObjects->scaleDivisor31ToPixel;
+    if ((!constructedGroup->polygons.isEmpty() || !constructedGroup->polylines.isEmpty()) &&
+        scaleDivisor31ToPixel.x > 0.0 &&
+        scaleDivisor31ToPixel.y > 0.0)
+    {
+        const Stopwatch simplificationStopwatch(metric != nullptr);
+
+        const auto& points31 = mapObject->points31;
+        const auto tolerance31 =
+            context.simplificationTolerance * qMin(scaleDivisor31ToPixel.x, scaleDivisor31ToPixel.y);
+        auto simplifiedPoints31 = Utilities::simplifyPolyline(points31, tolerance31);
+
+        // Polygon has to remain a ring, otherwise it's rasterized as is
+        const auto minPointsCount = constructedGroup->polygons.isEmpty() ? 2 : 4;
+        if (simplifiedPoints31.size() >= minPointsCount && simplifiedPoints31.size() < points31.size())
+        {
+            if (metric)
+                metric->simplificationRemovedPoints += points31.size() - simplifiedPoints31.size();
+
+            constructedGroup->simplifiedPoints31 = qMove(simplifiedPoints31);
+        }
+
+        if (metric)
+            metric->elapsedTimeForSimplification += simplificationStopwatch.elapsed();
+    }
+
     return group;
 }
 
+void OsmAnd::MapPrimitiviser_P::countEvaluationCacheLookup(
+    const MapStyleEvaluationCache::Lookup lookup,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    switch (lookup)
+    {
+        case MapStyleEvaluationCache::Lookup::Hit:
+            metric->evaluationCacheHits++;
+            break;
+        case MapStyleEvaluationCache::Lookup::Miss:
+            metric->evaluationCacheMisses++;
+            break;
+        case MapStyleEvaluationCache::Lookup::Bypass:
+            metric->evaluationCacheBypasses++;
+            break;
+    }
+}
+
 void OsmAnd::MapPrimitiviser_P::sortAndFilterPrimitives(
     const Context& context,
     const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
-    const MapObject::Comparator mapObjectsComparator;
-    const auto privitivesSort =
-        [mapObjectsComparator]
-        (const std::shared_ptr<const Primitive>& l, const std::shared_ptr<const Primitive>& r) -> bool
-        {
-            // Sort by zOrder first
-            if (l->zOrder != r->zOrder)
-                return l->zOrder < r->zOrder;
+    sortPrimitives(context, primitivisedObjects->polygons);
+    sortPrimitives(context, primitivisedObjects->polylines);
+    filterOutHighwaysByDensity(context, primitivisedObjects, metric);
+    sortPrimitives(context, primitivisedObjects->points);
+}
 
-            // Then sort by area
-            if (l->doubledArea != r->doubledArea)
-                return l->doubledArea > r->doubledArea;
+void OsmAnd::MapPrimitiviser_P::sortPrimitives(const Context& context, PrimitivesArrays& primitives)
+{
+    const auto partitionsCount = getPartitionsCount(
+        context,
+        primitives.size(),
+        MapPrimitiviser::MinPrimitivesPerSortPartition);
+    if (partitionsCount <= 1)
+    {
+        primitives.sort();
+        return;
+    }
 
-            // Then sort by tag=value ordering (this is possible only inside same object)
-            if (l->attributeIdIndex != r->attributeIdIndex && l->sourceObject == r->sourceObject)
+    // Only indices of records are sorted, and records are reordered once at the end
+    const PrimitivesArrays::Comparator comparator(primitives);
+    std::vector<uint32_t> order(primitives.size());
+    std::iota(order.begin(), order.end(), 0u);
+    const auto itBegin = order.begin();
+    QVector<int> bounds(partitionsCount + 1);
+    for (auto partitionIndex = 0; partitionIndex <= partitionsCount; partitionIndex++)
+        bounds[partitionIndex] = (primitives.size() * partitionIndex) / partitionsCount;
+
+    // Sort each partition
+    QVector<Concurrent::WorkerPool::Task> tasks;
+    tasks.reserve(partitionsCount);
+    for (auto partitionIndex = 0; partitionIndex < partitionsCount; partitionIndex++)
+    {
+        tasks.push_back(
+            [itBegin, &bounds, &comparator, partitionIndex]
+            ()
             {
-                if (l->type == PrimitiveType::Polygon)
-                    return l->attributeIdIndex > r->attributeIdIndex;
-                return l->attributeIdIndex < r->attributeIdIndex;
-            }
-
-            // Then sort by number of points
-            const auto lPointsCount = l->sourceObject->points31.size();
-            const auto rPointsCount = r->sourceObject->points31.size();
-            if (lPointsCount != rPointsCount)
-                return lPointsCount < rPointsCount;
+                std::sort(itBegin + bounds[partitionIndex], itBegin + bounds[partitionIndex + 1], comparator);
+            });
+    }
+    context.workerPool->runAndWait(tasks);
 
-            // Sort by map object sorting key, if map objects are equal
-            return mapObjectsComparator(l->sourceObject, r->sourceObject);
-        };
+    // Merge sorted partitions pairwise, until single partition is left
+    for (auto step = 1; step < partitionsCount; step *= 2)
+    {
+        tasks.clear();
+        for (auto partitionIndex = 0; partitionIndex + step < partitionsCount; partitionIndex += 2 * step)
+        {
+            const auto middle = bounds[partitionIndex + step];
+            const auto end = bounds[qMin(partitionIndex + 2 * step, partitionsCount)];
+            tasks.push_back(
+                [itBegin, &bounds, &comparator, partitionIndex, middle, end]
+                ()
+                {
+                    std::inplace_merge(
+                        itBegin + bounds[partitionIndex],
+                        itBegin + middle,
+                        itBegin + end,
+                        comparator);
+                });
+        }
+        context.workerPool->runAndWait(tasks);
+    }
 
-    std::sort(primitivisedObjects->polygons, privitivesSort);
-    std::sort(primitivisedObjects->polylines, privitivesSort);
-    filterOutHighwaysByDensity(context, primitivisedObjects, metric);
-    std::sort(primitivisedObjects->points, privitivesSort);
+    primitives.reorder(order);
 }
 
 void OsmAnd::MapPrimitiviser_P::filterOutHighwaysByDensity(
@@ -1854,53 +2077,43 @@ void OsmAnd::MapPrimitiviser_P::filterOutHighwaysByDensity(
     if (context.roadDensityZoomTile == 0 || context.roadsDensityLimitPerTile == 0)
         return;
 
-    const auto dZ = primitivisedObjects->zoom + context.roadDensityZoomTile;
-    QHash< uint64_t, std::pair<uint32_t, double> > densityMap;
-
-    auto itPolyline = mutableIteratorOf(primitivisedObjects->polylines);
-    itPolyline.toBack();
-    while (itPolyline.hasPrevious())
+    // Roads are checked from last to first, so that roads that are rasterized on top are accepted first
+    auto& polylines = primitivisedObjects->polylines;
+    RoadsDensityFilter roadsDensityFilter(
+        primitivisedObjects->zoom,
+        context.roadDensityZoomTile,
+        context.roadsDensityLimitPerTile);
+    std::vector<int> roadsIndices;
+    for (auto polylineIndex = polylines.size() - 1; polylineIndex >= 0; polylineIndex--)
     {
-        const auto& polyline = itPolyline.previous();
-        const auto& sourceObject = polyline->sourceObject;
+        const auto sourceObject = polylines.sourceObjects[polylineIndex];
 
         // If polyline is not road, it should be accepted
-        const auto pPrimitiveAttribute = sourceObject->resolveAttributeByIndex(polyline->attributeIdIndex);
-        if (!pPrimitiveAttribute)
+        const auto attributeIdIndex = static_cast<int>(polylines.attributeIdIndices[polylineIndex]);
+        if (attributeIdIndex >= sourceObject->attributeIds.size())
             continue;
-        if (pPrimitiveAttribute->tag != QLatin1String("highway"))
+        const auto attributeId = sourceObject->attributeIds[attributeIdIndex];
+        if (!sourceObject->attributeMapping->highwayAttributeIds.contains(attributeId))
             continue;
 
-        auto accept = false;
-        uint64_t prevId = 0;
-        const auto pointsCount = sourceObject->points31.size();
-        auto pPoint = sourceObject->points31.constData();
-        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
-        {
-            auto x = pPoint->x >> (MaxZoomLevel - dZ);
-            auto y = pPoint->y >> (MaxZoomLevel - dZ);
-            uint64_t id = (static_cast<uint64_t>(x) << dZ) | y;
-            if (prevId != id)
-            {
-                prevId = id;
+        roadsDensityFilter.addRoad(sourceObject->points31);
+        roadsIndices.push_back(polylineIndex);
+    }
 
-                auto& mapEntry = densityMap[id];
-                if (mapEntry.first < context.roadsDensityLimitPerTile /*&& p.second > o */)
-                {
-                    accept = true;
-                    mapEntry.first += 1;
-                    mapEntry.second = polyline->zOrder;
-                }
-            }
-        }
-        if (!accept)
-        {
-            if (metric)
-                metric->polylineRejectedByDensity++;
+    std::vector<uint8_t> rejectFlags;
+    const auto rejectedCount = roadsDensityFilter.filter(rejectFlags);
+    if (metric)
+        metric->polylineRejectedByDensity += rejectedCount;
+    if (rejectedCount == 0)
+        return;
 
-            itPolyline.remove();
-        }
+    std::vector<uint8_t> removeFlags(polylines.size(), 0);
+    for (auto roadIndex = 0u; roadIndex < roadsIndices.size(); roadIndex++)
+    {
+        if (rejectFlags[roadIndex])
+            removeFlags[roadsIndices[roadIndex]] = 1;
     }
+    polylines.remove(removeFlags);
 }
 
 void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
@@ -2266,8 +2479,9 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveTexts(
     //}
     //////////////////////////////////////////////////////////////////////////
 
-    // Text symbols can only be obtained from captions
-    if (mapObject->captions.isEmpty())
+    // Text symbols can only be obtained from captions. Order of captions is always known, while captions
+    // themselves may be still encoded
+    if (mapObject->captionsOrder.isEmpty())
         return;
 
     const auto& attributeMapping = mapObject->attributeMapping;
@@ -2279,7 +2493,7 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveTexts(
     textEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
 
     // Get captions and their order
-    auto captions = mapObject->captions;
+    auto captions = mapObject->getCaptions();
     auto captionsOrder = mapObject->captionsOrder;
 
     // Process captions to find out what names are present and modify that if needed
@@ -2550,9 +2764,9 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveTexts(
                     for (const auto& nameTag2AttributeEntry : rangeOf(constOf(nameTag2AttributesGroup)))
                     {
                         const auto attributeId = nameTag2AttributeEntry.value();
-                        const auto citExtraCaption = mapObject->captions.constFind(attributeId);
+                        const auto citExtraCaption = mapObject->getCaptions().constFind(attributeId);
 
-                        if (citExtraCaption == mapObject->captions.constEnd())
+                        if (citExtraCaption == mapObject->getCaptions().constEnd())
                             continue;
                         const auto& extraCaption = *citExtraCaption;
                         if (extraCaption.isEmpty())
@@ -2831,13 +3045,18 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveIcon(
 
 OsmAnd::MapPrimitiviser_P::Context::Context(
     const std::shared_ptr<const MapPresentationEnvironment>& env_,
-    const ZoomLevel zoom_)
+    const ZoomLevel zoom_,
+    const std::shared_ptr<Concurrent::WorkerPool>& workerPool_)
     : env(env_)
     , zoom(zoom_)
+    , workerPool(workerPool_)
 {
     polygonAreaMinimalThreshold = env->getPolygonAreaMinimalThreshold(zoom);
     roadDensityZoomTile = env->getRoadDensityZoomTile(zoom);
     roadsDensityLimitPerTile = env->getRoadsDensityLimitPerTile(zoom);
     defaultSymbolPathSpacing = env->getDefaultSymbolPathSpacing();
     defaultBlockPathSpacing = env->getDefaultBlockPathSpacing();
+
+    // Deviation of half a pixel is not noticeable after anti-aliasing
+    simplificationTolerance = 0.5;
 }
@@ -2,9 +2,11 @@
 #define _OSMAND_CORE_MAP_PRIMITIVISER_P_H_
 
 #include "stdlib_common.h"
+#include <proper/future.h>
 
 #include "QtExtensions.h"
 #include <QList>
+#include <QVector>
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
@@ -13,6 +15,8 @@
 #include "MapCommonTypes.h"
 #include "MapPresentationEnvironment.h"
 #include "MapPrimitiviser.h"
+#include "MapStyleEvaluationCache.h"
+#include "WorkerPool.h"
 
 namespace OsmAnd
 {
@@ -27,6 +31,7 @@ namespace OsmAnd
         typedef MapPrimitiviser::PrimitiveType PrimitiveType;
         typedef MapPrimitiviser::Primitive Primitive;
         typedef MapPrimitiviser::PrimitivesCollection PrimitivesCollection;
+        typedef MapPrimitiviser::PrimitivesArrays PrimitivesArrays;
         typedef MapPrimitiviser::PrimitivesGroup PrimitivesGroup;
         typedef MapPrimitiviser::PrimitivesGroupsCollection PrimitivesGroupsCollection;
         typedef MapPrimitiviser::Symbol Symbol;
@@ -39,6 +44,7 @@ namespace OsmAnd
         typedef MapPrimitiviser::Cache Cache;
 
     private:
+        std::shared_ptr<Concurrent::WorkerPool> _workerPool;
     protected:
         MapPrimitiviser_P(MapPrimitiviser* const owner);
 
@@ -54,16 +60,20 @@ namespace OsmAnd
         {
             Context(
                 const std::shared_ptr<const MapPresentationEnvironment>& env,
-                const ZoomLevel zoom);
+                const ZoomLevel zoom,
+                const std::shared_ptr<Concurrent::WorkerPool>& workerPool);
 
             const std::shared_ptr<const MapPresentationEnvironment> env;
             const ZoomLevel zoom;
+            const std::shared_ptr<Concurrent::WorkerPool> workerPool;
 
             double polygonAreaMinimalThreshold;
             unsigned int roadDensityZoomTile;
             unsigned int roadsDensityLimitPerTile;
             float defaultSymbolPathSpacing;
             float defaultBlockPathSpacing;
+            // In pixels
+            double simplificationTolerance;
 
         private:
             Q_DISABLE_COPY_AND_MOVE(Context);
@@ -115,6 +125,52 @@ namespace OsmAnd
             const std::shared_ptr<const IQueryController>& queryController,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
+        // Primitives obtained from single partition of source objects
+        struct ObtainedPrimitives Q_DECL_FINAL
+        {
+            PrimitivesGroupsCollection primitivesGroups;
+            PrimitivesArrays polygons;
+            PrimitivesArrays polylines;
+            PrimitivesArrays points;
+            QList< proper::shared_future< std::shared_ptr<const PrimitivesGroup> > > futureSharedPrimitivesGroups;
+        };
+
+        static void obtainPrimitivesFromPartition(
+            const Context& context,
+            const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+            const QList< std::shared_ptr<const OsmAnd::MapObject> >& source,
+            const int firstObjectIndex,
+            const int endObjectIndex,
+            MapStyleEvaluationResult& evaluationResult,
+            MapStyleEvaluationCache& evaluationCache,
+            const std::shared_ptr<Cache>& cache,
+            const std::shared_ptr<const IQueryController>& queryController,
+            ObtainedPrimitives& outPrimitives,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
+        // Returns number of partitions that given number of items is split into, which is 1 if there's no worker pool
+        static int getPartitionsCount(const Context& context, const int itemsCount, const int minItemsPerPartition);
+
+        template<typename T>
+        static void appendPrimitives(QList<T>& output, QList<T>& input)
+        {
+            if (output.isEmpty())
+                output = qMove(input);
+            else
+                output.append(input);
+        }
+        static void appendPrimitives(PrimitivesArrays& output, PrimitivesArrays& input)
+        {
+            if (output.isEmpty())
+                output = qMove(input);
+            else
+                output.append(input);
+        }
+
+        // Sorts primitives same way as PrimitivesArrays::sort() does, but sorts and merges partitions of large
+        // arrays on worker pool of context
+        static void sortPrimitives(const Context& context, PrimitivesArrays& primitives);
+
         static std::shared_ptr<const PrimitivesGroup> obtainPrimitivesGroup(
             const Context& context,
             const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
@@ -124,6 +180,11 @@ namespace OsmAnd
             MapStyleEvaluator& polygonEvaluator,
             MapStyleEvaluator& polylineEvaluator,
             MapStyleEvaluator& pointEvaluator,
+            MapStyleEvaluationCache& evaluationCache,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
+        static void countEvaluationCacheLookup(
+            const MapStyleEvaluationCache::Lookup lookup,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
         static void sortAndFilterPrimitives(
@@ -237,6 +298,9 @@ namespace OsmAnd
             const std::shared_ptr<const IQueryController>& queryController,
             MapPrimitiviser_Metrics::Metric_primitiviseWithoutSurface* const metric);
 
+        void setWorkerPool(const std::shared_ptr<Concurrent::WorkerPool>& workerPool);
+        std::shared_ptr<Concurrent::WorkerPool> getWorkerPool() const;
+
     friend class OsmAnd::MapPrimitiviser;
     };
 }
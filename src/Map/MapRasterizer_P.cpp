@@ -2,6 +2,9 @@
 #include "MapRasterizer.h"
 #include "MapRasterizer_Metrics.h"
 
+#include "stdlib_common.h"
+#include <limits>
+
 #include "QtCommon.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QReadWriteLock>
@@ -114,13 +117,14 @@ void OsmAnd::MapRasterizer_P::rasterize(
 void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
     const Context& context,
     SkCanvas& canvas,
-    const MapPrimitiviser::PrimitivesCollection& primitives,
+    const MapPrimitiviser::PrimitivesArrays& primitives,
     PrimitivesType type,
     const std::shared_ptr<const IQueryController>& queryController)
 {
     assert(type != PrimitivesType::Points);
 
-    for (const auto& primitive : constOf(primitives))
+    const auto primitivesCount = primitives.size();
+    for (auto primitiveIdx = 0; primitiveIdx < primitivesCount; primitiveIdx++)
     {
         if (queryController && queryController->isAborted())
             return;
@@ -130,14 +134,16 @@ void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
             rasterizePolygon(
                 context,
                 canvas,
-                primitive);
+                primitives.primitives[primitiveIdx],
+                *primitives.points31[primitiveIdx]);
         }
         else if (type == PrimitivesType::Polylines || type == PrimitivesType::Polylines_ShadowOnly)
         {
             rasterizePolyline(
                 context,
                 canvas,
-                primitive,
+                primitives.primitives[primitiveIdx],
+                *primitives.points31[primitiveIdx],
                 (type == PrimitivesType::Polylines_ShadowOnly));
         }
     }
@@ -328,11 +334,9 @@ bool OsmAnd::MapRasterizer_P::updatePaint(
 void OsmAnd::MapRasterizer_P::rasterizePolygon(
     const Context& context,
     SkCanvas& canvas,
-    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive)
+    const MapPrimitiviser::Primitive* const primitive,
+    const QVector<PointI>& points31)
 {
-    const auto& points31 = primitive->sourceObject->points31;
-    const auto& area31 = context.area31;
-
     assert(points31.size() > 2);
     assert(primitive->sourceObject->isClosedFigure());
     assert(primitive->sourceObject->isClosedFigure(true));
@@ -348,64 +352,14 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
     if (!updatePaint(context, paint, primitive->evaluationResult, PaintValuesSet::Layer_1, true))
         return;
 
-    // Construct and test geometry against bbox area
-    SkPath path;
-    bool containsAtLeastOnePoint = false;
-    int pointIdx = 0;
-    PointF vertex;
-    Utilities::CHValue prevChValue;
-    QVector< PointI > outerPoints;
-    const auto pointsCount = points31.size();
-    auto pPoint = points31.constData();
-    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
-    {
-        const auto& point = *pPoint;
-        calculateVertex(context, point, vertex);
-
-        // Hit-test
-        if (!containsAtLeastOnePoint)
-        {
-            if (area31.contains(point))
-                containsAtLeastOnePoint = true;
-            else
-                outerPoints.push_back(point);
-
-            const auto chValue = Utilities::computeCohenSutherlandValue(point, area31);
-            if (Q_LIKELY(pointIdx > 0))
-            {
-                // Check if line crosses area (reject only if points are on the same side)
-                const auto intersectedChValue = prevChValue & chValue;
-                if (static_cast<unsigned int>(intersectedChValue) != 0)
-                    containsAtLeastOnePoint = true;
-            }
-            prevChValue = chValue;
-        }
-
-        // Plot vertex
-        if (pointIdx == 0)
-            path.moveTo(vertex.x, vertex.y);
-        else
-            path.lineTo(vertex.x, vertex.y);
-    }
-
-    //////////////////////////////////////////////////////////////////////////
-    //if ((primitive->sourceObject->id >> 1) == 9223372032559801460u)
-    //{
-    //    int i = 5;
-    //}
-    //////////////////////////////////////////////////////////////////////////
+    // Clip outer ring by area. If nothing is left, polygon is completely outside of area, while polygon that
+    // covers entire area is clipped to area itself.
+    const auto outerRing31 = Utilities::clipPolygon(points31, context.clipArea31);
+    if (outerRing31.size() < 3)
+        return;
 
-    if (!containsAtLeastOnePoint)
-    {
-        // Check area is inside polygon
-        bool ok = true;
-        ok = ok || containsHelper(outerPoints, area31.topLeft);
-        ok = ok || containsHelper(outerPoints, area31.bottomRight);
-        ok = ok || containsHelper(outerPoints, PointI(0, area31.bottom()));
-        ok = ok || containsHelper(outerPoints, PointI(area31.right(), 0));
-        if (!ok)
-            return;
-    }
+    SkPath path;
+    plotRing(context, outerRing31, path);
 
     //////////////////////////////////////////////////////////////////////////
     //if ((primitive->sourceObject->id >> 1) == 95692962u)
@@ -414,22 +368,18 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
     //}
     //////////////////////////////////////////////////////////////////////////
 
-    if (!primitive->sourceObject->innerPolygonsPoints31.isEmpty())
+    // Inner polygons may be still encoded, getter decodes them
+    const auto& innerPolygonsPoints31 = primitive->sourceObject->getInnerPolygonsPoints31();
+    if (!innerPolygonsPoints31.isEmpty())
     {
         path.setFillType(SkPath::kEvenOdd_FillType);
-        for (const auto& polygon : constOf(primitive->sourceObject->innerPolygonsPoints31))
+        for (const auto& polygon : constOf(innerPolygonsPoints31))
         {
-            pointIdx = 0;
-            for (auto itVertex = cachingIteratorOf(constOf(polygon)); itVertex; ++itVertex, pointIdx++)
-            {
-                const auto& point = *itVertex;
-                calculateVertex(context, point, vertex);
+            const auto innerRing31 = Utilities::clipPolygon(polygon, context.clipArea31);
+            if (innerRing31.size() < 3)
+                continue;
 
-                if (pointIdx == 0)
-                    path.moveTo(vertex.x, vertex.y);
-                else
-                    path.lineTo(vertex.x, vertex.y);
-            }
+            plotRing(context, innerRing31, path);
         }
     }
 
@@ -444,11 +394,10 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
 void OsmAnd::MapRasterizer_P::rasterizePolyline(
     const Context& context,
     SkCanvas& canvas,
-    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+    const MapPrimitiviser::Primitive* const primitive,
+    const QVector<PointI>& points31,
     bool drawOnlyShadow)
 {
-    const auto& points31 = primitive->sourceObject->points31;
-    const auto& area31 = context.area31;
     const auto& env = context.env;
 
     assert(points31.size() >= 2);
@@ -469,41 +418,30 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
     if (drawOnlyShadow && (!ok || shadowRadius <= 0.0f))
         return;
 
+    // Clip each segment by area, path is broken where polyline leaves area
     SkPath path;
-    int pointIdx = 0;
     bool intersect = false;
-    int prevCross = 0;
+    PointI prevEnd31;
     PointF vertex;
     const auto pointsCount = points31.size();
-    auto pPoint = points31.constData();
-    PointF pVertex;
-    PointF tempVertex;
-    for (pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+    const auto pPoints = points31.constData();
+    for (auto pointIdx = 1; pointIdx < pointsCount; pointIdx++)
     {
-        const auto& point = *pPoint;
-        calculateVertex(context, point, vertex);
-
-        int cross = 0;
-        cross |= (point.x < area31.left() ? 1 : 0);
-        cross |= (point.x > area31.right() ? 2 : 0);
-        cross |= (point.y < area31.top() ? 4 : 0);
-        cross |= (point.y > area31.bottom() ? 8 : 0);
-        if (pointIdx > 0)
+        auto start31 = pPoints[pointIdx - 1];
+        auto end31 = pPoints[pointIdx];
+        if (!Utilities::clipSegment(start31, end31, context.clipArea31))
+            continue;
+
+        if (!intersect || start31 != prevEnd31)
         {
-            if ((prevCross & cross) == 0)
-            {
-                if (prevCross != 0 || !intersect)
-                {
-                    simplifyVertexToDirection(context, pVertex, vertex, tempVertex);
-                    path.moveTo(tempVertex.x, tempVertex.y);
-                }
-                simplifyVertexToDirection(context, vertex, pVertex, tempVertex);
-                path.lineTo(tempVertex.x, tempVertex.y);
-                intersect = true;
-            }
+            calculateVertex(context, start31, vertex);
+            path.moveTo(vertex.x, vertex.y);
         }
-        prevCross = cross;
-        pVertex = vertex;
+        calculateVertex(context, end31, vertex);
+        path.lineTo(vertex.x, vertex.y);
+
+        prevEnd31 = end31;
+        intersect = true;
     }
 
     if (!intersect)
@@ -632,49 +570,6 @@ void OsmAnd::MapRasterizer_P::rasterizePolylineIcons(
     }
 }
 
-float OsmAnd::MapRasterizer_P::lineEquation(float x1, float y1, float x2, float y2, float x)
-{
-    if(x2 == x1)
-        return y1;
-    return (x - x1) / (x2 - x1) * (y2 - y1) + y1;
-}
-
-void OsmAnd::MapRasterizer_P::simplifyVertexToDirection(
-    const Context& context,
-    const PointF& vertex,
-    const PointF& vertexTo,
-    PointF& res)
-{
-    const auto xShiftForSpacing = context.pixelArea.width() / 4;
-    const auto yShiftForSpacing = context.pixelArea.height() / 4;
-
-    if (vertex.x > context.pixelArea.right() + xShiftForSpacing )
-    {
-        res.x = context.pixelArea.right() + xShiftForSpacing;
-        res.y = lineEquation(vertex.x, vertex.y, vertexTo.x, vertexTo.y, res.x);
-    }
-    else if (vertex.x < context.pixelArea.left() - xShiftForSpacing)
-    {
-        res.x = context.pixelArea.left() - xShiftForSpacing;
-        res.y = lineEquation(vertex.x, vertex.y, vertexTo.x, vertexTo.y, res.x);
-    }
-    else if (vertex.y > context.pixelArea.bottom() + yShiftForSpacing)
-    {
-        res.y = context.pixelArea.bottom() + yShiftForSpacing;
-        res.x = lineEquation(vertex.y, vertex.x, vertexTo.y, vertexTo.x, res.y);
-    }
-    else if (vertex.y < context.pixelArea.top() - yShiftForSpacing)
-    {
-        res.y = context.pixelArea.top() - yShiftForSpacing;
-        res.x = lineEquation(vertex.y, vertex.x, vertexTo.y, vertexTo.x, res.y);
-    }
-    else
-    {
-        res.x = vertex.x;
-        res.y = vertex.y;
-    }
-}
-
 void OsmAnd::MapRasterizer_P::calculateVertex(const Context& context, const PointI& point31, PointF& vertex)
 {
     vertex.x = static_cast<float>(point31.x - context.area31.left()) / context.primitivisedObjects->scaleDivisor31ToPixel.x;
@@ -683,29 +578,21 @@ void OsmAnd::MapRasterizer_P::calculateVertex(const Context& context, const Poin
     vertex += PointF(context.pixelArea.topLeft);
 }
 
-bool OsmAnd::MapRasterizer_P::containsHelper(const QVector< PointI >& points, const PointI& otherPoint)
+void OsmAnd::MapRasterizer_P::plotRing(const Context& context, const QVector<PointI>& ring31, SkPath& path)
 {
-    uint32_t intersections = 0;
-
-    auto itPrevPoint = points.cbegin();
-    auto itPoint = itPrevPoint + 1;
-    for (const auto itEnd = points.cend(); itPoint != itEnd; itPrevPoint = itPoint, ++itPoint)
+    PointF vertex;
+    const auto pointsCount = ring31.size();
+    const auto pPoints = ring31.constData();
+    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++)
     {
-        const auto& point0 = *itPrevPoint;
-        const auto& point1 = *itPoint;
+        calculateVertex(context, pPoints[pointIdx], vertex);
 
-        if (Utilities::rayIntersect(point0, point1, otherPoint))
-            intersections++;
+        if (pointIdx == 0)
+            path.moveTo(vertex.x, vertex.y);
+        else
+            path.lineTo(vertex.x, vertex.y);
     }
-
-    // special handling, also count first and last, might not be closed, but
-    // we want this!
-    const auto& point0 = points.first();
-    const auto& point1 = points.last();
-    if (Utilities::rayIntersect(point0, point1, otherPoint))
-        intersections++;
-
-    return intersections % 2 == 1;
+    path.close();
 }
 
 bool OsmAnd::MapRasterizer_P::obtainPathEffect(const QString& encodedPathEffect, SkPathEffect* &outPathEffect) const
@@ -788,5 +675,13 @@ OsmAnd::MapRasterizer_P::Context::Context(
     , zoom(primitivisedObjects->zoom)
     , pixelArea(pixelArea_)
 {
+    const auto xMargin = static_cast<int64_t>(area31.width()) / 4;
+    const auto yMargin = static_cast<int64_t>(area31.height()) / 4;
+    clipArea31 = AreaI(
+        static_cast<int32_t>(qMax<int64_t>(area31.top() - yMargin, std::numeric_limits<int32_t>::min())),
+        static_cast<int32_t>(qMax<int64_t>(area31.left() - xMargin, std::numeric_limits<int32_t>::min())),
+        static_cast<int32_t>(qMin<int64_t>(area31.bottom() + yMargin, std::numeric_limits<int32_t>::max())),
+        static_cast<int32_t>(qMin<int64_t>(area31.right() + xMargin, std::numeric_limits<int32_t>::max())));
+
     env->obtainShadowOptions(zoom, shadowMode, shadowColor);
 }
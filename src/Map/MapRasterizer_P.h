@@ -48,6 +48,9 @@ namespace OsmAnd
             const ZoomLevel zoom;
             const AreaI pixelArea;
 
+            // Area that geometry is clipped by: area31 with margin of quarter of its size on each side
+            AreaI clipArea31;
+
             MapPresentationEnvironment::ShadowMode shadowMode;
             ColorARGB shadowColor;
 
@@ -85,19 +88,21 @@ namespace OsmAnd
         void rasterizeMapPrimitives(
             const Context& context,
             SkCanvas& canvas,
-            const MapPrimitiviser::PrimitivesCollection& primitives,
+            const MapPrimitiviser::PrimitivesArrays& primitives,
             const PrimitivesType type,
             const std::shared_ptr<const IQueryController>& queryController);
 
         void rasterizePolygon(
             const Context& context,
             SkCanvas& canvas,
-            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive);
+            const MapPrimitiviser::Primitive* const primitive,
+            const QVector<PointI>& points31);
 
         void rasterizePolyline(
             const Context& context,
             SkCanvas& canvas,
-            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+            const MapPrimitiviser::Primitive* const primitive,
+            const QVector<PointI>& points31,
             bool drawOnlyShadow);
 
         void rasterizePolylineShadow(
@@ -115,9 +120,7 @@ namespace OsmAnd
             const MapStyleEvaluationResult::Packed& evalResult);
 
         inline void calculateVertex(const Context& context, const PointI& point31, PointF& vertex);
-        inline float lineEquation(float x1, float y1, float x2, float y2, float x);
-        inline void simplifyVertexToDirection(const Context& , const PointF& , const PointF& , PointF&);
-        static bool containsHelper(const QVector< PointI >& points, const PointI& otherPoint);
+        inline void plotRing(const Context& context, const QVector<PointI>& ring31, SkPath& path);
 
         void initialize();
         
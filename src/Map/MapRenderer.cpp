@@ -392,7 +392,10 @@ bool OsmAnd::MapRenderer::preUpdate(IMapRenderer_Metrics::Metric_update* const m
     if (_resources->checkForUpdatesAndApply())
         invalidateFrame();
     if (metric)
+    {
         metric->elapsedTimeForUpdatesProcessing = updatesStopwatch.elapsed();
+        _resources->obtainPrefetchStatistics(metric->prefetchedTiles, metric->prefetchedTilesHits);
+    }
 
     return true;
 }
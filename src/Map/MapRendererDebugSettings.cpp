@@ -25,6 +25,8 @@ OsmAnd::MapRendererDebugSettings::MapRendererDebugSettings()
     , disableJunkResourcesCleanup(false)
     , disableNeededResourcesRequests(false)
     , disableSymbolsFastCheckByFrustum(false)
+    , disableIncrementalSymbolsPlacement(false)
+    , disableTilesPrefetch(false)
     , disableSkyStage(false)
     , disableMapLayersStage(false)
     , disableSymbolsStage(false)
@@ -61,6 +63,8 @@ void OsmAnd::MapRendererDebugSettings::copyTo(MapRendererDebugSettings& other) c
     other.disableJunkResourcesCleanup = disableJunkResourcesCleanup;
     other.disableNeededResourcesRequests = disableNeededResourcesRequests;
     other.disableSymbolsFastCheckByFrustum = disableSymbolsFastCheckByFrustum;
+    other.disableIncrementalSymbolsPlacement = disableIncrementalSymbolsPlacement;
+    other.disableTilesPrefetch = disableTilesPrefetch;
     other.disableSkyStage = disableSkyStage;
     other.disableMapLayersStage = disableMapLayersStage;
     other.disableSymbolsStage = disableSymbolsStage;
@@ -5,6 +5,7 @@
 #include "IMapKeyedSymbolsProvider.h"
 #include "MapSymbol.h"
 #include "RasterMapSymbol.h"
+#include "OnPathRasterMapSymbol.h"
 #include "MapSymbolsGroup.h"
 #include "IUpdatableMapSymbolsGroup.h"
 #include "MapRendererKeyedResourcesCollection.h"
@@ -97,6 +98,16 @@ bool OsmAnd::MapRendererKeyedSymbolsResource::obtainData(
         if (!rasterMapSymbol)
             continue;
 
+        // On-path texts from glyph atlas share page bitmap, so it's adjusted once for all of them
+        const auto onPathMapSymbol = std::dynamic_pointer_cast<OnPathRasterMapSymbol>(rasterMapSymbol);
+        if (onPathMapSymbol && onPathMapSymbol->glyphRun)
+        {
+            rasterMapSymbol->bitmap = resourcesManager->adjustSharedBitmapToConfiguration(
+                rasterMapSymbol->bitmap,
+                AlphaChannelPresence::Present);
+            continue;
+        }
+
         rasterMapSymbol->bitmap = resourcesManager->adjustBitmapToConfiguration(
             rasterMapSymbol->bitmap,
             AlphaChannelPresence::Present);
@@ -1,7 +1,12 @@
 #include "MapRendererRasterMapLayerResource.h"
 
+#include "ignore_warnings_on_external_includes.h"
+#include <SkBitmap.h>
+#include "restore_internal_warnings.h"
+
 #include "IRasterMapLayerProvider.h"
 #include "MapRendererResourcesManager.h"
+#include "MapRendererTiledResourcesCollection.h"
 
 OsmAnd::MapRendererRasterMapLayerResource::MapRendererRasterMapLayerResource(
     MapRendererResourcesManager* owner_,
@@ -53,6 +58,13 @@ bool OsmAnd::MapRendererRasterMapLayerResource::obtainData(
         return false;
     const auto provider = std::static_pointer_cast<IMapTiledDataProvider>(provider_);
 
+    // If this tile was obtained before, only upload is needed
+    if (obtainRetainedData())
+    {
+        dataAvailable = true;
+        return true;
+    }
+
     // Obtain tile from provider
     std::shared_ptr<IMapTiledDataProvider::Data> tiledData;
     IRasterMapLayerProvider::Request request;
@@ -74,6 +86,7 @@ bool OsmAnd::MapRendererRasterMapLayerResource::obtainData(
         _sourceData->bitmap = resourcesManager->adjustBitmapToConfiguration(
             _sourceData->bitmap,
             _sourceData->alphaChannelPresence);
+        retainData();
     }
 
     return true;
@@ -100,6 +113,13 @@ void OsmAnd::MapRendererRasterMapLayerResource::obtainDataAsync(
     }
     const auto provider = std::static_pointer_cast<IMapTiledDataProvider>(provider_);
 
+    // If this tile was obtained before, only upload is needed
+    if (obtainRetainedData())
+    {
+        callback(true, true);
+        return;
+    }
+
     IRasterMapLayerProvider::Request request;
     request.tileId = tileId;
     request.zoom = zoom;
@@ -123,12 +143,43 @@ void OsmAnd::MapRendererRasterMapLayerResource::obtainDataAsync(
                 _sourceData->bitmap = resourcesManager->adjustBitmapToConfiguration(
                     _sourceData->bitmap,
                     _sourceData->alphaChannelPresence);
+                retainData();
             }
 
             callback(requestSucceeded, dataAvailable);
         });
 }
 
+bool OsmAnd::MapRendererRasterMapLayerResource::obtainRetainedData()
+{
+    const auto link_ = link.lock();
+    if (!link_)
+        return false;
+    const auto collection = static_cast<MapRendererTiledResourcesCollection*>(&link_->collection);
+
+    std::shared_ptr<IMapTiledDataProvider::Data> retainedData;
+    if (!collection->obtainRetainedTileData(tileId, zoom, retainedData))
+        return false;
+
+    // Retained data was already converted, and uploading it to GPU does not consume it
+    _sourceData = std::static_pointer_cast<IRasterMapLayerProvider::Data>(retainedData);
+    return true;
+}
+
+void OsmAnd::MapRendererRasterMapLayerResource::retainData()
+{
+    // Data obtained by junk resource may be already outdated
+    if (isJunk || !_sourceData->bitmap)
+        return;
+
+    const auto link_ = link.lock();
+    if (!link_)
+        return;
+    const auto collection = static_cast<MapRendererTiledResourcesCollection*>(&link_->collection);
+
+    collection->retainTileData(tileId, zoom, _sourceData, _sourceData->bitmap->getSize());
+}
+
 bool OsmAnd::MapRendererRasterMapLayerResource::uploadToGPU()
 {
     bool ok = resourcesManager->uploadTiledDataToGPU(_sourceData, _resourceInGPU);
@@ -19,6 +19,8 @@ namespace OsmAnd
     class MapRendererRasterMapLayerResource : public MapRendererBaseTiledResource
     {
     private:
+        bool obtainRetainedData();
+        void retainData();
     protected:
         MapRendererRasterMapLayerResource(
             MapRendererResourcesManager* owner,
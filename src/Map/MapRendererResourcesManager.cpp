@@ -64,9 +64,15 @@
 OsmAnd::MapRendererResourcesManager::MapRendererResourcesManager(MapRenderer* const owner_)
     : _taskHostBridge(this)
     , _resourcesRequestWorkerPool(Concurrent::WorkerPool::Order::LIFO)
+    , _requestedResourcesCenterTileId(TileId::zero())
+    , _requestedResourcesZoom(InvalidZoomLevel)
+    , _junkCleanupZoom(InvalidZoomLevel)
     , _workerThreadIsAlive(false)
     , _workerThreadId(nullptr)
     , _workerThread(new Concurrent::Thread(std::bind(&MapRendererResourcesManager::workerThreadProcedure, this)))
+    , _prefetchTilesPredictionTime(-1)
+    , _prefetchedTilesCount(0u)
+    , _prefetchedTilesHitsCount(0u)
     , renderer(owner_)
     , processingTileStubs(_processingTileStubs)
     , unavailableTileStubs(_unavailableTileStubs)
@@ -74,6 +80,7 @@ OsmAnd::MapRendererResourcesManager::MapRendererResourcesManager(MapRenderer* co
     resetResourceWorkerThreadsLimit();
 
     _requestedResourcesTasks.reserve(1024);
+    _motionTimer.start();
 
     // Start worker thread
     _workerThreadIsAlive = true;
@@ -186,6 +193,39 @@ std::shared_ptr<const SkBitmap> OsmAnd::MapRendererResourcesManager::adjustBitma
     return renderer->adjustBitmapToConfiguration(input, alphaChannelPresence);
 }
 
+std::shared_ptr<const SkBitmap> OsmAnd::MapRendererResourcesManager::adjustSharedBitmapToConfiguration(
+    const std::shared_ptr<const SkBitmap>& input,
+    const AlphaChannelPresence alphaChannelPresence) const
+{
+    if (!input)
+        return nullptr;
+
+    QMutexLocker scopedLocker(&_adjustedSharedBitmapsMutex);
+
+    const auto citAdjustedBitmap = _adjustedSharedBitmaps.constFind(input.get());
+    if (citAdjustedBitmap != _adjustedSharedBitmaps.cend() && citAdjustedBitmap->source.lock() == input)
+        return citAdjustedBitmap->adjusted;
+
+    // Entries of released sources are not needed anymore
+    auto itAdjustedBitmap = mutableIteratorOf(_adjustedSharedBitmaps);
+    while (itAdjustedBitmap.hasNext())
+    {
+        if (itAdjustedBitmap.next().value().source.expired())
+            itAdjustedBitmap.remove();
+    }
+
+    const auto adjusted = renderer->adjustBitmapToConfiguration(input, alphaChannelPresence);
+    if (adjusted && adjusted != input)
+    {
+        AdjustedSharedBitmap adjustedBitmap;
+        adjustedBitmap.source = input;
+        adjustedBitmap.adjusted = adjusted;
+        _adjustedSharedBitmaps.insert(input.get(), adjustedBitmap);
+    }
+
+    return adjusted;
+}
+
 void OsmAnd::MapRendererResourcesManager::releaseGpuUploadableDataFrom(const std::shared_ptr<MapSymbol>& mapSymbol)
 {
     if (const auto rasterMapSymbol = std::dynamic_pointer_cast<RasterMapSymbol>(mapSymbol))
@@ -331,7 +371,9 @@ void OsmAnd::MapRendererResourcesManager::updateMapLayerProviderBindings(const M
 
         // Create new resources collection
         const std::shared_ptr< MapRendererTiledResourcesCollection > newResourcesCollection(
-            new MapRendererTiledResourcesCollection(MapRendererResourceType::MapLayer));
+            new MapRendererTiledResourcesCollection(
+                MapRendererResourceType::MapLayer,
+                renderer->setupOptions.retainedTilesCacheSizeLimit));
 
         // Add binding
         bindings.providersToCollections.insert(provider, newResourcesCollection);
@@ -382,7 +424,8 @@ void OsmAnd::MapRendererResourcesManager::updateSymbolProviderBindings(const Map
 
         // Create new resources collection
         const std::shared_ptr< MapRendererBaseResourcesCollection > newResourcesCollection(
-            static_cast<MapRendererBaseResourcesCollection*>(new MapRendererTiledSymbolsResourcesCollection()));
+            static_cast<MapRendererBaseResourcesCollection*>(new MapRendererTiledSymbolsResourcesCollection(
+                renderer->setupOptions.retainedTilesCacheSizeLimit)));
 
         // Add binding
         bindings.providersToCollections.insert(provider, newResourcesCollection);
@@ -413,13 +456,59 @@ void OsmAnd::MapRendererResourcesManager::updateSymbolProviderBindings(const Map
 void OsmAnd::MapRendererResourcesManager::updateActiveZone(
     const TileId centerTileId,
     const QVector<TileId>& tiles,
-    const ZoomLevel zoom)
+    const ZoomLevel zoomLevel,
+    const PointI target31,
+    const float zoom)
 {
+    const TileIdSet activeTiles(tiles);
+
+    // Predict which tiles are going to be needed next from the way active zone moves
+    const auto motionSampleTime = _motionTimer.elapsed();
+    _prefetchPredictor.addSample(motionSampleTime, target31, zoom);
+    PrefetchTiles prefetchTiles;
+    if (!renderer->currentDebugSettings->disableTilesPrefetch)
+    {
+        prefetchTiles = _prefetchPredictor.predict(
+            centerTileId,
+            activeTiles,
+            zoomLevel,
+            zoom,
+            renderer->getMinZoomLevel(),
+            renderer->getMaxZoomLevel());
+    }
+
+    // Previously prefetched tiles that became active are hits, and all tiles that were not predicted before
+    // are newly prefetched. Since prefetched tiles are never active, only added tiles may be hits
+    const auto citPrefetchTilesAtZoom = _prefetchTiles.constFind(zoomLevel);
+    if (citPrefetchTilesAtZoom != _prefetchTiles.cend())
+    {
+        QVector<TileId> addedTiles;
+        if (_activeZoom == zoomLevel)
+            activeTiles.diff(_activeTiles, &addedTiles);
+        else
+            addedTiles = tiles;
+        for (const auto& tileId : constOf(addedTiles))
+        {
+            if (citPrefetchTilesAtZoom->contains(tileId))
+                _prefetchedTilesHitsCount++;
+        }
+    }
+    for (const auto& prefetchTilesEntry : rangeOf(constOf(prefetchTiles)))
+    {
+        const auto citPreviousPrefetchTiles = _prefetchTiles.constFind(prefetchTilesEntry.key());
+        for (const auto& tileId : constOf(prefetchTilesEntry.value()))
+        {
+            if (citPreviousPrefetchTiles == _prefetchTiles.cend() || !citPreviousPrefetchTiles->contains(tileId))
+                _prefetchedTilesCount++;
+        }
+    }
+
     // Check if update needed
     bool update = true; //NOTE: So far this won't work, since resources won't be updated
     update = update || (_centerTileId != centerTileId);
-    update = update || (_activeZoom != zoom);
-    update = update || (_activeTiles != tiles);
+    update = update || (_activeZoom != zoomLevel);
+    update = update || activeTiles.diff(_activeTiles);
+    update = update || (_prefetchTiles != prefetchTiles);
 
     if (update)
     {
@@ -428,14 +517,27 @@ void OsmAnd::MapRendererResourcesManager::updateActiveZone(
 
         // Update active zone
         _centerTileId = centerTileId;
-        _activeTiles = tiles;
-        _activeZoom = zoom;
+        _activeTiles = activeTiles;
+        _activeZoom = zoomLevel;
+        _prefetchTiles = qMove(prefetchTiles);
+        _prefetchTilesPredictionTime = motionSampleTime;
 
         // Wake up the worker
         _workerThreadWakeup.wakeAll();
     }
 }
 
+void OsmAnd::MapRendererResourcesManager::obtainPrefetchStatistics(
+    unsigned int& outPrefetchedTilesCount,
+    unsigned int& outPrefetchedTilesHitsCount)
+{
+    outPrefetchedTilesCount = _prefetchedTilesCount;
+    outPrefetchedTilesHitsCount = _prefetchedTilesHitsCount;
+
+    _prefetchedTilesCount = 0u;
+    _prefetchedTilesHitsCount = 0u;
+}
+
 void OsmAnd::MapRendererResourcesManager::setResourceWorkerThreadsLimit(const unsigned int limit)
 {
     _resourcesRequestWorkerPool.setMaxThreadCount(limit);
@@ -599,28 +701,49 @@ void OsmAnd::MapRendererResourcesManager::workerThreadProcedure()
     // Capture worker thread ID
     _workerThreadId = QThread::currentThreadId();
 
+    // Prediction that has expired and whose prefetched tiles were already released
+    qint64 expiredPredictionTime = -1;
+
     while (_workerThreadIsAlive)
     {
         // Local copy of active zone
         TileId centerTileId;
-        QVector<TileId> activeTiles;
+        TileIdSet activeTiles;
+        PrefetchTiles prefetchTiles;
         ZoomLevel activeZoom;
 
         // Wait until we're unblocked by host
         {
             QMutexLocker scopedLocker(&_workerThreadWakeupMutex);
-            REPEAT_UNTIL(_workerThreadWakeup.wait(&_workerThreadWakeupMutex));
+
+            // Render thread may stop updating active zone once motion stops, e.g. after a fling, so while tiles
+            // are prefetched, worker also wakes up by itself once prediction expires to release them
+            if (!_prefetchTiles.isEmpty() && _prefetchTilesPredictionTime != expiredPredictionTime)
+            {
+                const auto predictionAge = _motionTimer.elapsed() - _prefetchTilesPredictionTime;
+                const auto timeout = static_cast<qint64>(TilesPrefetchPredictor::MaxMotionSampleIntervalMsecs) + 1 - predictionAge;
+                if (timeout > 0)
+                    _workerThreadWakeup.wait(&_workerThreadWakeupMutex, static_cast<unsigned long>(timeout));
+            }
+            else
+            {
+                REPEAT_UNTIL(_workerThreadWakeup.wait(&_workerThreadWakeupMutex));
+            }
 
             // Copy active zone to local copy
             centerTileId = _centerTileId;
             activeTiles = _activeTiles;
             activeZoom = _activeZoom;
+            if (!TilesPrefetchPredictor::isPredictionExpired(_prefetchTilesPredictionTime, _motionTimer.elapsed()))
+                prefetchTiles = _prefetchTiles;
+            else
+                expiredPredictionTime = _prefetchTilesPredictionTime;
         }
         if (!_workerThreadIsAlive)
             break;
 
         // Update resources
-        updateResources(centerTileId, activeTiles, activeZoom);
+        updateResources(centerTileId, activeTiles, prefetchTiles, activeZoom);
     }
 
     _workerThreadId = nullptr;
@@ -629,7 +752,8 @@ void OsmAnd::MapRendererResourcesManager::workerThreadProcedure()
 void OsmAnd::MapRendererResourcesManager::requestNeededResources(
     const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
     const TileId centerTileId,
-    const QVector<TileId>& activeTiles,
+    const TileIdSet& activeTiles,
+    const PrefetchTiles& prefetchTiles,
     const ZoomLevel activeZoom)
 {
     _requestedResourcesTasks.resize(0);
@@ -638,27 +762,35 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(
         if (!resourcesCollection)
             continue;
 
-        requestNeededResources(resourcesCollection, activeTiles, activeZoom);
+        requestNeededResources(resourcesCollection, activeTiles, prefetchTiles, activeZoom);
     }
 
-    _resourcesRequestWorkerPool.enqueue(
-        _requestedResourcesTasks,
-        [centerTileId, activeTiles, activeZoom]
-        (QRunnable* const l_, QRunnable* const r_) -> bool
+    // Priority of each request is evaluated once, and only evaluated again once active zone has moved
+    const Concurrent::WorkerPool::PriorityFunction getPriority =
+        [centerTileId, activeTiles, prefetchTiles, activeZoom]
+        (QRunnable* const runnable) -> Concurrent::WorkerPool::Priority
         {
-            const auto l = static_cast<ResourceRequestTask*>(l_);
-            const auto r = static_cast<ResourceRequestTask*>(r_);
+            const auto task = static_cast<ResourceRequestTask*>(runnable);
 
-            const auto lPriority = l->calculatePriority(centerTileId, activeTiles, activeZoom);
-            const auto rPriority = r->calculatePriority(centerTileId, activeTiles, activeZoom);
+            return task->calculatePriority(centerTileId, activeTiles, prefetchTiles, activeZoom);
+        };
+    if (_requestedResourcesCenterTileId != centerTileId ||
+        _requestedResourcesZoom != activeZoom ||
+        _requestedResourcesPrefetchTiles != prefetchTiles)
+    {
+        _resourcesRequestWorkerPool.reprioritize(getPriority);
 
-            return lPriority < rPriority;
-        });
+        _requestedResourcesCenterTileId = centerTileId;
+        _requestedResourcesZoom = activeZoom;
+        _requestedResourcesPrefetchTiles = prefetchTiles;
+    }
+    _resourcesRequestWorkerPool.enqueueWithPriorities(_requestedResourcesTasks, getPriority);
 }
 
 void OsmAnd::MapRendererResourcesManager::requestNeededResources(
     const std::shared_ptr<MapRendererBaseResourcesCollection>& resourcesCollection,
-    const QVector<TileId>& activeTiles,
+    const TileIdSet& activeTiles,
+    const PrefetchTiles& prefetchTiles,
     const ZoomLevel activeZoom)
 {
     // Skip resource types that do not have an available data source
@@ -672,6 +804,7 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(
         requestNeededTiledResources(
             tiledResourcesCollection,
             activeTiles,
+            prefetchTiles,
             activeZoom);
     }
     else if (const auto keyedResourcesCollection =
@@ -684,7 +817,8 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(
 
 void OsmAnd::MapRendererResourcesManager::requestNeededTiledResources(
     const std::shared_ptr<MapRendererTiledResourcesCollection>& resourcesCollection,
-    const QVector<TileId>& activeTiles,
+    const TileIdSet& activeTiles,
+    const PrefetchTiles& prefetchTiles,
     const ZoomLevel activeZoom)
 {
     const auto resourceType = resourcesCollection->type;
@@ -714,6 +848,19 @@ void OsmAnd::MapRendererResourcesManager::requestNeededTiledResources(
         requestNeededResource(resource);
     }
 
+    // Request tiles that are predicted to become active soon. Their requests have lower priority than any
+    // request of active tile, and are cancelled by junk cleanup as soon as prediction changes
+    for (const auto& prefetchTilesEntry : rangeOf(constOf(prefetchTiles)))
+    {
+        const auto prefetchZoom = prefetchTilesEntry.key();
+        for (const auto& prefetchTileId : constOf(prefetchTilesEntry.value()))
+        {
+            std::shared_ptr<MapRendererBaseTiledResource> resource;
+            resourcesCollection->obtainOrAllocateEntry(resource, prefetchTileId, prefetchZoom, resourceAllocator);
+            requestNeededResource(resource);
+        }
+    }
+
     // Request all other zoom levels that cover unavailable tile, in case all scaled tiles are not unavailable
     if (resourcesCollection->getType() == MapRendererResourceType::MapLayer/* ||
         resourcesCollection->getType() == MapRendererResourceType::Symbols*/)
@@ -1156,6 +1303,14 @@ bool OsmAnd::MapRendererResourcesManager::validateResourcesOfType(const MapRende
                 entry->markAsJunk();
                 atLeastOneMarked = true;
             });
+
+        // Data retained from provider is no longer valid as well. Junk resources don't retain their data, so
+        // it's released after marking
+        if (const auto tiledResourcesCollection =
+                std::dynamic_pointer_cast<MapRendererTiledResourcesCollection>(resourcesCollection))
+        {
+            tiledResourcesCollection->releaseRetainedTilesData();
+        }
     }
 
     return atLeastOneMarked;
@@ -1244,21 +1399,25 @@ bool OsmAnd::MapRendererResourcesManager::checkForUpdatesAndApply() const
 
 void OsmAnd::MapRendererResourcesManager::updateResources(
     const TileId centerTileId,
-    const QVector<TileId>& tiles,
+    const TileIdSet& tiles,
+    const PrefetchTiles& prefetchTiles,
     const ZoomLevel zoom)
 {
     QList< std::shared_ptr<MapRendererBaseResourcesCollection> > pendingRemovalResourcesCollections;
     QList< std::shared_ptr<MapRendererBaseResourcesCollection> > otherResourcesCollections;
     safeGetAllResourcesCollections(pendingRemovalResourcesCollections, otherResourcesCollections);
 
-    // Before requesting missing tiled resources, clean up cache to free some space
+    // Before requesting missing tiled resources, clean up cache to free some space. If cleanup was skipped, next one
+    // can't rely on tiles that were protected last time
     if (!renderer->currentDebugSettings->disableJunkResourcesCleanup)
-        cleanupJunkResources(pendingRemovalResourcesCollections, otherResourcesCollections, tiles, zoom);
+        cleanupJunkResources(pendingRemovalResourcesCollections, otherResourcesCollections, tiles, prefetchTiles, zoom);
+    else
+        _junkCleanupZoom = InvalidZoomLevel;
 
     // In the end of rendering processing, request tiled resources that are neither
     // present in requested list, nor in pending, nor in uploaded
     if (!renderer->currentDebugSettings->disableNeededResourcesRequests)
-        requestNeededResources(otherResourcesCollections, centerTileId, tiles, zoom);
+        requestNeededResources(otherResourcesCollections, centerTileId, tiles, prefetchTiles, zoom);
 }
 
 unsigned int OsmAnd::MapRendererResourcesManager::unloadResources()
@@ -1417,7 +1576,8 @@ void OsmAnd::MapRendererResourcesManager::uploadResourcesFrom(
 void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
     const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& pendingRemovalResourcesCollections,
     const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
-    const QVector<TileId>& activeTiles,
+    const TileIdSet& activeTiles,
+    const PrefetchTiles& prefetchTiles,
     const ZoomLevel activeZoom)
 {
     const auto debugSettings = renderer->getDebugSettings();
@@ -1450,6 +1610,20 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
         removedResouresCollections.clear();
     }
 
+    // Tiles of active zoom that are either active or predicted to become active soon are not junk
+    auto protectedTiles = activeTiles;
+    for (const auto& tileId : constOf(prefetchTiles.value(activeZoom)))
+        protectedTiles.insert(tileId);
+
+    // While active zoom stays the same, tiled resources of active zoom may become junk only if their tiles have
+    // left protected set since previous cleanup, so it's enough to look up resources of those tiles
+    const auto cleanupByTilesDelta = (_junkCleanupZoom == activeZoom);
+    QVector<TileId> unprotectedTiles;
+    if (cleanupByTilesDelta)
+        protectedTiles.diff(_junkCleanupProtectedTiles, nullptr, &unprotectedTiles);
+    _junkCleanupProtectedTiles = protectedTiles;
+    _junkCleanupZoom = activeZoom;
+
     // Use aggressive cache cleaning: remove all resources that are not needed
     for (const auto& resourcesCollection : constOf(resourcesCollections))
     {
@@ -1461,7 +1635,22 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
         std::shared_ptr<IMapDataProvider> dataProvider;
         const auto dataSourceAvailable = obtainProviderFor(resourcesCollection.get(), dataProvider);
 
-        // Regular checks common for all resources
+        // Mark resources of tiles that are no longer protected as junk, so that they will be cleaned up by
+        // regular checks right away
+        const auto tiledResourcesCollection =
+            std::dynamic_pointer_cast<IMapRendererTiledResourcesCollection>(resourcesCollection);
+        if (tiledResourcesCollection && cleanupByTilesDelta)
+        {
+            for (const auto& tileId : constOf(unprotectedTiles))
+            {
+                std::shared_ptr<MapRendererBaseTiledResource> entry;
+                if (tiledResourcesCollection->obtainResource(tileId, activeZoom, entry))
+                    entry->markAsJunk();
+            }
+        }
+
+        // Regular checks common for all resources. These still visit every resource, since unloaded resources and
+        // resources of unavailable provider are junk regardless of their tiles
         resourcesCollection->removeResources(
             [this, dataSourceAvailable, &needsResourcesUploadOrUnload]
             (const std::shared_ptr<MapRendererBaseResource>& entry, bool& cancel) -> bool
@@ -1532,43 +1721,49 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
         }
 
         // Some checks are only valid for tiled resources
-        if (const auto tiledResourcesCollection = std::dynamic_pointer_cast<IMapRendererTiledResourcesCollection>(resourcesCollection))
+        if (tiledResourcesCollection)
         {
-            resourcesCollection->removeResources(
-                [this, activeZoom, activeTiles, &needsResourcesUploadOrUnload]
-                (const std::shared_ptr<MapRendererBaseResource>& entry, bool& cancel) -> bool
-                {
-                    // If it was previously marked as junk, just leave it
-                    if (entry->isJunk)
-                        return false;
+            // Once active zoom has changed, every tiled resource has to be checked
+            if (!cleanupByTilesDelta)
+            {
+                resourcesCollection->removeResources(
+                    [this, activeZoom, &protectedTiles, &needsResourcesUploadOrUnload]
+                    (const std::shared_ptr<MapRendererBaseResource>& entry, bool& cancel) -> bool
+                    {
+                        // If it was previously marked as junk, just leave it
+                        if (entry->isJunk)
+                            return false;
 
-                    const auto tiledEntry = std::static_pointer_cast<MapRendererBaseTiledResource>(entry);
+                        const auto tiledEntry = std::static_pointer_cast<MapRendererBaseTiledResource>(entry);
 
-                    // Determine if resource is junk:
-                    bool isJunk = false;
-                        
-                    // If this tiled entry is part of active zoom, it's treated as junk only if it's not a part
-                    // of active tiles set
-                    if (tiledEntry->zoom == activeZoom)
-                        isJunk = isJunk || !activeTiles.contains(tiledEntry->tileId);
+                        // Determine if resource is junk:
+                        bool isJunk = false;
 
-                    // If zoom delta is larger than MapRenderer::MaxMissingDataZoomShift, it means than this underscaled
-                    // tile is not usable. If it's less than zero (overscaled tile), keep it.
-                    const auto deltaZoom = static_cast<int>(tiledEntry->zoom) - static_cast<int>(activeZoom);
-                    isJunk = isJunk || (deltaZoom > MapRenderer::MaxMissingDataZoomShift);
+                        // If this tiled entry is part of active zoom, it's treated as junk only if it's not a part
+                        // of active tiles set, nor it's predicted to become active soon
+                        if (tiledEntry->zoom == activeZoom)
+                            isJunk = isJunk || !protectedTiles.contains(tiledEntry->tileId);
 
-                    // Skip cleaning if this resource is not junk
-                    if (!isJunk)
-                        return false;
+                        // If zoom delta is larger than MapRenderer::MaxMissingDataZoomShift, it means than this
+                        // underscaled tile is not usable. If it's less than zero (overscaled tile), keep it.
+                        const auto deltaZoom = static_cast<int>(tiledEntry->zoom) - static_cast<int>(activeZoom);
+                        isJunk = isJunk || (deltaZoom > MapRenderer::MaxMissingDataZoomShift);
 
-                    // Mark this entry as junk until it will die
-                    entry->markAsJunk();
+                        // Skip cleaning if this resource is not junk
+                        if (!isJunk)
+                            return false;
 
-                    return cleanupJunkResource(entry, needsResourcesUploadOrUnload);
-                });
+                        // Mark this entry as junk until it will die
+                        entry->markAsJunk();
 
-            // Remove all tiled resources that are not needed for "full coverage" of (activeTiles@ActiveZoom)
-            QHash<ZoomLevel, QSet<TileId>> neededTilesMap;
+                        return cleanupJunkResource(entry, needsResourcesUploadOrUnload);
+                    });
+            }
+
+            // Remove all tiled resources that are not needed for "full coverage" of (activeTiles@ActiveZoom),
+            // except ones that are prefetched. Coverage depends on which resources of other zooms are uploaded, so
+            // this pass visits every resource regardless of tiles delta
+            QHash<ZoomLevel, QSet<TileId>> neededTilesMap = prefetchTiles;
             const auto isUsableResource =
                 []
                 (const std::shared_ptr<MapRendererBaseTiledResource>& entry) -> bool
@@ -2294,7 +2489,8 @@ void OsmAnd::MapRendererResourcesManager::ResourceRequestTask::postExecuteWrappe
 
 int64_t OsmAnd::MapRendererResourcesManager::ResourceRequestTask::calculatePriority(
     const TileId centerTileId,
-    const QVector<TileId>& activeTiles,
+    const TileIdSet& activeTiles,
+    const QHash< ZoomLevel, QSet<TileId> >& prefetchTiles,
     const ZoomLevel activeZoom) const
 {
     // Priority calculation does not need to be stable
@@ -2326,6 +2522,11 @@ int64_t OsmAnd::MapRendererResourcesManager::ResourceRequestTask::calculatePrior
             break;
     }
 
+    // Prefetched tiles go after all tiles that are needed right now
+    const auto citPrefetchTilesAtZoom = prefetchTiles.constFind(tiledResource->zoom);
+    if (citPrefetchTilesAtZoom != prefetchTiles.cend() && citPrefetchTilesAtZoom->contains(tiledResource->tileId))
+        priority -= 5000000000;
+
     priority -= qAbs(static_cast<int>(tiledResource->zoom) - static_cast<int>(activeZoom)) * 10000000;
 
     const auto dX = tiledResource->tileId.x - centerTileId.x;
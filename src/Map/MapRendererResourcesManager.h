@@ -13,6 +13,7 @@
 #include <QReadWriteLock>
 #include <QWaitCondition>
 #include <QVector>
+#include <QElapsedTimer>
 #include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
@@ -40,6 +41,8 @@
 #include "HostedTask.h"
 #include "WorkerPool.h"
 #include "IQueryController.h"
+#include "TileIdSet.h"
+#include "TilesPrefetchPredictor.h"
 
 namespace OsmAnd
 {
@@ -85,7 +88,8 @@ namespace OsmAnd
 
             int64_t calculatePriority(
                 const TileId centerTileId,
-                const QVector<TileId>& activeTiles,
+                const TileIdSet& activeTiles,
+                const QHash< ZoomLevel, QSet<TileId> >& prefetchTiles,
                 const ZoomLevel activeZoom) const;
         };
         void setResourceWorkerThreadsLimit(const unsigned int limit);
@@ -137,28 +141,44 @@ namespace OsmAnd
         bool validateResourcesOfType(const MapRendererResourceType type);
 
         // Resources management:
+        typedef TilesPrefetchPredictor::PrefetchTiles PrefetchTiles;
         TileId _centerTileId;
-        QVector<TileId> _activeTiles;
+        TileIdSet _activeTiles;
         ZoomLevel _activeZoom;
+        // Tiles that are predicted to become active soon. Written only by render thread
+        PrefetchTiles _prefetchTiles;
+        // Time of motion sample that prefetch tiles were predicted from, by motion timer
+        qint64 _prefetchTilesPredictionTime;
         QVector<QRunnable*> _requestedResourcesTasks;
+        // Active zone that priorities of queued requests were evaluated for
+        TileId _requestedResourcesCenterTileId;
+        ZoomLevel _requestedResourcesZoom;
+        PrefetchTiles _requestedResourcesPrefetchTiles;
+        // Tiles at zoom that junk cleanup was last done for, which are kept from being cleaned up
+        TileIdSet _junkCleanupProtectedTiles;
+        ZoomLevel _junkCleanupZoom;
         bool updatesPresent() const;
         bool checkForUpdatesAndApply() const;
         void updateResources(
             const TileId centerTileId,
-            const QVector<TileId>& tiles,
+            const TileIdSet& tiles,
+            const PrefetchTiles& prefetchTiles,
             const ZoomLevel zoom);
         void requestNeededResources(
             const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
             const TileId centerTileId,
-            const QVector<TileId>& activeTiles,
+            const TileIdSet& activeTiles,
+            const PrefetchTiles& prefetchTiles,
             const ZoomLevel activeZoom);
         void requestNeededResources(
             const std::shared_ptr<MapRendererBaseResourcesCollection>& resourcesCollection,
-            const QVector<TileId>& tiles,
+            const TileIdSet& tiles,
+            const PrefetchTiles& prefetchTiles,
             const ZoomLevel zoom);
         void requestNeededTiledResources(
             const std::shared_ptr<MapRendererTiledResourcesCollection>& resourcesCollection,
-            const QVector<TileId>& tiles,
+            const TileIdSet& tiles,
+            const PrefetchTiles& prefetchTiles,
             const ZoomLevel zoom);
         void requestNeededKeyedResources(
             const std::shared_ptr<MapRendererKeyedResourcesCollection>& resourcesCollection);
@@ -173,7 +193,8 @@ namespace OsmAnd
         void cleanupJunkResources(
             const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& pendingRemovalResourcesCollections,
             const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
-            const QVector<TileId>& activeTiles,
+            const TileIdSet& activeTiles,
+            const PrefetchTiles& prefetchTiles,
             const ZoomLevel activeZoom);
         bool cleanupJunkResource(
             const std::shared_ptr<MapRendererBaseResource>& resource,
@@ -204,12 +225,27 @@ namespace OsmAnd
         QWaitCondition _workerThreadWakeup;
         void workerThreadProcedure();
 
+        // Motion of active zone, tracked by render thread to predict tiles needed next:
+        QElapsedTimer _motionTimer;
+        TilesPrefetchPredictor _prefetchPredictor;
+        unsigned int _prefetchedTilesCount;
+        unsigned int _prefetchedTilesHitsCount;
+
         // Default resources:
         std::array<std::shared_ptr<const GPUAPI::ResourceInGPU>, MapStubStylesCount> _processingTileStubs;
         std::array<std::shared_ptr<const GPUAPI::ResourceInGPU>, MapStubStylesCount> _unavailableTileStubs;
         bool initializeDefaultResources();
         bool initializeTileStub(const QString& resourceName, std::shared_ptr<const GPUAPI::ResourceInGPU>& outResource);
         bool releaseDefaultResources();
+
+        // Bitmaps shared by several symbols (like pages of glyph atlas), adjusted once:
+        struct AdjustedSharedBitmap
+        {
+            std::weak_ptr<const SkBitmap> source;
+            std::shared_ptr<const SkBitmap> adjusted;
+        };
+        mutable QMutex _adjustedSharedBitmapsMutex;
+        mutable QHash<const SkBitmap*, AdjustedSharedBitmap> _adjustedSharedBitmaps;
     protected:
         MapRendererResourcesManager(MapRenderer* const owner);
 
@@ -219,6 +255,9 @@ namespace OsmAnd
         std::shared_ptr<const SkBitmap> adjustBitmapToConfiguration(
             const std::shared_ptr<const SkBitmap>& input,
             const AlphaChannelPresence alphaChannelPresence) const;
+        std::shared_ptr<const SkBitmap> adjustSharedBitmapToConfiguration(
+            const std::shared_ptr<const SkBitmap>& input,
+            const AlphaChannelPresence alphaChannelPresence) const;
         void releaseGpuUploadableDataFrom(const std::shared_ptr<MapSymbol>& mapSymbol);
 
         bool updateBindings(const MapRendererState& state, const MapRendererStateChanges updatedMask);
@@ -226,7 +265,13 @@ namespace OsmAnd
         void updateMapLayerProviderBindings(const MapRendererState& state);
         void updateSymbolProviderBindings(const MapRendererState& state);
 
-        void updateActiveZone(const TileId centerTileId, const QVector<TileId>& tiles, const ZoomLevel zoom);
+        void updateActiveZone(
+            const TileId centerTileId,
+            const QVector<TileId>& tiles,
+            const ZoomLevel zoomLevel,
+            const PointI target31,
+            const float zoom);
+        void obtainPrefetchStatistics(unsigned int& outPrefetchedTilesCount, unsigned int& outPrefetchedTilesHitsCount);
         void syncResourcesInGPU(
             const unsigned int limitUploads = 0u,
             bool* const outMoreUploadsThanLimitAvailable = nullptr,
@@ -7,6 +7,11 @@ OsmAnd::MapRendererSetupOptions::MapRendererSetupOptions()
     , frameUpdateRequestCallback(nullptr)
     , maxNumberOfRasterMapLayersInBatch(0)
     , displayDensityFactor(1.0f)
+#if defined(OSMAND_TARGET_OS_android) || defined(OSMAND_TARGET_OS_ios)
+    , retainedTilesCacheSizeLimit(0u)
+#else
+    , retainedTilesCacheSizeLimit(32u * 1024u * 1024u)
+#endif
 {
 }
 
@@ -1,9 +1,14 @@
 #include "MapRendererTiledResourcesCollection.h"
 
-OsmAnd::MapRendererTiledResourcesCollection::MapRendererTiledResourcesCollection(const MapRendererResourceType type_)
+OsmAnd::MapRendererTiledResourcesCollection::MapRendererTiledResourcesCollection(
+    const MapRendererResourceType type_,
+    const unsigned int retainedTilesDataSizeLimit /*= 0u*/)
     : MapRendererBaseResourcesCollection(type_)
     , _snapshot(new Snapshot(type_))
 {
+    _retainedTilesData.setMaxCost(static_cast<int>(qMin(
+        retainedTilesDataSizeLimit,
+        static_cast<unsigned int>(std::numeric_limits<int>::max()))));
 }
 
 OsmAnd::MapRendererTiledResourcesCollection::~MapRendererTiledResourcesCollection()
@@ -160,6 +165,57 @@ std::shared_ptr<OsmAnd::IMapRendererResourcesCollection> OsmAnd::MapRendererTile
     return _snapshot;
 }
 
+bool OsmAnd::MapRendererTiledResourcesCollection::retainsTilesData() const
+{
+    return _retainedTilesData.maxCost() > 0;
+}
+
+bool OsmAnd::MapRendererTiledResourcesCollection::obtainRetainedTileData(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<IMapTiledDataProvider::Data>& outData) const
+{
+    if (!retainsTilesData())
+        return false;
+
+    QMutexLocker scopedLocker(&_retainedTilesDataMutex);
+
+    const RetainedTileKey key = { tileId, zoom };
+    const auto pData = _retainedTilesData.object(key);
+    if (!pData)
+        return false;
+
+    outData = *pData;
+    return true;
+}
+
+void OsmAnd::MapRendererTiledResourcesCollection::retainTileData(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    const std::shared_ptr<IMapTiledDataProvider::Data>& data,
+    const size_t size)
+{
+    if (!retainsTilesData())
+        return;
+
+    QMutexLocker scopedLocker(&_retainedTilesDataMutex);
+
+    // Tiles larger than entire cache are not retained at all. Even empty tile costs something, so that number of
+    // retained tiles is bounded
+    const RetainedTileKey key = { tileId, zoom };
+    _retainedTilesData.insert(
+        key,
+        new std::shared_ptr<IMapTiledDataProvider::Data>(data),
+        static_cast<int>(qBound(static_cast<size_t>(1), size, static_cast<size_t>(std::numeric_limits<int>::max()))));
+}
+
+void OsmAnd::MapRendererTiledResourcesCollection::releaseRetainedTilesData()
+{
+    QMutexLocker scopedLocker(&_retainedTilesDataMutex);
+
+    _retainedTilesData.clear();
+}
+
 OsmAnd::MapRendererTiledResourcesCollection::Snapshot::Snapshot(const MapRendererResourceType type_)
     : type(type_)
 {
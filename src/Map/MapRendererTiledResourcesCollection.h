@@ -4,7 +4,11 @@
 #include "stdlib_common.h"
 
 #include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
 #include <QReadWriteLock>
+#include <QMutex>
+#include <QCache>
+#include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
 #include "MapRendererResourceType.h"
@@ -13,6 +17,7 @@
 #include "MapRendererBaseTiledResource.h"
 #include "MapRendererBaseResourcesCollection.h"
 #include "IMapRendererTiledResourcesCollection.h"
+#include "IMapTiledDataProvider.h"
 
 namespace OsmAnd
 {
@@ -60,8 +65,28 @@ namespace OsmAnd
         };
 
     private:
+        struct RetainedTileKey Q_DECL_FINAL
+        {
+            TileId tileId;
+            ZoomLevel zoom;
+
+            inline bool operator==(const RetainedTileKey& that) const
+            {
+                return tileId == that.tileId && zoom == that.zoom;
+            }
+        };
+        friend inline uint qHash(const RetainedTileKey& key, uint seed = 0)
+        {
+            return qHash(key.tileId.id, seed) ^ static_cast<uint>(key.zoom);
+        }
+
+        // Data of tiles as it was obtained from provider, which outlives resources of these tiles
+        mutable QMutex _retainedTilesDataMutex;
+        mutable QCache< RetainedTileKey, std::shared_ptr<IMapTiledDataProvider::Data> > _retainedTilesData;
     protected:
-        MapRendererTiledResourcesCollection(const MapRendererResourceType type);
+        MapRendererTiledResourcesCollection(
+            const MapRendererResourceType type,
+            const unsigned int retainedTilesDataSizeLimit = 0u);
 
         void verifyNoUploadedResourcesPresent() const;
         virtual void removeAllEntries();
@@ -93,6 +118,18 @@ namespace OsmAnd
 
         void requestNeededTiledResources(const QSet<TileId>& activeTiles, const ZoomLevel activeZoom);
 
+        bool retainsTilesData() const;
+        bool obtainRetainedTileData(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<IMapTiledDataProvider::Data>& outData) const;
+        void retainTileData(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            const std::shared_ptr<IMapTiledDataProvider::Data>& data,
+            const size_t size);
+        void releaseRetainedTilesData();
+
     friend class OsmAnd::MapRendererResourcesManager;
     };
 }
@@ -1,10 +1,16 @@
 #include "MapRendererTiledSymbolsResource.h"
 
+#include "ignore_warnings_on_external_includes.h"
+#include <SkBitmap.h>
+#include "restore_internal_warnings.h"
+
 #include "MapRenderer.h"
 #include "MapRendererResourcesManager.h"
 #include "IMapDataProvider.h"
 #include "IMapTiledSymbolsProvider.h"
 #include "RasterMapSymbol.h"
+#include "OnPathRasterMapSymbol.h"
+#include "VectorMapSymbol.h"
 #include "MapRendererResourcesManager.h"
 #include "MapRendererBaseResourcesCollection.h"
 #include "MapRendererTiledSymbolsResourcesCollection.h"
@@ -110,11 +116,60 @@ bool OsmAnd::MapRendererTiledSymbolsResource::obtainData(
             loadedSharedGroups.insert(sharingKey);
             return true;
         };
-    const auto requestSucceeded = provider->obtainTiledSymbols(request, tile);
-    if (queryController && queryController->isAborted())
-        return false;
-    if (!requestSucceeded)
-        return false;
+
+    // If this tile was obtained before, it holds all groups that tile had, so they only need to pass same filter
+    // as if they were provided. Shared groups that tile only referenced have no data retained, so tile is reused
+    // only while all of them are still loaded by other tiles
+    std::shared_ptr<IMapTiledDataProvider::Data> retainedTile_;
+    auto isRetained = collection->obtainRetainedTileData(tileId, zoom, retainedTile_);
+    if (isRetained)
+    {
+        const auto retainedTile = std::static_pointer_cast<const RetainedTile>(retainedTile_);
+        for (const auto& sharingKey : constOf(retainedTile->referencedSharedGroups))
+        {
+            std::shared_ptr<SharedGroupResources> sharedGroupResources;
+            if (!sharedGroupsResources.obtainReference(sharingKey, sharedGroupResources))
+            {
+                isRetained = false;
+                break;
+            }
+            referencedSharedGroupsResources.push_back(qMove(sharedGroupResources));
+        }
+
+        if (isRetained)
+        {
+            QList< std::shared_ptr<MapSymbolsGroup> > symbolsGroups;
+            for (const auto& symbolsGroup : constOf(retainedTile->symbolsGroups))
+            {
+                if (!request.filterCallback(provider.get(), symbolsGroup))
+                    continue;
+
+                // Accepted group is not loaded by any other tile, so it's safe to give it data for upload
+                retainedTile->restoreGpuUploadableDataTo(symbolsGroup);
+                symbolsGroups.push_back(symbolsGroup);
+            }
+            tile.reset(new IMapTiledSymbolsProvider::Data(tileId, zoom, symbolsGroups));
+            tile->retainableCacheMetadata = retainedTile->retainableCacheMetadata;
+        }
+        else
+        {
+            for (auto& sharedGroupResources : referencedSharedGroupsResources)
+            {
+                MapSymbolsGroup::SharingKey sharingKey;
+                sharedGroupResources->group->obtainSharingKey(sharingKey);
+                sharedGroupsResources.releaseReference(sharingKey, sharedGroupResources);
+            }
+            referencedSharedGroupsResources.clear();
+        }
+    }
+    if (!isRetained)
+    {
+        const auto requestSucceeded = provider->obtainTiledSymbols(request, tile);
+        if (queryController && queryController->isAborted())
+            return false;
+        if (!requestSucceeded)
+            return false;
+    }
     
     // Store data
     _sourceData = tile;
@@ -124,29 +179,48 @@ bool OsmAnd::MapRendererTiledSymbolsResource::obtainData(
     if (!dataAvailable)
         return true;
 
-    // Convert data
-    for (const auto& symbolsGroup : constOf(_sourceData->symbolsGroups))
+    // Convert data, unless it was converted before being retained
+    if (!isRetained)
     {
-        if (queryController && queryController->isAborted())
-            break;
-
-        for (const auto& mapSymbol : constOf(symbolsGroup->symbols))
+        for (const auto& symbolsGroup : constOf(_sourceData->symbolsGroups))
         {
             if (queryController && queryController->isAborted())
                 break;
 
-            const auto rasterMapSymbol = std::dynamic_pointer_cast<RasterMapSymbol>(mapSymbol);
-            if (!rasterMapSymbol)
-                continue;
+            for (const auto& mapSymbol : constOf(symbolsGroup->symbols))
+            {
+                if (queryController && queryController->isAborted())
+                    break;
+
+                const auto rasterMapSymbol = std::dynamic_pointer_cast<RasterMapSymbol>(mapSymbol);
+                if (!rasterMapSymbol)
+                    continue;
+
+                // On-path texts from glyph atlas share page bitmap, so it's adjusted once for all of them
+                const auto onPathMapSymbol = std::dynamic_pointer_cast<OnPathRasterMapSymbol>(rasterMapSymbol);
+                if (onPathMapSymbol && onPathMapSymbol->glyphRun)
+                {
+                    rasterMapSymbol->bitmap = resourcesManager->adjustSharedBitmapToConfiguration(
+                        rasterMapSymbol->bitmap,
+                        AlphaChannelPresence::Present);
+                    continue;
+                }
 
-            rasterMapSymbol->bitmap = resourcesManager->adjustBitmapToConfiguration(
-                rasterMapSymbol->bitmap,
-                AlphaChannelPresence::Present);
+                rasterMapSymbol->bitmap = resourcesManager->adjustBitmapToConfiguration(
+                    rasterMapSymbol->bitmap,
+                    AlphaChannelPresence::Present);
+            }
         }
     }
     if (queryController && queryController->isAborted())
         return false;
 
+    // Tile has to retain data of its symbols before they are uploaded to GPU, and loaded shared groups may be
+    // uploaded by other tiles as soon as they are shared. Data obtained by junk resource may be already outdated
+    std::shared_ptr<RetainedTile> newRetainedTile;
+    if (!isRetained && !isJunk && collection->retainsTilesData())
+        newRetainedTile.reset(new RetainedTile(tileId, zoom, _sourceData->symbolsGroups));
+
     // Move referenced shared groups
     _referencedSharedGroupsResources = referencedSharedGroupsResources;
 
@@ -260,6 +334,20 @@ bool OsmAnd::MapRendererTiledSymbolsResource::obtainData(
         return false;
     resourcesManager->batchPublishMapSymbols(mapSymbolsToPublish);
 
+    // Retain this tile along with sharing keys of shared groups loaded by other tiles
+    if (newRetainedTile && !isJunk)
+    {
+        for (const auto& groupResources : constOf(_referencedSharedGroupsResources))
+        {
+            MapSymbolsGroup::SharingKey sharingKey;
+            groupResources->group->obtainSharingKey(sharingKey);
+            if (!loadedSharedGroups.contains(sharingKey))
+                newRetainedTile->referencedSharedGroups.insert(sharingKey);
+        }
+        newRetainedTile->retainableCacheMetadata = _sourceData->retainableCacheMetadata;
+        collection->retainTileData(tileId, zoom, newRetainedTile, newRetainedTile->calculateSize());
+    }
+
     // Since there's a copy of references to map symbols groups and symbols themselves,
     // it's safe to consume all the data here
     _retainableCacheMetadata = _sourceData->retainableCacheMetadata;
@@ -699,3 +787,107 @@ OsmAnd::MapRendererTiledSymbolsResource::SharedGroupResources::SharedGroupResour
 OsmAnd::MapRendererTiledSymbolsResource::SharedGroupResources::~SharedGroupResources()
 {
 }
+
+OsmAnd::MapRendererTiledSymbolsResource::RetainedTile::RetainedTile(
+    const TileId tileId_,
+    const ZoomLevel zoom_,
+    const QList< std::shared_ptr<MapSymbolsGroup> >& symbolsGroups_)
+    : IMapTiledSymbolsProvider::Data(tileId_, zoom_, symbolsGroups_)
+{
+    for (const auto& symbolsGroup : constOf(symbolsGroups))
+    {
+        for (const auto& mapSymbol : constOf(symbolsGroup->symbols))
+        {
+            if (const auto rasterMapSymbol = std::dynamic_pointer_cast<const RasterMapSymbol>(mapSymbol))
+            {
+                if (rasterMapSymbol->bitmap)
+                    bitmaps.insert(mapSymbol, rasterMapSymbol->bitmap);
+            }
+            else if (const auto vectorMapSymbol = std::dynamic_pointer_cast<const VectorMapSymbol>(mapSymbol))
+            {
+                Primitive primitive;
+                if (vectorMapSymbol->vertices)
+                {
+                    primitive.vertices.resize(vectorMapSymbol->verticesCount);
+                    std::copy(
+                        vectorMapSymbol->vertices,
+                        vectorMapSymbol->vertices + vectorMapSymbol->verticesCount,
+                        primitive.vertices.begin());
+                }
+                if (vectorMapSymbol->indices)
+                {
+                    primitive.indices.resize(vectorMapSymbol->indicesCount);
+                    std::copy(
+                        vectorMapSymbol->indices,
+                        vectorMapSymbol->indices + vectorMapSymbol->indicesCount,
+                        primitive.indices.begin());
+                }
+                primitives.insert(mapSymbol, qMove(primitive));
+            }
+        }
+    }
+}
+
+OsmAnd::MapRendererTiledSymbolsResource::RetainedTile::~RetainedTile()
+{
+}
+
+size_t OsmAnd::MapRendererTiledSymbolsResource::RetainedTile::calculateSize() const
+{
+    size_t size = symbolsGroups.size() * sizeof(MapSymbolsGroup);
+    size += bitmaps.size() * sizeof(RasterMapSymbol);
+    size += primitives.size() * sizeof(VectorMapSymbol);
+
+    // Page of glyph atlas is shared by many on-path symbols, so each bitmap is counted once
+    QSet<const SkBitmap*> countedBitmaps;
+    for (const auto& bitmap : constOf(bitmaps))
+    {
+        if (countedBitmaps.contains(bitmap.get()))
+            continue;
+        countedBitmaps.insert(bitmap.get());
+
+        size += bitmap->getSize();
+    }
+
+    for (const auto& primitive : constOf(primitives))
+    {
+        size += primitive.vertices.size() * sizeof(VectorMapSymbol::Vertex);
+        size += primitive.indices.size() * sizeof(VectorMapSymbol::Index);
+    }
+
+    return size;
+}
+
+void OsmAnd::MapRendererTiledSymbolsResource::RetainedTile::restoreGpuUploadableDataTo(
+    const std::shared_ptr<MapSymbolsGroup>& symbolsGroup) const
+{
+    for (const auto& mapSymbol : constOf(symbolsGroup->symbols))
+    {
+        if (const auto rasterMapSymbol = std::dynamic_pointer_cast<RasterMapSymbol>(mapSymbol))
+        {
+            rasterMapSymbol->bitmap = bitmaps.value(mapSymbol);
+        }
+        else if (const auto vectorMapSymbol = std::dynamic_pointer_cast<VectorMapSymbol>(mapSymbol))
+        {
+            vectorMapSymbol->releaseVerticesAndIndices();
+
+            const auto citPrimitive = primitives.constFind(mapSymbol);
+            if (citPrimitive == primitives.cend())
+                continue;
+            const auto& primitive = *citPrimitive;
+
+            if (!primitive.vertices.isEmpty())
+            {
+                vectorMapSymbol->vertices = new VectorMapSymbol::Vertex[primitive.vertices.size()];
+                std::copy(primitive.vertices.cbegin(), primitive.vertices.cend(), vectorMapSymbol->vertices);
+                vectorMapSymbol->verticesCount = primitive.vertices.size();
+            }
+            if (!primitive.indices.isEmpty())
+            {
+                vectorMapSymbol->indices = new VectorMapSymbol::Index[primitive.indices.size()];
+                std::copy(primitive.indices.cbegin(), primitive.indices.cend(), vectorMapSymbol->indices);
+                vectorMapSymbol->indicesCount = primitive.indices.size();
+            }
+        }
+    }
+}
@@ -5,14 +5,20 @@
 
 #include "QtExtensions.h"
 #include <QReadWriteLock>
+#include <QSet>
+#include <QVector>
 
 #include "OsmAndCore.h"
 #include "MapRendererResourceType.h"
 #include "MapRendererResourceState.h"
 #include "MapRendererBaseTiledResource.h"
 #include "IMapTiledSymbolsProvider.h"
+#include "MapSymbolsGroup.h"
+#include "VectorMapSymbol.h"
 #include "GPUAPI.h"
 
+class SkBitmap;
+
 namespace OsmAnd
 {
     class MapRendererResourcesManager;
@@ -79,6 +85,40 @@ namespace OsmAnd
         virtual void releaseData() Q_DECL_OVERRIDE;
 
         void unloadFromGPU(const bool gpuContextLost);
+
+        // Tile retained by collection. Symbols release their bitmaps and vertices once uploaded to GPU, so retained
+        // tile holds own copy of them, which is released as soon as tile is evicted from collection
+        class RetainedTile : public IMapTiledSymbolsProvider::Data
+        {
+            Q_DISABLE_COPY_AND_MOVE(RetainedTile);
+        public:
+            struct Primitive
+            {
+                QVector<VectorMapSymbol::Vertex> vertices;
+                QVector<VectorMapSymbol::Index> indices;
+            };
+
+        private:
+        protected:
+            RetainedTile(
+                const TileId tileId,
+                const ZoomLevel zoom,
+                const QList< std::shared_ptr<MapSymbolsGroup> >& symbolsGroups);
+        public:
+            virtual ~RetainedTile();
+
+            QHash< std::shared_ptr<const MapSymbol>, std::shared_ptr<const SkBitmap> > bitmaps;
+            QHash< std::shared_ptr<const MapSymbol>, Primitive > primitives;
+
+            // Shared groups that tile referenced, but that were loaded and uploaded by other tiles, so there's no
+            // data of theirs to retain. Tile is complete only while these are still loaded
+            QSet<MapSymbolsGroup::SharingKey> referencedSharedGroups;
+
+            size_t calculateSize() const;
+            void restoreGpuUploadableDataTo(const std::shared_ptr<MapSymbolsGroup>& symbolsGroup) const;
+
+        friend class OsmAnd::MapRendererTiledSymbolsResource;
+        };
     public:
         virtual ~MapRendererTiledSymbolsResource();
 
@@ -1,7 +1,8 @@
 #include "MapRendererTiledSymbolsResourcesCollection.h"
 
-OsmAnd::MapRendererTiledSymbolsResourcesCollection::MapRendererTiledSymbolsResourcesCollection()
-    : MapRendererTiledResourcesCollection(MapRendererResourceType::Symbols)
+OsmAnd::MapRendererTiledSymbolsResourcesCollection::MapRendererTiledSymbolsResourcesCollection(
+    const unsigned int retainedTilesDataSizeLimit /*= 0u*/)
+    : MapRendererTiledResourcesCollection(MapRendererResourceType::Symbols, retainedTilesDataSizeLimit)
 {
 }
 
@@ -21,7 +21,7 @@ namespace OsmAnd
     {
     private:
     protected:
-        MapRendererTiledSymbolsResourcesCollection();
+        MapRendererTiledSymbolsResourcesCollection(const unsigned int retainedTilesDataSizeLimit = 0u);
 
         std::array< SharedResourcesContainer<MapSymbolsGroup::SharingKey, MapRendererTiledSymbolsResource::SharedGroupResources>, ZoomLevelsCount > _sharedGroupsResources;
     public:
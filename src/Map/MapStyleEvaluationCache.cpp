@@ -0,0 +1,177 @@
+#include "MapStyleEvaluationCache.h"
+
+#include <limits>
+
+#include "QtCommon.h"
+
+#include "MapStyleEvaluator.h"
+#include "MapStyleProgram.h"
+#include "MapStyleConstantValue.h"
+#include "MapStyleBuiltinValueDefinitions.h"
+
+OsmAnd::MapStyleEvaluationCache::MapStyleEvaluationCache(
+    const std::shared_ptr<const IMapStyle>& mapStyle_,
+    const unsigned int capacity_ /*= DefaultCapacity*/)
+    : _program(mapStyle_->getProgram())
+    , mapStyle(mapStyle_)
+    , capacity(capacity_)
+{
+}
+
+OsmAnd::MapStyleEvaluationCache::~MapStyleEvaluationCache()
+{
+}
+
+bool OsmAnd::MapStyleEvaluationCache::isRuleDependentOnObject(
+    const MapStyleRulesetType rulesetType,
+    const MapObject::AttributeMapping::TagValue& decodedAttribute) const
+{
+    const auto& builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+
+    // Same way as MapStyleEvaluator resolves INPUT_TAG and INPUT_VALUE
+    MapStyleConstantValue tagValue;
+    const auto tagStringId = mapStyle->parseValue(decodedAttribute.tag, builtinValueDefs->id_INPUT_TAG, tagValue)
+        ? tagValue.asSimple.asUInt
+        : std::numeric_limits<uint32_t>::max();
+    MapStyleConstantValue valueValue;
+    const auto valueStringId = mapStyle->parseValue(decodedAttribute.value, builtinValueDefs->id_INPUT_VALUE, valueValue)
+        ? valueValue.asSimple.asUInt
+        : std::numeric_limits<uint32_t>::max();
+
+    return _program->isRuleDependentOnObject(rulesetType, tagStringId, valueStringId);
+}
+
+bool OsmAnd::MapStyleEvaluationCache::evaluate(
+    MapStyleEvaluator& evaluator,
+    const std::shared_ptr<const MapObject>& mapObject,
+    const int attributeIdIndex,
+    const MapStyleRulesetType rulesetType,
+    const ZoomLevel zoom,
+    MapStyleEvaluationResult& outResult,
+    Lookup* const outLookup /*= nullptr*/)
+{
+    const auto& builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+    const auto attributeId = mapObject->attributeIds[attributeIdIndex];
+    const auto& decodedAttribute = mapObject->attributeMapping->decodeMap[attributeId];
+
+    if (!_program)
+    {
+        evaluator.setStringValue(builtinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
+        evaluator.setStringValue(builtinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
+
+        outResult.clear();
+        if (outLookup)
+            *outLookup = Lookup::Bypass;
+        return evaluator.evaluate(mapObject, rulesetType, &outResult);
+    }
+
+    const Key key(*mapObject, attributeId, rulesetType, zoom);
+    auto lookup = Lookup::Miss;
+    {
+        QReadLocker scopedLocker(&_entriesLock);
+
+        const auto citEntry = _entries.constFind(key);
+        if (citEntry != _entries.cend())
+        {
+            const auto& entry = *citEntry;
+            if (!entry.dependsOnObject)
+            {
+                outResult.clear();
+                for (const auto& resultEntry : constOf(entry.result.entries))
+                    outResult.setValue(resultEntry.first, resultEntry.second);
+
+                if (outLookup)
+                    *outLookup = Lookup::Hit;
+                return entry.success;
+            }
+
+            lookup = Lookup::Bypass;
+        }
+    }
+
+    evaluator.setStringValue(builtinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
+    evaluator.setStringValue(builtinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
+
+    outResult.clear();
+    const auto success = evaluator.evaluate(mapObject, rulesetType, &outResult);
+
+    if (lookup == Lookup::Miss)
+    {
+        // Rules that depend on object are remembered as well, so that they are not analyzed again
+        Entry entry;
+        entry.attributeMapping = mapObject->attributeMapping;
+        entry.dependsOnObject = isRuleDependentOnObject(rulesetType, decodedAttribute);
+        entry.success = success;
+        if (!entry.dependsOnObject)
+            outResult.pack(entry.result);
+        else
+            lookup = Lookup::Bypass;
+
+        QWriteLocker scopedLocker(&_entriesLock);
+
+        // Signatures of visible area are re-inserted quickly, so entire cache is dropped once it's full
+        if (static_cast<unsigned int>(_entries.size()) >= capacity)
+            _entries.clear();
+        _entries.insert(key, entry);
+    }
+
+    if (outLookup)
+        *outLookup = lookup;
+    return success;
+}
+
+void OsmAnd::MapStyleEvaluationCache::clear()
+{
+    QWriteLocker scopedLocker(&_entriesLock);
+
+    _entries.clear();
+}
+
+unsigned int OsmAnd::MapStyleEvaluationCache::getSize() const
+{
+    QReadLocker scopedLocker(&_entriesLock);
+
+    return _entries.size();
+}
+
+OsmAnd::MapStyleEvaluationCache::Key::Key(
+    const MapObject& mapObject,
+    const uint32_t attributeId_,
+    const MapStyleRulesetType rulesetType_,
+    const ZoomLevel zoom_)
+    : attributeMapping(mapObject.attributeMapping.get())
+    , attributeId(attributeId_)
+    , rulesetType(rulesetType_)
+    , zoom(zoom_)
+    , shape(0)
+    , attributeIds(mapObject.attributeIds)
+    , additionalAttributeIds(mapObject.additionalAttributeIds)
+{
+    // Layer and shape of map object are inputs of rules as well
+    shape = static_cast<uint32_t>(static_cast<int>(mapObject.getLayerType()) + 1) << 3;
+    if (mapObject.isArea)
+        shape |= 1u << 0;
+    if (mapObject.points31.size() == 1)
+        shape |= 1u << 1;
+    if (mapObject.isClosedFigure())
+        shape |= 1u << 2;
+
+    hash = qHash(attributeMapping);
+    hash = qHash(attributeIds, hash);
+    hash = qHash(additionalAttributeIds, hash);
+    hash = qHash(attributeId, hash);
+    hash = qHash((static_cast<uint32_t>(rulesetType) << 24) | (static_cast<uint32_t>(zoom) << 16) | shape, hash);
+}
+
+bool OsmAnd::MapStyleEvaluationCache::Key::operator==(const Key& that) const
+{
+    return
+        hash == that.hash &&
+        attributeMapping == that.attributeMapping &&
+        attributeId == that.attributeId &&
+        rulesetType == that.rulesetType &&
+        zoom == that.zoom &&
+        shape == that.shape &&
+        attributeIds == that.attributeIds &&
+        additionalAttributeIds == that.additionalAttributeIds;
+}
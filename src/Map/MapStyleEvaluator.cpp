@@ -7,10 +7,12 @@
 
 OsmAnd::MapStyleEvaluator::MapStyleEvaluator(
     const std::shared_ptr<const IMapStyle>& mapStyle_,
-    const float ptScaleFactor_)
+    const float ptScaleFactor_,
+    const bool useCompiledProgram_ /*= true*/)
     : _p(new MapStyleEvaluator_P(this))
     , mapStyle(mapStyle_)
     , ptScaleFactor(ptScaleFactor_)
+    , useCompiledProgram(useCompiledProgram_)
 {
     _p->prepare();
 }
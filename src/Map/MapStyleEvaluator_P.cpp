@@ -17,6 +17,7 @@
 
 OsmAnd::MapStyleEvaluator_P::MapStyleEvaluator_P(MapStyleEvaluator* owner_)
     : _builtinValueDefs(MapStyleBuiltinValueDefinitions::get())
+    , _lastResolvedAttributeMapping(nullptr)
     , owner(owner_)
     , intermediateEvaluationResultAllocator(std::bind(&MapStyleEvaluator_P::allocateIntermediateEvaluationResult, this))
 {
@@ -34,6 +35,9 @@ void OsmAnd::MapStyleEvaluator_P::prepare()
     _inputValuesShadow.reset(new ArrayMap<InputValue>(valueDefinitionsCount));
     _intermediateEvaluationResult.reset(new ArrayMap<IMapStyle::Value>(valueDefinitionsCount));
     _constantIntermediateEvaluationResult.reset(new ArrayMap<IMapStyle::Value>(valueDefinitionsCount));
+
+    if (owner->useCompiledProgram)
+        _program = owner->mapStyle->getProgram();
 }
 
 OsmAnd::ArrayMap<OsmAnd::IMapStyle::Value>* OsmAnd::MapStyleEvaluator_P::allocateIntermediateEvaluationResult()
@@ -54,13 +58,30 @@ OsmAnd::MapStyleConstantValue OsmAnd::MapStyleEvaluator_P::evaluateConstantValue
     bool wasDisabled = false;
     intermediateEvaluationResult->clear();
     OnDemand<IntermediateEvaluationResult> innerConstantEvaluationResult(intermediateEvaluationResultAllocator);
-    evaluate(
-        mapObject,
-        resolvedValue.asDynamicValue.attribute->getRootNodeRef(),
-        inputValues,
-        wasDisabled,
-        intermediateEvaluationResult.get(),
-        innerConstantEvaluationResult);
+    const auto& attribute = resolvedValue.asDynamicValue.attribute;
+    const auto programRootNode = _program
+        ? _program->getAttributeRootNode(attribute.get())
+        : MapStyleProgram::InvalidIndex;
+    if (programRootNode != MapStyleProgram::InvalidIndex)
+    {
+        evaluateProgramNode(
+            mapObject,
+            programRootNode,
+            inputValues,
+            wasDisabled,
+            intermediateEvaluationResult.get(),
+            innerConstantEvaluationResult);
+    }
+    else
+    {
+        evaluate(
+            mapObject,
+            attribute->getRootNodeRef(),
+            inputValues,
+            wasDisabled,
+            intermediateEvaluationResult.get(),
+            innerConstantEvaluationResult);
+    }
 
     IMapStyle::Value evaluatedValue;
     switch (dataType)
@@ -95,6 +116,7 @@ OsmAnd::MapStyleConstantValue OsmAnd::MapStyleEvaluator_P::evaluateConstantValue
 
 bool OsmAnd::MapStyleEvaluator_P::evaluate(
     const std::shared_ptr<const MapObject>& mapObject,
+    const MapStyleRulesetType rulesetType,
     const QHash< TagValueId, std::shared_ptr<const IMapStyle::IRule> >& ruleset,
     const ResolvedMapStyle::StringId tagStringId,
     const ResolvedMapStyle::StringId valueStringId,
@@ -102,10 +124,21 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
 {
     const auto ruleId = TagValueId::compose(tagStringId, valueStringId);
-    const auto citRule = ruleset.constFind(ruleId);
-    if (citRule == ruleset.cend())
-        return false;
-    const auto& rule = *citRule;
+    auto programRootNode = MapStyleProgram::InvalidIndex;
+    std::shared_ptr<const IMapStyle::IRuleNode> ruleRootNode;
+    if (_program)
+    {
+        programRootNode = _program->getRuleRootNode(rulesetType, ruleId);
+        if (programRootNode == MapStyleProgram::InvalidIndex)
+            return false;
+    }
+    else
+    {
+        const auto citRule = ruleset.constFind(ruleId);
+        if (citRule == ruleset.cend())
+            return false;
+        ruleRootNode = (*citRule)->getRootNodeRef();
+    }
 
     InputValue inputTag;
     inputTag.asUInt = tagStringId;
@@ -119,13 +152,21 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
         _intermediateEvaluationResult->clear();
 
     bool wasDisabled = false;
-    const auto success = evaluate(
-        mapObject.get(),
-        rule->getRootNodeRef(),
-        _inputValuesShadow,
-        wasDisabled,
-        _intermediateEvaluationResult.get(),
-        constantEvaluationResult);
+    const auto success = _program
+        ? evaluateProgramNode(
+            mapObject.get(),
+            programRootNode,
+            _inputValuesShadow,
+            wasDisabled,
+            _intermediateEvaluationResult.get(),
+            constantEvaluationResult)
+        : evaluate(
+            mapObject.get(),
+            ruleRootNode,
+            _inputValuesShadow,
+            wasDisabled,
+            _intermediateEvaluationResult.get(),
+            constantEvaluationResult);
     if (!success || wasDisabled)
         return false;
 
@@ -294,6 +335,276 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     return true;
 }
 
+bool OsmAnd::MapStyleEvaluator_P::evaluateProgramNode(
+    const MapObject* const mapObject,
+    const MapStyleProgram::Index nodeIndex,
+    const std::shared_ptr<const InputValues>& inputValues,
+    bool& outDisabled,
+    IntermediateEvaluationResult* const outResultStorage,
+    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
+{
+    ProgramEvaluationContext context;
+    context.mapObject = mapObject;
+    context.inputValues = inputValues;
+
+    InputValue zoomValue;
+    context.minZoom = inputValues->get(_builtinValueDefs->id_INPUT_MINZOOM, zoomValue) ? zoomValue.asInt : 0;
+    context.maxZoom = inputValues->get(_builtinValueDefs->id_INPUT_MAXZOOM, zoomValue) ? zoomValue.asInt : 0;
+
+    const auto& node = _program->nodes[nodeIndex];
+    if (node.minZoom > context.minZoom || node.maxZoom < context.maxZoom)
+        return false;
+
+    return evaluateProgramNode(
+        context,
+        nodeIndex,
+        outDisabled,
+        outResultStorage,
+        constantEvaluationResult);
+}
+
+bool OsmAnd::MapStyleEvaluator_P::evaluateProgramNode(
+    const ProgramEvaluationContext& context,
+    const MapStyleProgram::Index nodeIndex,
+    bool& outDisabled,
+    IntermediateEvaluationResult* const outResultStorage,
+    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
+{
+    // Same logic as evaluation of rule node, except that zoom bounds of the node were already checked by caller
+    const auto& node = _program->nodes[nodeIndex];
+
+    auto pCondition = _program->conditions.data() + node.firstCondition;
+    for (auto conditionIdx = 0u; conditionIdx < node.conditionsCount; conditionIdx++, pCondition++)
+    {
+        if (!evaluateProgramCondition(context, *pCondition, constantEvaluationResult))
+            return false;
+    }
+
+    if (node.disableOutput != MapStyleProgram::InvalidIndex)
+    {
+        const auto disableValue = evaluateConstantValue(
+            context.mapObject,
+            _builtinValueDefs->OUTPUT_DISABLE->dataType,
+            _program->outputs[node.disableOutput].value,
+            context.inputValues,
+            constantEvaluationResult);
+
+        assert(!disableValue.isComplex);
+        if (disableValue.asSimple.asUInt != 0)
+        {
+            outDisabled = true;
+            return false;
+        }
+    }
+
+    if (outResultStorage && !node.isSwitch)
+        fillResultFromProgramNode(node, *outResultStorage, true);
+
+    bool atLeastOneConditionalMatched = false;
+    auto pSubnode = _program->subnodes.data() + node.firstOneOfConditionalSubnode;
+    for (auto subnodeIdx = 0u; subnodeIdx < node.oneOfConditionalSubnodesCount; subnodeIdx++, pSubnode++)
+    {
+        if (pSubnode->minZoom > context.minZoom || pSubnode->maxZoom < context.maxZoom)
+            continue;
+
+        const auto evaluationResult = evaluateProgramNode(
+            context,
+            pSubnode->nodeIndex,
+            outDisabled,
+            outResultStorage,
+            constantEvaluationResult);
+
+        if (evaluationResult)
+        {
+            atLeastOneConditionalMatched = true;
+            break;
+        }
+    }
+    if (!atLeastOneConditionalMatched && node.isSwitch)
+        return false;
+
+    if (outResultStorage && node.isSwitch)
+        fillResultFromProgramNode(node, *outResultStorage, false);
+
+    pSubnode = _program->subnodes.data() + node.firstApplySubnode;
+    for (auto subnodeIdx = 0u; subnodeIdx < node.applySubnodesCount; subnodeIdx++, pSubnode++)
+    {
+        if (pSubnode->minZoom > context.minZoom || pSubnode->maxZoom < context.maxZoom)
+            continue;
+
+        evaluateProgramNode(
+            context,
+            pSubnode->nodeIndex,
+            outDisabled,
+            outResultStorage,
+            constantEvaluationResult);
+    }
+
+    if (outDisabled)
+        return false;
+
+    return true;
+}
+
+bool OsmAnd::MapStyleEvaluator_P::evaluateProgramCondition(
+    const ProgramEvaluationContext& context,
+    const MapStyleProgram::Condition& condition,
+    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
+{
+    typedef MapStyleProgram::ConditionType ConditionType;
+
+    InputValue inputValue;
+    context.inputValues->get(condition.valueDefId, inputValue);
+
+    switch (condition.type)
+    {
+        case ConditionType::IntegerEquals:
+            return (condition.constant.asInt == inputValue.asInt);
+        case ConditionType::FloatEquals:
+            return qFuzzyCompare(condition.constant.asFloat, inputValue.asFloat);
+        case ConditionType::Test:
+            return (inputValue.asInt == 1);
+        case ConditionType::AdditionalAttribute:
+        case ConditionType::AdditionalTag:
+        {
+            if (!context.mapObject)
+                return true;
+
+            const auto& attributeIds = resolveAdditionalAttribute(
+                context.mapObject,
+                condition.constant.additionalAttributeIndex,
+                condition.type == ConditionType::AdditionalTag);
+            for (const auto attributeId : constOf(attributeIds))
+            {
+                if (context.mapObject->additionalAttributeIds.contains(attributeId))
+                    return true;
+            }
+            return false;
+        }
+        case ConditionType::EvaluatedAdditional:
+            if (!context.mapObject)
+                return true;
+            break;
+        default:
+            break;
+    }
+
+    const auto constantRuleValue = evaluateConstantValue(
+        context.mapObject,
+        condition.dataType,
+        condition.value,
+        context.inputValues,
+        constantEvaluationResult);
+
+    switch (condition.type)
+    {
+        case ConditionType::EvaluatedMinZoom:
+            assert(!constantRuleValue.isComplex);
+            return (constantRuleValue.asSimple.asInt <= inputValue.asInt);
+        case ConditionType::EvaluatedMaxZoom:
+            assert(!constantRuleValue.isComplex);
+            return (constantRuleValue.asSimple.asInt >= inputValue.asInt);
+        case ConditionType::EvaluatedFloatEquals:
+        {
+            const auto lvalue = constantRuleValue.isComplex
+                ? constantRuleValue.asComplex.asFloat.evaluate(owner->ptScaleFactor)
+                : constantRuleValue.asSimple.asFloat;
+
+            return qFuzzyCompare(lvalue, inputValue.asFloat);
+        }
+        case ConditionType::EvaluatedIntegerEquals:
+        {
+            const auto lvalue = constantRuleValue.isComplex
+                ? constantRuleValue.asComplex.asInt.evaluate(owner->ptScaleFactor)
+                : constantRuleValue.asSimple.asInt;
+
+            return (lvalue == inputValue.asInt);
+        }
+        case ConditionType::EvaluatedAdditional:
+        {
+            assert(!constantRuleValue.isComplex);
+            const auto valueString = owner->mapStyle->getStringById(constantRuleValue.asSimple.asUInt);
+            const auto equalSignIdx = valueString.indexOf(QLatin1Char('='));
+            if (equalSignIdx >= 0)
+            {
+                const auto& tagRef = valueString.midRef(0, equalSignIdx);
+                const auto& valueRef = valueString.midRef(equalSignIdx + 1);
+                return context.mapObject->containsAttribute(tagRef, valueRef, true);
+            }
+            return context.mapObject->containsTag(valueString, true);
+        }
+        default:
+            break;
+    }
+
+    return false;
+}
+
+const OsmAnd::MapStyleEvaluator_P::AttributeIds& OsmAnd::MapStyleEvaluator_P::resolveAdditionalAttribute(
+    const MapObject* const mapObject,
+    const MapStyleProgram::Index additionalAttributeIndex,
+    const bool tagOnly) const
+{
+    const auto& attributeMapping = mapObject->attributeMapping;
+
+    // Usually all objects come from few sections, so attribute mapping rarely changes between objects
+    if (!_lastResolvedAttributeMapping || _lastResolvedAttributeMapping->attributeMapping != attributeMapping)
+    {
+        auto& resolvedAttributeMapping = _resolvedAttributeMappings[attributeMapping.get()];
+        if (!resolvedAttributeMapping)
+        {
+            const auto additionalAttributesCount = static_cast<int>(_program->additionalAttributes.size());
+
+            resolvedAttributeMapping.reset(new ResolvedAttributeMapping());
+            resolvedAttributeMapping->attributeMapping = attributeMapping;
+            resolvedAttributeMapping->isResolved.fill(false, additionalAttributesCount);
+            resolvedAttributeMapping->additionalAttributesIds.resize(additionalAttributesCount);
+        }
+        _lastResolvedAttributeMapping = resolvedAttributeMapping.get();
+    }
+
+    auto& attributeIds = _lastResolvedAttributeMapping->additionalAttributesIds[additionalAttributeIndex];
+    if (!_lastResolvedAttributeMapping->isResolved[additionalAttributeIndex])
+    {
+        const auto& additionalAttribute = _program->additionalAttributes[additionalAttributeIndex];
+        const auto citTagsGroup = attributeMapping->encodeMap.constFind(QStringRef(&additionalAttribute.tag));
+        if (citTagsGroup != attributeMapping->encodeMap.cend())
+        {
+            if (tagOnly)
+            {
+                for (const auto attributeId : constOf(*citTagsGroup))
+                    attributeIds.push_back(attributeId);
+            }
+            else
+            {
+                const auto citAttributeId = citTagsGroup->constFind(QStringRef(&additionalAttribute.value));
+                if (citAttributeId != citTagsGroup->cend())
+                    attributeIds.push_back(*citAttributeId);
+            }
+        }
+
+        _lastResolvedAttributeMapping->isResolved[additionalAttributeIndex] = true;
+    }
+
+    return attributeIds;
+}
+
+void OsmAnd::MapStyleEvaluator_P::fillResultFromProgramNode(
+    const MapStyleProgram::Node& node,
+    IntermediateEvaluationResult& outResultStorage,
+    const bool allowOverride) const
+{
+    auto pOutput = _program->outputs.data() + node.firstOutput;
+    for (auto outputIdx = 0u; outputIdx < node.outputsCount; outputIdx++, pOutput++)
+    {
+        // If value already defined and override not allowed, do nothing
+        if (!allowOverride && outResultStorage.contains(pOutput->valueDefId))
+            continue;
+
+        outResultStorage.set(pOutput->valueDefId, pOutput->value);
+    }
+}
+
 void OsmAnd::MapStyleEvaluator_P::fillResultFromRuleNode(
     const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
     IntermediateEvaluationResult& outResultStorage,
@@ -441,7 +752,10 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     //}
     //////////////////////////////////////////////////////////////////////////
 
-    const auto& ruleset = owner->mapStyle->getRuleset(rulesetType);
+    // Compiled program has own index of rules
+    const auto ruleset = _program
+        ? QHash< TagValueId, std::shared_ptr<const IMapStyle::IRule> >()
+        : owner->mapStyle->getRuleset(rulesetType);
 
     _constantIntermediateEvaluationResult->clear();
     OnDemand<IntermediateEvaluationResult> constantEvaluationResult(_constantIntermediateEvaluationResult);
@@ -450,6 +764,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     {
         const auto evaluationResult = evaluate(
             mapObject,
+            rulesetType,
             ruleset,
             _inputValues->getRef(_builtinValueDefs->id_INPUT_TAG)->asUInt,
             _inputValues->getRef(_builtinValueDefs->id_INPUT_VALUE)->asUInt,
@@ -463,6 +778,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     {
         const auto evaluationResult = evaluate(
             mapObject,
+            rulesetType,
             ruleset,
             _inputValues->getRef(_builtinValueDefs->id_INPUT_TAG)->asUInt,
             ResolvedMapStyle::EmptyStringId,
@@ -474,6 +790,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
 
     const auto evaluationResult = evaluate(
         mapObject,
+        rulesetType,
         ruleset,
         ResolvedMapStyle::EmptyStringId,
         ResolvedMapStyle::EmptyStringId,
@@ -496,13 +813,24 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     OnDemand<IntermediateEvaluationResult> constantEvaluationResult(_constantIntermediateEvaluationResult);
 
     bool wasDisabled = false;
-    const auto success = evaluate(
-        nullptr,
-        attribute->getRootNodeRef(),
-        _inputValues,
-        wasDisabled,
-        _intermediateEvaluationResult.get(),
-        constantEvaluationResult);
+    const auto programRootNode = _program
+        ? _program->getAttributeRootNode(attribute.get())
+        : MapStyleProgram::InvalidIndex;
+    const auto success = (programRootNode != MapStyleProgram::InvalidIndex)
+        ? evaluateProgramNode(
+            nullptr,
+            programRootNode,
+            _inputValues,
+            wasDisabled,
+            _intermediateEvaluationResult.get(),
+            constantEvaluationResult)
+        : evaluate(
+            nullptr,
+            attribute->getRootNodeRef(),
+            _inputValues,
+            wasDisabled,
+            _intermediateEvaluationResult.get(),
+            constantEvaluationResult);
     if (!success || wasDisabled)
         return false;
 
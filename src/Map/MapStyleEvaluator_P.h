@@ -5,6 +5,8 @@
 
 #include "QtExtensions.h"
 #include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QVector>
 #include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
@@ -13,12 +15,13 @@
 #include "PrivateImplementation.h"
 #include "MapStyleConstantValue.h"
 #include "IMapStyle.h"
+#include "MapStyleProgram.h"
+#include "MapObject.h"
 
 namespace OsmAnd
 {
     class MapStyleEvaluationResult;
     class MapStyleBuiltinValueDefinitions;
-    class MapObject;
 
     class MapStyleEvaluator;
     class MapStyleEvaluator_P Q_DECL_FINAL
@@ -47,6 +50,32 @@ namespace OsmAnd
         std::shared_ptr<IntermediateEvaluationResult> _intermediateEvaluationResult;
         std::shared_ptr<IntermediateEvaluationResult> _constantIntermediateEvaluationResult;
 
+        std::shared_ptr<const MapStyleProgram> _program;
+
+        // Ids of additional attributes referenced by program are resolved once per attribute mapping,
+        // instead of looking up tag and value strings for each map object
+        typedef QVector<uint32_t> AttributeIds;
+        struct ResolvedAttributeMapping
+        {
+            std::shared_ptr<const MapObject::AttributeMapping> attributeMapping;
+            QVector<bool> isResolved;
+            QVector<AttributeIds> additionalAttributesIds;
+        };
+        mutable QHash< const MapObject::AttributeMapping*, std::shared_ptr<ResolvedAttributeMapping> > _resolvedAttributeMappings;
+        mutable ResolvedAttributeMapping* _lastResolvedAttributeMapping;
+        const AttributeIds& resolveAdditionalAttribute(
+            const MapObject* const mapObject,
+            const MapStyleProgram::Index additionalAttributeIndex,
+            const bool tagOnly) const;
+
+        struct ProgramEvaluationContext
+        {
+            const MapObject* mapObject;
+            std::shared_ptr<const InputValues> inputValues;
+            int32_t minZoom;
+            int32_t maxZoom;
+        };
+
         void prepare();
 
         ArrayMap<IMapStyle::Value>* allocateIntermediateEvaluationResult();
@@ -68,12 +97,38 @@ namespace OsmAnd
 
         bool evaluate(
             const std::shared_ptr<const MapObject>& mapObject,
+            const MapStyleRulesetType rulesetType,
             const QHash< TagValueId, std::shared_ptr<const IMapStyle::IRule> >& ruleset,
             const IMapStyle::StringId tagStringId,
             const IMapStyle::StringId valueStringId,
             MapStyleEvaluationResult* const outResultStorage,
             OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
 
+        bool evaluateProgramNode(
+            const ProgramEvaluationContext& context,
+            const MapStyleProgram::Index nodeIndex,
+            bool& outDisabled,
+            IntermediateEvaluationResult* const outResultStorage,
+            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
+
+        bool evaluateProgramNode(
+            const MapObject* const mapObject,
+            const MapStyleProgram::Index nodeIndex,
+            const std::shared_ptr<const InputValues>& inputValues,
+            bool& outDisabled,
+            IntermediateEvaluationResult* const outResultStorage,
+            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
+
+        bool evaluateProgramCondition(
+            const ProgramEvaluationContext& context,
+            const MapStyleProgram::Condition& condition,
+            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
+
+        void fillResultFromProgramNode(
+            const MapStyleProgram::Node& node,
+            IntermediateEvaluationResult& outResultStorage,
+            const bool allowOverride) const;
+
         void fillResultFromRuleNode(
             const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
             IntermediateEvaluationResult& outResultStorage,
@@ -0,0 +1,372 @@
+#include "MapStyleProgram.h"
+
+#include "stdlib_common.h"
+#include <limits>
+
+#include "QtExtensions.h"
+#include "QtCommon.h"
+
+#include "MapStyleBuiltinValueDefinitions.h"
+#include "MapStyleValueDefinition.h"
+#include "QKeyValueIterator.h"
+
+OsmAnd::MapStyleProgram::MapStyleProgram()
+{
+}
+
+OsmAnd::MapStyleProgram::~MapStyleProgram()
+{
+}
+
+OsmAnd::MapStyleProgram::Index OsmAnd::MapStyleProgram::compileNode(
+    const IMapStyle& mapStyle,
+    const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode)
+{
+    const auto& builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+
+    // Node is registered before its subnodes, so that root of each rule goes first
+    const auto nodeIndex = static_cast<Index>(nodes.size());
+    nodes.push_back(Node());
+
+    Node node;
+    node.isSwitch = ruleNode->getIsSwitch();
+
+    std::vector<Condition> nodeConditions;
+    std::vector<Output> nodeOutputs;
+    const auto& ruleNodeValues = ruleNode->getValuesRef();
+    for (const auto& ruleValueEntry : rangeOf(constOf(ruleNodeValues)))
+    {
+        const auto valueDefId = ruleValueEntry.key();
+        const auto& valueDef = mapStyle.getValueDefinitionRefById(valueDefId);
+
+        if (valueDef->valueClass == MapStyleValueDefinition::Class::Input)
+        {
+            Condition condition;
+            if (compileCondition(mapStyle, valueDefId, ruleValueEntry.value(), node, condition))
+                nodeConditions.push_back(condition);
+        }
+        else if (valueDef->valueClass == MapStyleValueDefinition::Class::Output)
+        {
+            Output output;
+            output.valueDefId = valueDefId;
+            output.value = ruleValueEntry.value();
+            nodeOutputs.push_back(output);
+        }
+    }
+
+    // Order of conditions doesn't affect result, since all of them have to match
+    std::stable_sort(nodeConditions.begin(), nodeConditions.end(),
+        []
+        (const Condition& l, const Condition& r) -> bool
+        {
+            return static_cast<int>(l.type) < static_cast<int>(r.type);
+        });
+
+    node.firstCondition = static_cast<Index>(conditions.size());
+    node.conditionsCount = static_cast<Index>(nodeConditions.size());
+    conditions.insert(conditions.end(), nodeConditions.cbegin(), nodeConditions.cend());
+
+    node.firstOutput = static_cast<Index>(outputs.size());
+    node.outputsCount = static_cast<Index>(nodeOutputs.size());
+    for (const auto& output : nodeOutputs)
+    {
+        if (output.valueDefId == builtinValueDefs->id_OUTPUT_DISABLE)
+            node.disableOutput = static_cast<Index>(outputs.size());
+        outputs.push_back(output);
+    }
+
+    std::vector<Subnode> oneOfConditionalSubnodes;
+    for (const auto& oneOfConditionalSubnode : constOf(ruleNode->getOneOfConditionalSubnodesRef()))
+    {
+        Subnode subnode;
+        subnode.nodeIndex = compileNode(mapStyle, oneOfConditionalSubnode);
+        subnode.minZoom = nodes[subnode.nodeIndex].minZoom;
+        subnode.maxZoom = nodes[subnode.nodeIndex].maxZoom;
+        oneOfConditionalSubnodes.push_back(subnode);
+    }
+
+    std::vector<Subnode> applySubnodes;
+    for (const auto& applySubnode : constOf(ruleNode->getApplySubnodesRef()))
+    {
+        Subnode subnode;
+        subnode.nodeIndex = compileNode(mapStyle, applySubnode);
+        subnode.minZoom = nodes[subnode.nodeIndex].minZoom;
+        subnode.maxZoom = nodes[subnode.nodeIndex].maxZoom;
+        applySubnodes.push_back(subnode);
+    }
+
+    node.firstOneOfConditionalSubnode = static_cast<Index>(subnodes.size());
+    node.oneOfConditionalSubnodesCount = static_cast<Index>(oneOfConditionalSubnodes.size());
+    subnodes.insert(subnodes.end(), oneOfConditionalSubnodes.cbegin(), oneOfConditionalSubnodes.cend());
+
+    node.firstApplySubnode = static_cast<Index>(subnodes.size());
+    node.applySubnodesCount = static_cast<Index>(applySubnodes.size());
+    subnodes.insert(subnodes.end(), applySubnodes.cbegin(), applySubnodes.cend());
+
+    nodes[nodeIndex] = node;
+    return nodeIndex;
+}
+
+bool OsmAnd::MapStyleProgram::compileCondition(
+    const IMapStyle& mapStyle,
+    const IMapStyle::ValueDefinitionId valueDefId,
+    const IMapStyle::Value& value,
+    Node& node,
+    Condition& outCondition)
+{
+    const auto& builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+    const auto& valueDef = mapStyle.getValueDefinitionRefById(valueDefId);
+    const auto isConstant = !value.isDynamic && !value.asConstantValue.isComplex;
+
+    outCondition.valueDefId = valueDefId;
+    outCondition.dataType = valueDef->dataType;
+    outCondition.value = value;
+
+    if (valueDefId == builtinValueDefs->id_INPUT_MINZOOM)
+    {
+        if (!isConstant)
+        {
+            outCondition.type = ConditionType::EvaluatedMinZoom;
+            return true;
+        }
+
+        // Folded into node: minzoom <= INPUT_MINZOOM
+        node.minZoom = qMax(node.minZoom, value.asConstantValue.asSimple.asInt);
+        return false;
+    }
+    else if (valueDefId == builtinValueDefs->id_INPUT_MAXZOOM)
+    {
+        if (!isConstant)
+        {
+            outCondition.type = ConditionType::EvaluatedMaxZoom;
+            return true;
+        }
+
+        // Folded into node: maxzoom >= INPUT_MAXZOOM
+        node.maxZoom = qMin(node.maxZoom, value.asConstantValue.asSimple.asInt);
+        return false;
+    }
+    else if (valueDefId == builtinValueDefs->id_INPUT_ADDITIONAL)
+    {
+        if (value.isDynamic)
+        {
+            outCondition.type = ConditionType::EvaluatedAdditional;
+            return true;
+        }
+
+        const auto additional = mapStyle.getStringById(value.asConstantValue.asSimple.asUInt);
+        outCondition.type = additional.contains(QLatin1Char('='))
+            ? ConditionType::AdditionalAttribute
+            : ConditionType::AdditionalTag;
+        outCondition.constant.additionalAttributeIndex = registerAdditionalAttribute(additional);
+    }
+    else if (valueDefId == builtinValueDefs->id_INPUT_TEST)
+    {
+        outCondition.type = ConditionType::Test;
+    }
+    else if (valueDef->dataType == MapStyleValueDataType::Float)
+    {
+        outCondition.type = isConstant ? ConditionType::FloatEquals : ConditionType::EvaluatedFloatEquals;
+        if (isConstant)
+            outCondition.constant.asFloat = value.asConstantValue.asSimple.asFloat;
+    }
+    else
+    {
+        outCondition.type = isConstant ? ConditionType::IntegerEquals : ConditionType::EvaluatedIntegerEquals;
+        if (isConstant)
+            outCondition.constant.asInt = value.asConstantValue.asSimple.asInt;
+    }
+
+    return true;
+}
+
+OsmAnd::MapStyleProgram::Index OsmAnd::MapStyleProgram::registerAdditionalAttribute(const QString& additional)
+{
+    const auto citIndex = additionalAttributesIndices.constFind(additional);
+    if (citIndex != additionalAttributesIndices.cend())
+        return *citIndex;
+
+    AdditionalAttribute additionalAttribute;
+    const auto equalSignIdx = additional.indexOf(QLatin1Char('='));
+    if (equalSignIdx >= 0)
+    {
+        additionalAttribute.tag = additional.mid(0, equalSignIdx);
+        additionalAttribute.value = additional.mid(equalSignIdx + 1);
+    }
+    else
+        additionalAttribute.tag = additional;
+
+    const auto index = static_cast<Index>(additionalAttributes.size());
+    additionalAttributes.push_back(additionalAttribute);
+    additionalAttributesIndices.insert(additional, index);
+
+    return index;
+}
+
+bool OsmAnd::MapStyleProgram::resolveDependsOnObject(const Index nodeIndex, std::vector<ResolvingState>& states)
+{
+    auto& node = nodes[nodeIndex];
+    if (states[nodeIndex] == ResolvingState::Resolved)
+        return node.dependsOnObject;
+
+    // Attributes that (indirectly) reference themselves are treated as dependent, since it's not known what
+    // their evaluation reads
+    if (states[nodeIndex] == ResolvingState::Resolving)
+        return true;
+    states[nodeIndex] = ResolvingState::Resolving;
+
+    auto dependsOnObject = false;
+
+    auto pCondition = conditions.data() + node.firstCondition;
+    for (auto conditionIdx = 0u; conditionIdx < node.conditionsCount; conditionIdx++, pCondition++)
+    {
+        if (isObjectSpecificInput(pCondition->valueDefId) || resolveDependsOnObject(pCondition->value, states))
+            dependsOnObject = true;
+    }
+
+    for (auto outputIdx = node.firstOutput; outputIdx < node.firstOutput + node.outputsCount; outputIdx++)
+    {
+        if (resolveDependsOnObject(outputs[outputIdx].value, states))
+            dependsOnObject = true;
+    }
+
+    const auto subnodesEnd = node.firstApplySubnode + node.applySubnodesCount;
+    for (auto subnodeIdx = node.firstOneOfConditionalSubnode; subnodeIdx < subnodesEnd; subnodeIdx++)
+    {
+        if (resolveDependsOnObject(subnodes[subnodeIdx].nodeIndex, states))
+            dependsOnObject = true;
+    }
+
+    node.dependsOnObject = dependsOnObject;
+    states[nodeIndex] = ResolvingState::Resolved;
+
+    return dependsOnObject;
+}
+
+bool OsmAnd::MapStyleProgram::resolveDependsOnObject(const IMapStyle::Value& value, std::vector<ResolvingState>& states)
+{
+    if (!value.isDynamic)
+        return false;
+
+    const auto attributeRootNode = getAttributeRootNode(value.asDynamicValue.attribute.get());
+    if (attributeRootNode == InvalidIndex)
+        return true;
+
+    return resolveDependsOnObject(attributeRootNode, states);
+}
+
+bool OsmAnd::MapStyleProgram::isObjectSpecificInput(const IMapStyle::ValueDefinitionId valueDefId)
+{
+    const auto& builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+
+    return
+        valueDefId == builtinValueDefs->id_INPUT_NAME_TAG ||
+        valueDefId == builtinValueDefs->id_INPUT_TEXT_LENGTH;
+}
+
+bool OsmAnd::MapStyleProgram::isRuleDependentOnObject(
+    const MapStyleRulesetType rulesetType,
+    const IMapStyle::StringId tagStringId,
+    const IMapStyle::StringId valueStringId) const
+{
+    const TagValueId ruleIds[] = {
+        TagValueId::compose(tagStringId, valueStringId),
+        TagValueId::compose(tagStringId, IMapStyle::EmptyStringId),
+        TagValueId::compose(IMapStyle::EmptyStringId, IMapStyle::EmptyStringId),
+    };
+    for (const auto& ruleId : ruleIds)
+    {
+        const auto rootNodeIndex = getRuleRootNode(rulesetType, ruleId);
+        if (rootNodeIndex != InvalidIndex && nodes[rootNodeIndex].dependsOnObject)
+            return true;
+    }
+
+    return false;
+}
+
+OsmAnd::MapStyleProgram::Index OsmAnd::MapStyleProgram::getRuleRootNode(
+    const MapStyleRulesetType rulesetType,
+    const TagValueId tagValueId) const
+{
+    const auto& ruleset = rulesets[static_cast<unsigned int>(rulesetType)];
+    const auto citRootNode = ruleset.constFind(tagValueId);
+    if (citRootNode == ruleset.cend())
+        return InvalidIndex;
+    return *citRootNode;
+}
+
+OsmAnd::MapStyleProgram::Index OsmAnd::MapStyleProgram::getAttributeRootNode(
+    const IMapStyle::IAttribute* const attribute) const
+{
+    return attributes.value(attribute, InvalidIndex);
+}
+
+std::shared_ptr<const OsmAnd::MapStyleProgram> OsmAnd::MapStyleProgram::compile(const IMapStyle& mapStyle)
+{
+    const std::shared_ptr<MapStyleProgram> program(new MapStyleProgram());
+
+    for (const auto& attribute : constOf(mapStyle.getAttributes()))
+    {
+        const auto rootNodeIndex = program->compileNode(mapStyle, attribute->getRootNodeRef());
+        program->attributes.insert(attribute.get(), rootNodeIndex);
+    }
+
+    for (auto rulesetTypeIdx = 0u; rulesetTypeIdx < MapStyleRulesetTypesCount; rulesetTypeIdx++)
+    {
+        const auto ruleset = mapStyle.getRuleset(static_cast<MapStyleRulesetType>(rulesetTypeIdx));
+        for (const auto& ruleEntry : rangeOf(constOf(ruleset)))
+        {
+            const auto rootNodeIndex = program->compileNode(mapStyle, ruleEntry.value()->getRootNodeRef());
+            program->rulesets[rulesetTypeIdx].insert(ruleEntry.key(), rootNodeIndex);
+        }
+    }
+
+    std::vector<ResolvingState> states(program->nodes.size(), ResolvingState::Unresolved);
+    for (auto nodeIndex = 0u; nodeIndex < program->nodes.size(); nodeIndex++)
+        program->resolveDependsOnObject(static_cast<Index>(nodeIndex), states);
+
+    program->nodes.shrink_to_fit();
+    program->conditions.shrink_to_fit();
+    program->outputs.shrink_to_fit();
+    program->subnodes.shrink_to_fit();
+
+    return program;
+}
+
+OsmAnd::MapStyleProgram::Condition::Condition()
+    : type(ConditionType::IntegerEquals)
+    , valueDefId(-1)
+    , dataType(MapStyleValueDataType::Integer)
+{
+    constant.asInt = 0;
+}
+
+OsmAnd::MapStyleProgram::Condition::~Condition()
+{
+}
+
+OsmAnd::MapStyleProgram::Output::Output()
+    : valueDefId(-1)
+{
+}
+
+OsmAnd::MapStyleProgram::Output::~Output()
+{
+}
+
+OsmAnd::MapStyleProgram::Node::Node()
+    : isSwitch(false)
+    , dependsOnObject(false)
+    , minZoom(std::numeric_limits<int32_t>::min())
+    , maxZoom(std::numeric_limits<int32_t>::max())
+    , firstCondition(0)
+    , conditionsCount(0)
+    , disableOutput(InvalidIndex)
+    , firstOutput(0)
+    , outputsCount(0)
+    , firstOneOfConditionalSubnode(0)
+    , oneOfConditionalSubnodesCount(0)
+    , firstApplySubnode(0)
+    , applySubnodesCount(0)
+{
+}
@@ -8,7 +8,10 @@
 
 #include "MapDataProviderHelpers.h"
 #include "ObfsCollection.h"
+#include "ObfsCollection_P.h"
 #include "ObfDataInterface.h"
+#include "ObfReader.h"
+#include "ObfReader_P.h"
 #include "ObfMapSectionInfo.h"
 #include "ObfMapSectionReader_Metrics.h"
 #include "BinaryMapObject.h"
@@ -20,8 +23,8 @@
 #include "Logging.h"
 
 OsmAnd::ObfMapObjectsProvider_P::ObfMapObjectsProvider_P(ObfMapObjectsProvider* owner_)
-    : _binaryMapObjectsDataBlocksCache(new BinaryMapObjectsDataBlocksCache(false))
-    , _roadsDataBlocksCache(new RoadsDataBlocksCache(false))
+    : _binaryMapObjectsDataBlocksCache(new BinaryMapObjectsDataBlocksCache(true, RetainedBinaryMapObjectsDataBlocksBudget))
+    , _roadsDataBlocksCache(new RoadsDataBlocksCache(true, RetainedRoadsDataBlocksBudget))
     , _link(new Link(this))
     , owner(owner_)
 {
@@ -119,6 +122,7 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainTiledObfMapObjects(
     const auto zoom = request.zoom;
 
     // Obtain OBF data interface
+    const auto selectionTimeBefore = ObfsCollection_P::getSelectionTimeInCurrentThread();
     const Stopwatch obtainObfInterfaceStopwatch(metric != nullptr);
     const auto& dataInterface = owner->obfsCollection->obtainDataInterface(
         &tileBBox31,
@@ -126,7 +130,11 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainTiledObfMapObjects(
         request.zoom,
         ObfDataTypesMask().set(ObfDataType::Map).set(ObfDataType::Routing));
     if (metric)
+    {
         metric->elapsedTimeForObtainingObfInterface += obtainObfInterfaceStopwatch.elapsed();
+        metric->elapsedTimeForObfsSelection += ObfsCollection_P::getSelectionTimeInCurrentThread() - selectionTimeBefore;
+        metric->obfFilesSelected += dataInterface->obfReaders.size();
+    }
 
     // Perform read-out
     const Stopwatch totalReadTimeStopwatch(metric != nullptr);
@@ -425,7 +433,11 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainTiledObfMapObjects(
     }
 
     if (metric)
+    {
         metric->elapsedTimeForRead += totalReadTimeStopwatch.elapsed();
+        for (const auto& obfReader : constOf(dataInterface->obfReaders))
+            metric->obfFilesOpened += obfReader->_p->takeFileOpensCount();
+    }
 
     // Prepare data for the tile
     const auto sharedMapObjectsCount =
@@ -512,9 +524,11 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainTiledObfMapObjects(
 }
 
 OsmAnd::ObfMapObjectsProvider_P::BinaryMapObjectsDataBlocksCache::BinaryMapObjectsDataBlocksCache(
-    const bool cacheTileInnerDataBlocks_)
+    const bool cacheTileInnerDataBlocks_,
+    const size_t retentionBudget)
     : cacheTileInnerDataBlocks(cacheTileInnerDataBlocks_)
 {
+    setRetentionBudget(retentionBudget, &BinaryMapObjectsDataBlocksCache::estimateDataBlockSize);
 }
 
 OsmAnd::ObfMapObjectsProvider_P::BinaryMapObjectsDataBlocksCache::~BinaryMapObjectsDataBlocksCache()
@@ -534,10 +548,27 @@ bool OsmAnd::ObfMapObjectsProvider_P::BinaryMapObjectsDataBlocksCache::shouldCac
     return true;
 }
 
+bool OsmAnd::ObfMapObjectsProvider_P::BinaryMapObjectsDataBlocksCache::shouldDecodeLazily() const
+{
+    // Blocks are cached entirely, while most objects of blocks that cross tile edges are never rendered
+    return true;
+}
+
+size_t OsmAnd::ObfMapObjectsProvider_P::BinaryMapObjectsDataBlocksCache::estimateDataBlockSize(
+    const ResourcePtr& dataBlock)
+{
+    auto size = sizeof(ObfMapSectionReader::DataBlock);
+    for (const auto& mapObject : constOf(dataBlock->mapObjects))
+        size += estimateMapObjectSize(*mapObject);
+    return size;
+}
+
 OsmAnd::ObfMapObjectsProvider_P::RoadsDataBlocksCache::RoadsDataBlocksCache(
-    const bool cacheTileInnerDataBlocks_)
+    const bool cacheTileInnerDataBlocks_,
+    const size_t retentionBudget)
     : cacheTileInnerDataBlocks(cacheTileInnerDataBlocks_)
 {
+    setRetentionBudget(retentionBudget, &RoadsDataBlocksCache::estimateDataBlockSize);
 }
 
 OsmAnd::ObfMapObjectsProvider_P::RoadsDataBlocksCache::~RoadsDataBlocksCache()
@@ -616,3 +647,36 @@ OsmAnd::ObfMapObjectsProvider_P::RetainableCacheMetadata::~RetainableCacheMetada
     referencedBinaryMapObjects.clear();
     referencedRoads.clear();
 }
+
+size_t OsmAnd::ObfMapObjectsProvider_P::RoadsDataBlocksCache::estimateDataBlockSize(
+    const ResourcePtr& dataBlock)
+{
+    auto size = sizeof(ObfRoutingSectionReader::DataBlock);
+    for (const auto& road : constOf(dataBlock->roads))
+        size += estimateMapObjectSize(*road);
+    return size;
+}
+
+size_t OsmAnd::ObfMapObjectsProvider_P::estimateMapObjectSize(const BinaryMapObject& mapObject)
+{
+    return sizeof(BinaryMapObject) + estimateMapObjectDataSize(mapObject);
+}
+
+size_t OsmAnd::ObfMapObjectsProvider_P::estimateMapObjectSize(const Road& road)
+{
+    auto size = sizeof(Road) + estimateMapObjectDataSize(road);
+    for (const auto& pointTypes : constOf(road.pointsTypes))
+        size += sizeof(uint32_t) + sizeof(QVector<uint32_t>) + pointTypes.size() * sizeof(uint32_t);
+    size += road.restrictions.size() * (sizeof(ObfObjectId) + sizeof(RoadRestriction));
+    return size;
+}
+
+size_t OsmAnd::ObfMapObjectsProvider_P::estimateMapObjectDataSize(const MapObject& mapObject)
+{
+    // Only what's always decoded is accounted: captions and inner polygons may be still encoded,
+    // and must not be touched from here
+    return
+        mapObject.points31.size() * sizeof(PointI) +
+        (mapObject.attributeIds.size() + mapObject.additionalAttributeIds.size()) * sizeof(uint32_t) +
+        mapObject.captionsOrder.size() * (sizeof(uint32_t) + sizeof(QString));
+}
@@ -18,6 +18,7 @@
 #include "IMapTiledDataProvider.h"
 #include "TiledEntriesCollection.h"
 #include "SharedByZoomResourcesContainer.h"
+#include "StripedSharedResourcesContainer.h"
 #include "ObfMapSectionReader.h"
 #include "ObfRoutingSectionReader.h"
 #include "ObfMapObjectsProvider.h"
@@ -25,6 +26,7 @@
 
 namespace OsmAnd
 {
+    class MapObject;
     class BinaryMapObject;
     class Road;
 
@@ -34,13 +36,23 @@ namespace OsmAnd
     protected:
         ObfMapObjectsProvider_P(ObfMapObjectsProvider* owner);
 
+        // Budgets of data blocks that are kept after last tile that referenced them is released,
+        // so that panning back to recently visited area doesn't read same data again
+        enum : size_t {
+            RetainedBinaryMapObjectsDataBlocksBudget = 32 * 1024 * 1024,
+            RetainedRoadsDataBlocksBudget = 16 * 1024 * 1024,
+        };
+        static size_t estimateMapObjectSize(const BinaryMapObject& mapObject);
+        static size_t estimateMapObjectSize(const Road& road);
+        static size_t estimateMapObjectDataSize(const MapObject& mapObject);
+
         class BinaryMapObjectsDataBlocksCache : public ObfMapSectionReader::DataBlocksCache
         {
             Q_DISABLE_COPY_AND_MOVE(BinaryMapObjectsDataBlocksCache);
         private:
         protected:
         public:
-            BinaryMapObjectsDataBlocksCache(const bool cacheTileInnerDataBlocks);
+            BinaryMapObjectsDataBlocksCache(const bool cacheTileInnerDataBlocks, const size_t retentionBudget);
             virtual ~BinaryMapObjectsDataBlocksCache();
 
             const bool cacheTileInnerDataBlocks;
@@ -49,9 +61,12 @@ namespace OsmAnd
                 const DataBlockId id,
                 const AreaI blockBBox31,
                 const AreaI* const queryArea31 = nullptr) const;
+            virtual bool shouldDecodeLazily() const;
+
+            static size_t estimateDataBlockSize(const ResourcePtr& dataBlock);
         };
         const std::shared_ptr<ObfMapSectionReader::DataBlocksCache> _binaryMapObjectsDataBlocksCache;
-        mutable SharedByZoomResourcesContainer<ObfObjectId, const BinaryMapObject> _sharedBinaryMapObjects;
+        mutable StripedSharedResourcesContainer< SharedByZoomResourcesContainer<ObfObjectId, const BinaryMapObject> > _sharedBinaryMapObjects;
 
         class RoadsDataBlocksCache : public ObfRoutingSectionReader::DataBlocksCache
         {
@@ -59,7 +74,7 @@ namespace OsmAnd
         private:
         protected:
         public:
-            RoadsDataBlocksCache(const bool cacheTileInnerDataBlocks);
+            RoadsDataBlocksCache(const bool cacheTileInnerDataBlocks, const size_t retentionBudget);
             virtual ~RoadsDataBlocksCache();
 
             const bool cacheTileInnerDataBlocks;
@@ -69,9 +84,11 @@ namespace OsmAnd
                 const RoutingDataLevel dataLevel,
                 const AreaI blockBBox31,
                 const AreaI* const queryArea31 = nullptr) const;
+
+            static size_t estimateDataBlockSize(const ResourcePtr& dataBlock);
         };
         const std::shared_ptr<ObfRoutingSectionReader::DataBlocksCache> _roadsDataBlocksCache;
-        mutable SharedResourcesContainer<ObfObjectId, const Road> _sharedRoads;
+        mutable StripedSharedResourcesContainer< SharedResourcesContainer<ObfObjectId, const Road> > _sharedRoads;
 
         enum class TileState
         {
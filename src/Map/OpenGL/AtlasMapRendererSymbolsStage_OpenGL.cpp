@@ -628,7 +628,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath2D()
         4 /*param_vs_mPerspectiveProjectionView*/ +
         1 /*param_vs_glyphHeight*/ +
         1 /*param_vs_zDistanceFromCamera*/;
-    _onPathSymbol2dMaxGlyphsPerDrawCall = (gpuAPI->maxVertexUniformVectors - alreadyOccupiedUniforms) / 5;
+    _onPathSymbol2dMaxGlyphsPerDrawCall = (gpuAPI->maxVertexUniformVectors - alreadyOccupiedUniforms) / 4;
     if (initializeOnPath2DProgram(_onPathSymbol2dMaxGlyphsPerDrawCall))
     {
         LogPrintf(LogSeverityLevel::Info,
@@ -794,8 +794,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath2DProgram(cons
         "    vec2 anchorPoint;                                                                                              ""\n"
         "    float width;                                                                                                   ""\n"
         "    float angle;                                                                                                   ""\n"
-        "    float widthOfPreviousN;                                                                                        ""\n"
-        "    float widthN;                                                                                                  ""\n"
+        "    vec4 texCoordsOffsetAndScale;                                                                                  ""\n"
         "};                                                                                                                 ""\n"
         "uniform Glyph param_vs_glyphs[%MaxGlyphsPerDrawCall%];                                                             ""\n"
         "                                                                                                                   ""\n"
@@ -838,8 +837,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath2DProgram(cons
         "    gl_Position = param_vs_mOrthographicProjection * vertexOnScreen;                                               ""\n"
         "                                                                                                                   ""\n"
         // Prepare texture coordinates
-        "    v2f_texCoords.s = glyph.widthOfPreviousN + in_vs_vertexTexCoords.s*glyph.widthN;                               ""\n"
-        "    v2f_texCoords.t = in_vs_vertexTexCoords.t; // Height is compatible as-is                                       ""\n"
+        "    v2f_texCoords = glyph.texCoordsOffsetAndScale.xy + in_vs_vertexTexCoords*glyph.texCoordsOffsetAndScale.zw;     ""\n"
         "}                                                                                                                  ""\n");
     auto preprocessedVertexShader = vertexShader;
     preprocessedVertexShader.replace("%MaxGlyphsPerDrawCall%", QString::number(maxGlyphsPerDrawCall));
@@ -914,8 +912,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath2DProgram(cons
         ok = ok && lookup->lookupLocation(glyph.anchorPoint, glyphStructPrefix + ".anchorPoint", GlslVariableType::Uniform);
         ok = ok && lookup->lookupLocation(glyph.width, glyphStructPrefix + ".width", GlslVariableType::Uniform);
         ok = ok && lookup->lookupLocation(glyph.angle, glyphStructPrefix + ".angle", GlslVariableType::Uniform);
-        ok = ok && lookup->lookupLocation(glyph.widthOfPreviousN, glyphStructPrefix + ".widthOfPreviousN", GlslVariableType::Uniform);
-        ok = ok && lookup->lookupLocation(glyph.widthN, glyphStructPrefix + ".widthN", GlslVariableType::Uniform);
+        ok = ok && lookup->lookupLocation(glyph.texCoordsOffsetAndScale, glyphStructPrefix + ".texCoordsOffsetAndScale", GlslVariableType::Uniform);
     }
     ok = ok && lookup->lookupLocation(_onPath2dProgram.fs.param.sampler, "param_fs_sampler", GlslVariableType::Uniform);
     ok = ok && lookup->lookupLocation(_onPath2dProgram.fs.param.modulationColor, "param_fs_modulationColor", GlslVariableType::Uniform);
@@ -945,7 +942,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath3D()
         4 /*param_vs_mPerspectiveProjectionView*/ +
         1 /*param_vs_glyphHeight*/ +
         1 /*param_vs_zDistanceFromCamera*/;
-    _onPathSymbol3dMaxGlyphsPerDrawCall = (gpuAPI->maxVertexUniformVectors - alreadyOccupiedUniforms) / 5;
+    _onPathSymbol3dMaxGlyphsPerDrawCall = (gpuAPI->maxVertexUniformVectors - alreadyOccupiedUniforms) / 4;
     if (initializeOnPath3DProgram(_onPathSymbol3dMaxGlyphsPerDrawCall))
     {
         LogPrintf(LogSeverityLevel::Info,
@@ -1111,8 +1108,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath3DProgram(cons
         "    vec2 anchorPoint;                                                                                              ""\n"
         "    float width;                                                                                                   ""\n"
         "    float angle;                                                                                                   ""\n"
-        "    float widthOfPreviousN;                                                                                        ""\n"
-        "    float widthN;                                                                                                  ""\n"
+        "    vec4 texCoordsOffsetAndScale;                                                                                  ""\n"
         "};                                                                                                                 ""\n"
         "uniform Glyph param_vs_glyphs[%MaxGlyphsPerDrawCall%];                                                             ""\n"
         "                                                                                                                   ""\n"
@@ -1135,8 +1131,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath3DProgram(cons
         "    gl_Position.z = param_vs_zDistanceFromCamera;                                                                  ""\n"
         "                                                                                                                   ""\n"
         // Prepare texture coordinates
-        "    v2f_texCoords.s = glyph.widthOfPreviousN + in_vs_vertexTexCoords.s*glyph.widthN;                               ""\n"
-        "    v2f_texCoords.t = in_vs_vertexTexCoords.t; // Height is compatible as-is                                       ""\n"
+        "    v2f_texCoords = glyph.texCoordsOffsetAndScale.xy + in_vs_vertexTexCoords*glyph.texCoordsOffsetAndScale.zw;     ""\n"
         "}                                                                                                                  ""\n");
     auto preprocessedVertexShader = vertexShader;
     preprocessedVertexShader.replace("%MaxGlyphsPerDrawCall%", QString::number(maxGlyphsPerDrawCall));
@@ -1211,8 +1206,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::initializeOnPath3DProgram(cons
         ok = ok && lookup->lookupLocation(glyph.anchorPoint, glyphStructPrefix + ".anchorPoint", GlslVariableType::Uniform);
         ok = ok && lookup->lookupLocation(glyph.width, glyphStructPrefix + ".width", GlslVariableType::Uniform);
         ok = ok && lookup->lookupLocation(glyph.angle, glyphStructPrefix + ".angle", GlslVariableType::Uniform);
-        ok = ok && lookup->lookupLocation(glyph.widthOfPreviousN, glyphStructPrefix + ".widthOfPreviousN", GlslVariableType::Uniform);
-        ok = ok && lookup->lookupLocation(glyph.widthN, glyphStructPrefix + ".widthN", GlslVariableType::Uniform);
+        ok = ok && lookup->lookupLocation(glyph.texCoordsOffsetAndScale, glyphStructPrefix + ".texCoordsOffsetAndScale", GlslVariableType::Uniform);
     }
     ok = ok && lookup->lookupLocation(_onPath3dProgram.fs.param.sampler, "param_fs_sampler", GlslVariableType::Uniform);
     ok = ok && lookup->lookupLocation(_onPath3dProgram.fs.param.modulationColor, "param_fs_modulationColor", GlslVariableType::Uniform);
@@ -1278,7 +1272,8 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::renderOnPath2dSymbol(
         .arg(qPrintable(symbol->content)));
 
     // Set glyph height
-    glUniform1f(_onPath2dProgram.vs.param.glyphHeight, gpuResource->height);
+    const auto glyphHeight = symbol->glyphRun ? symbol->glyphRun->cellHeight : gpuResource->height;
+    glUniform1f(_onPath2dProgram.vs.param.glyphHeight, glyphHeight);
     GL_CHECK_RESULT;
 
     // Set distance from camera to symbol
@@ -1319,51 +1314,69 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::renderOnPath2dSymbol(
         symbol->modulationColor.a);
     GL_CHECK_RESULT;
 
-    // Draw chains of glyphs
-    const auto glyphsCount = renderable->glyphsPlacement.size();
-    unsigned int glyphsDrawn = 0;
-    auto pGlyph = renderable->glyphsPlacement.constData();
+    // Glyphs of glyph run are drawn cell by cell from page of glyph atlas, each cell centered at placement of its
+    // glyph. Otherwise texture contains entire text, that is sliced by widths of glyphs.
+    const auto& glyphRun = symbol->glyphRun;
+    const auto& glyphsPlacement = renderable->glyphsPlacement;
+    const auto quadsCount = glyphRun
+        ? (glyphsPlacement.size() == glyphRun->glyphsWidth.size() ? glyphRun->cells.size() : 0)
+        : glyphsPlacement.size();
+    unsigned int quadsDrawn = 0;
+    auto pGlyph = glyphsPlacement.constData();
+    auto pCell = glyphRun ? glyphRun->cells.constData() : nullptr;
     const auto pFirstGlyphVS = _onPath2dProgram.vs.param.glyphs.constData();
     float widthOfPreviousN = 0.0f;
-    while (glyphsDrawn < glyphsCount)
+    while (quadsDrawn < quadsCount)
     {
-        const auto glyphsToDraw = qMin(glyphsCount - glyphsDrawn, _onPathSymbol2dMaxGlyphsPerDrawCall);
+        const auto quadsToDraw = qMin(quadsCount - quadsDrawn, _onPathSymbol2dMaxGlyphsPerDrawCall);
         auto pGlyphVS = pFirstGlyphVS;
 
-        for (auto glyphIdx = 0; glyphIdx < glyphsToDraw; glyphIdx++)
+        for (auto quadIdx = 0; quadIdx < quadsToDraw; quadIdx++)
         {
-            const auto& glyph = *(pGlyph++);
+            const auto& glyph = pCell ? glyphsPlacement[pCell->glyphIndex] : *(pGlyph++);
             const auto& vsGlyph = *(pGlyphVS++);
 
+            auto width = glyph.width;
+            glm::vec4 texCoordsOffsetAndScale;
+            if (pCell)
+            {
+                const auto& cellArea = (pCell++)->area;
+                width = cellArea.width();
+                texCoordsOffsetAndScale = glm::vec4(
+                    cellArea.left()*gpuResource->uTexelSizeN,
+                    cellArea.top()*gpuResource->vTexelSizeN,
+                    cellArea.width()*gpuResource->uTexelSizeN,
+                    cellArea.height()*gpuResource->vTexelSizeN);
+            }
+            else
+            {
+                const auto widthN = glyph.width*gpuResource->uTexelSizeN;
+                texCoordsOffsetAndScale = glm::vec4(widthOfPreviousN, 0.0f, widthN, 1.0f);
+                widthOfPreviousN += widthN;
+            }
+
             // Set anchor point of glyph
             glUniform2fv(vsGlyph.anchorPoint, 1, glm::value_ptr(glyph.anchorPoint));
             GL_CHECK_RESULT;
 
             // Set glyph width
-            glUniform1f(vsGlyph.width, glyph.width);
+            glUniform1f(vsGlyph.width, width);
             GL_CHECK_RESULT;
 
             // Set angle
             glUniform1f(vsGlyph.angle, glyph.angle);
             GL_CHECK_RESULT;
 
-            // Set normalized width of all previous glyphs
-            glUniform1f(vsGlyph.widthOfPreviousN, widthOfPreviousN);
-            GL_CHECK_RESULT;
-
-            // Set normalized width of this glyph
-            const auto widthN = glyph.width*gpuResource->uTexelSizeN;
-            glUniform1f(vsGlyph.widthN, widthN);
+            // Set offset and scale of texture coordinates of glyph
+            glUniform4fv(vsGlyph.texCoordsOffsetAndScale, 1, glm::value_ptr(texCoordsOffsetAndScale));
             GL_CHECK_RESULT;
-
-            widthOfPreviousN += widthN;
         }
 
         // Draw chain of glyphs actually
-        glDrawElements(GL_TRIANGLES, 6 * glyphsToDraw, GL_UNSIGNED_SHORT, nullptr);
+        glDrawElements(GL_TRIANGLES, 6 * quadsToDraw, GL_UNSIGNED_SHORT, nullptr);
         GL_CHECK_RESULT;
 
-        glyphsDrawn += glyphsToDraw;
+        quadsDrawn += quadsToDraw;
     }
 
     GL_POP_GROUP_MARKER;
@@ -1421,7 +1434,8 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::renderOnPath3dSymbol(
         .arg(qPrintable(symbol->content)));
 
     // Set glyph height
-    glUniform1f(_onPath3dProgram.vs.param.glyphHeight, gpuResource->height*internalState.pixelInWorldProjectionScale);
+    const auto glyphHeight = symbol->glyphRun ? symbol->glyphRun->cellHeight : gpuResource->height;
+    glUniform1f(_onPath3dProgram.vs.param.glyphHeight, glyphHeight*internalState.pixelInWorldProjectionScale);
     GL_CHECK_RESULT;
 
     // Set distance from camera
@@ -1463,51 +1477,69 @@ bool OsmAnd::AtlasMapRendererSymbolsStage_OpenGL::renderOnPath3dSymbol(
     // Apply settings from texture block to texture
     gpuAPI->applyTextureBlockToTexture(GL_TEXTURE_2D, GL_TEXTURE0 + 0);
 
-    // Draw chains of glyphs
-    const auto glyphsCount = renderable->glyphsPlacement.size();
-    unsigned int glyphsDrawn = 0;
-    auto pGlyph = renderable->glyphsPlacement.constData();
+    // Glyphs of glyph run are drawn cell by cell from page of glyph atlas, each cell centered at placement of its
+    // glyph. Otherwise texture contains entire text, that is sliced by widths of glyphs.
+    const auto& glyphRun = symbol->glyphRun;
+    const auto& glyphsPlacement = renderable->glyphsPlacement;
+    const auto quadsCount = glyphRun
+        ? (glyphsPlacement.size() == glyphRun->glyphsWidth.size() ? glyphRun->cells.size() : 0)
+        : glyphsPlacement.size();
+    unsigned int quadsDrawn = 0;
+    auto pGlyph = glyphsPlacement.constData();
+    auto pCell = glyphRun ? glyphRun->cells.constData() : nullptr;
     const auto pFirstGlyphVS = _onPath3dProgram.vs.param.glyphs.constData();
     float widthOfPreviousN = 0.0f;
-    while (glyphsDrawn < glyphsCount)
+    while (quadsDrawn < quadsCount)
     {
-        const auto glyphsToDraw = qMin(glyphsCount - glyphsDrawn, _onPathSymbol3dMaxGlyphsPerDrawCall);
+        const auto quadsToDraw = qMin(quadsCount - quadsDrawn, _onPathSymbol3dMaxGlyphsPerDrawCall);
         auto pGlyphVS = pFirstGlyphVS;
 
-        for (auto glyphIdx = 0; glyphIdx < glyphsToDraw; glyphIdx++)
+        for (auto quadIdx = 0; quadIdx < quadsToDraw; quadIdx++)
         {
-            const auto& glyph = *(pGlyph++);
+            const auto& glyph = pCell ? glyphsPlacement[pCell->glyphIndex] : *(pGlyph++);
             const auto& vsGlyph = *(pGlyphVS++);
 
+            auto width = glyph.width;
+            glm::vec4 texCoordsOffsetAndScale;
+            if (pCell)
+            {
+                const auto& cellArea = (pCell++)->area;
+                width = cellArea.width();
+                texCoordsOffsetAndScale = glm::vec4(
+                    cellArea.left()*gpuResource->uTexelSizeN,
+                    cellArea.top()*gpuResource->vTexelSizeN,
+                    cellArea.width()*gpuResource->uTexelSizeN,
+                    cellArea.height()*gpuResource->vTexelSizeN);
+            }
+            else
+            {
+                const auto widthN = glyph.width*gpuResource->uTexelSizeN;
+                texCoordsOffsetAndScale = glm::vec4(widthOfPreviousN, 0.0f, widthN, 1.0f);
+                widthOfPreviousN += widthN;
+            }
+
             // Set anchor point of glyph
             glUniform2fv(vsGlyph.anchorPoint, 1, glm::value_ptr(glyph.anchorPoint));
             GL_CHECK_RESULT;
 
             // Set glyph width
-            glUniform1f(vsGlyph.width, glyph.width*internalState.pixelInWorldProjectionScale);
+            glUniform1f(vsGlyph.width, width*internalState.pixelInWorldProjectionScale);
             GL_CHECK_RESULT;
 
             // Set angle
             glUniform1f(vsGlyph.angle, Utilities::normalizedAngleRadians(glyph.angle + M_PI));
             GL_CHECK_RESULT;
 
-            // Set normalized width of all previous glyphs
-            glUniform1f(vsGlyph.widthOfPreviousN, widthOfPreviousN);
-            GL_CHECK_RESULT;
-
-            // Set normalized width of this glyph
-            const auto widthN = glyph.width*gpuResource->uTexelSizeN;
-            glUniform1f(vsGlyph.widthN, widthN);
+            // Set offset and scale of texture coordinates of glyph
+            glUniform4fv(vsGlyph.texCoordsOffsetAndScale, 1, glm::value_ptr(texCoordsOffsetAndScale));
             GL_CHECK_RESULT;
-
-            widthOfPreviousN += widthN;
         }
 
         // Draw chain of glyphs actually
-        glDrawElements(GL_TRIANGLES, 6 * glyphsToDraw, GL_UNSIGNED_SHORT, nullptr);
+        glDrawElements(GL_TRIANGLES, 6 * quadsToDraw, GL_UNSIGNED_SHORT, nullptr);
         GL_CHECK_RESULT;
 
-        glyphsDrawn += glyphsToDraw;
+        quadsDrawn += quadsToDraw;
     }
 
     GL_POP_GROUP_MARKER;
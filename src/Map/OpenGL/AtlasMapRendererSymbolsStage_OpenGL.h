@@ -81,8 +81,7 @@ namespace OsmAnd
             GLlocation anchorPoint;
             GLlocation width;
             GLlocation angle;
-            GLlocation widthOfPreviousN;
-            GLlocation widthN;
+            GLlocation texCoordsOffsetAndScale;
         };
         GLname _onPathSymbol2dVAO;
         GLname _onPathSymbol2dVBO;
@@ -37,7 +37,8 @@
 #endif
 
 OsmAnd::GPUAPI_OpenGL::GPUAPI_OpenGL()
-    : _vaoSimulationLastUnusedId(1)
+    : _sharedSymbolTexturesCleanupThreshold(64)
+    , _vaoSimulationLastUnusedId(1)
     , _glVersion(0)
     , _glslVersion(0)
     , _maxTextureSize(0)
@@ -1166,6 +1167,22 @@ bool OsmAnd::GPUAPI_OpenGL::uploadSymbolAsTextureToGPU(
     GL_CHECK_PRESENT(glGenerateMipmap);
     GL_CHECK_PRESENT(glTexParameteri);
 
+    // Reuse texture of other symbol with same bitmap, if it's still valid
+    {
+        QMutexLocker scopedLocker(&_sharedSymbolTexturesMutex);
+
+        const auto citSharedTexture = _sharedSymbolTextures.constFind(symbol->bitmap.get());
+        if (citSharedTexture != _sharedSymbolTextures.cend() && citSharedTexture->bitmap.lock() == symbol->bitmap)
+        {
+            const auto texture = citSharedTexture->texture.lock();
+            if (texture && texture->refInGPU)
+            {
+                resourceInGPU = texture;
+                return true;
+            }
+        }
+    }
+
     // Determine texture properties:
     auto alphaChannelType = AlphaChannelType::Invalid;
     GLsizei sourcePixelByteSize = 0;
@@ -1256,6 +1273,28 @@ bool OsmAnd::GPUAPI_OpenGL::uploadSymbolAsTextureToGPU(
         1,
         alphaChannelType));
 
+    {
+        QMutexLocker scopedLocker(&_sharedSymbolTexturesMutex);
+
+        // Most bitmaps are released right after upload, so entries of them are removed from time to time
+        if (_sharedSymbolTextures.size() >= _sharedSymbolTexturesCleanupThreshold)
+        {
+            auto itSharedTexture = mutableIteratorOf(_sharedSymbolTextures);
+            while (itSharedTexture.hasNext())
+            {
+                const auto& sharedTexture = itSharedTexture.next().value();
+                if (sharedTexture.bitmap.expired() || sharedTexture.texture.expired())
+                    itSharedTexture.remove();
+            }
+            _sharedSymbolTexturesCleanupThreshold = qMax(64, 2 * _sharedSymbolTextures.size());
+        }
+
+        SharedSymbolTexture sharedTexture;
+        sharedTexture.bitmap = symbol->bitmap;
+        sharedTexture.texture = resourceInGPU;
+        _sharedSymbolTextures.insert(symbol->bitmap.get(), sharedTexture);
+    }
+
     return true;
 }
 
@@ -13,6 +13,7 @@
 #include <QString>
 #include <QVector>
 #include <QHash>
+#include <QMutex>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -212,6 +213,16 @@ namespace OsmAnd
         bool uploadSymbolAsTextureToGPU(const std::shared_ptr< const RasterMapSymbol >& symbol, std::shared_ptr< const ResourceInGPU >& resourceInGPU);
         bool uploadSymbolAsMeshToGPU(const std::shared_ptr< const VectorMapSymbol >& symbol, std::shared_ptr< const ResourceInGPU >& resourceInGPU);
 
+        // Symbols that share same bitmap (like page of glyph atlas) share texture as well
+        struct SharedSymbolTexture
+        {
+            std::weak_ptr<const SkBitmap> bitmap;
+            std::weak_ptr<const ResourceInGPU> texture;
+        };
+        QMutex _sharedSymbolTexturesMutex;
+        QHash<const SkBitmap*, SharedSymbolTexture> _sharedSymbolTextures;
+        int _sharedSymbolTexturesCleanupThreshold;
+
         GLuint _vaoSimulationLastUnusedId;
         struct SimulatedVAO
         {
@@ -91,6 +91,11 @@ QString OsmAnd::ResolvedMapStyle::getStringById(const StringId id) const
     return _p->getStringById(id);
 }
 
+std::shared_ptr<const OsmAnd::MapStyleProgram> OsmAnd::ResolvedMapStyle::getProgram() const
+{
+    return _p->getProgram();
+}
+
 std::shared_ptr<const OsmAnd::ResolvedMapStyle> OsmAnd::ResolvedMapStyle::resolveMapStylesChain(
     const QList< std::shared_ptr<const UnresolvedMapStyle> >& unresolvedMapStylesChain)
 {
@@ -425,6 +425,9 @@ bool OsmAnd::ResolvedMapStyle_P::resolve()
     if (!mergeAndResolveRulesets())
         return false;
 
+    // Style is immutable from now on, so it's compiled once for all evaluators
+    _program = MapStyleProgram::compile(*owner);
+
     return true;
 }
 
@@ -518,3 +521,8 @@ QString OsmAnd::ResolvedMapStyle_P::getStringById(const StringId id) const
         return QString::null;
     return _stringsForwardLUT[id];
 }
+
+std::shared_ptr<const OsmAnd::MapStyleProgram> OsmAnd::ResolvedMapStyle_P::getProgram() const
+{
+    return _program;
+}
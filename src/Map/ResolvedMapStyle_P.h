@@ -15,6 +15,7 @@
 #include "PrivateImplementation.h"
 #include "UnresolvedMapStyle.h"
 #include "ResolvedMapStyle.h"
+#include "MapStyleProgram.h"
 
 namespace OsmAnd
 {
@@ -79,6 +80,7 @@ namespace OsmAnd
         QHash<StringId, std::shared_ptr<const IMapStyle::IParameter> > _parameters;
         QHash<StringId, std::shared_ptr<const IMapStyle::IAttribute> > _attributes;
         std::array< QHash<TagValueId, std::shared_ptr<const IMapStyle::IRule> >, MapStyleRulesetTypesCount> _rulesets;
+        std::shared_ptr<const MapStyleProgram> _program;
     public:
         virtual ~ResolvedMapStyle_P();
 
@@ -108,6 +110,8 @@ namespace OsmAnd
 
         QString getStringById(const StringId id) const;
 
+        std::shared_ptr<const MapStyleProgram> getProgram() const;
+
     friend class OsmAnd::ResolvedMapStyle;
     };
 }
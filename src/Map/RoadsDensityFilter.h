@@ -0,0 +1,238 @@
+#ifndef _OSMAND_CORE_ROADS_DENSITY_FILTER_H_
+#define _OSMAND_CORE_ROADS_DENSITY_FILTER_H_
+
+#include "stdlib_common.h"
+#include <limits>
+#include <vector>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QVector>
+#include <QHash>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define OSMAND_ROADS_DENSITY_SSE2 1
+#   define OSMAND_ROADS_DENSITY_NEON 0
+#   include "ignore_warnings_on_external_includes.h"
+#   include <emmintrin.h>
+#   include "restore_internal_warnings.h"
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define OSMAND_ROADS_DENSITY_SSE2 0
+#   define OSMAND_ROADS_DENSITY_NEON 1
+#   include "ignore_warnings_on_external_includes.h"
+#   include <arm_neon.h>
+#   include "restore_internal_warnings.h"
+#else
+#   define OSMAND_ROADS_DENSITY_SSE2 0
+#   define OSMAND_ROADS_DENSITY_NEON 0
+#endif
+
+namespace OsmAnd
+{
+    // RoadsDensityFilter limits number of roads per cell of grid at zoom of tile increased by density zoom.
+    // Roads are checked in order they were added: road is accepted if it enters at least one cell that has less
+    // roads than limit, and it's counted in each such cell. Consecutive points in same cell enter it once.
+    // Cells of all points of a road are computed at once when road is added, and counters are kept in a flat
+    // grid that covers all added roads (or in a hash, if such grid would be too large).
+    class RoadsDensityFilter Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(RoadsDensityFilter);
+    public:
+        enum : unsigned int {
+            MaxGridCellsCount = 1u << 18,
+        };
+
+    private:
+        // Cell of each point of all roads, as (x, y) pairs
+        std::vector<int32_t> _cells;
+        // Index of first point of next road in cells, for each road
+        std::vector<size_t> _roadsEnds;
+        int32_t _minCellX;
+        int32_t _minCellY;
+        int32_t _maxCellX;
+        int32_t _maxCellY;
+
+#if OSMAND_ROADS_DENSITY_SSE2
+        static inline __m128i selectMin(const __m128i a, const __m128i b)
+        {
+            const auto aIsGreater = _mm_cmpgt_epi32(a, b);
+            return _mm_or_si128(_mm_and_si128(aIsGreater, b), _mm_andnot_si128(aIsGreater, a));
+        }
+
+        static inline __m128i selectMax(const __m128i a, const __m128i b)
+        {
+            const auto aIsGreater = _mm_cmpgt_epi32(a, b);
+            return _mm_or_si128(_mm_and_si128(aIsGreater, a), _mm_andnot_si128(aIsGreater, b));
+        }
+#endif // OSMAND_ROADS_DENSITY_SSE2
+    protected:
+    public:
+        inline RoadsDensityFilter(
+            const ZoomLevel zoom,
+            const unsigned int densityZoom,
+            const unsigned int densityLimit_)
+            : _minCellX(std::numeric_limits<int32_t>::max())
+            , _minCellY(std::numeric_limits<int32_t>::max())
+            , _maxCellX(std::numeric_limits<int32_t>::min())
+            , _maxCellY(std::numeric_limits<int32_t>::min())
+            , cellZoom(qMin(static_cast<unsigned int>(zoom) + densityZoom, static_cast<unsigned int>(MaxZoomLevel)))
+            , densityLimit(densityLimit_)
+        {
+        }
+
+        inline ~RoadsDensityFilter()
+        {
+        }
+
+        const unsigned int cellZoom;
+        const unsigned int densityLimit;
+
+        inline void addRoad(const QVector<PointI>& points31)
+        {
+            const auto shift = static_cast<int>(MaxZoomLevel - cellZoom);
+            const auto valuesCount = static_cast<size_t>(points31.size()) * 2;
+            const auto offset = _cells.size();
+            _cells.resize(offset + valuesCount);
+
+            // Points are (x, y) pairs of int32, so both coordinates are shifted same way
+            const auto pSrc = reinterpret_cast<const int32_t*>(points31.constData());
+            const auto pDst = _cells.data() + offset;
+            size_t valueIdx = 0;
+
+#if OSMAND_ROADS_DENSITY_SSE2
+            // 4 points at once
+            const auto shiftCount = _mm_cvtsi32_si128(shift);
+            auto cellMin = _mm_setr_epi32(_minCellX, _minCellY, _minCellX, _minCellY);
+            auto cellMax = _mm_setr_epi32(_maxCellX, _maxCellY, _maxCellX, _maxCellY);
+            for (; valueIdx + 8 <= valuesCount; valueIdx += 8)
+            {
+                const auto cells0 = _mm_sra_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + valueIdx)),
+                    shiftCount);
+                const auto cells1 = _mm_sra_epi32(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + valueIdx + 4)),
+                    shiftCount);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + valueIdx), cells0);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + valueIdx + 4), cells1);
+
+                cellMin = selectMin(cellMin, selectMin(cells0, cells1));
+                cellMax = selectMax(cellMax, selectMax(cells0, cells1));
+            }
+
+            // Reduce both interleaved cells
+            cellMin = selectMin(cellMin, _mm_srli_si128(cellMin, 8));
+            cellMax = selectMax(cellMax, _mm_srli_si128(cellMax, 8));
+            _minCellX = _mm_cvtsi128_si32(cellMin);
+            _minCellY = _mm_cvtsi128_si32(_mm_srli_si128(cellMin, 4));
+            _maxCellX = _mm_cvtsi128_si32(cellMax);
+            _maxCellY = _mm_cvtsi128_si32(_mm_srli_si128(cellMax, 4));
+#elif OSMAND_ROADS_DENSITY_NEON
+            // 4 points at once
+            const auto shiftCount = vdupq_n_s32(-shift);
+            const int32_t initialMin[4] = { _minCellX, _minCellY, _minCellX, _minCellY };
+            const int32_t initialMax[4] = { _maxCellX, _maxCellY, _maxCellX, _maxCellY };
+            auto cellMin = vld1q_s32(initialMin);
+            auto cellMax = vld1q_s32(initialMax);
+            for (; valueIdx + 8 <= valuesCount; valueIdx += 8)
+            {
+                const auto cells0 = vshlq_s32(vld1q_s32(pSrc + valueIdx), shiftCount);
+                const auto cells1 = vshlq_s32(vld1q_s32(pSrc + valueIdx + 4), shiftCount);
+                vst1q_s32(pDst + valueIdx, cells0);
+                vst1q_s32(pDst + valueIdx + 4, cells1);
+
+                cellMin = vminq_s32(cellMin, vminq_s32(cells0, cells1));
+                cellMax = vmaxq_s32(cellMax, vmaxq_s32(cells0, cells1));
+            }
+
+            // Reduce both interleaved cells
+            const auto reducedMin = vmin_s32(vget_low_s32(cellMin), vget_high_s32(cellMin));
+            const auto reducedMax = vmax_s32(vget_low_s32(cellMax), vget_high_s32(cellMax));
+            _minCellX = vget_lane_s32(reducedMin, 0);
+            _minCellY = vget_lane_s32(reducedMin, 1);
+            _maxCellX = vget_lane_s32(reducedMax, 0);
+            _maxCellY = vget_lane_s32(reducedMax, 1);
+#endif
+
+            for (; valueIdx < valuesCount; valueIdx += 2)
+            {
+                const auto cellX = pSrc[valueIdx + 0] >> shift;
+                const auto cellY = pSrc[valueIdx + 1] >> shift;
+                pDst[valueIdx + 0] = cellX;
+                pDst[valueIdx + 1] = cellY;
+
+                _minCellX = qMin(_minCellX, cellX);
+                _minCellY = qMin(_minCellY, cellY);
+                _maxCellX = qMax(_maxCellX, cellX);
+                _maxCellY = qMax(_maxCellY, cellY);
+            }
+
+            _roadsEnds.push_back(_cells.size() / 2);
+        }
+
+        inline int getRoadsCount() const
+        {
+            return static_cast<int>(_roadsEnds.size());
+        }
+
+        // Fills one flag per road, in order roads were added, that is non-zero if road is rejected.
+        // Returns number of rejected roads.
+        inline int filter(std::vector<uint8_t>& outRejectFlags) const
+        {
+            const auto roadsCount = _roadsEnds.size();
+            outRejectFlags.assign(roadsCount, 0);
+            if (roadsCount == 0)
+                return 0;
+
+            // Grid covers all cells of all roads
+            const auto gridWidth = static_cast<int64_t>(_maxCellX) - _minCellX + 1;
+            const auto gridHeight = static_cast<int64_t>(_maxCellY) - _minCellY + 1;
+            const auto useGrid = (gridWidth * gridHeight <= MaxGridCellsCount);
+            std::vector<uint32_t> gridCounters(useGrid ? static_cast<size_t>(gridWidth * gridHeight) : 0, 0);
+            QHash<uint64_t, uint32_t> hashCounters;
+
+            auto rejectedCount = 0;
+            const auto pCells = _cells.data();
+            size_t pointIdx = 0;
+            for (size_t roadIdx = 0; roadIdx < roadsCount; roadIdx++)
+            {
+                auto accept = false;
+
+                // First point of a road does not enter cell (0, 0), which only matters at corner of the world
+                int32_t prevCellX = 0;
+                int32_t prevCellY = 0;
+                for (const auto roadEnd = _roadsEnds[roadIdx]; pointIdx < roadEnd; pointIdx++)
+                {
+                    const auto cellX = pCells[pointIdx * 2 + 0];
+                    const auto cellY = pCells[pointIdx * 2 + 1];
+                    if (cellX == prevCellX && cellY == prevCellY)
+                        continue;
+                    prevCellX = cellX;
+                    prevCellY = cellY;
+
+                    auto& counter = useGrid
+                        ? gridCounters[static_cast<size_t>((cellY - _minCellY) * gridWidth + (cellX - _minCellX))]
+                        : hashCounters[(static_cast<uint64_t>(cellX) << cellZoom) | static_cast<uint64_t>(cellY)];
+                    if (counter < densityLimit)
+                    {
+                        accept = true;
+                        counter++;
+                    }
+                }
+
+                if (!accept)
+                {
+                    outRejectFlags[roadIdx] = 1;
+                    rejectedCount++;
+                }
+            }
+
+            return rejectedCount;
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_ROADS_DENSITY_FILTER_H_)
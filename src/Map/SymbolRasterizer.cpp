@@ -16,9 +16,10 @@ void OsmAnd::SymbolRasterizer::rasterize(
     const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
     QList< std::shared_ptr<const RasterizedSymbolsGroup> >& outSymbolsGroups,
     const FilterByMapObject filter /*= nullptr*/,
+    SymbolRasterizer_Metrics::Metric_rasterize* const metric /*= nullptr*/,
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/) const
 {
-    _p->rasterize(primitivisedObjects, outSymbolsGroups, filter, queryController);
+    _p->rasterize(primitivisedObjects, outSymbolsGroups, filter, metric, queryController);
 }
 
 OsmAnd::SymbolRasterizer::RasterizedSymbolsGroup::RasterizedSymbolsGroup(const std::shared_ptr<const MapObject>& mapObject_)
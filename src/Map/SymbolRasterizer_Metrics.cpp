@@ -0,0 +1,36 @@
+#include "SymbolRasterizer_Metrics.h"
+
+OsmAnd::SymbolRasterizer_Metrics::Metric_rasterize::Metric_rasterize()
+{
+    reset();
+}
+
+OsmAnd::SymbolRasterizer_Metrics::Metric_rasterize::~Metric_rasterize()
+{
+}
+
+void OsmAnd::SymbolRasterizer_Metrics::Metric_rasterize::reset()
+{
+    OsmAnd__SymbolRasterizer_Metrics__Metric_rasterize__FIELDS(RESET_METRIC_FIELD);
+
+    Metric::reset();
+}
+
+QString OsmAnd::SymbolRasterizer_Metrics::Metric_rasterize::toString(const bool shortFormat /*= false*/, const QString& prefix /*= QString::null*/) const
+{
+    QString output;
+
+    OsmAnd__SymbolRasterizer_Metrics__Metric_rasterize__FIELDS(PRINT_METRIC_FIELD);
+
+    output += QLatin1String("\n") + prefix + QString(QLatin1String("~text-bitmap-cache-hit-rate = %1%"))
+        .arg(100.0f * static_cast<float>(textCacheBitmapHits) / static_cast<float>(texts));
+    output += QLatin1String("\n") + prefix + QString(QLatin1String("~text-cache-hit-rate = %1%"))
+        .arg(100.0f * static_cast<float>(textCacheBitmapHits + textCacheShapedTextHits) / static_cast<float>(texts));
+    output += QLatin1String("\n") + prefix + QString(QLatin1String("~glyph-cells-reuse-rate = %1%"))
+        .arg(100.0f * static_cast<float>(glyphCells - glyphCellsDrawn) / static_cast<float>(glyphCells));
+    const auto submetricsString = Metric::toString(shortFormat, prefix);
+    if (!submetricsString.isEmpty())
+        output += QLatin1String("\n") + Metric::toString(shortFormat, prefix);
+
+    return output;
+}
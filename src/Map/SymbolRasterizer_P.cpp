@@ -46,14 +46,20 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
     const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
     QList< std::shared_ptr<const RasterizedSymbolsGroup> >& outSymbolsGroups,
     const FilterByMapObject filter,
+    SymbolRasterizer_Metrics::Metric_rasterize* const metric,
     const std::shared_ptr<const IQueryController>& queryController) const
 {
+    const Stopwatch totalStopwatch(metric != nullptr);
+
     const auto& env = primitivisedObjects->mapPresentationEnvironment;
 
+    // Bitmaps of glyph atlas pages are obtained after all texts are laid out, so that they're shared
+    QList< QPair< std::shared_ptr<RasterizedSymbolsGroup>, std::shared_ptr<RasterizedOnPathSymbol> > > glyphRunSymbols;
+
     for (const auto& symbolGroupEntry : rangeOf(constOf(primitivisedObjects->symbolsGroups)))
     {
         if (queryController && queryController->isAborted())
-            return;
+            break;
 
         const auto& mapObject = symbolGroupEntry.key();
         const auto& symbolsGroup = symbolGroupEntry.value();
@@ -80,7 +86,7 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
         for (const auto& symbol : constOf(symbolsGroup->symbols))
         {
             if (queryController && queryController->isAborted())
-                return;
+                break;
 
             if (const auto& textSymbol = std::dynamic_pointer_cast<const MapPrimitiviser::TextSymbol>(symbol))
             {
@@ -127,17 +133,79 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
                         .setHaloRadius(textSymbol->shadowRadius);
                 }
 
+                const Stopwatch textStopwatch(metric != nullptr);
+
+                // Texts on path are drawn glyph by glyph, so they're taken from glyph atlas when possible
+                if (textSymbol->drawOnPath)
+                {
+                    unsigned int drawnCellsCount = 0;
+                    const auto glyphRun = owner->textRasterizer->obtainGlyphRun(
+                        textSymbol->value,
+                        style,
+                        &drawnCellsCount);
+
+                    if (glyphRun)
+                    {
+                        if (metric)
+                        {
+                            metric->texts++;
+                            metric->elapsedTimeForTexts += textStopwatch.elapsed();
+                            metric->glyphRuns++;
+                            metric->glyphCells += glyphRun->cells.size();
+                            metric->glyphCellsDrawn += drawnCellsCount;
+                        }
+
+                        const std::shared_ptr<RasterizedOnPathSymbol> rasterizedSymbol(new RasterizedOnPathSymbol(
+                            group,
+                            textSymbol));
+                        rasterizedSymbol->order = textSymbol->order;
+                        rasterizedSymbol->contentType = RasterizedSymbol::ContentType::Text;
+                        rasterizedSymbol->content = textSymbol->value;
+                        rasterizedSymbol->languageId = textSymbol->languageId;
+                        rasterizedSymbol->minDistance = textSymbol->minDistance;
+                        rasterizedSymbol->glyphsWidth = glyphRun->glyphsWidth;
+                        rasterizedSymbol->glyphRun = glyphRun;
+                        glyphRunSymbols.push_back(qMakePair(group, rasterizedSymbol));
+                        group->symbols.push_back(qMove(rasterizedSymbol));
+                        continue;
+                    }
+                }
+
                 float lineSpacing;
                 float symbolExtraTopSpace;
                 float symbolExtraBottomSpace;
                 QVector<SkScalar> glyphsWidth;
-                const auto rasterizedText = owner->textRasterizer->rasterize(
+                auto cacheLookup = TextRasterizer::CacheLookup::Bypass;
+                const auto rasterizedText = owner->textRasterizer->obtainRasterized(
                     textSymbol->value,
                     style,
                     textSymbol->drawOnPath ? &glyphsWidth : nullptr,
                     &symbolExtraTopSpace,
                     &symbolExtraBottomSpace,
-                    &lineSpacing);
+                    &lineSpacing,
+                    &cacheLookup);
+
+                if (metric)
+                {
+                    metric->texts++;
+                    metric->elapsedTimeForTexts += textStopwatch.elapsed();
+                    switch (cacheLookup)
+                    {
+                        case TextRasterizer::CacheLookup::BitmapHit:
+                            metric->textCacheBitmapHits++;
+                            break;
+                        case TextRasterizer::CacheLookup::ShapedTextHit:
+                            metric->textCacheShapedTextHits++;
+                            break;
+                        case TextRasterizer::CacheLookup::Miss:
+                            metric->textCacheMisses++;
+                            break;
+                        case TextRasterizer::CacheLookup::Bypass:
+                            metric->textCacheBypasses++;
+                            break;
+                    }
+                }
+
                 if (!rasterizedText)
                     continue;
 
@@ -358,7 +426,26 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
             }
         }
 
+        if (queryController && queryController->isAborted())
+            break;
+
         // Add group to output
         outSymbolsGroups.push_back(qMove(group));
     }
+
+    for (const auto& glyphRunSymbolEntry : constOf(glyphRunSymbols))
+    {
+        const auto& group = glyphRunSymbolEntry.first;
+        const auto& rasterizedSymbol = glyphRunSymbolEntry.second;
+
+        rasterizedSymbol->bitmap = owner->textRasterizer->glyphAtlas->obtainPageBitmap(
+            *rasterizedSymbol->glyphRun);
+
+        // Symbol without bitmap can't be drawn, so it's dropped instead of being uploaded empty
+        if (!rasterizedSymbol->bitmap)
+            group->symbols.removeOne(rasterizedSymbol);
+    }
+
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
 }
@@ -47,6 +47,7 @@ namespace OsmAnd
             const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
             QList< std::shared_ptr<const RasterizedSymbolsGroup> >& outSymbolsGroups,
             const FilterByMapObject filter,
+            SymbolRasterizer_Metrics::Metric_rasterize* const metric,
             const std::shared_ptr<const IQueryController>& queryController) const;
 
     friend class OsmAnd::SymbolRasterizer;
@@ -0,0 +1,213 @@
+#ifndef _OSMAND_CORE_TILES_PREFETCH_PREDICTOR_H_
+#define _OSMAND_CORE_TILES_PREFETCH_PREDICTOR_H_
+
+#include "stdlib_common.h"
+#include <algorithm>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PointsAndAreas.h"
+#include "QtCommon.h"
+#include "Utilities.h"
+#include "TileIdSet.h"
+
+namespace OsmAnd
+{
+    // Tracks how active zone moves between frames and predicts tiles that are going to become active soon:
+    // active tiles shifted along the panning direction, children of central tiles when zooming in, parents and
+    // their neighbours when zooming out. Velocity is known only from samples, so prediction expires once samples
+    // stop coming, e.g. when no frames are rendered after a fling has ended.
+    class TilesPrefetchPredictor Q_DECL_FINAL
+    {
+    public:
+        enum : unsigned int {
+            MaxPrefetchTilesCount = 64u,
+            PrefetchHorizonMsecs = 500u,
+            MaxMotionSampleIntervalMsecs = 500u,
+        };
+        typedef QHash< ZoomLevel, QSet<TileId> > PrefetchTiles;
+
+    private:
+        qint64 _lastSampleTime;
+        PointI _lastSampleTarget31;
+        float _lastSampleZoom;
+        // Smoothed velocity, in 31-coordinates and zoom levels per second
+        PointD _target31Velocity;
+        double _zoomVelocity;
+    protected:
+    public:
+        inline TilesPrefetchPredictor()
+            : _lastSampleTime(-1)
+            , _lastSampleZoom(0.0f)
+            , _zoomVelocity(0.0)
+        {
+        }
+
+        // Time is in milliseconds since any fixed moment, zoom is continuous
+        inline void addSample(const qint64 time, const PointI target31, const float zoom)
+        {
+            const auto sampleInterval = time - _lastSampleTime;
+            if (_lastSampleTime < 0 || sampleInterval > MaxMotionSampleIntervalMsecs)
+            {
+                // Map was still for a while, so there's no motion to continue
+                _target31Velocity = PointD();
+                _zoomVelocity = 0.0;
+            }
+            else if (sampleInterval > 0)
+            {
+                // Target is allowed to cross 180th meridian, so shortest way is taken
+                auto dX = static_cast<int64_t>(target31.x) - static_cast<int64_t>(_lastSampleTarget31.x);
+                if (dX > (INT64_C(1) << 30))
+                    dX -= (INT64_C(1) << 31);
+                else if (dX < -(INT64_C(1) << 30))
+                    dX += (INT64_C(1) << 31);
+                const auto dY = static_cast<int64_t>(target31.y) - static_cast<int64_t>(_lastSampleTarget31.y);
+                const auto dZoom = static_cast<double>(zoom) - static_cast<double>(_lastSampleZoom);
+
+                // Velocity is smoothed, since intervals between frames are not even
+                const auto secondsElapsed = sampleInterval / 1000.0;
+                _target31Velocity.x = 0.5 * _target31Velocity.x + 0.5 * (dX / secondsElapsed);
+                _target31Velocity.y = 0.5 * _target31Velocity.y + 0.5 * (dY / secondsElapsed);
+                _zoomVelocity = 0.5 * _zoomVelocity + 0.5 * (dZoom / secondsElapsed);
+            }
+            else
+            {
+                return;
+            }
+
+            _lastSampleTime = time;
+            _lastSampleTarget31 = target31;
+            _lastSampleZoom = zoom;
+        }
+
+        inline PointD getTarget31Velocity() const
+        {
+            return _target31Velocity;
+        }
+
+        inline double getZoomVelocity() const
+        {
+            return _zoomVelocity;
+        }
+
+        // Motion may stop without any new sample, so tiles predicted at some moment are not prefetched for longer
+        // than interval after which motion is considered stopped
+        static inline bool isPredictionExpired(const qint64 predictionTime, const qint64 time)
+        {
+            return predictionTime < 0 || time - predictionTime > MaxMotionSampleIntervalMsecs;
+        }
+
+        inline PrefetchTiles predict(
+            const TileId centerTileId,
+            const TileIdSet& activeTiles,
+            const ZoomLevel activeZoom,
+            const float zoom,
+            const ZoomLevel minZoomLevel,
+            const ZoomLevel maxZoomLevel) const
+        {
+            PrefetchTiles prefetchTiles;
+            auto prefetchTilesCount = 0u;
+            const auto horizon = PrefetchHorizonMsecs / 1000.0;
+
+            // Shift active tiles along the way target moves, nearest shift first
+            const auto tileSize31 = static_cast<double>(1u << (ZoomLevel31 - activeZoom));
+            const auto tilesShiftX = qRound(_target31Velocity.x * horizon / tileSize31);
+            const auto tilesShiftY = qRound(_target31Velocity.y * horizon / tileSize31);
+            const auto shiftStepsCount = qMax(qAbs(tilesShiftX), qAbs(tilesShiftY));
+            for (auto shiftStep = 1; shiftStep <= shiftStepsCount && prefetchTilesCount < MaxPrefetchTilesCount; shiftStep++)
+            {
+                const auto shift = TileId::fromXY(
+                    tilesShiftX * shiftStep / shiftStepsCount,
+                    tilesShiftY * shiftStep / shiftStepsCount);
+                for (const auto& activeTileId : constOf(activeTiles))
+                {
+                    const auto tileId = Utilities::normalizeTileId(activeTileId + shift, activeZoom);
+                    if (activeTiles.contains(tileId))
+                        continue;
+
+                    auto& prefetchTilesAtZoom = prefetchTiles[activeZoom];
+                    if (prefetchTilesAtZoom.contains(tileId))
+                        continue;
+                    prefetchTilesAtZoom.insert(tileId);
+                    if (++prefetchTilesCount >= MaxPrefetchTilesCount)
+                        break;
+                }
+            }
+
+            // Next zoom level is the one that zoom is rounded to, same as in MapRenderer::setZoom()
+            const auto predictedZoomLevel = qBound(
+                static_cast<int>(minZoomLevel),
+                qRound(zoom + _zoomVelocity * horizon),
+                static_cast<int>(maxZoomLevel));
+            if (predictedZoomLevel > activeZoom && activeZoom < MaxZoomLevel)
+            {
+                // Zooming in shows only central part of current view, so children of tiles closest to center go first
+                const auto nextZoom = static_cast<ZoomLevel>(activeZoom + 1);
+                auto centralTiles = activeTiles.toVector();
+                std::sort(centralTiles.begin(), centralTiles.end(),
+                    [centerTileId]
+                    (const TileId l, const TileId r) -> bool
+                    {
+                        const auto lX = static_cast<int64_t>(l.x - centerTileId.x);
+                        const auto lY = static_cast<int64_t>(l.y - centerTileId.y);
+                        const auto rX = static_cast<int64_t>(r.x - centerTileId.x);
+                        const auto rY = static_cast<int64_t>(r.y - centerTileId.y);
+                        return lX*lX + lY*lY < rX*rX + rY*rY;
+                    });
+                auto& prefetchTilesAtZoom = prefetchTiles[nextZoom];
+                for (const auto& centralTileId : constOf(centralTiles))
+                {
+                    const auto childTileIds = Utilities::getTileIdsUnderscaledByZoomShift(centralTileId, 1);
+                    if (prefetchTilesCount + childTileIds.size() > MaxPrefetchTilesCount)
+                        break;
+
+                    for (const auto& childTileId : constOf(childTileIds))
+                        prefetchTilesAtZoom.insert(childTileId);
+                    prefetchTilesCount += childTileIds.size();
+                }
+            }
+            else if (predictedZoomLevel < activeZoom && activeZoom > MinZoomLevel)
+            {
+                // Zooming out shows parents of current view and ones around them
+                const auto nextZoom = static_cast<ZoomLevel>(activeZoom - 1);
+                QSet<TileId> parentTileIds;
+                for (const auto& activeTileId : constOf(activeTiles))
+                    parentTileIds.insert(Utilities::getTileIdOverscaledByZoomShift(activeTileId, 1));
+
+                auto& prefetchTilesAtZoom = prefetchTiles[nextZoom];
+                for (const auto& parentTileId : constOf(parentTileIds))
+                {
+                    if (prefetchTilesCount >= MaxPrefetchTilesCount)
+                        break;
+                    prefetchTilesAtZoom.insert(parentTileId);
+                    prefetchTilesCount++;
+                }
+                for (const auto& parentTileId : constOf(parentTileIds))
+                {
+                    for (auto dY = -1; dY <= 1 && prefetchTilesCount < MaxPrefetchTilesCount; dY++)
+                    {
+                        for (auto dX = -1; dX <= 1 && prefetchTilesCount < MaxPrefetchTilesCount; dX++)
+                        {
+                            const auto tileId = Utilities::normalizeTileId(parentTileId + TileId::fromXY(dX, dY), nextZoom);
+                            if (parentTileIds.contains(tileId) || prefetchTilesAtZoom.contains(tileId))
+                                continue;
+                            prefetchTilesAtZoom.insert(tileId);
+                            prefetchTilesCount++;
+                        }
+                    }
+                }
+            }
+
+            return prefetchTiles;
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TILES_PREFETCH_PREDICTOR_H_)
@@ -0,0 +1,65 @@
+#include "MemoryInputStream.h"
+
+namespace OsmAnd
+{
+    namespace gpb = google::obf_protobuf;
+}
+
+OsmAnd::MemoryInputStream::MemoryInputStream(const uint8_t* const data_, const qint64 size_)
+    : _data(data_)
+    , _size(size_)
+    , _currentPosition(0)
+{
+}
+
+OsmAnd::MemoryInputStream::~MemoryInputStream()
+{
+}
+
+bool OsmAnd::MemoryInputStream::Next(const void** data, int* size)
+{
+    // Check if current position is in valid range
+    if (Q_UNLIKELY(!_data || _currentPosition < 0 || _currentPosition >= _size))
+    {
+        *data = nullptr;
+        *size = 0;
+        return false;
+    }
+
+    // Return everything that is left, but no more than fits into int
+    auto chunkSize = _size - _currentPosition;
+    if (Q_UNLIKELY(chunkSize > std::numeric_limits<int>::max()))
+        chunkSize = std::numeric_limits<int>::max();
+
+    *data = _data + _currentPosition;
+    *size = static_cast<int>(chunkSize);
+
+    _currentPosition += chunkSize;
+    return true;
+}
+
+void OsmAnd::MemoryInputStream::BackUp(int count)
+{
+    if (count > _currentPosition)
+        _currentPosition = 0;
+    else
+        _currentPosition -= count;
+}
+
+bool OsmAnd::MemoryInputStream::Skip(int count)
+{
+    // Landing exactly at the end is a successful skip, only skipping past the end fails
+    if (Q_UNLIKELY(count < 0 || _currentPosition + count > _size))
+    {
+        _currentPosition = _size;
+        return false;
+    }
+
+    _currentPosition += count;
+    return true;
+}
+
+OsmAnd::gpb::int64 OsmAnd::MemoryInputStream::ByteCount() const
+{
+    return static_cast<gpb::int64>(_currentPosition);
+}
@@ -5,6 +5,9 @@
 #include "QtExtensions.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QSet>
+#include <QVector>
+#include <QAtomicInt>
+#include <QMutex>
 #include "restore_internal_warnings.h"
 
 #include "Ref.h"
@@ -19,12 +22,17 @@
 #include "ObfAddressSectionReader.h"
 #include "ObfAddressSectionInfo.h"
 #include "ObfMapObject.h"
+#include "BinaryMapObject.h"
 #include "Amenity.h"
 #include "StreetGroup.h"
 #include "Street.h"
 #include "IQueryController.h"
 #include "FunctorQueryController.h"
 #include "QKeyValueIterator.h"
+#include "WorkerPool.h"
+#include "Stopwatch.h"
+#include "Utilities.h"
+#include "Address.h"
 
 OsmAnd::ObfDataInterface::ObfDataInterface(const QList< std::shared_ptr<const ObfReader> >& obfReaders_)
     : obfReaders(obfReaders_)
@@ -35,6 +43,284 @@ OsmAnd::ObfDataInterface::~ObfDataInterface()
 {
 }
 
+void OsmAnd::ObfDataInterface::setWorkerPool(const std::shared_ptr<Concurrent::WorkerPool>& workerPool)
+{
+    _workerPool = workerPool;
+}
+
+std::shared_ptr<OsmAnd::Concurrent::WorkerPool> OsmAnd::ObfDataInterface::getWorkerPool() const
+{
+    return _workerPool;
+}
+
+bool OsmAnd::ObfDataInterface::shouldRunInParallel(const int sectionsCount) const
+{
+    return _workerPool && sectionsCount > 1;
+}
+
+bool OsmAnd::ObfDataInterface::runSectionTasks(
+    const QVector<SectionTask>& tasks,
+    const std::shared_ptr<const IQueryController>& queryController) const
+{
+    if (!shouldRunInParallel(tasks.size()))
+    {
+        for (const auto& task : constOf(tasks))
+        {
+            if (queryController && queryController->isAborted())
+                return false;
+
+            task();
+        }
+
+        return true;
+    }
+
+    // Calling thread takes tasks as well, see Concurrent::WorkerPool::runAndWait()
+    _workerPool->runAndWait(
+        tasks,
+        [queryController]
+        () -> bool
+        {
+            return queryController && queryController->isAborted();
+        });
+
+    return !(queryController && queryController->isAborted());
+}
+
+// Keeps up to limit results nearest to given point. Farthest of them is on top of max-heap,
+// so it's the one that gets displaced by nearer result
+template<typename RESULT_TYPE>
+struct OsmAnd::ObfDataInterface::NearestResults
+{
+    typedef std::pair<double, RESULT_TYPE> Entry;
+
+    NearestResults(const unsigned int limit_)
+        : limit(limit_)
+    {
+    }
+
+    const unsigned int limit;
+    std::vector<Entry> entries;
+
+    static bool isNearer(const Entry& l, const Entry& r)
+    {
+        return l.first < r.first;
+    }
+
+    bool isFull() const
+    {
+        return limit > 0 && entries.size() >= limit;
+    }
+
+    // Once full, only results that are nearer than farthest kept one can get in
+    bool mayContain(const double squaredDistance) const
+    {
+        return !isFull() || squaredDistance < entries.front().first;
+    }
+
+    // Returns true if farthest kept result was displaced
+    bool insert(const double squaredDistance, const RESULT_TYPE& result)
+    {
+        bool displaced = false;
+        if (isFull())
+        {
+            std::pop_heap(entries.begin(), entries.end(), &isNearer);
+            entries.pop_back();
+            displaced = true;
+        }
+
+        entries.push_back(Entry(squaredDistance, result));
+        std::push_heap(entries.begin(), entries.end(), &isNearer);
+
+        return displaced;
+    }
+
+    void takeSorted(QList<RESULT_TYPE>* const output)
+    {
+        std::sort_heap(entries.begin(), entries.end(), &isNearer);
+        for (auto& entry : entries)
+            output->push_back(qMove(entry.second));
+        entries.clear();
+    }
+};
+
+struct OsmAnd::ObfDataInterface::StreamingQuery
+{
+    StreamingQuery(
+        const unsigned int limit_,
+        const std::shared_ptr<const IQueryController>& queryController_,
+        const bool keepNearest_ = false)
+        : limit(limit_)
+        , keepNearest(keepNearest_)
+        , queryController(queryController_)
+        , acceptedResults(0)
+        , visitedSections(0)
+        , rejectedResults(0)
+        , droppedResults(0)
+    {
+        // Readers check this controller after each box, so they stop as soon as quota is met
+        sectionsQueryController.reset(new FunctorQueryController(
+            [this]
+            (const FunctorQueryController* const controller) -> bool
+            {
+                return isAborted() || isQuotaMet();
+            }));
+    }
+
+    const unsigned int limit;
+    // Nearer results may be still ahead after limit is reached, so quota doesn't stop reading. Instead, sections
+    // that are farther than all kept results are skipped
+    const bool keepNearest;
+    const std::shared_ptr<const IQueryController> queryController;
+    std::shared_ptr<const IQueryController> sectionsQueryController;
+
+    QAtomicInt acceptedResults;
+    QAtomicInt visitedSections;
+
+    QMutex visitMutex;
+    unsigned int rejectedResults;
+    unsigned int droppedResults;
+
+    bool isAborted() const
+    {
+        return queryController && queryController->isAborted();
+    }
+
+    bool isQuotaMet() const
+    {
+        return !keepNearest && limit > 0 && static_cast<unsigned int>(acceptedResults.loadAcquire()) >= limit;
+    }
+
+    // Results that are read after quota was met (by boxes that were already being read) are dropped,
+    // so that exactly limit results are accepted. Visitor is called under lock, so it's never called concurrently
+    template<typename VISITOR_TYPE, typename RESULT_TYPE>
+    bool visit(const VISITOR_TYPE& visitor, const RESULT_TYPE& result)
+    {
+        QMutexLocker scopedLocker(&visitMutex);
+
+        if (isQuotaMet())
+        {
+            droppedResults++;
+            return false;
+        }
+
+        if (visitor && !visitor(result))
+        {
+            rejectedResults++;
+            return false;
+        }
+
+        acceptedResults.ref();
+        return true;
+    }
+
+    // Visitor acts as filter here: result it accepts may be displaced later by nearer one, and then it's dropped
+    template<typename VISITOR_TYPE, typename RESULT_TYPE>
+    bool visitNearest(
+        const VISITOR_TYPE& visitor,
+        const RESULT_TYPE& result,
+        const double squaredDistance,
+        NearestResults<RESULT_TYPE>& nearestResults)
+    {
+        QMutexLocker scopedLocker(&visitMutex);
+
+        if (!nearestResults.mayContain(squaredDistance))
+        {
+            droppedResults++;
+            return false;
+        }
+
+        if (visitor && !visitor(result))
+        {
+            rejectedResults++;
+            return false;
+        }
+
+        if (nearestResults.insert(squaredDistance, result))
+            droppedResults++;
+        acceptedResults.storeRelease(static_cast<int>(nearestResults.entries.size()));
+        return true;
+    }
+
+    // Sections are read in order of distance, so once section is farther than all kept results, so are the rest
+    template<typename RESULT_TYPE>
+    bool shouldVisitSection(const double squaredDistance, const NearestResults<RESULT_TYPE>& nearestResults)
+    {
+        QMutexLocker scopedLocker(&visitMutex);
+
+        return nearestResults.mayContain(squaredDistance);
+    }
+
+    void fillMetric(
+        ObfDataInterface_Metrics::Metric_streamQuery* const metric,
+        const unsigned int sectionsCount) const
+    {
+        if (!metric)
+            return;
+
+        const auto visitedSectionsCount = static_cast<unsigned int>(visitedSections.loadAcquire());
+        metric->visitedSections += visitedSectionsCount;
+        metric->skippedSections += sectionsCount - visitedSectionsCount;
+        metric->acceptedResults += static_cast<unsigned int>(acceptedResults.loadAcquire());
+        metric->rejectedResults += rejectedResults;
+        metric->droppedResults += droppedResults;
+    }
+};
+
+double OsmAnd::ObfDataInterface::getSquaredDistanceToArea(const PointI& point31, const AreaI& area31)
+{
+    const PointI nearestPoint31(
+        qBound(area31.left(), point31.x, area31.right()),
+        qBound(area31.top(), point31.y, area31.bottom()));
+
+    return Utilities::squareDistance31(point31, nearestPoint31);
+}
+
+bool OsmAnd::ObfDataInterface::resolvePoiCategoriesFilter(
+    const std::shared_ptr<const ObfReader>& obfReader,
+    const std::shared_ptr<const ObfPoiSectionInfo>& poiSection,
+    const QHash<QString, QStringList>& categoriesFilter,
+    QSet<ObfPoiCategoryId>& outCategoriesFilterById,
+    const std::shared_ptr<const IQueryController>& queryController)
+{
+    std::shared_ptr<const ObfPoiSectionCategories> categories;
+    OsmAnd::ObfPoiSectionReader::loadCategories(
+        obfReader,
+        poiSection,
+        categories,
+        queryController);
+
+    if (!categories)
+        return false;
+
+    for (const auto& categoriesFilterEntry : rangeOf(constOf(categoriesFilter)))
+    {
+        const auto mainCategoryIndex = categories->mainCategories.indexOf(categoriesFilterEntry.key());
+        if (mainCategoryIndex < 0)
+            continue;
+
+        const auto& subcategories = categories->subCategories[mainCategoryIndex];
+        if (categoriesFilterEntry.value().isEmpty())
+        {
+            for (auto subCategoryIndex = 0; subCategoryIndex < subcategories.size(); subCategoryIndex++)
+                outCategoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
+        }
+        else
+        {
+            for (const auto& subcategory : constOf(categoriesFilterEntry.value()))
+            {
+                const auto subCategoryIndex = subcategories.indexOf(subcategory);
+                if (subCategoryIndex < 0)
+                    continue;
+
+                outCategoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
+            }
+        }
+    }
+
+    return true;
+}
+
 bool OsmAnd::ObfDataInterface::loadObfFiles(
     QList< std::shared_ptr<const ObfFile> >* outFiles /*= nullptr*/,
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/)
@@ -241,6 +527,23 @@ bool OsmAnd::ObfDataInterface::loadMapObjects(
 
     QSet<QString> processedMapSectionsNames;
 
+    // All sections that have to be read are collected first, so that they can be read in parallel
+    struct MapSectionQuery
+    {
+        std::shared_ptr<const ObfReader> obfReader;
+        Ref<ObfMapSectionInfo> mapSection;
+        ZoomLevel zoom;
+        const AreaI* bbox31;
+        bool isBasemap;
+    };
+    QVector<MapSectionQuery> mapSectionQueries;
+    struct RoutingSectionQuery
+    {
+        std::shared_ptr<const ObfReader> obfReader;
+        Ref<ObfRoutingSectionInfo> routingSection;
+    };
+    QVector<RoutingSectionQuery> routingSectionQueries;
+
     for (const auto& obfReader : constOf(obfReaders))
     {
         if (queryController && queryController->isAborted())
@@ -268,46 +571,22 @@ bool OsmAnd::ObfDataInterface::loadMapObjects(
 
         for (const auto& mapSection : constOf(obfInfo->mapSections))
         {
-            if (queryController && queryController->isAborted())
-                return false;
-
             // Remember that this section was processed (by name)
             processedMapSectionsNames.insert(mapSection->name);
 
-            // Read objects from each map section
-            auto surfaceTypeToMerge = MapSurfaceType::Undefined;
-            OsmAnd::ObfMapSectionReader::loadMapObjects(
-                obfReader,
-                mapSection,
-                zoom,
-                bbox31,
-                outBinaryMapObjects,
-                &surfaceTypeToMerge,
-                filterMapObjectsById,
-                nullptr,
-                binaryMapObjectsCache,
-                outReferencedBinaryMapObjectsCacheEntries,
-                queryController,
-                binaryMapObjectsMetric);
-            if (surfaceTypeToMerge != MapSurfaceType::Undefined)
-            {
-                if (mergedSurfaceType == MapSurfaceType::Undefined)
-                    mergedSurfaceType = surfaceTypeToMerge;
-                else if (mergedSurfaceType != surfaceTypeToMerge)
-                    mergedSurfaceType = MapSurfaceType::Mixed;
-            }
+            mapSectionQueries.push_back({ obfReader, mapSection, zoom, bbox31, false });
         }
     }
 
     // In case there's basemap available and requested zoom is more detailed than basemap max zoom level,
     // read tile from MaxBasemapZoomLevel that covers requested tile
+    AreaI basemapBBox31;
     if (basemapReader && zoom > static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel))
     {
         const auto& obfInfo = basemapReader->obtainInfo();
 
         // Calculate proper bbox31 on MaxBasemapZoomLevel (if possible)
         const AreaI *pBasemapBBox31 = nullptr;
-        AreaI basemapBBox31;
         if (bbox31)
         {
             pBasemapBBox31 = &basemapBBox31;
@@ -318,41 +597,15 @@ bool OsmAnd::ObfDataInterface::loadMapObjects(
 
         for (const auto& mapSection : constOf(obfInfo->mapSections))
         {
-            if (queryController && queryController->isAborted())
-                return false;
-
-            // Read objects from each map section
-            auto surfaceTypeToMerge = MapSurfaceType::Undefined;
-            OsmAnd::ObfMapSectionReader::loadMapObjects(
+            mapSectionQueries.push_back({
                 basemapReader,
                 mapSection,
                 static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel),
                 pBasemapBBox31,
-                outBinaryMapObjects,
-                &surfaceTypeToMerge,
-                filterMapObjectsById,
-                nullptr,
-                binaryMapObjectsCache,
-                outReferencedBinaryMapObjectsCacheEntries,
-                queryController,
-                binaryMapObjectsMetric);
-
-            // Basemap must always have a surface type defined
-            assert(surfaceTypeToMerge != MapSurfaceType::Undefined);
-            if (mergedSurfaceType == MapSurfaceType::Undefined)
-                mergedSurfaceType = surfaceTypeToMerge;
-            else if (mergedSurfaceType != surfaceTypeToMerge)
-                mergedSurfaceType = MapSurfaceType::Mixed;
+                true });
         }
     }
 
-    // In case there was a basemap present, Undefined is Land
-    if (mergedSurfaceType == MapSurfaceType::Undefined && !basemapReader)
-        mergedSurfaceType = MapSurfaceType::FullLand;
-
-    if (outSurfaceType)
-        *outSurfaceType = mergedSurfaceType;
-
     if (zoom > ObfMapSectionLevel::MaxBasemapZoomLevel)
     {
         for (const auto& obfReader : constOf(obfReaders))
@@ -368,28 +621,126 @@ bool OsmAnd::ObfDataInterface::loadMapObjects(
 
             for (const auto& routingSection : constOf(obfInfo->routingSections))
             {
-                // Check if request is aborted
-                if (queryController && queryController->isAborted())
-                    return false;
-
                 // Check that map section with same name was not processed from other file
                 if (processedMapSectionsNames.contains(routingSection->name))
                     continue;
 
-                // Read objects from each map section
+                routingSectionQueries.push_back({ obfReader, routingSection });
+            }
+        }
+    }
+
+    struct MapSectionResult
+    {
+        MapSectionResult()
+            : surfaceType(MapSurfaceType::Undefined)
+        {
+        }
+
+        QList< std::shared_ptr<const OsmAnd::BinaryMapObject> > binaryMapObjects;
+        MapSurfaceType surfaceType;
+        QList< std::shared_ptr<const ObfMapSectionReader::DataBlock> > referencedCacheEntries;
+        ObfMapSectionReader_Metrics::Metric_loadMapObjects metric;
+    };
+    std::vector<MapSectionResult> mapSectionResults(mapSectionQueries.size());
+    struct RoutingSectionResult
+    {
+        QList< std::shared_ptr<const OsmAnd::Road> > roads;
+        QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> > referencedCacheEntries;
+        ObfRoutingSectionReader_Metrics::Metric_loadRoads metric;
+    };
+    std::vector<RoutingSectionResult> routingSectionResults(routingSectionQueries.size());
+
+    const auto parallel = shouldRunInParallel(mapSectionQueries.size() + routingSectionQueries.size());
+    QVector<SectionTask> tasks;
+    tasks.reserve(mapSectionQueries.size() + routingSectionQueries.size());
+    for (auto sectionIndex = 0; sectionIndex < mapSectionQueries.size(); sectionIndex++)
+    {
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
+            {
+                const auto& query = mapSectionQueries.at(sectionIndex);
+                auto& result = mapSectionResults[sectionIndex];
+
+                OsmAnd::ObfMapSectionReader::loadMapObjects(
+                    query.obfReader,
+                    query.mapSection,
+                    query.zoom,
+                    query.bbox31,
+                    selectSectionOutput(outBinaryMapObjects, &result.binaryMapObjects, parallel),
+                    &result.surfaceType,
+                    filterMapObjectsById,
+                    nullptr,
+                    binaryMapObjectsCache,
+                    selectSectionOutput(outReferencedBinaryMapObjectsCacheEntries, &result.referencedCacheEntries, parallel),
+                    queryController,
+                    selectSectionOutput(binaryMapObjectsMetric, &result.metric, parallel));
+            });
+    }
+    for (auto sectionIndex = 0; sectionIndex < routingSectionQueries.size(); sectionIndex++)
+    {
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
+            {
+                const auto& query = routingSectionQueries.at(sectionIndex);
+                auto& result = routingSectionResults[sectionIndex];
+
                 OsmAnd::ObfRoutingSectionReader::loadRoads(
-                    obfReader,
-                    routingSection,
+                    query.obfReader,
+                    query.routingSection,
                     RoutingDataLevel::Detailed,
                     bbox31,
-                    outRoads,
+                    selectSectionOutput(outRoads, &result.roads, parallel),
                     filterRoadsById,
                     nullptr,
                     roadsCache,
-                    outReferencedRoadsCacheEntries,
+                    selectSectionOutput(outReferencedRoadsCacheEntries, &result.referencedCacheEntries, parallel),
                     queryController,
-                    roadsMetric);
-            }
+                    selectSectionOutput(roadsMetric, &result.metric, parallel));
+            });
+    }
+    if (!runSectionTasks(tasks, queryController))
+        return false;
+
+    for (auto sectionIndex = 0; sectionIndex < mapSectionQueries.size(); sectionIndex++)
+    {
+        auto& result = mapSectionResults[sectionIndex];
+        if (parallel)
+        {
+            mergeSectionOutput(outBinaryMapObjects, result.binaryMapObjects);
+            mergeSectionOutput(outReferencedBinaryMapObjectsCacheEntries, result.referencedCacheEntries);
+            if (binaryMapObjectsMetric)
+                binaryMapObjectsMetric->merge(result.metric);
+        }
+
+        // Basemap must always have a surface type defined
+        assert(!mapSectionQueries.at(sectionIndex).isBasemap || result.surfaceType != MapSurfaceType::Undefined);
+        if (result.surfaceType != MapSurfaceType::Undefined)
+        {
+            if (mergedSurfaceType == MapSurfaceType::Undefined)
+                mergedSurfaceType = result.surfaceType;
+            else if (mergedSurfaceType != result.surfaceType)
+                mergedSurfaceType = MapSurfaceType::Mixed;
+        }
+    }
+
+    // In case there was a basemap present, Undefined is Land
+    if (mergedSurfaceType == MapSurfaceType::Undefined && !basemapReader)
+        mergedSurfaceType = MapSurfaceType::FullLand;
+
+    if (outSurfaceType)
+        *outSurfaceType = mergedSurfaceType;
+
+    if (parallel)
+    {
+        for (auto& result : routingSectionResults)
+        {
+            mergeSectionOutput(outRoads, result.roads);
+            mergeSectionOutput(outReferencedRoadsCacheEntries, result.referencedCacheEntries);
+            if (roadsMetric)
+                roadsMetric->merge(result.metric);
         }
     }
 
@@ -454,6 +805,8 @@ bool OsmAnd::ObfDataInterface::loadAmenities(
     const ObfPoiSectionReader::VisitorFunction visitor /*= nullptr*/,
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/)
 {
+    typedef std::pair< std::shared_ptr<const ObfReader>, Ref<ObfPoiSectionInfo> > PoiSection;
+    QVector<PoiSection> poiSections;
     for (const auto& obfReader : constOf(obfReaders))
     {
         if (queryController && queryController->isAborted())
@@ -462,9 +815,6 @@ bool OsmAnd::ObfDataInterface::loadAmenities(
         const auto& obfInfo = obfReader->obtainInfo();
         for (const auto& poiSection : constOf(obfInfo->poiSections))
         {
-            if (queryController && queryController->isAborted())
-                return false;
-
             if (pBbox31)
             {
                 bool accept = false;
@@ -476,56 +826,49 @@ bool OsmAnd::ObfDataInterface::loadAmenities(
                     continue;
             }
 
-            QSet<ObfPoiCategoryId> categoriesFilterById;
-            if (categoriesFilter)
-            {
-                std::shared_ptr<const ObfPoiSectionCategories> categories;
-                OsmAnd::ObfPoiSectionReader::loadCategories(
-                    obfReader,
-                    poiSection,
-                    categories,
-                    queryController);
+            poiSections.push_back(PoiSection(obfReader, poiSection));
+        }
+    }
 
-                if (!categories)
-                    continue;
+    const auto parallel = shouldRunInParallel(poiSections.size());
+    std::vector< QList< std::shared_ptr<const OsmAnd::Amenity> > > sectionsAmenities(poiSections.size());
+    QVector<SectionTask> tasks;
+    tasks.reserve(poiSections.size());
+    for (auto sectionIndex = 0; sectionIndex < poiSections.size(); sectionIndex++)
+    {
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
+            {
+                const auto& obfReader = poiSections.at(sectionIndex).first;
+                const auto& poiSection = poiSections.at(sectionIndex).second;
 
-                for (const auto& categoriesFilterEntry : rangeOf(constOf(*categoriesFilter)))
+                QSet<ObfPoiCategoryId> categoriesFilterById;
+                if (categoriesFilter &&
+                    !resolvePoiCategoriesFilter(obfReader, poiSection, *categoriesFilter, categoriesFilterById, queryController))
                 {
-                    const auto mainCategoryIndex = categories->mainCategories.indexOf(categoriesFilterEntry.key());
-                    if (mainCategoryIndex < 0)
-                        continue;
-
-                    const auto& subcategories = categories->subCategories[mainCategoryIndex];
-                    if (categoriesFilterEntry.value().isEmpty())
-                    {
-                        for (auto subCategoryIndex = 0; subCategoryIndex < subcategories.size(); subCategoryIndex++)
-                            categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
-                    }
-                    else
-                    {
-                        for (const auto& subcategory : constOf(categoriesFilterEntry.value()))
-                        {
-                            const auto subCategoryIndex = subcategories.indexOf(subcategory);
-                            if (subCategoryIndex < 0)
-                                continue;
-
-                            categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
-                        }
-                    }
+                    return;
                 }
-            }
 
-            OsmAnd::ObfPoiSectionReader::loadAmenities(
-                obfReader,
-                poiSection,
-                outAmenities,
-                pBbox31,
-                tileFilter,
-                zoomFilter,
-                categoriesFilter ? &categoriesFilterById : nullptr,
-                visitor,
-                queryController);
-        }
+                OsmAnd::ObfPoiSectionReader::loadAmenities(
+                    obfReader,
+                    poiSection,
+                    selectSectionOutput(outAmenities, &sectionsAmenities[sectionIndex], parallel),
+                    pBbox31,
+                    tileFilter,
+                    zoomFilter,
+                    categoriesFilter ? &categoriesFilterById : nullptr,
+                    visitor,
+                    queryController);
+            });
+    }
+    if (!runSectionTasks(tasks, queryController))
+        return false;
+
+    if (parallel)
+    {
+        for (auto& sectionAmenities : sectionsAmenities)
+            mergeSectionOutput(outAmenities, sectionAmenities);
     }
 
     return true;
@@ -594,64 +937,47 @@ bool OsmAnd::ObfDataInterface::scanAmenitiesByName(
             });
     }
 
-    for (const auto& orderedSection : constOf(orderedSections))
+    // Results of nearest sections still go first, even if they are read in parallel
+    const auto parallel = shouldRunInParallel(static_cast<int>(orderedSections.size()));
+    std::vector< QList< std::shared_ptr<const OsmAnd::Amenity> > > sectionsAmenities(orderedSections.size());
+    QVector<SectionTask> tasks;
+    tasks.reserve(static_cast<int>(orderedSections.size()));
+    for (auto sectionIndex = 0u; sectionIndex < orderedSections.size(); sectionIndex++)
     {
-        if (queryController && queryController->isAborted())
-            return false;
-
-        const auto& obfReader = orderedSection.first;
-        const auto& poiSection = orderedSection.second;
-
-        QSet<ObfPoiCategoryId> categoriesFilterById;
-        if (categoriesFilter)
-        {
-            std::shared_ptr<const ObfPoiSectionCategories> categories;
-            OsmAnd::ObfPoiSectionReader::loadCategories(
-                obfReader,
-                poiSection,
-                categories,
-                queryController);
-
-            if (!categories)
-                continue;
-
-            for (const auto& categoriesFilterEntry : rangeOf(constOf(*categoriesFilter)))
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
             {
-                const auto mainCategoryIndex = categories->mainCategories.indexOf(categoriesFilterEntry.key());
-                if (mainCategoryIndex < 0)
-                    continue;
+                const auto& obfReader = orderedSections[sectionIndex].first;
+                const auto& poiSection = orderedSections[sectionIndex].second;
 
-                const auto& subcategories = categories->subCategories[mainCategoryIndex];
-                if (categoriesFilterEntry.value().isEmpty())
+                QSet<ObfPoiCategoryId> categoriesFilterById;
+                if (categoriesFilter &&
+                    !resolvePoiCategoriesFilter(obfReader, poiSection, *categoriesFilter, categoriesFilterById, queryController))
                 {
-                    for (auto subCategoryIndex = 0; subCategoryIndex < subcategories.size(); subCategoryIndex++)
-                        categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
+                    return;
                 }
-                else
-                {
-                    for (const auto& subcategory : constOf(categoriesFilterEntry.value()))
-                    {
-                        const auto subCategoryIndex = subcategories.indexOf(subcategory);
-                        if (subCategoryIndex < 0)
-                            continue;
-
-                        categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
-                    }
-                }
-            }
-        }
 
-        OsmAnd::ObfPoiSectionReader::scanAmenitiesByName(
-            obfReader,
-            poiSection,
-            query,
-            outAmenities,
-            xy31,
-            pBbox31,
-            tileFilter,
-            categoriesFilter ? &categoriesFilterById : nullptr,
-            visitor,
-            queryController);
+                OsmAnd::ObfPoiSectionReader::scanAmenitiesByName(
+                    obfReader,
+                    poiSection,
+                    query,
+                    selectSectionOutput(outAmenities, &sectionsAmenities[sectionIndex], parallel),
+                    xy31,
+                    pBbox31,
+                    tileFilter,
+                    categoriesFilter ? &categoriesFilterById : nullptr,
+                    visitor,
+                    queryController);
+            });
+    }
+    if (!runSectionTasks(tasks, queryController))
+        return false;
+
+    if (parallel)
+    {
+        for (auto& sectionAmenities : sectionsAmenities)
+            mergeSectionOutput(outAmenities, sectionAmenities);
     }
 
     return true;
@@ -762,6 +1088,8 @@ bool OsmAnd::ObfDataInterface::scanAddressesByName(
     const ObfAddressSectionReader::VisitorFunction visitor /*= nullptr*/,
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/)
 {
+    typedef std::pair< std::shared_ptr<const ObfReader>, Ref<ObfAddressSectionInfo> > AddressSection;
+    QVector<AddressSection> addressSections;
     for (const auto& obfReader : constOf(obfReaders))
     {
         if (queryController && queryController->isAborted())
@@ -770,9 +1098,6 @@ bool OsmAnd::ObfDataInterface::scanAddressesByName(
         const auto& obfInfo = obfReader->obtainInfo();
         for (const auto& addressSection : constOf(obfInfo->addressSections))
         {
-            if (queryController && queryController->isAborted())
-                return false;
-
             if (bbox31)
             {
                 bool accept = false;
@@ -784,23 +1109,475 @@ bool OsmAnd::ObfDataInterface::scanAddressesByName(
                     continue;
             }
 
-            OsmAnd::ObfAddressSectionReader::scanAddressesByName(
-                obfReader,
-                addressSection,
-                query,
-                matcherMode,
-                outAddresses,
-                bbox31,
-                streetGroupTypesFilter,
-                includeStreets,
-                visitor,
-                queryController);
+            addressSections.push_back(AddressSection(obfReader, addressSection));
         }
     }
 
+    const auto parallel = shouldRunInParallel(addressSections.size());
+    std::vector< QList< std::shared_ptr<const OsmAnd::Address> > > sectionsAddresses(addressSections.size());
+    QVector<SectionTask> tasks;
+    tasks.reserve(addressSections.size());
+    for (auto sectionIndex = 0; sectionIndex < addressSections.size(); sectionIndex++)
+    {
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
+            {
+                OsmAnd::ObfAddressSectionReader::scanAddressesByName(
+                    addressSections.at(sectionIndex).first,
+                    addressSections.at(sectionIndex).second,
+                    query,
+                    matcherMode,
+                    selectSectionOutput(outAddresses, &sectionsAddresses[sectionIndex], parallel),
+                    bbox31,
+                    streetGroupTypesFilter,
+                    includeStreets,
+                    visitor,
+                    queryController);
+            });
+    }
+    if (!runSectionTasks(tasks, queryController))
+        return false;
+
+    if (parallel)
+    {
+        for (auto& sectionAddresses : sectionsAddresses)
+            mergeSectionOutput(outAddresses, sectionAddresses);
+    }
+
     return true;
 }
 
+bool OsmAnd::ObfDataInterface::streamBinaryMapObjects(
+    QList< std::shared_ptr<const OsmAnd::BinaryMapObject> >* outMapObjects,
+    const unsigned int limit,
+    const ZoomLevel zoom,
+    const PointI* const nearestTo31 /*= nullptr*/,
+    const AreaI* const bbox31 /*= nullptr*/,
+    const ObfMapSectionReader::FilterByIdFunction filterById /*= nullptr*/,
+    const ObfMapSectionReader::VisitorFunction visitor /*= nullptr*/,
+    const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/,
+    ObfDataInterface_Metrics::Metric_streamQuery* const metric /*= nullptr*/)
+{
+    const Stopwatch totalStopwatch(metric != nullptr);
+
+    // Each section is read at requested zoom, except basemap that has no data beyond its max zoom
+    struct MapSection
+    {
+        std::shared_ptr<const ObfReader> obfReader;
+        Ref<ObfMapSectionInfo> section;
+        ZoomLevel zoom;
+        AreaI area31;
+    };
+    std::vector<MapSection> mapSections;
+    bool basemapFound = false;
+    for (const auto& obfReader : constOf(obfReaders))
+    {
+        if (queryController && queryController->isAborted())
+            return false;
+
+        const auto& obfInfo = obfReader->obtainInfo();
+
+        auto sectionsZoom = zoom;
+        if (obfInfo->isBasemapWithCoastlines)
+        {
+            // In case there's more than 1 basemap reader present, use only first and warn about this fact
+            if (basemapFound)
+            {
+                LogPrintf(LogSeverityLevel::Warning, "More than 1 basemap available");
+                continue;
+            }
+            basemapFound = true;
+
+            sectionsZoom = qMin(zoom, static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel));
+        }
+
+        for (const auto& mapSection : constOf(obfInfo->mapSections))
+        {
+            // Only levels that have data for zoom are read, so section covers just their area
+            AreaI sectionArea31;
+            bool hasLevels = false;
+            for (const auto& level : constOf(mapSection->levels))
+            {
+                if (level->minZoom > sectionsZoom || level->maxZoom < sectionsZoom)
+                    continue;
+
+                if (hasLevels)
+                    sectionArea31.enlargeToInclude(level->area31);
+                else
+                    sectionArea31 = level->area31;
+                hasLevels = true;
+            }
+            if (!hasLevels)
+                continue;
+
+            if (bbox31)
+            {
+                bool accept = false;
+                accept = accept || sectionArea31.contains(*bbox31);
+                accept = accept || sectionArea31.intersects(*bbox31);
+                accept = accept || bbox31->contains(sectionArea31);
+
+                if (!accept)
+                    continue;
+            }
+
+            MapSection entry;
+            entry.obfReader = obfReader;
+            entry.section = mapSection;
+            entry.zoom = sectionsZoom;
+            entry.area31 = sectionArea31;
+            mapSections.push_back(entry);
+        }
+    }
+
+    if (nearestTo31)
+    {
+        const auto point31 = *nearestTo31;
+        std::stable_sort(mapSections.begin(), mapSections.end(),
+            [point31]
+            (const MapSection& l, const MapSection& r) -> bool
+            {
+                return getSquaredDistanceToArea(point31, l.area31) < getSquaredDistanceToArea(point31, r.area31);
+            });
+    }
+
+    StreamingQuery streamingQuery(limit, queryController, nearestTo31 != nullptr);
+    NearestResults< std::shared_ptr<const OsmAnd::BinaryMapObject> > nearestMapObjects(limit);
+    const ObfMapSectionReader::VisitorFunction sectionVisitor =
+        [&streamingQuery, &nearestMapObjects, visitor, nearestTo31]
+        (const std::shared_ptr<const OsmAnd::BinaryMapObject>& mapObject) -> bool
+        {
+            if (!nearestTo31)
+                return streamingQuery.visit(visitor, mapObject);
+
+            const auto squaredDistance = getSquaredDistanceToArea(*nearestTo31, mapObject->bbox31);
+            return streamingQuery.visitNearest(visitor, mapObject, squaredDistance, nearestMapObjects);
+        };
+
+    // Nearest results are collected aside, since they're known only once all candidates were read
+    const auto pOutMapObjects = nearestTo31 ? nullptr : outMapObjects;
+    const auto parallel = shouldRunInParallel(static_cast<int>(mapSections.size()));
+    std::vector< QList< std::shared_ptr<const OsmAnd::BinaryMapObject> > > sectionsMapObjects(mapSections.size());
+    QVector<SectionTask> tasks;
+    tasks.reserve(static_cast<int>(mapSections.size()));
+    for (auto sectionIndex = 0u; sectionIndex < mapSections.size(); sectionIndex++)
+    {
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
+            {
+                const auto& mapSection = mapSections[sectionIndex];
+                if (nearestTo31 &&
+                    !streamingQuery.shouldVisitSection(
+                        getSquaredDistanceToArea(*nearestTo31, mapSection.area31),
+                        nearestMapObjects))
+                {
+                    return;
+                }
+                streamingQuery.visitedSections.ref();
+
+                // Basemap bbox has to be aligned to zoom it's read at
+                const AreaI* pSectionBBox31 = bbox31;
+                AreaI sectionBBox31;
+                if (bbox31 && mapSection.zoom != zoom)
+                {
+                    sectionBBox31 = Utilities::roundBoundingBox31(*bbox31, mapSection.zoom);
+                    pSectionBBox31 = &sectionBBox31;
+                }
+
+                OsmAnd::ObfMapSectionReader::loadMapObjects(
+                    mapSection.obfReader,
+                    mapSection.section,
+                    mapSection.zoom,
+                    pSectionBBox31,
+                    selectSectionOutput(pOutMapObjects, &sectionsMapObjects[sectionIndex], parallel),
+                    nullptr,
+                    filterById,
+                    sectionVisitor,
+                    nullptr,
+                    nullptr,
+                    streamingQuery.sectionsQueryController);
+            });
+    }
+    runSectionTasks(tasks, streamingQuery.sectionsQueryController);
+
+    if (pOutMapObjects && parallel)
+    {
+        for (auto& sectionMapObjects : sectionsMapObjects)
+            mergeSectionOutput(pOutMapObjects, sectionMapObjects);
+    }
+
+    if (outMapObjects && nearestTo31)
+        nearestMapObjects.takeSorted(outMapObjects);
+
+    streamingQuery.fillMetric(metric, static_cast<unsigned int>(mapSections.size()));
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
+
+    return !streamingQuery.isAborted();
+}
+
+bool OsmAnd::ObfDataInterface::streamAmenities(
+    QList< std::shared_ptr<const OsmAnd::Amenity> >* outAmenities,
+    const unsigned int limit,
+    const PointI* const nearestTo31 /*= nullptr*/,
+    const AreaI* const bbox31 /*= nullptr*/,
+    const QString& nameQuery /*= QString::null*/,
+    const QHash<QString, QStringList>* const categoriesFilter /*= nullptr*/,
+    const ObfPoiSectionReader::VisitorFunction visitor /*= nullptr*/,
+    const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/,
+    ObfDataInterface_Metrics::Metric_streamQuery* const metric /*= nullptr*/)
+{
+    const Stopwatch totalStopwatch(metric != nullptr);
+
+    typedef std::pair< std::shared_ptr<const ObfReader>, Ref<ObfPoiSectionInfo> > PoiSection;
+    std::vector<PoiSection> poiSections;
+    for (const auto& obfReader : constOf(obfReaders))
+    {
+        if (queryController && queryController->isAborted())
+            return false;
+
+        const auto& obfInfo = obfReader->obtainInfo();
+        for (const auto& poiSection : constOf(obfInfo->poiSections))
+        {
+            if (bbox31)
+            {
+                bool accept = false;
+                accept = accept || poiSection->area31.contains(*bbox31);
+                accept = accept || poiSection->area31.intersects(*bbox31);
+                accept = accept || bbox31->contains(poiSection->area31);
+
+                if (!accept)
+                    continue;
+            }
+
+            poiSections.push_back(PoiSection(obfReader, poiSection));
+        }
+    }
+
+    // Sections that contain point (or are nearest to it) are read first, so quota is mostly met by them
+    if (nearestTo31)
+    {
+        const auto point31 = *nearestTo31;
+        std::stable_sort(poiSections.begin(), poiSections.end(),
+            [point31]
+            (const PoiSection& l, const PoiSection& r) -> bool
+            {
+                return getSquaredDistanceToArea(point31, l.second->area31) <
+                    getSquaredDistanceToArea(point31, r.second->area31);
+            });
+    }
+
+    StreamingQuery streamingQuery(limit, queryController, nearestTo31 != nullptr);
+    NearestResults< std::shared_ptr<const OsmAnd::Amenity> > nearestAmenities(limit);
+    const ObfPoiSectionReader::VisitorFunction sectionVisitor =
+        [&streamingQuery, &nearestAmenities, visitor, nearestTo31]
+        (const std::shared_ptr<const OsmAnd::Amenity>& amenity) -> bool
+        {
+            if (!nearestTo31)
+                return streamingQuery.visit(visitor, amenity);
+
+            const auto squaredDistance = Utilities::squareDistance31(*nearestTo31, amenity->position31);
+            return streamingQuery.visitNearest(visitor, amenity, squaredDistance, nearestAmenities);
+        };
+
+    // Nearest results are collected aside, since they're known only once all candidates were read
+    const auto pOutAmenities = nearestTo31 ? nullptr : outAmenities;
+    const auto parallel = shouldRunInParallel(static_cast<int>(poiSections.size()));
+    std::vector< QList< std::shared_ptr<const OsmAnd::Amenity> > > sectionsAmenities(poiSections.size());
+    QVector<SectionTask> tasks;
+    tasks.reserve(static_cast<int>(poiSections.size()));
+    for (auto sectionIndex = 0u; sectionIndex < poiSections.size(); sectionIndex++)
+    {
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
+            {
+                const auto& obfReader = poiSections[sectionIndex].first;
+                const auto& poiSection = poiSections[sectionIndex].second;
+                const auto& sectionQueryController = streamingQuery.sectionsQueryController;
+                if (nearestTo31 &&
+                    !streamingQuery.shouldVisitSection(
+                        getSquaredDistanceToArea(*nearestTo31, poiSection->area31),
+                        nearestAmenities))
+                {
+                    return;
+                }
+                streamingQuery.visitedSections.ref();
+
+                QSet<ObfPoiCategoryId> categoriesFilterById;
+                if (categoriesFilter &&
+                    !resolvePoiCategoriesFilter(obfReader, poiSection, *categoriesFilter, categoriesFilterById, sectionQueryController))
+                {
+                    return;
+                }
+
+                if (nameQuery.isEmpty())
+                {
+                    OsmAnd::ObfPoiSectionReader::loadAmenities(
+                        obfReader,
+                        poiSection,
+                        selectSectionOutput(pOutAmenities, &sectionsAmenities[sectionIndex], parallel),
+                        bbox31,
+                        nullptr,
+                        InvalidZoomLevel,
+                        categoriesFilter ? &categoriesFilterById : nullptr,
+                        sectionVisitor,
+                        sectionQueryController);
+                }
+                else
+                {
+                    OsmAnd::ObfPoiSectionReader::scanAmenitiesByName(
+                        obfReader,
+                        poiSection,
+                        nameQuery,
+                        selectSectionOutput(pOutAmenities, &sectionsAmenities[sectionIndex], parallel),
+                        nearestTo31,
+                        bbox31,
+                        nullptr,
+                        categoriesFilter ? &categoriesFilterById : nullptr,
+                        sectionVisitor,
+                        sectionQueryController);
+                }
+            });
+    }
+    runSectionTasks(tasks, streamingQuery.sectionsQueryController);
+
+    if (pOutAmenities && parallel)
+    {
+        for (auto& sectionAmenities : sectionsAmenities)
+            mergeSectionOutput(pOutAmenities, sectionAmenities);
+    }
+
+    if (outAmenities && nearestTo31)
+        nearestAmenities.takeSorted(outAmenities);
+
+    streamingQuery.fillMetric(metric, static_cast<unsigned int>(poiSections.size()));
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
+
+    // Reaching the limit is a regular completion of streaming query
+    return !streamingQuery.isAborted();
+}
+
+bool OsmAnd::ObfDataInterface::streamAddressesByName(
+    const QString& query,
+    const StringMatcherMode matcherMode,
+    QList< std::shared_ptr<const OsmAnd::Address> >* outAddresses,
+    const unsigned int limit,
+    const PointI* const nearestTo31 /*= nullptr*/,
+    const AreaI* const bbox31 /*= nullptr*/,
+    const ObfAddressStreetGroupTypesMask streetGroupTypesFilter /*= fullObfAddressStreetGroupTypesMask()*/,
+    const bool includeStreets /*= true*/,
+    const ObfAddressSectionReader::VisitorFunction visitor /*= nullptr*/,
+    const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/,
+    ObfDataInterface_Metrics::Metric_streamQuery* const metric /*= nullptr*/)
+{
+    const Stopwatch totalStopwatch(metric != nullptr);
+
+    typedef std::pair< std::shared_ptr<const ObfReader>, Ref<ObfAddressSectionInfo> > AddressSection;
+    std::vector<AddressSection> addressSections;
+    for (const auto& obfReader : constOf(obfReaders))
+    {
+        if (queryController && queryController->isAborted())
+            return false;
+
+        const auto& obfInfo = obfReader->obtainInfo();
+        for (const auto& addressSection : constOf(obfInfo->addressSections))
+        {
+            if (bbox31)
+            {
+                bool accept = false;
+                accept = accept || addressSection->area31.contains(*bbox31);
+                accept = accept || addressSection->area31.intersects(*bbox31);
+                accept = accept || bbox31->contains(addressSection->area31);
+
+                if (!accept)
+                    continue;
+            }
+
+            addressSections.push_back(AddressSection(obfReader, addressSection));
+        }
+    }
+
+    if (nearestTo31)
+    {
+        const auto point31 = *nearestTo31;
+        std::stable_sort(addressSections.begin(), addressSections.end(),
+            [point31]
+            (const AddressSection& l, const AddressSection& r) -> bool
+            {
+                return getSquaredDistanceToArea(point31, l.second->area31) <
+                    getSquaredDistanceToArea(point31, r.second->area31);
+            });
+    }
+
+    StreamingQuery streamingQuery(limit, queryController, nearestTo31 != nullptr);
+    NearestResults< std::shared_ptr<const OsmAnd::Address> > nearestAddresses(limit);
+    const ObfAddressSectionReader::VisitorFunction sectionVisitor =
+        [&streamingQuery, &nearestAddresses, visitor, nearestTo31]
+        (const std::shared_ptr<const OsmAnd::Address>& address) -> bool
+        {
+            if (!nearestTo31)
+                return streamingQuery.visit(visitor, address);
+
+            const auto squaredDistance = Utilities::squareDistance31(*nearestTo31, address->position31);
+            return streamingQuery.visitNearest(visitor, address, squaredDistance, nearestAddresses);
+        };
+
+    // Nearest results are collected aside, since they're known only once all candidates were read
+    const auto pOutAddresses = nearestTo31 ? nullptr : outAddresses;
+    const auto parallel = shouldRunInParallel(static_cast<int>(addressSections.size()));
+    std::vector< QList< std::shared_ptr<const OsmAnd::Address> > > sectionsAddresses(addressSections.size());
+    QVector<SectionTask> tasks;
+    tasks.reserve(static_cast<int>(addressSections.size()));
+    for (auto sectionIndex = 0u; sectionIndex < addressSections.size(); sectionIndex++)
+    {
+        tasks.push_back(
+            [&, sectionIndex]
+            ()
+            {
+                if (nearestTo31 &&
+                    !streamingQuery.shouldVisitSection(
+                        getSquaredDistanceToArea(*nearestTo31, addressSections[sectionIndex].second->area31),
+                        nearestAddresses))
+                {
+                    return;
+                }
+                streamingQuery.visitedSections.ref();
+
+                OsmAnd::ObfAddressSectionReader::scanAddressesByName(
+                    addressSections[sectionIndex].first,
+                    addressSections[sectionIndex].second,
+                    query,
+                    matcherMode,
+                    selectSectionOutput(pOutAddresses, &sectionsAddresses[sectionIndex], parallel),
+                    bbox31,
+                    streetGroupTypesFilter,
+                    includeStreets,
+                    sectionVisitor,
+                    streamingQuery.sectionsQueryController);
+            });
+    }
+    runSectionTasks(tasks, streamingQuery.sectionsQueryController);
+
+    if (pOutAddresses && parallel)
+    {
+        for (auto& sectionAddresses : sectionsAddresses)
+            mergeSectionOutput(pOutAddresses, sectionAddresses);
+    }
+
+    if (outAddresses && nearestTo31)
+        nearestAddresses.takeSorted(outAddresses);
+
+    streamingQuery.fillMetric(metric, static_cast<unsigned int>(addressSections.size()));
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
+
+    return !streamingQuery.isAborted();
+}
+
 bool OsmAnd::ObfDataInterface::loadStreetGroups(
     QList< std::shared_ptr<const StreetGroup> >* resultOut /*= nullptr*/,
     const AreaI* const bbox31 /*= nullptr*/,
@@ -0,0 +1,30 @@
+#include "ObfDataInterface_Metrics.h"
+
+OsmAnd::ObfDataInterface_Metrics::Metric_streamQuery::Metric_streamQuery()
+{
+    reset();
+}
+
+OsmAnd::ObfDataInterface_Metrics::Metric_streamQuery::~Metric_streamQuery()
+{
+}
+
+void OsmAnd::ObfDataInterface_Metrics::Metric_streamQuery::reset()
+{
+    OsmAnd__ObfDataInterface_Metrics__Metric_streamQuery__FIELDS(RESET_METRIC_FIELD);
+
+    Metric::reset();
+}
+
+QString OsmAnd::ObfDataInterface_Metrics::Metric_streamQuery::toString(const bool shortFormat /*= false*/, const QString& prefix /*= QString::null*/) const
+{
+    QString output;
+
+    OsmAnd__ObfDataInterface_Metrics__Metric_streamQuery__FIELDS(PRINT_METRIC_FIELD);
+
+    const auto submetricsString = Metric::toString(shortFormat, prefix);
+    if (!submetricsString.isEmpty())
+        output += QLatin1String("\n") + Metric::toString(shortFormat, prefix);
+
+    return output;
+}
@@ -1,8 +1,9 @@
 #include "ObfsCollection.h"
 #include "ObfsCollection_P.h"
 
-OsmAnd::ObfsCollection::ObfsCollection()
+OsmAnd::ObfsCollection::ObfsCollection(const QString& obfInfoCachePath_ /*= QString::null*/)
     : _p(new ObfsCollection_P(this))
+    , obfInfoCachePath(obfInfoCachePath_)
 {
 }
 
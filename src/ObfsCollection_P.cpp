@@ -10,17 +10,28 @@
 #include "ObfDataInterface.h"
 #include "ObfFile.h"
 #include "ObfInfo.h"
+#include "ObfInfoCache.h"
+#include "ObfMapSectionInfo.h"
+#include "ObfRoutingSectionInfo.h"
+#include "ObfAddressSectionInfo.h"
+#include "ObfPoiSectionInfo.h"
 #include "QKeyValueIterator.h"
 #include "Stopwatch.h"
 #include "Utilities.h"
 #include "Logging.h"
 
+QThreadStorage<float> OsmAnd::ObfsCollection_P::_selectionTime;
+
 OsmAnd::ObfsCollection_P::ObfsCollection_P(ObfsCollection* owner_)
     : owner(owner_)
     , _fileSystemWatcher(new QFileSystemWatcher())
     , _lastUnusedSourceOriginId(0)
     , _collectedSourcesInvalidated(1)
+    , _sharedReadersGeneration(0)
 {
+    for (auto& sectionsTree : _sectionsIndex)
+        sectionsTree = IndexedSectionsTree(AreaI::largestPositive(), 12);
+
     _fileSystemWatcher->moveToThread(gMainThread);
 
     _onDirectoryChangedConnection = QObject::connect(
@@ -54,8 +65,17 @@ void OsmAnd::ObfsCollection_P::collectSources() const
     if (invalidationsToProcess == 0)
         return;
 
+    QWriteLocker scopedLocker3(&_sectionsIndexLock);
+
     const Stopwatch collectSourcesStopwatch(true);
 
+    // Capture files that were reported as changed, since their headers may be different now
+    QSet<QString> changedFiles;
+    {
+        QMutexLocker scopedLocker4(&_changedFilesMutex);
+        changedFiles.swap(_changedFiles);
+    }
+
     // Check all previously collected sources
     auto itCollectedSourcesEntry = mutableIteratorOf(_collectedSources);
     while(itCollectedSourcesEntry.hasNext())
@@ -72,7 +92,10 @@ void OsmAnd::ObfsCollection_P::collectSources() const
             // Ensure that ObfFile is not being read anywhere
             for(const auto& itCollectedSource : rangeOf(collectedSources))
             {
+                releaseSharedReader(itCollectedSource.key());
+                removeFromSectionsIndex(itCollectedSource.key());
                 const auto obfFile = itCollectedSource.value();
+                ObfInfoCache::remove(obfFile->infoCacheFilePath);
 
                 //NOTE: OBF should have been locked here, but since file is gone anyways, this lock is quite useless
 
@@ -84,19 +107,25 @@ void OsmAnd::ObfsCollection_P::collectSources() const
             continue;
         }
 
-        // Check for missing files
+        // Check for missing or changed files
         auto itObfFileEntry = mutableIteratorOf(collectedSources);
         while(itObfFileEntry.hasNext())
         {
             const auto& sourceFilename = itObfFileEntry.next().key();
-            if (QFile::exists(sourceFilename))
+            const auto isChanged = changedFiles.contains(sourceFilename);
+            if (!isChanged && QFile::exists(sourceFilename))
                 continue;
+            releaseSharedReader(sourceFilename);
+            removeFromSectionsIndex(sourceFilename);
             const auto obfFile = itObfFileEntry.value();
 
+            // Sidecar describes previous state of the file, so it's useless now
+            ObfInfoCache::remove(obfFile->infoCacheFilePath);
+
             //NOTE: OBF should have been locked here, but since file is gone anyways, this lock is quite useless
 
             itObfFileEntry.remove();
-            assert(obfFile.use_count() == 1);
+            assert(isChanged || obfFile.use_count() == 1);
         }
 
         // If all collected sources for current source origin are gone,
@@ -130,8 +159,9 @@ void OsmAnd::ObfsCollection_P::collectSources() const
                 if (collectedSources.constFind(obfFilePath) != collectedSources.cend())
                     continue;
                 
-                auto obfFile = new ObfFile(obfFilePath, obfFileInfo.size());
-                collectedSources.insert(obfFilePath, std::shared_ptr<ObfFile>(obfFile));
+                const auto obfFile = createObfFile(obfFilePath, obfFileInfo.size());
+                addToSectionsIndex(obfFile);
+                collectedSources.insert(obfFilePath, obfFile);
             }
 
             if (directoryAsSourceOrigin->isRecursive)
@@ -160,8 +190,9 @@ void OsmAnd::ObfsCollection_P::collectSources() const
             if (collectedSources.constFind(obfFilePath) != collectedSources.cend())
                 continue;
 
-            auto obfFile = new ObfFile(obfFilePath, fileAsSourceOrigin->fileInfo.size());
-            collectedSources.insert(obfFilePath, std::shared_ptr<ObfFile>(obfFile));
+            const auto obfFile = createObfFile(obfFilePath, fileAsSourceOrigin->fileInfo.size());
+            addToSectionsIndex(obfFile);
+            collectedSources.insert(obfFilePath, obfFile);
         }
     }
 
@@ -171,6 +202,21 @@ void OsmAnd::ObfsCollection_P::collectSources() const
     LogPrintf(LogSeverityLevel::Info, "Collected OBF sources in %fs", collectSourcesStopwatch.elapsed());
 }
 
+std::shared_ptr<OsmAnd::ObfFile> OsmAnd::ObfsCollection_P::createObfFile(
+    const QString& filePath,
+    const uint64_t fileSize) const
+{
+    const std::shared_ptr<ObfFile> obfFile(new ObfFile(
+        filePath,
+        fileSize,
+        ObfInfoCache::getCacheFilePath(owner->obfInfoCachePath, filePath)));
+
+    // Headers from valid sidecar allow to filter this file without opening it
+    obfFile->loadInfoFromCache();
+
+    return obfFile;
+}
+
 QList<OsmAnd::ObfsCollection::SourceOriginId> OsmAnd::ObfsCollection_P::getSourceOriginIds() const
 {
     QReadLocker scopedLocker(&_sourcesOriginsLock);
@@ -291,47 +337,211 @@ std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ObfsCollection_P::obtainDataIn
     if (_collectedSourcesInvalidated.loadAcquire() > 0)
         collectSources();
 
-    // Create ObfReaders from collected sources
     QList< std::shared_ptr<const ObfReader> > obfReaders;
     {
-        QReadLocker scopedLocker(&_collectedSourcesLock);
+        QReadLocker scopedLocker1(&_collectedSourcesLock);
 
-        for (const auto& collectedSources : constOf(_collectedSources))
+        // Select candidates from index, while files without known headers can only be checked after opening
+        const Stopwatch selectionStopwatch(true);
+        QList< std::shared_ptr<const ObfFile> > candidateObfFiles;
+        QList< std::shared_ptr<const ObfFile> > unindexedObfFiles;
         {
-            obfReaders.reserve(obfReaders.size() + collectedSources.size());
-            for (const auto& obfFile : constOf(collectedSources))
-            {
-                // If OBF information already available, perform check
-                if (obfFile->obfInfo &&
-                    !obfFile->obfInfo->isBasemap &&
-                    !obfFile->obfInfo->isBasemapWithCoastlines)
-                {
-                    bool accept = obfFile->obfInfo->containsDataFor(pBbox31, minZoomLevel, maxZoomLevel, desiredDataTypes);
-                    if (!accept)
-                        continue;
-                }
+            QReadLocker scopedLocker2(&_sectionsIndexLock);
 
-                // Otherwise, open file in any case to repeat check
-                std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfFile));
-                if (!obfReader->isOpened() || !obfReader->obtainInfo())
-                    continue;
+            querySectionsIndex(pBbox31, minZoomLevel, maxZoomLevel, desiredDataTypes, candidateObfFiles);
+            unindexedObfFiles = _unindexedFiles.values();
+        }
+        _selectionTime.setLocalData(_selectionTime.localData() + selectionStopwatch.elapsed());
 
-                // Repeat checks if needed
-                if (!obfFile->obfInfo->isBasemap && !obfFile->obfInfo->isBasemapWithCoastlines)
-                {
-                    bool accept = obfFile->obfInfo->containsDataFor(pBbox31, minZoomLevel, maxZoomLevel, desiredDataTypes);
-                    if (!accept)
-                        continue;
-                }
+        obfReaders.reserve(candidateObfFiles.size() + unindexedObfFiles.size());
+        for (const auto& obfFile : constOf(candidateObfFiles))
+        {
+            const auto obfReader = obtainSharedReader(obfFile);
+            if (!obfReader)
+                continue;
 
-                obfReaders.push_back(qMove(obfReader));
+            obfReaders.push_back(qMove(obfReader));
+        }
+
+        for (const auto& obfFile : constOf(unindexedObfFiles))
+        {
+            // Open file (or reuse already opened one) to get its headers
+            const auto obfReader = obtainSharedReader(obfFile);
+            if (!obfReader)
+                continue;
+
+            // Now headers are known, so file can be indexed for next requests
+            {
+                QWriteLocker scopedLocker2(&_sectionsIndexLock);
+
+                if (_unindexedFiles.contains(obfFile->filePath))
+                    addToSectionsIndex(obfFile);
+            }
+
+            if (!obfFile->obfInfo->isBasemap && !obfFile->obfInfo->isBasemapWithCoastlines)
+            {
+                bool accept = obfFile->obfInfo->containsDataFor(pBbox31, minZoomLevel, maxZoomLevel, desiredDataTypes);
+                if (!accept)
+                    continue;
             }
+
+            obfReaders.push_back(qMove(obfReader));
         }
     }
 
     return std::shared_ptr<ObfDataInterface>(new ObfDataInterface(obfReaders));
 }
 
+void OsmAnd::ObfsCollection_P::addToSectionsIndex(const std::shared_ptr<const ObfFile>& obfFile) const
+{
+    const auto& filePath = obfFile->filePath;
+    const auto& obfInfo = obfFile->obfInfo;
+    if (!obfInfo)
+    {
+        _unindexedFiles.insert(filePath, obfFile);
+        return;
+    }
+    _unindexedFiles.remove(filePath);
+
+    // Basemaps are always selected, so there's no need to index them
+    if (obfInfo->isBasemap || obfInfo->isBasemapWithCoastlines)
+    {
+        _indexedBasemapFiles.insert(filePath, obfFile);
+        return;
+    }
+
+    auto& indexedSections = _indexedFiles[filePath];
+    const auto indexSection =
+        [this, obfFile, &indexedSections]
+        (const ObfDataType dataType, const AreaI& area31, const ZoomLevel minZoom, const ZoomLevel maxZoom)
+        {
+            const std::shared_ptr<IndexedSection> indexedSection(new IndexedSection());
+            indexedSection->obfFile = obfFile;
+            indexedSection->minZoom = minZoom;
+            indexedSection->maxZoom = maxZoom;
+            indexedSection->area31 = area31;
+
+            _sectionsIndex[static_cast<int>(dataType)].insert(indexedSection, area31);
+            indexedSections.push_back(std::make_pair(dataType, std::shared_ptr<const IndexedSection>(indexedSection)));
+        };
+
+    for (const auto& mapSection : constOf(obfInfo->mapSections))
+    {
+        for (const auto& level : constOf(mapSection->levels))
+            indexSection(ObfDataType::Map, level->area31, level->minZoom, level->maxZoom);
+    }
+    for (const auto& routingSection : constOf(obfInfo->routingSections))
+        indexSection(ObfDataType::Routing, routingSection->area31, MinZoomLevel, MaxZoomLevel);
+    for (const auto& addressSection : constOf(obfInfo->addressSections))
+        indexSection(ObfDataType::Address, addressSection->area31, MinZoomLevel, MaxZoomLevel);
+    for (const auto& poiSection : constOf(obfInfo->poiSections))
+        indexSection(ObfDataType::POI, poiSection->area31, MinZoomLevel, MaxZoomLevel);
+}
+
+void OsmAnd::ObfsCollection_P::removeFromSectionsIndex(const QString& filePath) const
+{
+    _unindexedFiles.remove(filePath);
+    _indexedBasemapFiles.remove(filePath);
+
+    const auto itIndexedFile = _indexedFiles.find(filePath);
+    if (itIndexedFile == _indexedFiles.end())
+        return;
+
+    for (const auto& indexedSectionEntry : constOf(*itIndexedFile))
+    {
+        const auto& indexedSection = indexedSectionEntry.second;
+        _sectionsIndex[static_cast<int>(indexedSectionEntry.first)].removeOne(indexedSection, indexedSection->area31);
+    }
+    _indexedFiles.erase(itIndexedFile);
+}
+
+void OsmAnd::ObfsCollection_P::querySectionsIndex(
+    const AreaI* const pBbox31,
+    const ZoomLevel minZoomLevel,
+    const ZoomLevel maxZoomLevel,
+    const ObfDataTypesMask desiredDataTypes,
+    QList< std::shared_ptr<const ObfFile> >& outObfFiles) const
+{
+    outObfFiles.append(_indexedBasemapFiles.values());
+
+    const IndexedSectionsTree::Acceptor acceptor =
+        [minZoomLevel, maxZoomLevel]
+        (const std::shared_ptr<const IndexedSection>& indexedSection, const IndexedSectionsTree::BBox& bbox) -> bool
+        {
+            return (minZoomLevel <= indexedSection->maxZoom && indexedSection->minZoom <= maxZoomLevel);
+        };
+
+    QSet<QString> selectedFilePaths;
+    for (auto dataTypeIdx = 0; dataTypeIdx < IndexedDataTypesCount; dataTypeIdx++)
+    {
+        if (!desiredDataTypes.isSet(static_cast<ObfDataType>(dataTypeIdx)))
+            continue;
+
+        QList< std::shared_ptr<const IndexedSection> > indexedSections;
+        if (pBbox31)
+            _sectionsIndex[dataTypeIdx].query(*pBbox31, indexedSections, false, acceptor);
+        else
+            _sectionsIndex[dataTypeIdx].get(indexedSections, acceptor);
+
+        for (const auto& indexedSection : constOf(indexedSections))
+        {
+            const auto& obfFile = indexedSection->obfFile;
+            if (selectedFilePaths.contains(obfFile->filePath))
+                continue;
+            selectedFilePaths.insert(obfFile->filePath);
+
+            outObfFiles.push_back(obfFile);
+        }
+    }
+}
+
+float OsmAnd::ObfsCollection_P::getSelectionTimeInCurrentThread()
+{
+    return _selectionTime.localData();
+}
+
+std::shared_ptr<const OsmAnd::ObfReader> OsmAnd::ObfsCollection_P::obtainSharedReader(
+    const std::shared_ptr<const ObfFile>& obfFile) const
+{
+    unsigned int sharedReadersGeneration;
+    {
+        QMutexLocker scopedLocker(&_sharedReadersMutex);
+
+        const auto citSharedReader = _sharedReaders.constFind(obfFile->filePath);
+        if (citSharedReader != _sharedReaders.cend())
+            return *citSharedReader;
+        sharedReadersGeneration = _sharedReadersGeneration;
+    }
+
+    // Reader is shared by all threads that request data, so it's thread-safe. It reads file via positional reads
+    // rather than mapping it, since file replaced in-place while being mapped would crash on next access.
+    // Opening it and reading its headers is slow, so that's done without lock, and other files are not blocked
+    std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfFile, false, true));
+    if (!obfReader->isOpened() || !obfReader->obtainInfo())
+        return nullptr;
+
+    QMutexLocker scopedLocker(&_sharedReadersMutex);
+
+    // Another thread may have opened same file meanwhile, then its reader is used so that only one stays shared
+    const auto citSharedReader = _sharedReaders.constFind(obfFile->filePath);
+    if (citSharedReader != _sharedReaders.cend())
+        return *citSharedReader;
+
+    // If any reader was released meanwhile, file may have been changed after this reader was opened, so it's used
+    // only by this request and not shared
+    if (sharedReadersGeneration == _sharedReadersGeneration)
+        _sharedReaders.insert(obfFile->filePath, obfReader);
+    return obfReader;
+}
+
+void OsmAnd::ObfsCollection_P::releaseSharedReader(const QString& filePath) const
+{
+    QMutexLocker scopedLocker(&_sharedReadersMutex);
+
+    _sharedReaders.remove(filePath);
+    _sharedReadersGeneration++;
+}
+
 void OsmAnd::ObfsCollection_P::onDirectoryChanged(const QString& path)
 {
     invalidateCollectedSources();
@@ -339,5 +549,14 @@ void OsmAnd::ObfsCollection_P::onDirectoryChanged(const QString& path)
 
 void OsmAnd::ObfsCollection_P::onFileChanged(const QString& path)
 {
+    const auto filePath = QFileInfo(path).canonicalFilePath();
+    {
+        QMutexLocker scopedLocker(&_changedFilesMutex);
+        _changedFiles.insert(filePath);
+    }
+
+    // Don't hand out reader of previous state of the file till sources are collected again
+    releaseSharedReader(filePath);
+
     invalidateCollectedSources();
 }
@@ -8,17 +8,21 @@
 #include <QHash>
 #include <QSet>
 #include <QReadWriteLock>
+#include <QMutex>
+#include <QThreadStorage>
 #include <QFileSystemWatcher>
 #include <QEventLoop>
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
 #include "PrivateImplementation.h"
+#include "QuadTree.h"
 #include "ObfsCollection.h"
 
 namespace OsmAnd
 {
     class ObfFile;
+    class ObfReader;
     class ObfDataInterface;
 
     class ObfsCollection;
@@ -80,9 +84,50 @@ namespace OsmAnd
         mutable QHash< ObfsCollection::SourceOriginId, QHash<QString, std::shared_ptr<ObfFile> > > _collectedSources;
         mutable QReadWriteLock _collectedSourcesLock;
         void collectSources() const;
+        std::shared_ptr<ObfFile> createObfFile(const QString& filePath, const uint64_t fileSize) const;
+
+        mutable QSet<QString> _changedFiles;
+        mutable QMutex _changedFilesMutex;
+
+        // Spatial index of section (and map level) bounding boxes of all collected files.
+        // Each data type has own tree, while zoom range is checked on each found entry.
+        struct IndexedSection
+        {
+            std::shared_ptr<const ObfFile> obfFile;
+            ZoomLevel minZoom;
+            ZoomLevel maxZoom;
+            AreaI area31;
+        };
+        typedef QuadTree< std::shared_ptr<const IndexedSection>, AreaI::CoordType > IndexedSectionsTree;
+        enum {
+            IndexedDataTypesCount = static_cast<int>(ObfDataType::POI) + 1,
+        };
+        mutable IndexedSectionsTree _sectionsIndex[IndexedDataTypesCount];
+        mutable QHash< QString, QList< std::pair<ObfDataType, std::shared_ptr<const IndexedSection> > > > _indexedFiles;
+        mutable QHash< QString, std::shared_ptr<const ObfFile> > _indexedBasemapFiles;
+        mutable QHash< QString, std::shared_ptr<const ObfFile> > _unindexedFiles;
+        mutable QReadWriteLock _sectionsIndexLock;
+        void addToSectionsIndex(const std::shared_ptr<const ObfFile>& obfFile) const;
+        void removeFromSectionsIndex(const QString& filePath) const;
+        void querySectionsIndex(
+            const AreaI* const pBbox31,
+            const ZoomLevel minZoomLevel,
+            const ZoomLevel maxZoomLevel,
+            const ObfDataTypesMask desiredDataTypes,
+            QList< std::shared_ptr<const ObfFile> >& outObfFiles) const;
+
+        static QThreadStorage<float> _selectionTime;
+
+        mutable QHash< QString, std::shared_ptr<const ObfReader> > _sharedReaders;
+        mutable QMutex _sharedReadersMutex;
+        mutable unsigned int _sharedReadersGeneration;
+        std::shared_ptr<const ObfReader> obtainSharedReader(const std::shared_ptr<const ObfFile>& obfFile) const;
+        void releaseSharedReader(const QString& filePath) const;
     public:
         virtual ~ObfsCollection_P();
 
+        static float getSelectionTimeInCurrentThread();
+
         ImplementationInterface<ObfsCollection> owner;
 
         QList<ObfsCollection::SourceOriginId> getSourceOriginIds() const;
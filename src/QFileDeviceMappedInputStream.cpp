@@ -0,0 +1,133 @@
+#include "QFileDeviceMappedInputStream.h"
+
+#include "Logging.h"
+
+namespace OsmAnd
+{
+    namespace gpb = google::obf_protobuf;
+}
+
+OsmAnd::QFileDeviceMappedInputStream::QFileDeviceMappedInputStream(const std::shared_ptr<QFileDevice>& file_)
+    : _file(file_)
+    , _fileSize(_file->size())
+    , _mappedMemory(nullptr)
+    , _currentPosition(0)
+    , _closeOnDestruction(false)
+    , file(_file)
+{
+    // If file is not opened, open it
+    if (!_file->isOpen())
+    {
+        if (!_file->open(QIODevice::ReadOnly))
+        {
+            LogPrintf(LogSeverityLevel::Warning,
+                "Failed to open '%s' for mapping: (%d) %s",
+                qPrintable(file->fileName()),
+                static_cast<int>(file->error()),
+                qPrintable(file->errorString()));
+            return;
+        }
+        _closeOnDestruction = true;
+    }
+
+    // Map entire file at once
+    if (_fileSize > 0)
+        _mappedMemory = _file->map(0, _fileSize);
+    if (Q_UNLIKELY(!_mappedMemory))
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to map %" PRIi64 " bytes from '%s' (handle 0x%08x) into memory: (%d) %s",
+            _fileSize,
+            qPrintable(file->fileName()),
+            file->handle(),
+            static_cast<int>(file->error()),
+            qPrintable(file->errorString()));
+    }
+}
+
+OsmAnd::QFileDeviceMappedInputStream::~QFileDeviceMappedInputStream()
+{
+    if (_mappedMemory)
+    {
+        const auto ok = _file->unmap(_mappedMemory);
+        if (!ok)
+        {
+            LogPrintf(LogSeverityLevel::Warning,
+                "Failed to unmap memory %p of '%s' (handle 0x%08x): (%d) %s",
+                _mappedMemory,
+                qPrintable(file->fileName()),
+                file->handle(),
+                static_cast<int>(file->error()),
+                qPrintable(file->errorString()));
+        }
+
+        _mappedMemory = nullptr;
+    }
+
+    // If file was opened during work, close it
+    if (_closeOnDestruction && _file->isOpen())
+        _file->close();
+}
+
+bool OsmAnd::QFileDeviceMappedInputStream::isMapped() const
+{
+    return (_mappedMemory != nullptr);
+}
+
+const uint8_t* OsmAnd::QFileDeviceMappedInputStream::getMappedMemory() const
+{
+    return _mappedMemory;
+}
+
+qint64 OsmAnd::QFileDeviceMappedInputStream::getMappedSize() const
+{
+    return _mappedMemory ? _fileSize : 0;
+}
+
+bool OsmAnd::QFileDeviceMappedInputStream::Next(const void** data, int* size)
+{
+    // Check if current position is in valid range
+    if (Q_UNLIKELY(!_mappedMemory || _currentPosition < 0 || _currentPosition >= _fileSize))
+    {
+        *data = nullptr;
+        *size = 0;
+        return false;
+    }
+
+    // Return everything that is left, but no more than fits into int
+    auto chunkSize = _fileSize - _currentPosition;
+    if (Q_UNLIKELY(chunkSize > std::numeric_limits<int>::max()))
+        chunkSize = std::numeric_limits<int>::max();
+
+    *data = _mappedMemory + _currentPosition;
+    *size = static_cast<int>(chunkSize);
+
+    _currentPosition += chunkSize;
+    return true;
+}
+
+void OsmAnd::QFileDeviceMappedInputStream::BackUp(int count)
+{
+    if (count > _currentPosition)
+        _currentPosition = 0;
+    else
+        _currentPosition -= count;
+}
+
+bool OsmAnd::QFileDeviceMappedInputStream::Skip(int count)
+{
+    // Landing exactly at the end is a successful skip, only skipping past the end fails
+    if (Q_UNLIKELY(count < 0 || _currentPosition + count > _fileSize))
+    {
+        _currentPosition = _fileSize;
+        return false;
+    }
+
+    _currentPosition += count;
+    return true;
+}
+
+OsmAnd::gpb::int64 OsmAnd::QFileDeviceMappedInputStream::ByteCount() const
+{
+    return static_cast<gpb::int64>(_currentPosition);
+}
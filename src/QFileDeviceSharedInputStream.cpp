@@ -0,0 +1,120 @@
+#include "QFileDeviceSharedInputStream.h"
+
+#include "Logging.h"
+
+namespace OsmAnd
+{
+    namespace gpb = google::obf_protobuf;
+}
+
+OsmAnd::QFileDeviceSharedInputStream::QFileDeviceSharedInputStream(
+    const std::shared_ptr<QFileDevice>& file_,
+    const std::shared_ptr<QMutex>& fileMutex_,
+    const size_t bufferSize_ /*= DefaultBufferSize*/)
+    : _file(file_)
+    , _fileMutex(fileMutex_)
+    , _fileSize(_file->size())
+    , _buffer(static_cast<int>(bufferSize_), Qt::Uninitialized)
+    , _bufferOffset(0)
+    , _bufferLength(0)
+    , _currentPosition(0)
+    , file(_file)
+{
+}
+
+OsmAnd::QFileDeviceSharedInputStream::~QFileDeviceSharedInputStream()
+{
+}
+
+bool OsmAnd::QFileDeviceSharedInputStream::Next(const void** data, int* size)
+{
+    // Check if current position is in valid range
+    if (Q_UNLIKELY(_currentPosition < 0 || _currentPosition >= _fileSize))
+    {
+        *data = nullptr;
+        *size = 0;
+        return false;
+    }
+
+    // If current position is outside of buffered data, read new portion of data
+    if (_currentPosition < _bufferOffset || _currentPosition >= _bufferOffset + _bufferLength)
+    {
+        auto readSize = static_cast<qint64>(_buffer.size());
+        if (_currentPosition + readSize >= _fileSize)
+            readSize = _fileSize - _currentPosition;
+
+        qint64 bytesRead = -1;
+        {
+            QMutexLocker scopedLocker(_fileMutex.get());
+
+            // File is opened and closed only by its owner, so once it's closed there's nothing to read
+            if (Q_UNLIKELY(!_file->isOpen()))
+            {
+                LogPrintf(LogSeverityLevel::Warning,
+                    "Failed to read '%s': file is not opened",
+                    qPrintable(file->fileName()));
+
+                *data = nullptr;
+                *size = 0;
+                return false;
+            }
+
+            if (_file->seek(_currentPosition))
+                bytesRead = _file->read(_buffer.data(), readSize);
+        }
+
+        // Check if data was read successfully
+        if (Q_UNLIKELY(bytesRead <= 0))
+        {
+            LogPrintf(LogSeverityLevel::Warning,
+                "Failed to read %" PRIi64 " bytes starting at %" PRIi64 " offset from '%s': (%d) %s",
+                readSize,
+                _currentPosition,
+                qPrintable(file->fileName()),
+                static_cast<int>(file->error()),
+                qPrintable(file->errorString()));
+
+            _bufferLength = 0;
+            *data = nullptr;
+            *size = 0;
+            return false;
+        }
+
+        _bufferOffset = _currentPosition;
+        _bufferLength = static_cast<int>(bytesRead);
+    }
+
+    // Return everything that is left in buffer
+    const auto offsetInBuffer = static_cast<int>(_currentPosition - _bufferOffset);
+    *data = _buffer.constData() + offsetInBuffer;
+    *size = _bufferLength - offsetInBuffer;
+
+    _currentPosition = _bufferOffset + _bufferLength;
+    return true;
+}
+
+void OsmAnd::QFileDeviceSharedInputStream::BackUp(int count)
+{
+    if (count > _currentPosition)
+        _currentPosition = 0;
+    else
+        _currentPosition -= count;
+}
+
+bool OsmAnd::QFileDeviceSharedInputStream::Skip(int count)
+{
+    // Landing exactly at the end is a successful skip, only skipping past the end fails
+    if (Q_UNLIKELY(count < 0 || _currentPosition + count > _fileSize))
+    {
+        _currentPosition = _fileSize;
+        return false;
+    }
+
+    _currentPosition += count;
+    return true;
+}
+
+OsmAnd::gpb::int64 OsmAnd::QFileDeviceSharedInputStream::ByteCount() const
+{
+    return static_cast<gpb::int64>(_currentPosition);
+}
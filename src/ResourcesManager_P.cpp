@@ -14,6 +14,7 @@
 #include "OsmAndCore_private.h"
 #include "CoreResourcesEmbeddedBundle.h"
 #include "ObfReader.h"
+#include "ObfInfoCache.h"
 #include "ArchiveReader.h"
 #include "ObfDataInterface.h"
 #include "ResolvedMapStyle.h"
@@ -47,8 +48,11 @@ void OsmAnd::ResourcesManager_P::initialize()
 {
     if (!owner->miniBasemapFilename.isNull())
     {
-        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(owner->miniBasemapFilename));
-        if (ObfReader(obfFile).obtainInfo())
+        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(
+            owner->miniBasemapFilename,
+            QFile(owner->miniBasemapFilename).size(),
+            getObfInfoCacheFilePath(owner->miniBasemapFilename)));
+        if (obtainObfInfo(obfFile))
             _miniBasemapObfFile = obfFile;
         else
         {
@@ -335,6 +339,23 @@ bool OsmAnd::ResourcesManager_P::loadLocalResourcesFromPath(
     return true;
 }
 
+QString OsmAnd::ResourcesManager_P::getObfInfoCacheFilePath(const QString& obfFilePath) const
+{
+    return ObfInfoCache::getCacheFilePath(
+        QDir(owner->localTemporaryPath).absoluteFilePath(QLatin1String("obfinfo")),
+        obfFilePath);
+}
+
+std::shared_ptr<const OsmAnd::ObfInfo> OsmAnd::ResourcesManager_P::obtainObfInfo(
+    const std::shared_ptr<const ObfFile>& obfFile) const
+{
+    // Valid sidecar allows to skip opening the OBF at all
+    if (obfFile->loadInfoFromCache())
+        return obfFile->obfInfo;
+
+    return ObfReader(obfFile).obtainInfo();
+}
+
 void OsmAnd::ResourcesManager_P::loadLocalResourcesFromPath_Obf(
     const QString& storagePath,
     QHash< QString, std::shared_ptr<const LocalResource> > &outResult,
@@ -348,8 +369,11 @@ void OsmAnd::ResourcesManager_P::loadLocalResourcesFromPath_Obf(
         const auto filePath = obfFileInfo.absoluteFilePath();
 
         // Read information from OBF
-        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(filePath));
-        if (!ObfReader(obfFile).obtainInfo())
+        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(
+            filePath,
+            obfFileInfo.size(),
+            getObfInfoCacheFilePath(filePath)));
+        if (!obtainObfInfo(obfFile))
         {
             LogPrintf(LogSeverityLevel::Warning, "Failed to open OBF '%s'", qPrintable(filePath));
             continue;
@@ -382,8 +406,11 @@ void OsmAnd::ResourcesManager_P::loadLocalResourcesFromPath_Obf(
         const auto fileName = obfFileInfo.fileName();
 
         // Read information from OBF
-        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(filePath));
-        const auto obfInfo = ObfReader(obfFile).obtainInfo();
+        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(
+            filePath,
+            obfFileInfo.size(),
+            getObfInfoCacheFilePath(filePath)));
+        const auto obfInfo = obtainObfInfo(obfFile);
         if (!obfInfo)
         {
             LogPrintf(LogSeverityLevel::Warning, "Failed to open OBF '%s'", qPrintable(filePath));
@@ -59,6 +59,8 @@ namespace OsmAnd
             const bool isUnmanagedStorage,
             QHash< QString, std::shared_ptr<const LocalResource> >& outResult) const;
 
+        QString getObfInfoCacheFilePath(const QString& obfFilePath) const;
+        std::shared_ptr<const ObfInfo> obtainObfInfo(const std::shared_ptr<const ObfFile>& obfFile) const;
         void loadLocalResourcesFromPath_Obf(
             const QString& storagePath,
             QHash< QString, std::shared_ptr<const LocalResource> > &outResult,
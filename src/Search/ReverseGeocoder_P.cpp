@@ -279,14 +279,14 @@ QVector<std::shared_ptr<const OsmAnd::ReverseGeocoder::ResultEntry>> OsmAnd::Rev
                                                [this]
                                                (const std::shared_ptr<const OsmAnd::Road>& road) -> bool
                                                {
-                                                   return !road->captions.isEmpty();
+                                                   return !road->getCaptions().isEmpty();
                                                });
     if (roads.isEmpty())
         roads = roadLocator->findNearestRoads(searchPoint31, STOP_SEARCHING_STREET_WITHOUT_MULTIPLIER_RADIUS * 10, OsmAnd::RoutingDataLevel::Detailed,
                                               [this]
                                               (const std::shared_ptr<const OsmAnd::Road>& road) -> bool
                                               {
-                                                  return !road->captions.isEmpty();
+                                                  return !road->getCaptions().isEmpty();
                                               });
     
     double distSquare = 0;
@@ -300,7 +300,7 @@ QVector<std::shared_ptr<const OsmAnd::ReverseGeocoder::ResultEntry>> OsmAnd::Rev
             continue;
         else
             set.insert(road->id);
-        if (!road->captions.isEmpty())
+        if (!road->getCaptions().isEmpty())
         {
             if (distSquare == 0 || distSquare > roadDistSquare)
                 distSquare = roadDistSquare;
@@ -309,8 +309,8 @@ QVector<std::shared_ptr<const OsmAnd::ReverseGeocoder::ResultEntry>> OsmAnd::Rev
             entry->streetName = road->getCaptionInNativeLanguage();
             if (entry->streetName.isEmpty())
             {
-                if (!road->captions.isEmpty())
-                    entry->streetName = road->captions.values().last();
+                if (!road->getCaptions().isEmpty())
+                    entry->streetName = road->getCaptions().values().last();
             }
                 
             entry->searchPoint = searchPoint;
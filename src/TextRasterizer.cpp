@@ -8,10 +8,16 @@
 #include "ChainedFontFinder.h"
 
 OsmAnd::TextRasterizer::TextRasterizer(
-    const std::shared_ptr<const IFontFinder>& fontFinder_)
+    const std::shared_ptr<const IFontFinder>& fontFinder_,
+    const unsigned int shapedTextsCacheSizeLimit_ /*= DefaultShapedTextsCacheSizeLimit*/,
+    const unsigned int bitmapsCacheSizeLimit_ /*= DefaultBitmapsCacheSizeLimit*/)
     : _p(new TextRasterizer_P(this))
     , fontFinder(fontFinder_)
+    , shapedTextsCacheSizeLimit(shapedTextsCacheSizeLimit_)
+    , bitmapsCacheSizeLimit(bitmapsCacheSizeLimit_)
+    , glyphAtlas(new GlyphAtlas())
 {
+    _p->initialize();
 }
 
 OsmAnd::TextRasterizer::~TextRasterizer()
@@ -54,6 +60,38 @@ bool OsmAnd::TextRasterizer::rasterize(
         outLineSpacing);
 }
 
+std::shared_ptr<const SkBitmap> OsmAnd::TextRasterizer::obtainRasterized(
+    const QString& text,
+    const Style& style /*= Style()*/,
+    QVector<SkScalar>* const outGlyphWidths /*= nullptr*/,
+    float* const outExtraTopSpace /*= nullptr*/,
+    float* const outExtraBottomSpace /*= nullptr*/,
+    float* const outLineSpacing /*= nullptr*/,
+    CacheLookup* const outCacheLookup /*= nullptr*/) const
+{
+    return _p->obtainRasterized(
+        text,
+        style,
+        outGlyphWidths,
+        outExtraTopSpace,
+        outExtraBottomSpace,
+        outLineSpacing,
+        outCacheLookup);
+}
+
+std::shared_ptr<const OsmAnd::GlyphAtlas::GlyphRun> OsmAnd::TextRasterizer::obtainGlyphRun(
+    const QString& text,
+    const Style& style /*= Style()*/,
+    unsigned int* const outDrawnCellsCount /*= nullptr*/) const
+{
+    return _p->obtainGlyphRun(text, style, outDrawnCellsCount);
+}
+
+void OsmAnd::TextRasterizer::clearCaches() const
+{
+    _p->clearCaches();
+}
+
 static std::shared_ptr<const OsmAnd::TextRasterizer> s_defaultTextRasterizer;
 std::shared_ptr<const OsmAnd::TextRasterizer> OsmAnd::TextRasterizer::getDefault()
 {
@@ -32,6 +32,16 @@ OsmAnd::TextRasterizer_P::~TextRasterizer_P()
 {
 }
 
+void OsmAnd::TextRasterizer_P::initialize()
+{
+    _shapedTextsCache.setMaxCost(static_cast<int>(qMin(
+        owner->shapedTextsCacheSizeLimit,
+        static_cast<unsigned int>(std::numeric_limits<int>::max()))));
+    _bitmapsCache.setMaxCost(static_cast<int>(qMin(
+        owner->bitmapsCacheSizeLimit,
+        static_cast<unsigned int>(std::numeric_limits<int>::max()))));
+}
+
 QVector<OsmAnd::TextRasterizer_P::LinePaint> OsmAnd::TextRasterizer_P::evaluatePaints(
     const QVector<QStringRef>& lineRefs,
     const Style& style) const
@@ -384,118 +394,150 @@ SkRect OsmAnd::TextRasterizer_P::positionText(
     return textArea;
 }
 
-std::shared_ptr<SkBitmap> OsmAnd::TextRasterizer_P::rasterize(
-    const QString& text,
-    const Style& style,
-    QVector<SkScalar>* const outGlyphWidths,
-    float* const outExtraTopSpace,
-    float* const outExtraBottomSpace,
-    float* const outLineSpacing) const
-{
-    std::shared_ptr<SkBitmap> bitmap(new SkBitmap());
-    const bool ok = rasterize(
-        *bitmap,
-        text,
-        style,
-        outGlyphWidths,
-        outExtraTopSpace,
-        outExtraBottomSpace,
-        outLineSpacing);
-    if (!ok)
-        return nullptr;
-    return bitmap;
-}
-
-bool OsmAnd::TextRasterizer_P::rasterize(
-    SkBitmap& targetBitmap,
+std::shared_ptr<const OsmAnd::TextRasterizer_P::ShapedText> OsmAnd::TextRasterizer_P::shapeText(
     const QString& text_,
     const Style& style,
-    QVector<SkScalar>* const outGlyphWidths,
-    float* const outExtraTopSpace,
-    float* const outExtraBottomSpace,
-    float* const outLineSpacing) const
+    const bool withGlyphWidths) const
 {
+    const std::shared_ptr<ShapedText> shapedText(new ShapedText());
+
     // Prepare text and break by lines
-    const auto text = ICU::convertToVisualOrder(text_);
+    shapedText->text = ICU::convertToVisualOrder(text_);
+    const auto& text = shapedText->text;
     const auto lineRefs = style.wrapWidth > 0
         ? ICU::getTextWrappingRefs(text, style.wrapWidth)
         : (QVector<QStringRef>() << QStringRef(&text));
 
     // Obtain paints from lines and style
-    auto paints = evaluatePaints(lineRefs, style);
+    auto& paints = shapedText->paints;
+    paints = evaluatePaints(lineRefs, style);
 
     // Measure text
     SkScalar maxLineWidthInPixels = 0;
     measureText(paints, maxLineWidthInPixels);
 
     // Measure glyphs (if requested and there's no halo)
-    if (outGlyphWidths && style.haloRadius == 0)
-        measureGlyphs(paints, *outGlyphWidths);
+    if (withGlyphWidths && style.haloRadius == 0)
+        measureGlyphs(paints, shapedText->glyphWidths);
 
     // Process halo if exists
     if (style.haloRadius > 0)
     {
         measureHalo(style, paints);
 
-        if (outGlyphWidths)
-            measureHaloGlyphs(style, paints, *outGlyphWidths);
+        if (withGlyphWidths)
+            measureHaloGlyphs(style, paints, shapedText->glyphWidths);
     }
+    shapedText->hasGlyphWidths = withGlyphWidths;
 
-    // Set output line spacing
-    if (outLineSpacing)
-    {
-        float lineSpacing = 0.0f;
-        for (const auto& linePaint : constOf(paints))
-            lineSpacing = qMax(lineSpacing, linePaint.maxFontLineSpacing);
+    // Calculate line spacing
+    for (const auto& linePaint : constOf(paints))
+        shapedText->lineSpacing = qMax(shapedText->lineSpacing, linePaint.maxFontLineSpacing);
 
-        *outLineSpacing = lineSpacing;
+    // Calculate extra top and bottom space
+    SkScalar maxTop = 0;
+    SkScalar maxBottom = 0;
+    for (const auto& linePaint : constOf(paints))
+    {
+        maxTop = qMax(maxTop, linePaint.maxFontTop);
+        maxBottom = qMax(maxBottom, linePaint.maxFontBottom);
     }
+    shapedText->extraTopSpace = qMax(0.0f, maxTop - paints.first().maxFontTop);
+    shapedText->extraBottomSpace = qMax(0.0f, maxBottom - paints.last().maxFontBottom);
+
+    // Position text horizontally and vertically
+    shapedText->textArea = positionText(paints, maxLineWidthInPixels, style.textAlignment);
+
+    return shapedText;
+}
+
+std::shared_ptr<const OsmAnd::TextRasterizer_P::ShapedText> OsmAnd::TextRasterizer_P::obtainShapedText(
+    const CacheKey& key,
+    const Style& style,
+    const bool withGlyphWidths,
+    bool* const outHit /*= nullptr*/) const
+{
+    if (outHit)
+        *outHit = false;
+
+    if (owner->shapedTextsCacheSizeLimit == 0)
+        return shapeText(key.text, style, withGlyphWidths);
 
-    // Calculate extra top and bottom space
-    if (outExtraTopSpace)
     {
-        SkScalar maxTop = 0;
-        for (const auto& linePaint : constOf(paints))
-            maxTop = qMax(maxTop, linePaint.maxFontTop);
+        QMutexLocker scopedLocker(&_shapedTextsCacheMutex);
 
-        *outExtraTopSpace = qMax(0.0f, maxTop - paints.first().maxFontTop);
+        // Glyph widths of shaped text that lacks them are measured by publishShapedText()
+        if (const auto pShapedText = _shapedTextsCache.object(key))
+        {
+            if (outHit)
+                *outHit = true;
+            return *pShapedText;
+        }
     }
-    if (outExtraBottomSpace)
+
+    const auto shapedText = shapeText(key.text, style, withGlyphWidths);
+
     {
-        SkScalar maxBottom = 0;
-        for (const auto& linePaint : constOf(paints))
-            maxBottom = qMax(maxBottom, linePaint.maxFontBottom);
+        QMutexLocker scopedLocker(&_shapedTextsCacheMutex);
 
-        *outExtraBottomSpace = qMax(0.0f, maxBottom - paints.last().maxFontBottom);
+        _shapedTextsCache.insert(
+            key,
+            new std::shared_ptr<const ShapedText>(shapedText),
+            static_cast<int>(shapedText->getSizeInBytes()));
     }
 
-    // Position text horizontally and vertically
-    const auto textArea = positionText(paints, maxLineWidthInPixels, style.textAlignment);
-    
+    return shapedText;
+}
+
+void OsmAnd::TextRasterizer_P::publishShapedText(
+    const ShapedText& shapedText,
+    const Style& style,
+    QVector<SkScalar>* const outGlyphWidths,
+    float* const outExtraTopSpace,
+    float* const outExtraBottomSpace,
+    float* const outLineSpacing) const
+{
+    if (outGlyphWidths)
+    {
+        if (shapedText.hasGlyphWidths)
+            *outGlyphWidths += shapedText.glyphWidths;
+        else if (style.haloRadius > 0)
+            measureHaloGlyphs(style, shapedText.paints, *outGlyphWidths);
+        else
+            measureGlyphs(shapedText.paints, *outGlyphWidths);
+    }
+
+    if (outLineSpacing)
+        *outLineSpacing = shapedText.lineSpacing;
+
+    // Extra spacing is not applicable to text that is drawn over background
+    if (outExtraTopSpace)
+        *outExtraTopSpace = style.backgroundBitmap ? 0.0f : shapedText.extraTopSpace;
+    if (outExtraBottomSpace)
+        *outExtraBottomSpace = style.backgroundBitmap ? 0.0f : shapedText.extraBottomSpace;
+}
+
+bool OsmAnd::TextRasterizer_P::drawShapedText(
+    SkBitmap& targetBitmap,
+    const ShapedText& shapedText,
+    const Style& style) const
+{
+    const auto& textArea = shapedText.textArea;
+
     // Calculate bitmap size
     auto bitmapWidth = qCeil(textArea.width());
     auto bitmapHeight = qCeil(textArea.height());
+    auto offset = SkPoint::Make(0.0f, 0.0f);
     if (style.backgroundBitmap)
     {
-        // Clear extra spacing
-        if (outExtraTopSpace)
-            *outExtraTopSpace = 0.0f;
-        if (outExtraBottomSpace)
-            *outExtraBottomSpace = 0.0f;
-
         // Enlarge bitmap if shield is larger than text
         bitmapWidth = qMax(bitmapWidth, style.backgroundBitmap->width());
         bitmapHeight = qMax(bitmapHeight, style.backgroundBitmap->height());
 
         // Shift text area to proper position in a larger
-        const auto offset = SkPoint::Make(
+        offset = SkPoint::Make(
             (bitmapWidth - qCeil(textArea.width())) / 2.0f,
             (bitmapHeight - qCeil(textArea.height())) / 2.0f);
-        for (auto& linePaint : paints)
-        {
-            for (auto& textPaint : linePaint.textPaints)
-                textPaint.positionedBounds.offset(offset);
-        }
     }
 
     // Check if bitmap size was successfully calculated
@@ -503,7 +545,7 @@ bool OsmAnd::TextRasterizer_P::rasterize(
     {
         LogPrintf(LogSeverityLevel::Error,
             "Failed to rasterize text '%s': resulting bitmap size %dx%d is invalid",
-            qPrintable(text),
+            qPrintable(shapedText.text),
             bitmapWidth,
             bitmapHeight);
         return false;
@@ -516,7 +558,7 @@ bool OsmAnd::TextRasterizer_P::rasterize(
         {
             LogPrintf(LogSeverityLevel::Error,
                 "Failed to allocate bitmap of size %dx%d",
-                qPrintable(text),
+                qPrintable(shapedText.text),
                 bitmapWidth,
                 bitmapHeight);
             return false;
@@ -539,28 +581,28 @@ bool OsmAnd::TextRasterizer_P::rasterize(
     // Rasterize text halo first (if enabled)
     if (style.haloRadius > 0)
     {
-        for (const auto& linePaint : paints)
+        for (const auto& linePaint : constOf(shapedText.paints))
         {
-            for (const auto& textPaint : linePaint.textPaints)
+            for (const auto& textPaint : constOf(linePaint.textPaints))
             {
                 const auto haloPaint = getHaloPaint(textPaint.paint, style);
 
                 canvas.drawText(
                     textPaint.text.constData(), textPaint.text.length()*sizeof(QChar),
-                    textPaint.positionedBounds.left(), textPaint.positionedBounds.top(),
+                    textPaint.positionedBounds.left() + offset.x(), textPaint.positionedBounds.top() + offset.y(),
                     haloPaint);
             }
         }
     }
 
     // Rasterize text itself
-    for (const auto& linePaint : paints)
+    for (const auto& linePaint : constOf(shapedText.paints))
     {
-        for (const auto& textPaint : linePaint.textPaints)
+        for (const auto& textPaint : constOf(linePaint.textPaints))
         {
             canvas.drawText(
                 textPaint.text.constData(), textPaint.text.length()*sizeof(QChar),
-                textPaint.positionedBounds.left(), textPaint.positionedBounds.top(),
+                textPaint.positionedBounds.left() + offset.x(), textPaint.positionedBounds.top() + offset.y(),
                 textPaint.paint);
         }
     }
@@ -569,3 +611,308 @@ bool OsmAnd::TextRasterizer_P::rasterize(
 
     return true;
 }
+
+std::shared_ptr<SkBitmap> OsmAnd::TextRasterizer_P::rasterize(
+    const QString& text,
+    const Style& style,
+    QVector<SkScalar>* const outGlyphWidths,
+    float* const outExtraTopSpace,
+    float* const outExtraBottomSpace,
+    float* const outLineSpacing) const
+{
+    std::shared_ptr<SkBitmap> bitmap(new SkBitmap());
+    const bool ok = rasterize(
+        *bitmap,
+        text,
+        style,
+        outGlyphWidths,
+        outExtraTopSpace,
+        outExtraBottomSpace,
+        outLineSpacing);
+    if (!ok)
+        return nullptr;
+    return bitmap;
+}
+
+bool OsmAnd::TextRasterizer_P::rasterize(
+    SkBitmap& targetBitmap,
+    const QString& text,
+    const Style& style,
+    QVector<SkScalar>* const outGlyphWidths,
+    float* const outExtraTopSpace,
+    float* const outExtraBottomSpace,
+    float* const outLineSpacing) const
+{
+    const auto shapedText = obtainShapedText(CacheKey(text, style), style, outGlyphWidths != nullptr);
+
+    publishShapedText(
+        *shapedText,
+        style,
+        outGlyphWidths,
+        outExtraTopSpace,
+        outExtraBottomSpace,
+        outLineSpacing);
+
+    return drawShapedText(targetBitmap, *shapedText, style);
+}
+
+std::shared_ptr<const SkBitmap> OsmAnd::TextRasterizer_P::obtainRasterized(
+    const QString& text,
+    const Style& style,
+    QVector<SkScalar>* const outGlyphWidths,
+    float* const outExtraTopSpace,
+    float* const outExtraBottomSpace,
+    float* const outLineSpacing,
+    CacheLookup* const outCacheLookup) const
+{
+    const CacheKey key(text, style);
+
+    // Background bitmaps are usually created for each text, so such texts are never reused
+    const auto useBitmapsCache = owner->bitmapsCacheSizeLimit > 0 && !style.backgroundBitmap;
+    if (useBitmapsCache)
+    {
+        QMutexLocker scopedLocker(&_bitmapsCacheMutex);
+
+        if (const auto pRasterizedText = _bitmapsCache.object(key))
+        {
+            const auto rasterizedText = *pRasterizedText;
+            scopedLocker.unlock();
+
+            publishShapedText(
+                *rasterizedText.shapedText,
+                style,
+                outGlyphWidths,
+                outExtraTopSpace,
+                outExtraBottomSpace,
+                outLineSpacing);
+
+            if (outCacheLookup)
+                *outCacheLookup = CacheLookup::BitmapHit;
+            return rasterizedText.bitmap;
+        }
+    }
+
+    bool shapedTextHit = false;
+    const auto shapedText = obtainShapedText(key, style, outGlyphWidths != nullptr, &shapedTextHit);
+
+    const std::shared_ptr<SkBitmap> bitmap(new SkBitmap());
+    if (!drawShapedText(*bitmap, *shapedText, style))
+        return nullptr;
+
+    publishShapedText(
+        *shapedText,
+        style,
+        outGlyphWidths,
+        outExtraTopSpace,
+        outExtraBottomSpace,
+        outLineSpacing);
+
+    if (useBitmapsCache)
+    {
+        const auto pRasterizedText = new RasterizedText();
+        pRasterizedText->shapedText = shapedText;
+        pRasterizedText->bitmap = bitmap;
+
+        QMutexLocker scopedLocker(&_bitmapsCacheMutex);
+
+        _bitmapsCache.insert(key, pRasterizedText, static_cast<int>(bitmap->getSize()));
+    }
+
+    if (outCacheLookup)
+    {
+        if (shapedTextHit)
+            *outCacheLookup = CacheLookup::ShapedTextHit;
+        else if (owner->shapedTextsCacheSizeLimit > 0 || useBitmapsCache)
+            *outCacheLookup = CacheLookup::Miss;
+        else
+            *outCacheLookup = CacheLookup::Bypass;
+    }
+    return bitmap;
+}
+
+std::shared_ptr<const OsmAnd::GlyphAtlas::GlyphRun> OsmAnd::TextRasterizer_P::obtainGlyphRun(
+    const QString& text,
+    const Style& style,
+    unsigned int* const outDrawnCellsCount) const
+{
+    if (outDrawnCellsCount)
+        *outDrawnCellsCount = 0;
+
+    if (text.isEmpty() || style.wrapWidth > 0 || style.backgroundBitmap)
+        return nullptr;
+
+    const auto shapedText = obtainShapedText(CacheKey(text, style), style, false);
+    if (shapedText->paints.size() != 1)
+        return nullptr;
+    const auto& linePaint = shapedText->paints.first();
+
+    // Cell has margin for antialiased edges and halo around glyph
+    const auto margin = 1 + qCeil(style.haloRadius / 2.0f);
+
+    // All cells of run share baseline, so vertical metrics are taken from all fonts of the line
+    SkScalar maxFontTop = 0;
+    SkScalar maxFontBottom = 0;
+    for (const auto& textPaint : constOf(linePaint.textPaints))
+    {
+        SkPaint::FontMetrics metrics;
+        textPaint.paint.getFontMetrics(&metrics);
+        maxFontTop = qMax(maxFontTop, -metrics.fTop);
+        maxFontBottom = qMax(maxFontBottom, metrics.fBottom);
+    }
+    const auto cellAscent = qCeil(maxFontTop) + margin;
+    const auto cellDescent = qCeil(maxFontBottom) + margin;
+
+    struct Glyph
+    {
+        const TextPaint* textPaint;
+        uint16_t glyphId;
+        SkScalar width;
+    };
+    QVector<Glyph> glyphs;
+    QVector<float> glyphsWidth;
+    QVector<GlyphAtlas::CellRequest> haloCells;
+    QVector<GlyphAtlas::CellRequest> cells;
+    for (const auto& textPaint : constOf(linePaint.textPaints))
+    {
+        const auto byteLength = textPaint.text.length()*sizeof(QChar);
+        const auto glyphsCount = textPaint.paint.textToGlyphs(textPaint.text.constData(), byteLength, nullptr);
+        if (glyphsCount <= 0)
+            continue;
+        QVector<uint16_t> glyphIds(glyphsCount);
+        textPaint.paint.textToGlyphs(textPaint.text.constData(), byteLength, glyphIds.data());
+
+        auto glyphPaint = textPaint.paint;
+        glyphPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+        QVector<SkScalar> widths(glyphsCount);
+        QVector<SkRect> bounds(glyphsCount);
+        glyphPaint.getTextWidths(glyphIds.constData(), glyphsCount*sizeof(uint16_t), widths.data(), bounds.data());
+
+        GlyphAtlas::CellRequest cell;
+        cell.key.typefaceId = SkTypeface::UniqueID(textPaint.paint.getTypeface());
+        cell.key.size = textPaint.paint.getTextSize();
+        cell.key.fakeBold = textPaint.paint.isFakeBoldText();
+        cell.key.cellAscent = cellAscent;
+        cell.key.cellDescent = cellDescent;
+        for (auto idx = 0; idx < glyphsCount; idx++)
+        {
+            const auto glyphWidth = widths[idx];
+            const auto& glyphBounds = bounds[idx];
+
+            Glyph glyph;
+            glyph.textPaint = &textPaint;
+            glyph.glyphId = glyphIds[idx];
+            glyph.width = glyphWidth;
+            cell.glyphIndex = glyphs.size();
+            glyphs.push_back(glyph);
+            glyphsWidth.push_back(glyphWidth);
+
+            // Glyphs without ink (like spaces) only advance next glyphs
+            if (glyphBounds.isEmpty())
+                continue;
+
+            // Cell is symmetric around center of glyph advance, since it's drawn centered at glyph placement
+            const auto halfWidth = qMax(
+                glyphWidth / 2.0f,
+                qMax(glyphWidth / 2.0f - glyphBounds.left(), glyphBounds.right() - glyphWidth / 2.0f));
+            cell.width = 2 * (qCeil(halfWidth) + margin);
+            cell.key.glyphId = glyph.glyphId;
+            cell.key.color = style.color;
+            cell.key.haloRadius = 0;
+            cells.push_back(cell);
+
+            if (style.haloRadius > 0)
+            {
+                cell.key.color = style.haloColor;
+                cell.key.haloRadius = style.haloRadius;
+                haloCells.push_back(cell);
+            }
+        }
+    }
+    if (cells.isEmpty())
+        return nullptr;
+
+    // Halos of all glyphs are drawn before glyphs, so that halo never covers neighbour glyph
+    if (!haloCells.isEmpty())
+        cells = haloCells + cells;
+
+    return owner->glyphAtlas->obtainGlyphRun(
+        glyphsWidth,
+        cellAscent + cellDescent,
+        cells,
+        [this, &glyphs, &style, cellAscent]
+        (SkCanvas& canvas, const GlyphAtlas::CellRequest& cell)
+        {
+            const auto& glyph = glyphs[cell.glyphIndex];
+
+            auto paint = cell.key.haloRadius > 0
+                ? getHaloPaint(glyph.textPaint->paint, style)
+                : glyph.textPaint->paint;
+            paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+            canvas.drawText(&glyph.glyphId, sizeof(uint16_t), (cell.width - glyph.width) / 2.0f, cellAscent, paint);
+        },
+        outDrawnCellsCount);
+}
+
+void OsmAnd::TextRasterizer_P::clearCaches() const
+{
+    owner->glyphAtlas->clear();
+
+    {
+        QMutexLocker scopedLocker(&_shapedTextsCacheMutex);
+
+        _shapedTextsCache.clear();
+    }
+
+    {
+        QMutexLocker scopedLocker(&_bitmapsCacheMutex);
+
+        _bitmapsCache.clear();
+    }
+}
+
+unsigned int OsmAnd::TextRasterizer_P::ShapedText::getSizeInBytes() const
+{
+    auto size = sizeof(ShapedText);
+    size += text.size() * sizeof(QChar);
+    size += glyphWidths.size() * sizeof(SkScalar);
+    for (const auto& linePaint : constOf(paints))
+        size += sizeof(LinePaint) + linePaint.textPaints.size() * sizeof(TextPaint);
+
+    return static_cast<unsigned int>(size);
+}
+
+OsmAnd::TextRasterizer_P::CacheKey::CacheKey(const QString& text_, const Style& style)
+    : text(text_)
+    , wrapWidth(style.wrapWidth)
+    , size(style.size)
+    , bold(style.bold)
+    , italic(style.italic)
+    , color(style.color)
+    , haloRadius(style.haloRadius)
+    , haloColor(style.haloColor)
+    , textAlignment(style.textAlignment)
+{
+    hash = qHash(text);
+    hash = qHash(wrapWidth, hash);
+    hash = qHash(size, hash);
+    hash = qHash(color.argb, hash);
+    hash = qHash(haloColor.argb, hash);
+    hash = qHash(
+        (haloRadius << 4) | (static_cast<unsigned int>(textAlignment) << 2) | (bold ? 2u : 0u) | (italic ? 1u : 0u),
+        hash);
+}
+
+bool OsmAnd::TextRasterizer_P::CacheKey::operator==(const CacheKey& that) const
+{
+    return
+        hash == that.hash &&
+        wrapWidth == that.wrapWidth &&
+        size == that.size &&
+        bold == that.bold &&
+        italic == that.italic &&
+        color == that.color &&
+        haloRadius == that.haloRadius &&
+        haloColor == that.haloColor &&
+        textAlignment == that.textAlignment &&
+        text == that.text;
+}
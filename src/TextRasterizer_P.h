@@ -8,6 +8,8 @@
 #include "ignore_warnings_on_external_includes.h"
 #include <QList>
 #include <QVector>
+#include <QCache>
+#include <QMutex>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -19,6 +21,7 @@
 #include "CommonTypes.h"
 #include "MapCommonTypes.h"
 #include "TextRasterizer.h"
+#include "GlyphAtlas.h"
 
 namespace OsmAnd
 {
@@ -30,6 +33,7 @@ namespace OsmAnd
     {
     public:
         typedef TextRasterizer::Style Style;
+        typedef TextRasterizer::CacheLookup CacheLookup;
 
     private:
         SkPaint _defaultPaint;
@@ -80,6 +84,83 @@ namespace OsmAnd
             SkScalar minBoundsTop;
             SkScalar width;
         };
+
+        // Text in visual order along with paints that are measured and positioned, so that it's ready to be
+        // drawn. Paints reference text of the same instance, so it's never copied.
+        struct ShapedText Q_DECL_FINAL
+        {
+            Q_DISABLE_COPY_AND_MOVE(ShapedText);
+
+            inline ShapedText()
+                : lineSpacing(0.0f)
+                , extraTopSpace(0.0f)
+                , extraBottomSpace(0.0f)
+                , hasGlyphWidths(false)
+            {
+            }
+
+            QString text;
+            QVector<LinePaint> paints;
+            SkRect textArea;
+            float lineSpacing;
+            float extraTopSpace;
+            float extraBottomSpace;
+            bool hasGlyphWidths;
+            QVector<SkScalar> glyphWidths;
+
+            unsigned int getSizeInBytes() const;
+        };
+
+        // Background bitmap is not a part of the key, since it doesn't affect shaping and texts with
+        // background are never put to bitmaps cache
+        struct CacheKey Q_DECL_FINAL
+        {
+            CacheKey(const QString& text, const Style& style);
+
+            QString text;
+            unsigned int wrapWidth;
+            float size;
+            bool bold;
+            bool italic;
+            ColorARGB color;
+            unsigned int haloRadius;
+            ColorARGB haloColor;
+            Style::TextAlignment textAlignment;
+            uint hash;
+
+            bool operator==(const CacheKey& that) const;
+        };
+        friend inline uint qHash(const CacheKey& key, uint seed = 0)
+        {
+            return key.hash ^ seed;
+        }
+
+        struct RasterizedText Q_DECL_FINAL
+        {
+            std::shared_ptr<const ShapedText> shapedText;
+            std::shared_ptr<const SkBitmap> bitmap;
+        };
+
+        mutable QMutex _shapedTextsCacheMutex;
+        mutable QCache< CacheKey, std::shared_ptr<const ShapedText> > _shapedTextsCache;
+        mutable QMutex _bitmapsCacheMutex;
+        mutable QCache< CacheKey, RasterizedText > _bitmapsCache;
+
+        std::shared_ptr<const ShapedText> shapeText(const QString& text, const Style& style, const bool withGlyphWidths) const;
+        std::shared_ptr<const ShapedText> obtainShapedText(
+            const CacheKey& key,
+            const Style& style,
+            const bool withGlyphWidths,
+            bool* const outHit = nullptr) const;
+        void publishShapedText(
+            const ShapedText& shapedText,
+            const Style& style,
+            QVector<SkScalar>* const outGlyphWidths,
+            float* const outExtraTopSpace,
+            float* const outExtraBottomSpace,
+            float* const outLineSpacing) const;
+        bool drawShapedText(SkBitmap& targetBitmap, const ShapedText& shapedText, const Style& style) const;
+
         QVector<LinePaint> evaluatePaints(const QVector<QStringRef>& lineRefs, const Style& style) const;
         void measureText(QVector<LinePaint>& paints, SkScalar& outMaxLineWidth) const;
         void measureGlyphs(const QVector<LinePaint>& paints, QVector<SkScalar>& outGlyphWidths) const;
@@ -92,6 +173,8 @@ namespace OsmAnd
             const Style::TextAlignment textAlignment) const;
     protected:
         TextRasterizer_P(TextRasterizer* const owner);
+
+        void initialize();
     public:
         ~TextRasterizer_P();
 
@@ -114,6 +197,22 @@ namespace OsmAnd
             float* const outExtraBottomSpace,
             float* const outLineSpacing) const;
 
+        std::shared_ptr<const SkBitmap> obtainRasterized(
+            const QString& text,
+            const Style& style,
+            QVector<SkScalar>* const outGlyphWidths,
+            float* const outExtraTopSpace,
+            float* const outExtraBottomSpace,
+            float* const outLineSpacing,
+            CacheLookup* const outCacheLookup) const;
+
+        std::shared_ptr<const GlyphAtlas::GlyphRun> obtainGlyphRun(
+            const QString& text,
+            const Style& style,
+            unsigned int* const outDrawnCellsCount) const;
+
+        void clearCaches() const;
+
     friend class OsmAnd::TextRasterizer;
     };
 }
@@ -0,0 +1,150 @@
+#ifndef _OSMAND_CORE_TILE_ID_SET_H_
+#define _OSMAND_CORE_TILE_ID_SET_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QSet>
+#include <QVector>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+
+namespace OsmAnd
+{
+    // Set of tiles (of same zoom level). Membership test is a single hash lookup, and difference between two sets
+    // is found by walking each of them once, so that a change of visible area costs time proportional to number of
+    // visible tiles, regardless of how many resources are loaded.
+    class TileIdSet Q_DECL_FINAL
+    {
+    public:
+        typedef QSet<TileId>::const_iterator const_iterator;
+
+    private:
+        QSet<TileId> _tileIds;
+    protected:
+    public:
+        inline TileIdSet()
+        {
+        }
+
+        inline explicit TileIdSet(const QVector<TileId>& tileIds)
+        {
+            _tileIds.reserve(tileIds.size());
+            for (const auto& tileId : tileIds)
+                _tileIds.insert(tileId);
+        }
+
+        inline ~TileIdSet()
+        {
+        }
+
+        inline bool contains(const TileId tileId) const
+        {
+            return _tileIds.contains(tileId);
+        }
+
+        inline void insert(const TileId tileId)
+        {
+            _tileIds.insert(tileId);
+        }
+
+        inline bool remove(const TileId tileId)
+        {
+            return _tileIds.remove(tileId);
+        }
+
+        inline void unite(const TileIdSet& that)
+        {
+            _tileIds.unite(that._tileIds);
+        }
+
+        inline int size() const
+        {
+            return _tileIds.size();
+        }
+
+        inline bool isEmpty() const
+        {
+            return _tileIds.isEmpty();
+        }
+
+        inline void clear()
+        {
+            _tileIds.clear();
+        }
+
+        inline const_iterator begin() const
+        {
+            return _tileIds.cbegin();
+        }
+
+        inline const_iterator end() const
+        {
+            return _tileIds.cend();
+        }
+
+        inline QVector<TileId> toVector() const
+        {
+            QVector<TileId> result;
+            result.reserve(_tileIds.size());
+            for (const auto& tileId : _tileIds)
+                result.push_back(tileId);
+            return result;
+        }
+
+        // Collects tiles that are present in this set but not in previous one (added), and tiles that are present
+        // only in previous set (removed). Returns true if sets differ.
+        inline bool diff(
+            const TileIdSet& previous,
+            QVector<TileId>* const outAdded = nullptr,
+            QVector<TileId>* const outRemoved = nullptr) const
+        {
+            bool differs = false;
+
+            for (const auto& tileId : _tileIds)
+            {
+                if (previous._tileIds.contains(tileId))
+                    continue;
+
+                differs = true;
+                if (!outAdded)
+                    break;
+                outAdded->push_back(tileId);
+            }
+
+            // Sets of same size without added tiles are equal, so there's no need to look for removed ones
+            if (!differs && previous._tileIds.size() == _tileIds.size())
+                return false;
+            if (differs && !outRemoved)
+                return true;
+
+            for (const auto& tileId : previous._tileIds)
+            {
+                if (_tileIds.contains(tileId))
+                    continue;
+
+                differs = true;
+                if (!outRemoved)
+                    break;
+                outRemoved->push_back(tileId);
+            }
+
+            return differs;
+        }
+
+        inline bool operator==(const TileIdSet& that) const
+        {
+            return _tileIds == that._tileIds;
+        }
+
+        inline bool operator!=(const TileIdSet& that) const
+        {
+            return _tileIds != that._tileIds;
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TILE_ID_SET_H_)
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <limits>
 #include <cmath>
+#include <vector>
 
 #include "QtExtensions.h"
 #include <QtNumeric>
@@ -560,3 +561,198 @@ QString OsmAnd::Utilities::resolveColorFromPalette(const QString& input, const b
 
     return value;
 }
+
+namespace
+{
+    // Returns intersection of segment p0-p1 with line of area edge, that is opposite to given outer side. Segment
+    // has to cross that line.
+    inline OsmAnd::PointI intersectWithAreaEdge(
+        const OsmAnd::PointI& p0,
+        const OsmAnd::PointI& p1,
+        const OsmAnd::AreaI& area,
+        const OsmAnd::Utilities::CHCode side)
+    {
+        const auto dx = static_cast<int64_t>(p1.x) - static_cast<int64_t>(p0.x);
+        const auto dy = static_cast<int64_t>(p1.y) - static_cast<int64_t>(p0.y);
+
+        OsmAnd::PointI intersection;
+        switch (side)
+        {
+            case OsmAnd::Utilities::CHCode::Left:
+            case OsmAnd::Utilities::CHCode::Right:
+                intersection.x = (side == OsmAnd::Utilities::CHCode::Left) ? area.left() : area.right();
+                intersection.y = static_cast<int32_t>(
+                    p0.y + dy * (static_cast<int64_t>(intersection.x) - p0.x) / dx);
+                break;
+            case OsmAnd::Utilities::CHCode::Bottom:
+            case OsmAnd::Utilities::CHCode::Top:
+                intersection.y = (side == OsmAnd::Utilities::CHCode::Bottom) ? area.top() : area.bottom();
+                intersection.x = static_cast<int32_t>(
+                    p0.x + dx * (static_cast<int64_t>(intersection.y) - p0.y) / dy);
+                break;
+        }
+        return intersection;
+    }
+}
+
+bool OsmAnd::Utilities::clipSegment(PointI& p0, PointI& p1, const AreaI& area)
+{
+    auto value0 = computeCohenSutherlandValue(p0, area);
+    auto value1 = computeCohenSutherlandValue(p1, area);
+    for (;;)
+    {
+        const auto code0 = static_cast<unsigned int>(value0);
+        const auto code1 = static_cast<unsigned int>(value1);
+
+        // Both points are inside of area
+        if ((code0 | code1) == 0)
+            return true;
+
+        // Both points are beyond same edge of area
+        if ((code0 & code1) != 0)
+            return false;
+
+        // Move one of outer points onto edge it's beyond of
+        const auto clipFirst = (code0 != 0);
+        const auto& value = clipFirst ? value0 : value1;
+        CHCode side;
+        if (value.isSet(CHCode::Left))
+            side = CHCode::Left;
+        else if (value.isSet(CHCode::Right))
+            side = CHCode::Right;
+        else if (value.isSet(CHCode::Bottom))
+            side = CHCode::Bottom;
+        else
+            side = CHCode::Top;
+
+        if (clipFirst)
+        {
+            p0 = intersectWithAreaEdge(p0, p1, area, side);
+            value0 = computeCohenSutherlandValue(p0, area);
+        }
+        else
+        {
+            p1 = intersectWithAreaEdge(p0, p1, area, side);
+            value1 = computeCohenSutherlandValue(p1, area);
+        }
+    }
+}
+
+QVector<OsmAnd::PointI> OsmAnd::Utilities::clipPolygon(const QVector<PointI>& ring, const AreaI& area)
+{
+    QVector<PointI> output = ring;
+    if (output.size() > 1 && output.first() == output.last())
+        output.removeLast();
+
+    // Ring is clipped by each edge of area in turn
+    QVector<PointI> input;
+    for (const auto side : { CHCode::Left, CHCode::Right, CHCode::Bottom, CHCode::Top })
+    {
+        if (output.isEmpty())
+            break;
+
+        input.swap(output);
+        output.clear();
+        output.reserve(input.size() + 1);
+
+        const auto pointsCount = input.size();
+        const auto pPoints = input.constData();
+        auto pPrevPoint = &pPoints[pointsCount - 1];
+        auto isPrevPointInside = !computeCohenSutherlandValue(*pPrevPoint, area).isSet(side);
+        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++)
+        {
+            const auto pPoint = &pPoints[pointIdx];
+            const auto isPointInside = !computeCohenSutherlandValue(*pPoint, area).isSet(side);
+
+            if (isPointInside != isPrevPointInside)
+                output.push_back(intersectWithAreaEdge(*pPrevPoint, *pPoint, area, side));
+            if (isPointInside)
+                output.push_back(*pPoint);
+
+            pPrevPoint = pPoint;
+            isPrevPointInside = isPointInside;
+        }
+    }
+
+    return output;
+}
+
+QVector<OsmAnd::PointI> OsmAnd::Utilities::simplifyPolyline(const QVector<PointI>& points, const double tolerance)
+{
+    const auto pointsCount = points.size();
+    if (pointsCount <= 2 || tolerance <= 0.0)
+        return points;
+    const auto squaredTolerance = tolerance * tolerance;
+
+    // Snap points that are too close to previous kept point, except the last one
+    QVector<PointI> snappedPoints;
+    snappedPoints.reserve(pointsCount);
+    const auto pPoints = points.constData();
+    snappedPoints.push_back(pPoints[0]);
+    for (auto pointIdx = 1; pointIdx < pointsCount - 1; pointIdx++)
+    {
+        const auto squaredDistance = static_cast<double>((PointI64(pPoints[pointIdx]) - PointI64(snappedPoints.last())).squareNorm());
+        if (squaredDistance < squaredTolerance)
+            continue;
+
+        snappedPoints.push_back(pPoints[pointIdx]);
+    }
+    snappedPoints.push_back(pPoints[pointsCount - 1]);
+
+    const auto snappedPointsCount = snappedPoints.size();
+    if (snappedPointsCount <= 2)
+        return snappedPoints;
+
+    // Douglas-Peucker, with ranges kept on stack instead of recursion
+    const auto pSnappedPoints = snappedPoints.constData();
+    std::vector<uint8_t> keepFlags(snappedPointsCount, 0);
+    keepFlags.front() = 1;
+    keepFlags.back() = 1;
+    std::vector< std::pair<int, int> > ranges;
+    ranges.push_back(std::make_pair(0, snappedPointsCount - 1));
+    while (!ranges.empty())
+    {
+        const auto range = ranges.back();
+        ranges.pop_back();
+
+        const auto& start = pSnappedPoints[range.first];
+        const auto& end = pSnappedPoints[range.second];
+        auto maxSquaredDistance = 0.0;
+        auto maxPointIdx = -1;
+        for (auto pointIdx = range.first + 1; pointIdx < range.second; pointIdx++)
+        {
+            const auto& point = pSnappedPoints[pointIdx];
+
+            // Distance to segment, not to line, so that spikes along the segment are kept
+            bool isOnLine = false;
+            auto squaredDistance = squaredDistanceBetweenPointAndLine(start, end, point, &isOnLine);
+            if (!isOnLine)
+            {
+                squaredDistance = static_cast<double>(qMin(
+                    (PointI64(point) - PointI64(start)).squareNorm(),
+                    (PointI64(point) - PointI64(end)).squareNorm()));
+            }
+
+            if (squaredDistance > maxSquaredDistance)
+            {
+                maxSquaredDistance = squaredDistance;
+                maxPointIdx = pointIdx;
+            }
+        }
+        if (maxPointIdx < 0 || maxSquaredDistance <= squaredTolerance)
+            continue;
+
+        keepFlags[maxPointIdx] = 1;
+        ranges.push_back(std::make_pair(range.first, maxPointIdx));
+        ranges.push_back(std::make_pair(maxPointIdx, range.second));
+    }
+
+    QVector<PointI> simplifiedPoints;
+    simplifiedPoints.reserve(snappedPointsCount);
+    for (auto pointIdx = 0; pointIdx < snappedPointsCount; pointIdx++)
+    {
+        if (keepFlags[pointIdx])
+            simplifiedPoints.push_back(pSnappedPoints[pointIdx]);
+    }
+    return simplifiedPoints;
+}
@@ -95,7 +95,7 @@ bool OsmAnd::WorldRegions_P::loadWorldRegions(
 
                 auto worldRegion = std::make_shared<WorldRegion>();
                 worldRegion->boundary = mapObject->containsAttribute("osmand_region", "boundary");
-                for (const auto& captionEntry : rangeOf(constOf(mapObject->captions)))
+                for (const auto& captionEntry : rangeOf(constOf(mapObject->getCaptions())))
                 {
                     const auto& attributeId = captionEntry.key();
                     const auto& value = captionEntry.value();
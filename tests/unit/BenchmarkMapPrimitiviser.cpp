@@ -0,0 +1,374 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/Common.h>
+#include <OsmAndCore/CoreResourcesEmbeddedBundle.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Concurrent/WorkerPool.h>
+#include <OsmAndCore/Data/ObfFile.h>
+#include <OsmAndCore/Data/ObfInfo.h>
+#include <OsmAndCore/Data/ObfReader.h>
+#include <OsmAndCore/Data/ObfMapSectionInfo.h>
+#include <OsmAndCore/Data/ObfMapSectionReader.h>
+#include <OsmAndCore/Data/BinaryMapObject.h>
+#include <OsmAndCore/Map/MapStylesCollection.h>
+#include <OsmAndCore/Map/MapPresentationEnvironment.h>
+#include <OsmAndCore/Map/MapPrimitiviser.h>
+
+#include "RoadsDensityFilter.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <memory>
+
+using namespace OsmAnd;
+
+// Benchmarks expect OSMAND_BENCHMARK_OBF to point to a (preferably large) OBF file.
+// OSMAND_BENCHMARK_ZOOM optionally overrides zoom of the tiles.
+// Only the heaviest tiles (by number of map objects) are primitivised, since those are the ones that
+// determine latency of rendering.
+
+class BenchmarkMapPrimitiviser : public QObject
+{
+    Q_OBJECT
+
+private:
+    enum {
+        MaxScannedTilesCount = 4096,
+        HeaviestTilesCount = 8,
+    };
+
+    struct Tile
+    {
+        TileId tileId;
+        QList< std::shared_ptr<const MapObject> > mapObjects;
+        int polygonsCount;
+        int polylinesCount;
+        int pointsCount;
+        std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects> primitivisedObjects;
+    };
+
+    static bool comparePrimitives(
+        const std::shared_ptr<const MapPrimitiviser::Primitive>& l,
+        const std::shared_ptr<const MapPrimitiviser::Primitive>& r);
+    static int filterRoadsByDensityUsingHash(
+        const QList< const QVector<PointI>* >& roads,
+        const ZoomLevel zoom,
+        const unsigned int densityZoom,
+        const unsigned int densityLimit);
+
+    bool coreInitialized = false;
+    ZoomLevel zoom;
+    std::shared_ptr<const MapPresentationEnvironment> environment;
+    QVector<Tile> heaviestTiles;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void primitiviseAllMapObjects_data();
+    void primitiviseAllMapObjects();
+    void sortPrimitives_data();
+    void sortPrimitives();
+    void filterRoadsByDensity_data();
+    void filterRoadsByDensity();
+};
+
+void BenchmarkMapPrimitiviser::initTestCase()
+{
+    const QString obfFilePath = qgetenv("OSMAND_BENCHMARK_OBF");
+    if (obfFilePath.isEmpty() || !QFile::exists(obfFilePath))
+        QSKIP("OSMAND_BENCHMARK_OBF is not set or does not exist");
+
+    bool ok = false;
+    const auto zoomValue = qgetenv("OSMAND_BENCHMARK_ZOOM").toInt(&ok);
+    zoom = (ok && zoomValue >= MinZoomLevel && zoomValue <= MaxZoomLevel) ? static_cast<ZoomLevel>(zoomValue) : ZoomLevel15;
+
+    coreInitialized = InitializeCore(CoreResourcesEmbeddedBundle::loadFromCurrentExecutable());
+    QVERIFY(coreInitialized);
+
+    const std::shared_ptr<MapStylesCollection> stylesCollection(new MapStylesCollection());
+    const auto mapStyle = stylesCollection->getResolvedStyleByName(QLatin1String("default"));
+    if (!mapStyle)
+        QSKIP("Default style is not available");
+    environment.reset(new MapPresentationEnvironment(mapStyle));
+
+    const std::shared_ptr<const ObfFile> obfFile(new ObfFile(obfFilePath));
+    const std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfFile));
+    QVERIFY(obfReader->isOpened());
+    const auto obfInfo = obfReader->obtainInfo();
+    QVERIFY(obfInfo);
+
+    // Collect tiles that are covered by map sections at requested zoom
+    QVector<TileId> tileIds;
+    for (const auto& mapSection : obfInfo->mapSections)
+    {
+        for (const auto& level : mapSection->levels)
+        {
+            if (zoom < level->minZoom || zoom > level->maxZoom)
+                continue;
+
+            const auto zoomShift = ZoomLevel31 - zoom;
+            for (auto y = level->area31.top() >> zoomShift; y <= (level->area31.bottom() >> zoomShift); y++)
+                for (auto x = level->area31.left() >> zoomShift; x <= (level->area31.right() >> zoomShift); x++)
+                    tileIds.push_back(TileId::fromXY(x, y));
+        }
+    }
+    if (tileIds.isEmpty())
+        QSKIP("No map data at requested zoom");
+
+    // Scan evenly spread subset of tiles, and keep the heaviest of them
+    const auto scanStep = qMax(1, tileIds.size() / MaxScannedTilesCount);
+    QVector<Tile> tiles;
+    for (auto tileIdIndex = 0; tileIdIndex < tileIds.size(); tileIdIndex += scanStep)
+    {
+        Tile tile;
+        tile.tileId = tileIds[tileIdIndex];
+
+        const auto bbox31 = Utilities::tileBoundingBox31(tile.tileId, zoom);
+        QList< std::shared_ptr<const BinaryMapObject> > mapObjects;
+        for (const auto& mapSection : obfInfo->mapSections)
+            ObfMapSectionReader::loadMapObjects(obfReader, mapSection, zoom, &bbox31, &mapObjects);
+        if (mapObjects.isEmpty())
+            continue;
+
+        for (const auto& mapObject : mapObjects)
+            tile.mapObjects.push_back(mapObject);
+        tiles.push_back(tile);
+    }
+    if (tiles.isEmpty())
+        QSKIP("No map objects at requested zoom");
+    std::sort(tiles.begin(), tiles.end(),
+        []
+        (const Tile& l, const Tile& r) -> bool
+        {
+            return l.mapObjects.size() > r.mapObjects.size();
+        });
+    heaviestTiles = tiles.mid(0, HeaviestTilesCount);
+
+    // Sequential result is the reference for all parallel ones
+    MapPrimitiviser primitiviser(environment);
+    for (auto& tile : heaviestTiles)
+    {
+        const auto primitivisedObjects = primitiviser.primitiviseAllMapObjects(zoom, tile.mapObjects);
+        QVERIFY(primitivisedObjects);
+        tile.polygonsCount = primitivisedObjects->polygons.size();
+        tile.polylinesCount = primitivisedObjects->polylines.size();
+        tile.pointsCount = primitivisedObjects->points.size();
+        tile.primitivisedObjects = primitivisedObjects;
+    }
+    qDebug() << "Heaviest tile has" << heaviestTiles.first().mapObjects.size() << "map objects";
+}
+
+void BenchmarkMapPrimitiviser::cleanupTestCase()
+{
+    environment.reset();
+    heaviestTiles.clear();
+    if (coreInitialized)
+        ReleaseCore();
+}
+
+void BenchmarkMapPrimitiviser::primitiviseAllMapObjects_data()
+{
+    QTest::addColumn<int>("threadsCount");
+
+    QTest::newRow("sequential") << 1;
+    for (auto threadsCount = 2; threadsCount <= qMax(2, QThread::idealThreadCount()); threadsCount *= 2)
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads").arg(threadsCount))) << threadsCount;
+}
+
+void BenchmarkMapPrimitiviser::primitiviseAllMapObjects()
+{
+    QFETCH(int, threadsCount);
+
+    // Calling thread primitivises partitions as well, so pool has one thread less
+    MapPrimitiviser primitiviser(environment);
+    if (threadsCount > 1)
+        primitiviser.setWorkerPool(std::make_shared<Concurrent::WorkerPool>(Concurrent::WorkerPool::Order::FIFO, threadsCount - 1));
+
+    // Tiles are primitivised one after another, so that latency of a single tile is measured
+    QBENCHMARK
+    {
+        for (const auto& tile : constOf(heaviestTiles))
+        {
+            const auto primitivisedObjects = primitiviser.primitiviseAllMapObjects(zoom, tile.mapObjects);
+            QCOMPARE(primitivisedObjects->polygons.size(), tile.polygonsCount);
+            QCOMPARE(primitivisedObjects->polylines.size(), tile.polylinesCount);
+            QCOMPARE(primitivisedObjects->points.size(), tile.pointsCount);
+        }
+    }
+}
+
+// Same order as PrimitivesArrays::Comparator, but on shared primitives, as it was before PrimitivesArrays
+bool BenchmarkMapPrimitiviser::comparePrimitives(
+    const std::shared_ptr<const MapPrimitiviser::Primitive>& l,
+    const std::shared_ptr<const MapPrimitiviser::Primitive>& r)
+{
+    if (l->zOrder != r->zOrder)
+        return l->zOrder < r->zOrder;
+    if (l->doubledArea != r->doubledArea)
+        return l->doubledArea > r->doubledArea;
+    if (l->attributeIdIndex != r->attributeIdIndex && l->sourceObject == r->sourceObject)
+    {
+        if (l->type == MapPrimitiviser::PrimitiveType::Polygon)
+            return l->attributeIdIndex > r->attributeIdIndex;
+        return l->attributeIdIndex < r->attributeIdIndex;
+    }
+    const auto lPointsCount = l->sourceObject->points31.size();
+    const auto rPointsCount = r->sourceObject->points31.size();
+    if (lPointsCount != rPointsCount)
+        return lPointsCount < rPointsCount;
+    return MapObject::Comparator()(l->sourceObject, r->sourceObject);
+}
+
+void BenchmarkMapPrimitiviser::sortPrimitives_data()
+{
+    QTest::addColumn<bool>("useArrays");
+
+    QTest::newRow("shared_ptr lists") << false;
+    QTest::newRow("arrays") << true;
+}
+
+void BenchmarkMapPrimitiviser::sortPrimitives()
+{
+    QFETCH(bool, useArrays);
+
+    // Polylines of all groups of a tile are collected and sorted, which is what primitivisation does for each tile.
+    // Lists allocate a node per primitive (and touch its reference counter), while arrays allocate once per field.
+    QBENCHMARK
+    {
+        for (const auto& tile : constOf(heaviestTiles))
+        {
+            if (useArrays)
+            {
+                MapPrimitiviser::PrimitivesArrays polylines;
+                for (const auto& group : constOf(tile.primitivisedObjects->primitivesGroups))
+                    polylines.append(group->polylines);
+                polylines.sort();
+            }
+            else
+            {
+                MapPrimitiviser::PrimitivesCollection polylines;
+                for (const auto& group : constOf(tile.primitivisedObjects->primitivesGroups))
+                    polylines.append(group->polylines);
+                std::sort(polylines.begin(), polylines.end(), comparePrimitives);
+            }
+        }
+    }
+}
+
+// Counts cells of each point in a hash, as it was before RoadsDensityFilter
+int BenchmarkMapPrimitiviser::filterRoadsByDensityUsingHash(
+    const QList< const QVector<PointI>* >& roads,
+    const ZoomLevel zoom,
+    const unsigned int densityZoom,
+    const unsigned int densityLimit)
+{
+    const auto dZ = zoom + densityZoom;
+    QHash<uint64_t, uint32_t> densityMap;
+
+    auto rejectedCount = 0;
+    for (const auto pRoad : roads)
+    {
+        auto accept = false;
+        uint64_t prevId = 0;
+        for (const auto& point : *pRoad)
+        {
+            const auto x = point.x >> (MaxZoomLevel - dZ);
+            const auto y = point.y >> (MaxZoomLevel - dZ);
+            const uint64_t id = (static_cast<uint64_t>(x) << dZ) | y;
+            if (prevId == id)
+                continue;
+            prevId = id;
+
+            auto& count = densityMap[id];
+            if (count < densityLimit)
+            {
+                accept = true;
+                count++;
+            }
+        }
+        if (!accept)
+            rejectedCount++;
+    }
+
+    return rejectedCount;
+}
+
+void BenchmarkMapPrimitiviser::filterRoadsByDensity_data()
+{
+    QTest::addColumn<bool>("useGrid");
+
+    QTest::newRow("hash") << false;
+    QTest::newRow("grid") << true;
+}
+
+void BenchmarkMapPrimitiviser::filterRoadsByDensity()
+{
+    QFETCH(bool, useGrid);
+
+    // Zoom of density cells is limited, same way as RoadsDensityFilter limits it
+    auto densityZoom = environment->getRoadDensityZoomTile(zoom);
+    const auto densityLimit = environment->getRoadsDensityLimitPerTile(zoom);
+    if (densityZoom == 0 || densityLimit == 0)
+        QSKIP("Style does not filter roads by density at requested zoom");
+    densityZoom = qMin(densityZoom, static_cast<unsigned int>(MaxZoomLevel - zoom));
+
+    // Roads of each tile (including ones that were rejected), in order they are checked by primitiviser
+    QVector< QList< const QVector<PointI>* > > tilesRoads;
+    for (const auto& tile : constOf(heaviestTiles))
+    {
+        MapPrimitiviser::PrimitivesArrays polylines;
+        for (const auto& group : constOf(tile.primitivisedObjects->primitivesGroups))
+            polylines.append(group->polylines);
+        polylines.sort();
+
+        QList< const QVector<PointI>* > roads;
+        for (auto polylineIndex = polylines.size() - 1; polylineIndex >= 0; polylineIndex--)
+        {
+            const auto sourceObject = polylines.sourceObjects[polylineIndex];
+            const auto attributeIdIndex = static_cast<int>(polylines.attributeIdIndices[polylineIndex]);
+            if (attributeIdIndex >= sourceObject->attributeIds.size())
+                continue;
+            if (!sourceObject->attributeMapping->highwayAttributeIds.contains(sourceObject->attributeIds[attributeIdIndex]))
+                continue;
+
+            roads.push_back(&sourceObject->points31);
+        }
+        tilesRoads.push_back(roads);
+    }
+
+    // Both ways have to reject same number of roads
+    for (const auto& roads : constOf(tilesRoads))
+    {
+        RoadsDensityFilter roadsDensityFilter(zoom, densityZoom, densityLimit);
+        for (const auto pRoad : roads)
+            roadsDensityFilter.addRoad(*pRoad);
+
+        std::vector<uint8_t> rejectFlags;
+        QCOMPARE(
+            roadsDensityFilter.filter(rejectFlags),
+            filterRoadsByDensityUsingHash(roads, zoom, densityZoom, densityLimit));
+    }
+
+    QBENCHMARK
+    {
+        for (const auto& roads : constOf(tilesRoads))
+        {
+            if (useGrid)
+            {
+                RoadsDensityFilter roadsDensityFilter(zoom, densityZoom, densityLimit);
+                for (const auto pRoad : roads)
+                    roadsDensityFilter.addRoad(*pRoad);
+
+                std::vector<uint8_t> rejectFlags;
+                roadsDensityFilter.filter(rejectFlags);
+            }
+            else
+            {
+                filterRoadsByDensityUsingHash(roads, zoom, densityZoom, densityLimit);
+            }
+        }
+    }
+}
+
+QTEST_MAIN(BenchmarkMapPrimitiviser)
+#include "BenchmarkMapPrimitiviser.moc"
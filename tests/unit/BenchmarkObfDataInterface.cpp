@@ -0,0 +1,108 @@
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/ObfDataInterface.h>
+#include <OsmAndCore/Concurrent/WorkerPool.h>
+#include <OsmAndCore/Data/Amenity.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QDir>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+// Benchmarks expect OSMAND_BENCHMARK_OBF_DIR to point to a directory with several OBF files (e.g. installed countries).
+// OSMAND_BENCHMARK_QUERY optionally overrides name that is searched for.
+
+class BenchmarkObfDataInterface : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::shared_ptr<ObfsCollection> obfsCollection;
+    QString query;
+private slots:
+    void initTestCase();
+    void scanAmenitiesByName_data();
+    void scanAmenitiesByName();
+    void streamAmenities_data();
+    void streamAmenities();
+};
+
+void BenchmarkObfDataInterface::initTestCase()
+{
+    const QString obfsDirPath = qgetenv("OSMAND_BENCHMARK_OBF_DIR");
+    if (obfsDirPath.isEmpty() || !QDir(obfsDirPath).exists())
+        QSKIP("OSMAND_BENCHMARK_OBF_DIR is not set or does not exist");
+
+    query = qgetenv("OSMAND_BENCHMARK_QUERY");
+    if (query.isEmpty())
+        query = QLatin1String("cafe");
+
+    obfsCollection.reset(new ObfsCollection());
+    obfsCollection->addDirectory(obfsDirPath);
+    if (obfsCollection->getObfFiles().size() < 2)
+        QSKIP("At least 2 OBF files are needed to measure scaling");
+}
+
+void BenchmarkObfDataInterface::scanAmenitiesByName_data()
+{
+    QTest::addColumn<int>("threadsCount");
+
+    QTest::newRow("sequential") << 1;
+    for (auto threadsCount = 2; threadsCount <= qMax(2, QThread::idealThreadCount()); threadsCount *= 2)
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads").arg(threadsCount))) << threadsCount;
+}
+
+void BenchmarkObfDataInterface::scanAmenitiesByName()
+{
+    QFETCH(int, threadsCount);
+
+    // Calling thread reads sections as well, so pool has one thread less
+    const auto dataInterface = obfsCollection->obtainDataInterface();
+    if (threadsCount > 1)
+        dataInterface->setWorkerPool(std::make_shared<Concurrent::WorkerPool>(Concurrent::WorkerPool::Order::FIFO, threadsCount - 1));
+
+    // Headers are read once, so that only search is measured
+    QVERIFY(dataInterface->loadObfFiles());
+
+    int amenitiesCount = 0;
+    QBENCHMARK
+    {
+        QList< std::shared_ptr<const Amenity> > amenities;
+        QVERIFY(dataInterface->scanAmenitiesByName(query, &amenities));
+        amenitiesCount = amenities.size();
+    }
+    qDebug() << amenitiesCount << "amenities found in" << dataInterface->obfReaders.size() << "files";
+}
+
+void BenchmarkObfDataInterface::streamAmenities_data()
+{
+    QTest::addColumn<unsigned int>("limit");
+
+    QTest::newRow("unlimited") << 0u;
+    QTest::newRow("first 10") << 10u;
+    QTest::newRow("first 100") << 100u;
+}
+
+void BenchmarkObfDataInterface::streamAmenities()
+{
+    QFETCH(unsigned int, limit);
+
+    const auto dataInterface = obfsCollection->obtainDataInterface();
+    QVERIFY(dataInterface->loadObfFiles());
+
+    ObfDataInterface_Metrics::Metric_streamQuery metric;
+    QBENCHMARK
+    {
+        metric.reset();
+        QList< std::shared_ptr<const Amenity> > amenities;
+        QVERIFY(dataInterface->streamAmenities(&amenities, limit, nullptr, nullptr, query,
+            nullptr, nullptr, nullptr, &metric));
+        QVERIFY(limit == 0 || amenities.size() <= static_cast<int>(limit));
+    }
+    qDebug() << qPrintable(metric.toString());
+}
+
+QTEST_MAIN(BenchmarkObfDataInterface)
+#include "BenchmarkObfDataInterface.moc"
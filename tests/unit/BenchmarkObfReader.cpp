@@ -0,0 +1,284 @@
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Data/ObfFile.h>
+#include <OsmAndCore/Data/ObfInfo.h>
+#include <OsmAndCore/Data/ObfReader.h>
+#include <OsmAndCore/Data/ObfMapSectionInfo.h>
+#include <OsmAndCore/Data/ObfMapSectionReader.h>
+#include <OsmAndCore/Data/ObfMapSectionReader_Metrics.h>
+#include <OsmAndCore/Data/BinaryMapObject.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QTemporaryDir>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+// Benchmarks expect OSMAND_BENCHMARK_OBF to point to a (preferably large) OBF file.
+// OSMAND_BENCHMARK_ZOOM optionally overrides zoom of the tile sweep.
+
+class BenchmarkObfReader : public QObject
+{
+    Q_OBJECT
+
+private:
+    QString obfFilePath;
+    ZoomLevel sweepZoom;
+
+    QVector<TileId> collectTileIds(const std::shared_ptr<const ObfInfo>& obfInfo) const;
+private slots:
+    void initTestCase();
+    void obtainInfo_data();
+    void obtainInfo();
+    void loadMapObjects_data();
+    void loadMapObjects();
+    void decodeGeometry_data();
+    void decodeGeometry();
+    void decodeLazily_data();
+    void decodeLazily();
+};
+
+namespace
+{
+    class BenchmarkDataBlocksCache : public ObfMapSectionReader::DataBlocksCache
+    {
+    public:
+        BenchmarkDataBlocksCache(const bool decodeLazily_)
+            : decodeLazily(decodeLazily_)
+        {
+        }
+
+        const bool decodeLazily;
+
+        virtual bool shouldDecodeLazily() const
+        {
+            return decodeLazily;
+        }
+    };
+}
+
+void BenchmarkObfReader::initTestCase()
+{
+    obfFilePath = qgetenv("OSMAND_BENCHMARK_OBF");
+    if (obfFilePath.isEmpty() || !QFile::exists(obfFilePath))
+        QSKIP("OSMAND_BENCHMARK_OBF is not set or does not exist");
+
+    bool ok = false;
+    const auto zoom = qgetenv("OSMAND_BENCHMARK_ZOOM").toInt(&ok);
+    sweepZoom = (ok && zoom >= MinZoomLevel && zoom <= MaxZoomLevel) ? static_cast<ZoomLevel>(zoom) : ZoomLevel14;
+}
+
+QVector<TileId> BenchmarkObfReader::collectTileIds(const std::shared_ptr<const ObfInfo>& obfInfo) const
+{
+    // Sweep all tiles that are covered by map sections at requested zoom
+    QVector<TileId> tileIds;
+    for (const auto& mapSection : obfInfo->mapSections)
+    {
+        for (const auto& level : mapSection->levels)
+        {
+            if (sweepZoom < level->minZoom || sweepZoom > level->maxZoom)
+                continue;
+
+            const auto zoomShift = ZoomLevel31 - sweepZoom;
+            for (auto y = level->area31.top() >> zoomShift; y <= (level->area31.bottom() >> zoomShift); y++)
+                for (auto x = level->area31.left() >> zoomShift; x <= (level->area31.right() >> zoomShift); x++)
+                    tileIds.push_back(TileId::fromXY(x, y));
+        }
+    }
+
+    return tileIds;
+}
+
+void BenchmarkObfReader::obtainInfo_data()
+{
+    QTest::addColumn<bool>("useInfoCache");
+
+    QTest::newRow("uncached") << false;
+    QTest::newRow("cached") << true;
+}
+
+void BenchmarkObfReader::obtainInfo()
+{
+    QFETCH(bool, useInfoCache);
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    const auto infoCacheFilePath = useInfoCache
+        ? QDir(cacheDir.path()).absoluteFilePath(QLatin1String("benchmark.obfinfo"))
+        : QString::null;
+    const auto fileSize = QFileInfo(obfFilePath).size();
+
+    // Warm up sidecar, so that only loading from it is measured
+    if (useInfoCache)
+    {
+        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(obfFilePath, fileSize, infoCacheFilePath));
+        QVERIFY(ObfReader(obfFile).obtainInfo());
+        QVERIFY(QFile::exists(infoCacheFilePath));
+    }
+
+    // Each iteration simulates startup: fresh ObfFile without any loaded headers
+    QBENCHMARK
+    {
+        const std::shared_ptr<const ObfFile> obfFile(new ObfFile(obfFilePath, fileSize, infoCacheFilePath));
+        if (!obfFile->loadInfoFromCache())
+            QVERIFY(ObfReader(obfFile).obtainInfo());
+        QVERIFY(obfFile->obfInfo);
+    }
+}
+
+void BenchmarkObfReader::loadMapObjects_data()
+{
+    QTest::addColumn<bool>("useMemoryMapping");
+
+    QTest::newRow("QFile") << false;
+    QTest::newRow("mmap") << true;
+}
+
+void BenchmarkObfReader::loadMapObjects()
+{
+    QFETCH(bool, useMemoryMapping);
+
+    const std::shared_ptr<const ObfFile> obfFile(new ObfFile(obfFilePath));
+    const std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfFile, useMemoryMapping));
+    QVERIFY(obfReader->isOpened());
+    const auto obfInfo = obfReader->obtainInfo();
+    QVERIFY(obfInfo);
+
+    const auto tileIds = collectTileIds(obfInfo);
+    if (tileIds.isEmpty())
+        QSKIP("No map data at requested zoom");
+
+    QBENCHMARK
+    {
+        for (const auto& tileId : tileIds)
+        {
+            const auto bbox31 = Utilities::tileBoundingBox31(tileId, sweepZoom);
+
+            QList< std::shared_ptr<const BinaryMapObject> > mapObjects;
+            for (const auto& mapSection : obfInfo->mapSections)
+                ObfMapSectionReader::loadMapObjects(obfReader, mapSection, sweepZoom, &bbox31, &mapObjects);
+        }
+    }
+}
+
+void BenchmarkObfReader::decodeGeometry_data()
+{
+    loadMapObjects_data();
+}
+
+void BenchmarkObfReader::decodeGeometry()
+{
+    QFETCH(bool, useMemoryMapping);
+
+    const std::shared_ptr<const ObfFile> obfFile(new ObfFile(obfFilePath));
+    const std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfFile, useMemoryMapping));
+    QVERIFY(obfReader->isOpened());
+    const auto obfInfo = obfReader->obtainInfo();
+    QVERIFY(obfInfo);
+
+    const auto tileIds = collectTileIds(obfInfo);
+    if (tileIds.isEmpty())
+        QSKIP("No map data at requested zoom");
+
+    // Only time spent on decoding vertices of real map objects (both skipped and not) is reported,
+    // so that this can be compared across changes of the geometry decoder
+    ObfMapSectionReader_Metrics::Metric_loadMapObjects metric;
+    for (const auto& tileId : tileIds)
+    {
+        const auto bbox31 = Utilities::tileBoundingBox31(tileId, sweepZoom);
+
+        for (const auto& mapSection : obfInfo->mapSections)
+        {
+            ObfMapSectionReader::loadMapObjects(
+                obfReader,
+                mapSection,
+                sweepZoom,
+                &bbox31,
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr,
+                &metric);
+        }
+    }
+
+    const auto pointsCount = metric.skippedMapObjectsPoints + metric.notSkippedMapObjectsPoints;
+    if (pointsCount == 0)
+        QSKIP("No geometry at requested zoom");
+    qDebug() << pointsCount << "vertices decoded";
+
+    const auto decodingTime = metric.elapsedTimeForSkippedMapObjectsPoints + metric.elapsedTimeForNotSkippedMapObjectsPoints;
+    QTest::setBenchmarkResult(decodingTime * 1000.0, QTest::WalltimeMilliseconds);
+}
+
+void BenchmarkObfReader::decodeLazily_data()
+{
+    QTest::addColumn<bool>("decodeLazily");
+
+    QTest::newRow("eager") << false;
+    QTest::newRow("lazy") << true;
+}
+
+void BenchmarkObfReader::decodeLazily()
+{
+    QFETCH(bool, decodeLazily);
+
+    const std::shared_ptr<const ObfFile> obfFile(new ObfFile(obfFilePath));
+    const std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfFile));
+    QVERIFY(obfReader->isOpened());
+    const auto obfInfo = obfReader->obtainInfo();
+    QVERIFY(obfInfo);
+
+    const auto tileIds = collectTileIds(obfInfo);
+    if (tileIds.isEmpty())
+        QSKIP("No map data at requested zoom");
+
+    // Same way as ObfMapObjectsProvider does: entire blocks are read into cache, and only objects inside
+    // tile are returned. Each iteration starts with empty cache, so that all blocks are actually read
+    ObfMapSectionReader_Metrics::Metric_loadMapObjects metric;
+    QBENCHMARK
+    {
+        metric.reset();
+        BenchmarkDataBlocksCache cache(decodeLazily);
+        for (const auto& tileId : tileIds)
+        {
+            const auto bbox31 = Utilities::tileBoundingBox31(tileId, sweepZoom);
+
+            QList< std::shared_ptr<const BinaryMapObject> > mapObjects;
+            QList< std::shared_ptr<const ObfMapSectionReader::DataBlock> > referencedCacheEntries;
+            for (const auto& mapSection : obfInfo->mapSections)
+            {
+                ObfMapSectionReader::loadMapObjects(
+                    obfReader,
+                    mapSection,
+                    sweepZoom,
+                    &bbox31,
+                    &mapObjects,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    &cache,
+                    &referencedCacheEntries,
+                    nullptr,
+                    &metric);
+            }
+
+            for (auto& referencedCacheEntry : referencedCacheEntries)
+                cache.releaseReference(referencedCacheEntry->id, sweepZoom, referencedCacheEntry);
+        }
+    }
+
+    qDebug()
+        << metric.decodedCaptions << "captions decoded,"
+        << metric.deferredCaptions << "deferred;"
+        << metric.decodedInnerPolygons << "inner polygons decoded,"
+        << metric.deferredInnerPolygons << "deferred;"
+        << tileIds.size() << "tiles";
+}
+
+QTEST_MAIN(BenchmarkObfReader)
+#include "BenchmarkObfReader.moc"
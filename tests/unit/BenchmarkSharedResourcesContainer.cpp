@@ -0,0 +1,119 @@
+#include <OsmAndCore/SharedResourcesContainer.h>
+#include <OsmAndCore/StripedSharedResourcesContainer.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace OsmAnd;
+
+// Each thread repeatedly obtains a reference to one of shared keys (or promises and fulfils it) and releases it,
+// same way as map objects and data blocks are shared between tiles that are loaded in parallel.
+// Total number of operations is the same for any number of threads.
+
+class BenchmarkSharedResourcesContainer : public QObject
+{
+    Q_OBJECT
+
+private:
+    enum {
+        KeysCount = 4096,
+        OperationsCount = 1 << 20,
+    };
+
+    typedef SharedResourcesContainer<int, const int> Container;
+    typedef StripedSharedResourcesContainer<Container> StripedContainer;
+
+    template<typename CONTAINER_TYPE>
+    static void run(CONTAINER_TYPE& container, const int threadsCount);
+private slots:
+    void contention_data();
+    void contention();
+};
+
+template<typename CONTAINER_TYPE>
+void BenchmarkSharedResourcesContainer::run(CONTAINER_TYPE& container, const int threadsCount)
+{
+    const auto operationsPerThread = OperationsCount / threadsCount;
+
+    std::vector<std::thread> threads;
+    for (auto threadIdx = 0; threadIdx < threadsCount; threadIdx++)
+    {
+        threads.emplace_back(
+            [&container, operationsPerThread, threadIdx]
+            ()
+            {
+                // Simple LCG is enough to spread keys, and doesn't add any locking of its own
+                auto seed = static_cast<uint32_t>(threadIdx) * 7919u + 1u;
+                for (auto operationIdx = 0; operationIdx < operationsPerThread; operationIdx++)
+                {
+                    seed = seed * 1664525u + 1013904223u;
+                    const auto key = static_cast<int>((seed >> 8) % KeysCount);
+
+                    typename CONTAINER_TYPE::ResourcePtr resource;
+                    proper::shared_future<typename CONTAINER_TYPE::ResourcePtr> futureResource;
+                    if (container.obtainReferenceOrFutureReferenceOrMakePromise(key, resource, futureResource))
+                    {
+                        if (!resource)
+                            resource = futureResource.get();
+                    }
+                    else
+                    {
+                        resource.reset(new int(key));
+                        container.fulfilPromiseAndReference(key, resource);
+                    }
+
+                    container.releaseReference(key, resource);
+                }
+            });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void BenchmarkSharedResourcesContainer::contention_data()
+{
+    QTest::addColumn<int>("threadsCount");
+    QTest::addColumn<bool>("striped");
+
+    for (auto threadsCount = 1; threadsCount <= 32; threadsCount *= 2)
+    {
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads, single lock").arg(threadsCount)))
+            << threadsCount << false;
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads, %2 stripes").arg(threadsCount).arg(StripedContainer::StripesCount)))
+            << threadsCount << true;
+    }
+}
+
+void BenchmarkSharedResourcesContainer::contention()
+{
+    QFETCH(int, threadsCount);
+    QFETCH(bool, striped);
+
+    // Half of keys are retained after release, so that both hits and misses are exercised
+    if (striped)
+    {
+        StripedContainer container;
+        container.setRetentionBudget(KeysCount / 2);
+        QBENCHMARK
+        {
+            run(container, threadsCount);
+        }
+    }
+    else
+    {
+        Container container;
+        container.setRetentionBudget(KeysCount / 2);
+        QBENCHMARK
+        {
+            run(container, threadsCount);
+        }
+    }
+}
+
+QTEST_MAIN(BenchmarkSharedResourcesContainer)
+#include "BenchmarkSharedResourcesContainer.moc"
@@ -0,0 +1,277 @@
+#include <OsmAndCore/Concurrent/WorkerPool.h>
+#include <OsmAndCore/QRunnableFunctor.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSemaphore>
+
+#include <algorithm>
+#include <vector>
+
+using namespace OsmAnd;
+
+// Thousands of short tasks are pushed through the pool, either by one thread (as resources are requested by
+// renderer) or by tasks themselves (as runAndWait() does from inside of worker). Latency is the time between
+// enqueue of a task and start of its execution.
+
+class BenchmarkWorkerPool : public QObject
+{
+    Q_OBJECT
+
+private:
+    enum {
+        TasksCount = 10000,
+        TaskWorkIterations = 200,
+    };
+
+    static void doShortWork(const int seed);
+    static QRunnable* makeTask(
+        const int taskIdx,
+        QAtomicInt& executedCount,
+        std::vector<qint64>* const latencies = nullptr,
+        const QElapsedTimer* const timer = nullptr);
+    static QVector<QRunnable*> makeTasks(QAtomicInt& executedCount);
+private slots:
+    void throughput_data();
+    void throughput();
+    void nestedThroughput_data();
+    void nestedThroughput();
+    void latency_data();
+    void latency();
+    void priorityOrder();
+};
+
+void BenchmarkWorkerPool::doShortWork(const int seed)
+{
+    // Simple LCG keeps the task busy for about a microsecond without touching shared memory
+    volatile auto value = static_cast<uint32_t>(seed);
+    for (auto iteration = 0; iteration < TaskWorkIterations; iteration++)
+        value = value * 1664525u + 1013904223u;
+}
+
+QRunnable* BenchmarkWorkerPool::makeTask(
+    const int taskIdx,
+    QAtomicInt& executedCount,
+    std::vector<qint64>* const latencies /*= nullptr*/,
+    const QElapsedTimer* const timer /*= nullptr*/)
+{
+    const auto enqueuedAt = timer ? timer->nsecsElapsed() : 0;
+    return new QRunnableFunctor(
+        [&executedCount, latencies, timer, taskIdx, enqueuedAt]
+        (const QRunnableFunctor* const runnable)
+        {
+            if (latencies)
+                (*latencies)[taskIdx] = timer->nsecsElapsed() - enqueuedAt;
+            doShortWork(taskIdx);
+            executedCount.fetchAndAddOrdered(1);
+        });
+}
+
+QVector<QRunnable*> BenchmarkWorkerPool::makeTasks(QAtomicInt& executedCount)
+{
+    QVector<QRunnable*> tasks;
+    tasks.reserve(TasksCount);
+    for (auto taskIdx = 0; taskIdx < TasksCount; taskIdx++)
+        tasks.push_back(makeTask(taskIdx, executedCount));
+    return tasks;
+}
+
+void BenchmarkWorkerPool::throughput_data()
+{
+    QTest::addColumn<int>("threadsCount");
+    QTest::addColumn<bool>("batched");
+
+    for (auto threadsCount = 1; threadsCount <= 16; threadsCount *= 2)
+    {
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads, one by one").arg(threadsCount)))
+            << threadsCount << false;
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads, batch").arg(threadsCount)))
+            << threadsCount << true;
+    }
+}
+
+void BenchmarkWorkerPool::throughput()
+{
+    QFETCH(int, threadsCount);
+    QFETCH(bool, batched);
+
+    Concurrent::WorkerPool pool(Concurrent::WorkerPool::Order::LIFO, threadsCount);
+    QAtomicInt executedCount;
+    QBENCHMARK
+    {
+        executedCount.storeRelease(0);
+        const auto tasks = makeTasks(executedCount);
+        if (batched)
+        {
+            pool.enqueueWithPriorities(tasks,
+                []
+                (QRunnable* const runnable) -> Concurrent::WorkerPool::Priority
+                {
+                    return reinterpret_cast<intptr_t>(runnable) & 0xFFFF;
+                });
+        }
+        else
+        {
+            auto priority = 0;
+            for (const auto task : tasks)
+                pool.enqueueWithPriority(task, priority++ & 0xFF);
+        }
+        QVERIFY(pool.waitForDone());
+        QCOMPARE(executedCount.loadAcquire(), static_cast<int>(TasksCount));
+    }
+}
+
+void BenchmarkWorkerPool::nestedThroughput_data()
+{
+    QTest::addColumn<int>("threadsCount");
+
+    for (auto threadsCount = 1; threadsCount <= 16; threadsCount *= 2)
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads").arg(threadsCount))) << threadsCount;
+}
+
+void BenchmarkWorkerPool::nestedThroughput()
+{
+    QFETCH(int, threadsCount);
+
+    // Each outer task fans out into a batch of short tasks, which are enqueued into queue of its own worker
+    enum {
+        OuterTasksCount = 50,
+        InnerTasksCount = TasksCount / OuterTasksCount,
+    };
+
+    Concurrent::WorkerPool pool(Concurrent::WorkerPool::Order::FIFO, threadsCount);
+    QAtomicInt executedCount;
+    QBENCHMARK
+    {
+        executedCount.storeRelease(0);
+        QVector<QRunnable*> outerTasks;
+        for (auto outerTaskIdx = 0; outerTaskIdx < OuterTasksCount; outerTaskIdx++)
+        {
+            outerTasks.push_back(new QRunnableFunctor(
+                [&pool, &executedCount, outerTaskIdx]
+                (const QRunnableFunctor* const runnable)
+                {
+                    QVector<Concurrent::WorkerPool::Task> tasks;
+                    tasks.reserve(InnerTasksCount);
+                    for (auto innerTaskIdx = 0; innerTaskIdx < InnerTasksCount; innerTaskIdx++)
+                    {
+                        const auto seed = outerTaskIdx * InnerTasksCount + innerTaskIdx;
+                        tasks.push_back(
+                            [&executedCount, seed]
+                            ()
+                            {
+                                doShortWork(seed);
+                                executedCount.fetchAndAddOrdered(1);
+                            });
+                    }
+                    pool.runAndWait(tasks);
+                }));
+        }
+        pool.enqueue(outerTasks);
+        QVERIFY(pool.waitForDone());
+        QCOMPARE(executedCount.loadAcquire(), static_cast<int>(TasksCount));
+    }
+}
+
+void BenchmarkWorkerPool::latency_data()
+{
+    QTest::addColumn<int>("threadsCount");
+
+    for (auto threadsCount = 1; threadsCount <= 16; threadsCount *= 2)
+        QTest::newRow(qPrintable(QString::fromLatin1("%1 threads").arg(threadsCount))) << threadsCount;
+}
+
+void BenchmarkWorkerPool::latency()
+{
+    QFETCH(int, threadsCount);
+
+    Concurrent::WorkerPool pool(Concurrent::WorkerPool::Order::FIFO, threadsCount);
+    QAtomicInt executedCount;
+    std::vector<qint64> latencies(TasksCount, 0);
+    QElapsedTimer timer;
+    timer.start();
+
+    // Tasks are enqueued one by one right after being created, same as tasks that arrive over time
+    for (auto taskIdx = 0; taskIdx < TasksCount; taskIdx++)
+        pool.enqueueWithPriority(makeTask(taskIdx, executedCount, &latencies, &timer), 0);
+    QVERIFY(pool.waitForDone());
+    QCOMPARE(executedCount.loadAcquire(), static_cast<int>(TasksCount));
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile =
+        [&latencies]
+        (const int percent) -> double
+        {
+            return latencies[(latencies.size() - 1) * percent / 100] / 1000.0;
+        };
+    qDebug("%d tasks on %d threads: latency p50 = %.1fus, p90 = %.1fus, p99 = %.1fus, max = %.1fus",
+        static_cast<int>(TasksCount),
+        threadsCount,
+        percentile(50),
+        percentile(90),
+        percentile(99),
+        percentile(100));
+}
+
+void BenchmarkWorkerPool::priorityOrder()
+{
+    // While the only thread is blocked, queued tasks have to be ordered by priority, and reprioritization has
+    // to be applied to ones that are already queued
+    Concurrent::WorkerPool pool(Concurrent::WorkerPool::Order::FIFO, 1);
+
+    QSemaphore blockerStarted;
+    QSemaphore blockerReleased;
+    pool.enqueue(new QRunnableFunctor(
+        [&blockerStarted, &blockerReleased]
+        (const QRunnableFunctor* const runnable)
+        {
+            blockerStarted.release();
+            blockerReleased.acquire();
+        }));
+    blockerStarted.acquire();
+
+    enum {
+        OrderedTasksCount = 64,
+    };
+    QVector<int> executionOrder;
+    QVector<QRunnable*> tasks;
+    QHash<QRunnable*, int> taskIndices;
+    for (auto taskIdx = 0; taskIdx < OrderedTasksCount; taskIdx++)
+    {
+        const auto task = new QRunnableFunctor(
+            [&executionOrder, taskIdx]
+            (const QRunnableFunctor* const runnable)
+            {
+                executionOrder.push_back(taskIdx);
+            });
+        tasks.push_back(task);
+        taskIndices.insert(task, taskIdx);
+    }
+    pool.enqueueWithPriorities(tasks,
+        [&taskIndices]
+        (QRunnable* const runnable) -> Concurrent::WorkerPool::Priority
+        {
+            return taskIndices[runnable];
+        });
+    QCOMPARE(pool.queuedCount(), static_cast<unsigned int>(OrderedTasksCount));
+
+    // Reverse priorities: lower index runs first
+    pool.reprioritize(
+        [&taskIndices]
+        (QRunnable* const runnable) -> Concurrent::WorkerPool::Priority
+        {
+            return -taskIndices[runnable];
+        });
+
+    blockerReleased.release();
+    QVERIFY(pool.waitForDone());
+
+    QCOMPARE(executionOrder.size(), static_cast<int>(OrderedTasksCount));
+    for (auto taskIdx = 0; taskIdx < OrderedTasksCount; taskIdx++)
+        QCOMPARE(executionOrder[taskIdx], taskIdx);
+}
+
+QTEST_MAIN(BenchmarkWorkerPool)
+#include "BenchmarkWorkerPool.moc"
@@ -0,0 +1,180 @@
+#include <OsmAndCore/Utilities.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+using namespace OsmAnd;
+
+class TestGeometrySimplification : public QObject
+{
+    Q_OBJECT
+
+private:
+    static bool isInside(const QVector<PointI>& points, const AreaI& area);
+private slots:
+    void collinearPointsAreRemoved();
+    void pointsWithinToleranceAreSnapped();
+    void deviationAboveToleranceIsKept();
+    void ringStaysClosed();
+    void segmentInsideIsKept();
+    void segmentOutsideIsRejected();
+    void segmentCrossingIsClipped();
+    void polygonOutsideIsEmpty();
+    void polygonCoveringAreaIsClippedToArea();
+    void polygonCrossingIsClipped();
+};
+
+bool TestGeometrySimplification::isInside(const QVector<PointI>& points, const AreaI& area)
+{
+    for (const auto& point : points)
+    {
+        if (!area.contains(point))
+            return false;
+    }
+    return true;
+}
+
+void TestGeometrySimplification::collinearPointsAreRemoved()
+{
+    QVector<PointI> points;
+    for (auto x = 0; x <= 1000; x += 100)
+        points.push_back(PointI(x, 2 * x));
+
+    const auto simplified = Utilities::simplifyPolyline(points, 1.0);
+    QCOMPARE(simplified.size(), 2);
+    QCOMPARE(simplified.first(), points.first());
+    QCOMPARE(simplified.last(), points.last());
+}
+
+void TestGeometrySimplification::pointsWithinToleranceAreSnapped()
+{
+    // Zig-zag that never deviates more than tolerance from its start
+    QVector<PointI> points;
+    for (auto idx = 0; idx < 10; idx++)
+        points.push_back(PointI(idx % 3, idx % 2));
+    points.push_back(PointI(1000, 0));
+
+    const auto simplified = Utilities::simplifyPolyline(points, 10.0);
+    QCOMPARE(simplified.size(), 2);
+    QCOMPARE(simplified.last(), PointI(1000, 0));
+}
+
+void TestGeometrySimplification::deviationAboveToleranceIsKept()
+{
+    QVector<PointI> points;
+    points.push_back(PointI(0, 0));
+    points.push_back(PointI(500, 5));
+    points.push_back(PointI(1000, 0));
+    points.push_back(PointI(1000, 1000));
+
+    const auto simplified = Utilities::simplifyPolyline(points, 10.0);
+    QCOMPARE(simplified.size(), 3);
+    QCOMPARE(simplified[1], PointI(1000, 0));
+
+    // Spike along the line is not on the segment, thus it's kept as well
+    QVector<PointI> spike;
+    spike.push_back(PointI(0, 0));
+    spike.push_back(PointI(3000, 0));
+    spike.push_back(PointI(1000, 0));
+    QCOMPARE(Utilities::simplifyPolyline(spike, 10.0).size(), 3);
+}
+
+void TestGeometrySimplification::ringStaysClosed()
+{
+    QVector<PointI> ring;
+    ring.push_back(PointI(0, 0));
+    ring.push_back(PointI(500, 1));
+    ring.push_back(PointI(1000, 0));
+    ring.push_back(PointI(1000, 1000));
+    ring.push_back(PointI(0, 1000));
+    ring.push_back(PointI(0, 0));
+
+    const auto simplified = Utilities::simplifyPolyline(ring, 10.0);
+    QCOMPARE(simplified.size(), 5);
+    QCOMPARE(simplified.first(), simplified.last());
+}
+
+void TestGeometrySimplification::segmentInsideIsKept()
+{
+    const AreaI area(0, 0, 100, 100);
+    PointI p0(10, 10);
+    PointI p1(90, 50);
+    QVERIFY(Utilities::clipSegment(p0, p1, area));
+    QCOMPARE(p0, PointI(10, 10));
+    QCOMPARE(p1, PointI(90, 50));
+}
+
+void TestGeometrySimplification::segmentOutsideIsRejected()
+{
+    const AreaI area(0, 0, 100, 100);
+    PointI p0(-50, -10);
+    PointI p1(150, -20);
+    QVERIFY(!Utilities::clipSegment(p0, p1, area));
+
+    // Crosses corner region only, without touching area
+    PointI p2(-50, 60);
+    PointI p3(60, 200);
+    QVERIFY(!Utilities::clipSegment(p2, p3, area));
+}
+
+void TestGeometrySimplification::segmentCrossingIsClipped()
+{
+    const AreaI area(0, 0, 100, 100);
+    PointI p0(-100, 50);
+    PointI p1(200, 50);
+    QVERIFY(Utilities::clipSegment(p0, p1, area));
+    QCOMPARE(p0, PointI(0, 50));
+    QCOMPARE(p1, PointI(100, 50));
+
+    PointI p2(50, -100);
+    PointI p3(150, 100);
+    QVERIFY(Utilities::clipSegment(p2, p3, area));
+    QCOMPARE(p2, PointI(100, 0));
+    QCOMPARE(p3, PointI(100, 0));
+}
+
+void TestGeometrySimplification::polygonOutsideIsEmpty()
+{
+    const AreaI area(0, 0, 100, 100);
+    QVector<PointI> ring;
+    ring.push_back(PointI(200, 200));
+    ring.push_back(PointI(300, 200));
+    ring.push_back(PointI(300, 300));
+    ring.push_back(PointI(200, 200));
+
+    QVERIFY(Utilities::clipPolygon(ring, area).isEmpty());
+}
+
+void TestGeometrySimplification::polygonCoveringAreaIsClippedToArea()
+{
+    const AreaI area(0, 0, 100, 100);
+    QVector<PointI> ring;
+    ring.push_back(PointI(-1000, -1000));
+    ring.push_back(PointI(1000, -1000));
+    ring.push_back(PointI(1000, 1000));
+    ring.push_back(PointI(-1000, 1000));
+    ring.push_back(PointI(-1000, -1000));
+
+    const auto clipped = Utilities::clipPolygon(ring, area);
+    QCOMPARE(clipped.size(), 4);
+    QVERIFY(isInside(clipped, area));
+    QCOMPARE(Utilities::doubledPolygonArea(clipped + QVector<PointI>(1, clipped.first())), int64_t(2 * 100 * 100));
+}
+
+void TestGeometrySimplification::polygonCrossingIsClipped()
+{
+    const AreaI area(0, 0, 100, 100);
+    QVector<PointI> ring;
+    ring.push_back(PointI(50, 50));
+    ring.push_back(PointI(150, 50));
+    ring.push_back(PointI(150, 150));
+    ring.push_back(PointI(50, 150));
+    ring.push_back(PointI(50, 50));
+
+    const auto clipped = Utilities::clipPolygon(ring, area);
+    QVERIFY(isInside(clipped, area));
+    QCOMPARE(Utilities::doubledPolygonArea(clipped + QVector<PointI>(1, clipped.first())), int64_t(2 * 50 * 50));
+}
+
+QTEST_MAIN(TestGeometrySimplification)
+#include "TestGeometrySimplification.moc"
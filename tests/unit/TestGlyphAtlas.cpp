@@ -0,0 +1,306 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CoreResourcesEmbeddedBundle.h>
+#include <OsmAndCore/GlyphAtlas.h>
+#include <OsmAndCore/TextRasterizer.h>
+
+#include <SkBitmap.h>
+#include <SkCanvas.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+class TestGlyphAtlas : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVector<GlyphAtlas::CellRequest> makeCells(const int firstGlyphId, const int count, const int width);
+    static bool hasInk(const SkBitmap& bitmap, const AreaI& area);
+
+    bool coreInitialized = false;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void packedAreasDoNotOverlap();
+    void packerFailsOnceFull();
+    void repeatedRunDrawsNothing();
+    void atlasStartsOverOnceAllPagesAreFull();
+    void oversizedCellsAreRejected();
+    void textRunReusesGlyphs();
+    void unsupportedTextsHaveNoRun();
+};
+
+void TestGlyphAtlas::initTestCase()
+{
+    coreInitialized = InitializeCore(CoreResourcesEmbeddedBundle::loadFromCurrentExecutable());
+    QVERIFY(coreInitialized);
+}
+
+void TestGlyphAtlas::cleanupTestCase()
+{
+    if (coreInitialized)
+        ReleaseCore();
+}
+
+QVector<GlyphAtlas::CellRequest> TestGlyphAtlas::makeCells(const int firstGlyphId, const int count, const int width)
+{
+    QVector<GlyphAtlas::CellRequest> cells;
+    for (auto idx = 0; idx < count; idx++)
+    {
+        GlyphAtlas::CellRequest cell;
+        cell.key.glyphId = static_cast<uint16_t>(firstGlyphId + idx);
+        cell.key.size = 14.0f;
+        cell.glyphIndex = idx;
+        cell.width = width;
+        cells.push_back(cell);
+    }
+    return cells;
+}
+
+bool TestGlyphAtlas::hasInk(const SkBitmap& bitmap, const AreaI& area)
+{
+    SkAutoLockPixels lock(bitmap);
+    for (auto y = area.top(); y < area.bottom(); y++)
+    {
+        for (auto x = area.left(); x < area.right(); x++)
+        {
+            if (SkColorGetA(bitmap.getColor(x, y)) != 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+void TestGlyphAtlas::packedAreasDoNotOverlap()
+{
+    GlyphAtlas::ShelfPacker packer(PointI(128, 128), 2);
+    QVERIFY(packer.isEmpty());
+
+    QVector<AreaI> areas;
+    for (auto idx = 0; idx < 40; idx++)
+    {
+        const PointI size(5 + (idx * 7) % 19, 8 + (idx * 5) % 11);
+        AreaI area;
+        QVERIFY(packer.pack(size, area));
+        QCOMPARE(area.width(), size.x);
+        QCOMPARE(area.height(), size.y);
+        QVERIFY(area.left() >= packer.padding && area.top() >= packer.padding);
+        QVERIFY(area.right() + packer.padding <= packer.size.x && area.bottom() + packer.padding <= packer.size.y);
+
+        // Areas are separated by padding
+        const AreaI paddedArea(
+            area.top() - packer.padding,
+            area.left() - packer.padding,
+            area.bottom() + packer.padding,
+            area.right() + packer.padding);
+        for (const auto& otherArea : constOf(areas))
+        {
+            QVERIFY(paddedArea.right() <= otherArea.left() || otherArea.right() <= paddedArea.left() ||
+                paddedArea.bottom() <= otherArea.top() || otherArea.bottom() <= paddedArea.top());
+        }
+        areas.push_back(area);
+    }
+    QVERIFY(!packer.isEmpty());
+}
+
+void TestGlyphAtlas::packerFailsOnceFull()
+{
+    GlyphAtlas::ShelfPacker packer(PointI(32, 32));
+
+    AreaI area;
+    QVERIFY(!packer.pack(PointI(31, 4), area));
+    QVERIFY(!packer.pack(PointI(0, 4), area));
+
+    auto packedCount = 0;
+    while (packer.pack(PointI(9, 9), area))
+        packedCount++;
+    QCOMPARE(packedCount, 9);
+
+    packer.reset();
+    QVERIFY(packer.isEmpty());
+    QVERIFY(packer.pack(PointI(30, 30), area));
+    QCOMPARE(area.topLeft, PointI(1, 1));
+}
+
+void TestGlyphAtlas::repeatedRunDrawsNothing()
+{
+    GlyphAtlas atlas(64, 2);
+    auto paintedCount = 0;
+    const GlyphAtlas::CellPainter painter =
+        [&paintedCount]
+        (SkCanvas& canvas, const GlyphAtlas::CellRequest& cell)
+        {
+            Q_UNUSED(cell);
+            canvas.drawColor(SK_ColorRED);
+            paintedCount++;
+        };
+
+    auto cells = makeCells(1, 3, 10);
+    cells.push_back(cells.first());
+    const QVector<float> glyphsWidth(cells.size(), 8.0f);
+
+    unsigned int drawnCellsCount = 0;
+    const auto first = atlas.obtainGlyphRun(glyphsWidth, 12, cells, painter, &drawnCellsCount);
+    QVERIFY(first);
+    QCOMPARE(drawnCellsCount, 3u);
+    QCOMPARE(paintedCount, 3);
+    QCOMPARE(first->cells.size(), cells.size());
+    QCOMPARE(first->cells.last().area, first->cells.first().area);
+    QCOMPARE(first->getWidth(), 32.0f);
+    QCOMPARE(atlas.getCellsCount(), 3u);
+
+    const auto second = atlas.obtainGlyphRun(glyphsWidth, 12, cells, painter, &drawnCellsCount);
+    QVERIFY(second);
+    QCOMPARE(drawnCellsCount, 0u);
+    QCOMPARE(paintedCount, 3);
+    QCOMPARE(second->page, first->page);
+    for (auto idx = 0; idx < cells.size(); idx++)
+        QCOMPARE(second->cells[idx].area, first->cells[idx].area);
+
+    // Page bitmap is shared until new cells are drawn
+    const auto bitmap = atlas.obtainPageBitmap(*first);
+    QVERIFY(bitmap);
+    QCOMPARE(atlas.obtainPageBitmap(*second).get(), bitmap.get());
+    // Only rows that have cells are copied
+    QCOMPARE(bitmap->width(), static_cast<int>(atlas.pageSize));
+    QVERIFY(bitmap->height() < static_cast<int>(atlas.pageSize));
+    QVERIFY(bitmap->height() >= first->cells.first().area.bottom());
+    for (const auto& cell : constOf(first->cells))
+        QVERIFY(hasInk(*bitmap, cell.area));
+
+    QVERIFY(atlas.obtainGlyphRun(glyphsWidth, 12, makeCells(10, 1, 10), painter, &drawnCellsCount));
+    QCOMPARE(drawnCellsCount, 1u);
+    const auto updatedBitmap = atlas.obtainPageBitmap(*first);
+    QVERIFY(updatedBitmap);
+    QVERIFY(updatedBitmap.get() != bitmap.get());
+}
+
+void TestGlyphAtlas::atlasStartsOverOnceAllPagesAreFull()
+{
+    GlyphAtlas atlas(64, 2);
+    const GlyphAtlas::CellPainter painter =
+        []
+        (SkCanvas& canvas, const GlyphAtlas::CellRequest& cell)
+        {
+            Q_UNUSED(cell);
+            canvas.drawColor(SK_ColorBLACK);
+        };
+
+    // Each run takes a whole shelf of a page, and 3 shelves fit into a page
+    QList< std::shared_ptr<const GlyphAtlas::GlyphRun> > runs;
+    for (auto runIdx = 0; runIdx < 6; runIdx++)
+    {
+        const auto cells = makeCells(runIdx * 10, 3, 20);
+        const auto run = atlas.obtainGlyphRun(QVector<float>(cells.size(), 1.0f), 20, cells, painter);
+        QVERIFY(run);
+        runs.push_back(run);
+    }
+    QCOMPARE(atlas.getPagesCount(), 2u);
+    QCOMPARE(atlas.getCellsCount(), 18u);
+    QVERIFY(runs[0]->page == runs[2]->page);
+    QVERIFY(runs[2]->page != runs[3]->page);
+
+    const auto cells = makeCells(100, 3, 20);
+    const auto run = atlas.obtainGlyphRun(QVector<float>(cells.size(), 1.0f), 20, cells, painter);
+    QVERIFY(run);
+    QCOMPARE(atlas.getPagesCount(), 1u);
+    QCOMPARE(atlas.getCellsCount(), 3u);
+
+    // Runs obtained earlier keep their pages
+    QVERIFY(atlas.obtainPageBitmap(*runs.first()));
+
+    atlas.clear();
+    QCOMPARE(atlas.getPagesCount(), 0u);
+    QCOMPARE(atlas.getCellsCount(), 0u);
+}
+
+void TestGlyphAtlas::oversizedCellsAreRejected()
+{
+    GlyphAtlas atlas(64, 2);
+    const GlyphAtlas::CellPainter painter =
+        []
+        (SkCanvas& canvas, const GlyphAtlas::CellRequest& cell)
+        {
+            Q_UNUSED(canvas);
+            Q_UNUSED(cell);
+        };
+
+    QVERIFY(!atlas.obtainGlyphRun(QVector<float>(1, 1.0f), 63, makeCells(1, 1, 10), painter));
+    QVERIFY(!atlas.obtainGlyphRun(QVector<float>(1, 1.0f), 10, makeCells(1, 1, 63), painter));
+
+    // Cells fit into a page one by one, but not all of them together
+    QVERIFY(!atlas.obtainGlyphRun(QVector<float>(1, 1.0f), 40, makeCells(1, 4, 40), painter));
+    QCOMPARE(atlas.getPagesCount(), 1u);
+}
+
+void TestGlyphAtlas::textRunReusesGlyphs()
+{
+    const std::shared_ptr<const TextRasterizer> rasterizer(new TextRasterizer(
+        TextRasterizer::getDefault()->fontFinder));
+    const auto text = QString::fromUtf8("Sesame Street");
+
+    TextRasterizer::Style style;
+    style.setSize(16.0f).setColor(ColorARGB(0xFF000000u));
+
+    unsigned int drawnCellsCount = 0;
+    const auto run = rasterizer->obtainGlyphRun(text, style, &drawnCellsCount);
+    QVERIFY(run);
+    QCOMPARE(run->glyphsWidth.size(), text.size());
+    // Space has no cell, and repeated letters are drawn once
+    QCOMPARE(run->cells.size(), text.size() - 1);
+    QVERIFY(drawnCellsCount > 0u);
+    QVERIFY(drawnCellsCount < static_cast<unsigned int>(run->cells.size()));
+    QCOMPARE(run->cells[1].area, run->cells[5].area);
+    QVERIFY(run->getWidth() > 0.0f);
+
+    const auto bitmap = rasterizer->glyphAtlas->obtainPageBitmap(*run);
+    QVERIFY(bitmap);
+    for (const auto& cell : constOf(run->cells))
+    {
+        QCOMPARE(cell.area.height(), run->cellHeight);
+        QVERIFY(hasInk(*bitmap, cell.area));
+    }
+
+    QVERIFY(rasterizer->obtainGlyphRun(text, style, &drawnCellsCount));
+    QCOMPARE(drawnCellsCount, 0u);
+
+    // Halo of each glyph is a separate cell
+    style.setHaloRadius(3).setHaloColor(ColorARGB(0xFFFFFFFFu));
+    const auto haloRun = rasterizer->obtainGlyphRun(text, style, &drawnCellsCount);
+    QVERIFY(haloRun);
+    QCOMPARE(haloRun->cells.size(), 2 * run->cells.size());
+    QVERIFY(haloRun->cellHeight > run->cellHeight);
+
+    rasterizer->clearCaches();
+    QCOMPARE(rasterizer->glyphAtlas->getCellsCount(), 0u);
+}
+
+void TestGlyphAtlas::unsupportedTextsHaveNoRun()
+{
+    const std::shared_ptr<const TextRasterizer> rasterizer(new TextRasterizer(
+        TextRasterizer::getDefault()->fontFinder));
+
+    TextRasterizer::Style style;
+    style.setSize(16.0f);
+    QVERIFY(!rasterizer->obtainGlyphRun(QString(), style));
+    QVERIFY(!rasterizer->obtainGlyphRun(QString::fromUtf8("   "), style));
+
+    auto wrappedStyle = style;
+    wrappedStyle.setWrapWidth(10);
+    QVERIFY(!rasterizer->obtainGlyphRun(QString::fromUtf8("Museum of Natural History"), wrappedStyle));
+
+    const std::shared_ptr<SkBitmap> background(new SkBitmap());
+    QVERIFY(background->tryAllocPixels(SkImageInfo::MakeN32Premul(20, 20)));
+    auto backgroundStyle = style;
+    backgroundStyle.setBackgroundBitmap(background);
+    QVERIFY(!rasterizer->obtainGlyphRun(QString::fromUtf8("A1"), backgroundStyle));
+
+    QCOMPARE(rasterizer->glyphAtlas->getCellsCount(), 0u);
+}
+
+QTEST_MAIN(TestGlyphAtlas)
+#include "TestGlyphAtlas.moc"
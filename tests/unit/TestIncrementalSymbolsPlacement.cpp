@@ -0,0 +1,140 @@
+#include "IncrementalSymbolsPlacement.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+using namespace OsmAnd;
+
+// Symbols placed in previous frame are reused only while view differs by target and symbols stay near placement
+class TestIncrementalSymbolsPlacement : public QObject
+{
+    Q_OBJECT
+
+private:
+    static IncrementalSymbolsPlacement::View makeView();
+private slots:
+    void sameViewAllowsIncrementalPlacement();
+    void changedViewInvalidatesPlacement_data();
+    void changedViewInvalidatesPlacement();
+    void groupInstanceReuse_data();
+    void groupInstanceReuse();
+    void symbolReuseIsLimitedByShift_data();
+    void symbolReuseIsLimitedByShift();
+};
+
+IncrementalSymbolsPlacement::View TestIncrementalSymbolsPlacement::makeView()
+{
+    IncrementalSymbolsPlacement::View view;
+    view.isValid = true;
+    view.mPerspectiveProjectionView = glm::mat4(1.0f);
+    view.glmViewport = glm::vec4(0.0f, 0.0f, 800.0f, 600.0f);
+    view.windowSize = PointI(800, 600);
+    view.zoomLevel = ZoomLevel15;
+    return view;
+}
+
+void TestIncrementalSymbolsPlacement::sameViewAllowsIncrementalPlacement()
+{
+    QVERIFY(IncrementalSymbolsPlacement::canPlaceIncrementally(makeView(), makeView()));
+
+    // Nothing was placed yet
+    QVERIFY(!IncrementalSymbolsPlacement::canPlaceIncrementally(IncrementalSymbolsPlacement::View(), makeView()));
+}
+
+void TestIncrementalSymbolsPlacement::changedViewInvalidatesPlacement_data()
+{
+    QTest::addColumn<int>("change");
+
+    QTest::newRow("zoom") << 0;
+    QTest::newRow("window size") << 1;
+    QTest::newRow("viewport") << 2;
+    QTest::newRow("projection-view") << 3;
+}
+
+void TestIncrementalSymbolsPlacement::changedViewInvalidatesPlacement()
+{
+    QFETCH(int, change);
+
+    auto view = makeView();
+    switch (change)
+    {
+        case 0:
+            view.zoomLevel = ZoomLevel16;
+            break;
+        case 1:
+            view.windowSize = PointI(800, 601);
+            break;
+        case 2:
+            view.glmViewport.z = 801.0f;
+            break;
+        case 3:
+            view.mPerspectiveProjectionView[3][0] = 0.5f;
+            break;
+    }
+
+    QVERIFY(!IncrementalSymbolsPlacement::canPlaceIncrementally(makeView(), view));
+}
+
+void TestIncrementalSymbolsPlacement::groupInstanceReuse_data()
+{
+    QTest::addColumn<int>("publishedSymbolsCountAtPlacement");
+    QTest::addColumn<int>("placedSymbolsCount");
+    QTest::addColumn<bool>("hasRejectedSymbols");
+    QTest::addColumn<int>("publishedSymbolsCount");
+    QTest::addColumn<bool>("reused");
+
+    QTest::newRow("unchanged") << 3 << 3 << false << 3 << true;
+    QTest::newRow("nothing placed") << 3 << 0 << true << 3 << false;
+    QTest::newRow("nothing placed, nothing rejected") << 0 << 0 << false << 0 << false;
+    QTest::newRow("some rejected") << 3 << 2 << true << 3 << false;
+    QTest::newRow("symbol published") << 3 << 3 << false << 4 << false;
+    QTest::newRow("symbol unpublished") << 3 << 3 << false << 2 << false;
+}
+
+void TestIncrementalSymbolsPlacement::groupInstanceReuse()
+{
+    QFETCH(int, publishedSymbolsCountAtPlacement);
+    QFETCH(int, placedSymbolsCount);
+    QFETCH(bool, hasRejectedSymbols);
+    QFETCH(int, publishedSymbolsCount);
+    QFETCH(bool, reused);
+
+    QCOMPARE(
+        IncrementalSymbolsPlacement::canReuseGroupInstance(
+            publishedSymbolsCountAtPlacement,
+            placedSymbolsCount,
+            hasRejectedSymbols,
+            publishedSymbolsCount),
+        reused);
+}
+
+void TestIncrementalSymbolsPlacement::symbolReuseIsLimitedByShift_data()
+{
+    QTest::addColumn<float>("dx");
+    QTest::addColumn<float>("dy");
+    QTest::addColumn<bool>("reused");
+
+    QTest::newRow("not moved") << 0.0f << 0.0f << true;
+    QTest::newRow("moved by limit") << 0.0f << 2.0f << true;
+    QTest::newRow("moved diagonally") << 1.0f << -1.0f << true;
+    QTest::newRow("moved beyond limit") << 2.5f << 0.0f << false;
+    QTest::newRow("moved diagonally beyond limit") << -2.0f << 2.0f << false;
+    QTest::newRow("panned") << 40.0f << 0.0f << false;
+}
+
+void TestIncrementalSymbolsPlacement::symbolReuseIsLimitedByShift()
+{
+    QFETCH(float, dx);
+    QFETCH(float, dy);
+    QFETCH(bool, reused);
+
+    const glm::vec2 anchorOnScreenAtPlacement(100.0f, 200.0f);
+    QCOMPARE(
+        IncrementalSymbolsPlacement::canReuseSymbol(
+            anchorOnScreenAtPlacement,
+            anchorOnScreenAtPlacement + glm::vec2(dx, dy)),
+        reused);
+}
+
+QTEST_MAIN(TestIncrementalSymbolsPlacement)
+#include "TestIncrementalSymbolsPlacement.moc"
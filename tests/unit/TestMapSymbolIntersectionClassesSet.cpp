@@ -0,0 +1,122 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/Map/MapSymbolIntersectionClassesSet.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QSet>
+
+#include <random>
+
+using namespace OsmAnd;
+
+// MapSymbolIntersectionClassesSet has to behave exactly as QSet of class ids does, both for inline and overflow classes
+class TestMapSymbolIntersectionClassesSet : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QSet<MapSymbolIntersectionClassId> generateClasses(
+        const int classesCount,
+        const int maxClassId,
+        std::mt19937& generator);
+    static MapSymbolIntersectionClassesSet makeSet(const QSet<MapSymbolIntersectionClassId>& classes);
+private slots:
+    void intersectsAsQSet_data();
+    void intersectsAsQSet();
+    void removeTrimsOverflow();
+    void negativeClassIsIgnored();
+};
+
+QSet<MapSymbolIntersectionClassId> TestMapSymbolIntersectionClassesSet::generateClasses(
+    const int classesCount,
+    const int maxClassId,
+    std::mt19937& generator)
+{
+    std::uniform_int_distribution<int> classIdDistribution(0, maxClassId);
+
+    QSet<MapSymbolIntersectionClassId> classes;
+    for (auto classIdx = 0; classIdx < classesCount; classIdx++)
+        classes.insert(classIdDistribution(generator));
+    return classes;
+}
+
+MapSymbolIntersectionClassesSet TestMapSymbolIntersectionClassesSet::makeSet(
+    const QSet<MapSymbolIntersectionClassId>& classes)
+{
+    MapSymbolIntersectionClassesSet set;
+    for (const auto classId : classes)
+        set.insert(classId);
+    return set;
+}
+
+void TestMapSymbolIntersectionClassesSet::intersectsAsQSet_data()
+{
+    QTest::addColumn<int>("classesCount");
+    QTest::addColumn<int>("maxClassId");
+    QTest::addColumn<unsigned int>("seed");
+
+    QTest::newRow("inline only") << 3 << 100 << 1u;
+    QTest::newRow("inline boundary") << 2 << 130 << 2u;
+    QTest::newRow("mostly overflow") << 4 << 1000 << 3u;
+    QTest::newRow("dense") << 40 << 300 << 4u;
+}
+
+void TestMapSymbolIntersectionClassesSet::intersectsAsQSet()
+{
+    QFETCH(int, classesCount);
+    QFETCH(int, maxClassId);
+    QFETCH(unsigned int, seed);
+
+    std::mt19937 generator(seed);
+    for (auto pairIdx = 0; pairIdx < 1000; pairIdx++)
+    {
+        const auto lClasses = generateClasses(classesCount, maxClassId, generator);
+        const auto rClasses = generateClasses(classesCount, maxClassId, generator);
+        const auto l = makeSet(lClasses);
+        const auto r = makeSet(rClasses);
+
+        QCOMPARE(l.toSet(), lClasses);
+        QCOMPARE(l.count(), lClasses.size());
+        QCOMPARE(l.isEmpty(), lClasses.isEmpty());
+        for (auto classId = 0; classId <= maxClassId; classId++)
+            QCOMPARE(l.contains(classId), lClasses.contains(classId));
+
+        const auto expectedIntersects = !(QSet<MapSymbolIntersectionClassId>(lClasses) & rClasses).isEmpty();
+        QCOMPARE(l.intersects(r), expectedIntersects);
+        QCOMPARE(r.intersects(l), expectedIntersects);
+    }
+}
+
+void TestMapSymbolIntersectionClassesSet::removeTrimsOverflow()
+{
+    MapSymbolIntersectionClassesSet set;
+    set.insert(0);
+    set.insert(MapSymbolIntersectionClassesSet::InlineClassesCount + 500);
+    QVERIFY(set.hasOverflow());
+
+    MapSymbolIntersectionClassesSet inlineSet;
+    inlineSet.insert(0);
+    QVERIFY(set != inlineSet);
+    QVERIFY(set.intersects(inlineSet));
+
+    QVERIFY(set.remove(MapSymbolIntersectionClassesSet::InlineClassesCount + 500));
+    QVERIFY(!set.remove(MapSymbolIntersectionClassesSet::InlineClassesCount + 500));
+    QVERIFY(!set.hasOverflow());
+    QVERIFY(set == inlineSet);
+
+    QVERIFY(set.remove(0));
+    QVERIFY(set.isEmpty());
+    QVERIFY(!set.intersects(inlineSet));
+}
+
+void TestMapSymbolIntersectionClassesSet::negativeClassIsIgnored()
+{
+    MapSymbolIntersectionClassesSet set;
+    set.insert(-1);
+    QVERIFY(set.isEmpty());
+    QVERIFY(!set.contains(-1));
+    QVERIFY(!set.remove(-1));
+}
+
+QTEST_MAIN(TestMapSymbolIntersectionClassesSet)
+#include "TestMapSymbolIntersectionClassesSet.moc"
@@ -0,0 +1,227 @@
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/ObfDataInterface.h>
+#include <OsmAndCore/ObfDataInterface_Metrics.h>
+#include <OsmAndCore/Data/Amenity.h>
+#include <OsmAndCore/Data/BinaryMapObject.h>
+#include <OsmAndCore/Utilities.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QDir>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+// Tests expect OSMAND_TEST_OBF_DIR to point to a directory with OBF files that have POI and map sections.
+// Queries run without worker pool, so sections are read one by one and skipping of sections is deterministic.
+
+class TestObfDataInterface : public QObject
+{
+    Q_OBJECT
+
+private:
+    std::shared_ptr<ObfsCollection> obfsCollection;
+    std::shared_ptr<ObfDataInterface> dataInterface;
+    QList< std::shared_ptr<const Amenity> > allAmenities;
+    ObfDataInterface_Metrics::Metric_streamQuery allAmenitiesMetric;
+
+    static double distanceToMapObject(const PointI& point31, const std::shared_ptr<const BinaryMapObject>& mapObject);
+private slots:
+    void initTestCase();
+    void streamAmenitiesHonoursLimit_data();
+    void streamAmenitiesHonoursLimit();
+    void streamAmenitiesOrdersByDistance();
+    void streamAmenitiesReturnsNearest();
+    void streamAmenitiesSkipsSections();
+    void streamAmenitiesCountsRejected();
+    void streamBinaryMapObjectsHonoursLimit();
+};
+
+void TestObfDataInterface::initTestCase()
+{
+    const QString obfsDirPath = qgetenv("OSMAND_TEST_OBF_DIR");
+    if (obfsDirPath.isEmpty() || !QDir(obfsDirPath).exists())
+        QSKIP("OSMAND_TEST_OBF_DIR is not set or does not exist");
+
+    obfsCollection.reset(new ObfsCollection());
+    obfsCollection->addDirectory(obfsDirPath);
+    dataInterface = obfsCollection->obtainDataInterface();
+    QVERIFY(dataInterface->loadObfFiles());
+
+    // Without limit every section is read
+    QVERIFY(dataInterface->streamAmenities(&allAmenities, 0, nullptr, nullptr, QString::null, nullptr, nullptr, nullptr,
+        &allAmenitiesMetric));
+    if (allAmenities.size() < 100)
+        QSKIP("At least 100 amenities are needed");
+    QCOMPARE(allAmenitiesMetric.skippedSections, 0u);
+    QCOMPARE(allAmenitiesMetric.acceptedResults, static_cast<unsigned int>(allAmenities.size()));
+}
+
+double TestObfDataInterface::distanceToMapObject(
+    const PointI& point31,
+    const std::shared_ptr<const BinaryMapObject>& mapObject)
+{
+    const auto& bbox31 = mapObject->bbox31;
+    const PointI nearestPoint31(
+        qBound(bbox31.left(), point31.x, bbox31.right()),
+        qBound(bbox31.top(), point31.y, bbox31.bottom()));
+    return Utilities::squareDistance31(point31, nearestPoint31);
+}
+
+void TestObfDataInterface::streamAmenitiesHonoursLimit_data()
+{
+    QTest::addColumn<unsigned int>("limit");
+
+    QTest::newRow("1") << 1u;
+    QTest::newRow("10") << 10u;
+    QTest::newRow("100") << 100u;
+}
+
+void TestObfDataInterface::streamAmenitiesHonoursLimit()
+{
+    QFETCH(unsigned int, limit);
+
+    unsigned int visitsCount = 0;
+    QList< std::shared_ptr<const Amenity> > amenities;
+    ObfDataInterface_Metrics::Metric_streamQuery metric;
+    QVERIFY(dataInterface->streamAmenities(
+        &amenities,
+        limit,
+        nullptr,
+        nullptr,
+        QString::null,
+        nullptr,
+        [&visitsCount]
+        (const std::shared_ptr<const Amenity>& amenity) -> bool
+        {
+            visitsCount++;
+            return true;
+        },
+        nullptr,
+        &metric));
+
+    QCOMPARE(static_cast<unsigned int>(amenities.size()), limit);
+    QCOMPARE(metric.acceptedResults, limit);
+    QCOMPARE(visitsCount, limit);
+}
+
+void TestObfDataInterface::streamAmenitiesOrdersByDistance()
+{
+    // Point at one of amenities, so that there's data near it
+    const auto nearestTo31 = allAmenities[allAmenities.size() / 2]->position31;
+
+    QList< std::shared_ptr<const Amenity> > amenities;
+    QVERIFY(dataInterface->streamAmenities(&amenities, 50, &nearestTo31));
+    QCOMPARE(amenities.size(), 50);
+
+    for (auto amenityIndex = 1; amenityIndex < amenities.size(); amenityIndex++)
+    {
+        QVERIFY(Utilities::squareDistance31(nearestTo31, amenities[amenityIndex - 1]->position31) <=
+            Utilities::squareDistance31(nearestTo31, amenities[amenityIndex]->position31));
+    }
+}
+
+void TestObfDataInterface::streamAmenitiesReturnsNearest()
+{
+    const auto nearestTo31 = allAmenities[allAmenities.size() / 3]->position31;
+    const auto limit = 50;
+
+    // Nearest ones from full scan are the reference, compared by distance since equally distant may differ
+    QVector<double> expectedDistances;
+    for (const auto& amenity : constOf(allAmenities))
+        expectedDistances.push_back(Utilities::squareDistance31(nearestTo31, amenity->position31));
+    std::sort(expectedDistances.begin(), expectedDistances.end());
+    expectedDistances.resize(limit);
+
+    QList< std::shared_ptr<const Amenity> > amenities;
+    ObfDataInterface_Metrics::Metric_streamQuery metric;
+    QVERIFY(dataInterface->streamAmenities(&amenities, limit, &nearestTo31, nullptr, QString::null, nullptr, nullptr,
+        nullptr, &metric));
+    QCOMPARE(amenities.size(), limit);
+    QCOMPARE(metric.acceptedResults, static_cast<unsigned int>(limit));
+
+    for (auto amenityIndex = 0; amenityIndex < amenities.size(); amenityIndex++)
+    {
+        QCOMPARE(Utilities::squareDistance31(nearestTo31, amenities[amenityIndex]->position31),
+            expectedDistances[amenityIndex]);
+    }
+}
+
+void TestObfDataInterface::streamAmenitiesSkipsSections()
+{
+    const auto sectionsCount = allAmenitiesMetric.visitedSections;
+    if (sectionsCount < 2)
+        QSKIP("At least 2 POI sections are needed");
+
+    QList< std::shared_ptr<const Amenity> > amenities;
+    ObfDataInterface_Metrics::Metric_streamQuery metric;
+    QVERIFY(dataInterface->streamAmenities(&amenities, 1, nullptr, nullptr, QString::null, nullptr, nullptr, nullptr,
+        &metric));
+
+    // Sections after the one that met the limit are not read at all
+    QCOMPARE(metric.visitedSections + metric.skippedSections, sectionsCount);
+    QVERIFY(metric.visitedSections <= sectionsCount);
+    QCOMPARE(metric.acceptedResults, 1u);
+    QCOMPARE(static_cast<unsigned int>(amenities.size()), 1u);
+
+    // Reading stops after a box, so nothing beyond single section can be read past the limit
+    QVERIFY(metric.droppedResults < allAmenitiesMetric.acceptedResults);
+}
+
+void TestObfDataInterface::streamAmenitiesCountsRejected()
+{
+    // Every other amenity is rejected by visitor, and rejected ones don't count towards limit
+    unsigned int visitsCount = 0;
+    QList< std::shared_ptr<const Amenity> > amenities;
+    ObfDataInterface_Metrics::Metric_streamQuery metric;
+    QVERIFY(dataInterface->streamAmenities(
+        &amenities,
+        10,
+        nullptr,
+        nullptr,
+        QString::null,
+        nullptr,
+        [&visitsCount]
+        (const std::shared_ptr<const Amenity>& amenity) -> bool
+        {
+            return (visitsCount++ % 2) == 1;
+        },
+        nullptr,
+        &metric));
+
+    QCOMPARE(amenities.size(), 10);
+    QCOMPARE(metric.acceptedResults, 10u);
+    QCOMPARE(metric.rejectedResults, 10u);
+}
+
+void TestObfDataInterface::streamBinaryMapObjectsHonoursLimit()
+{
+    const auto zoom = ZoomLevel14;
+    const auto nearestTo31 = allAmenities.first()->position31;
+    const auto tileId = TileId::fromXY(nearestTo31.x >> (ZoomLevel31 - zoom), nearestTo31.y >> (ZoomLevel31 - zoom));
+    const auto bbox31 = Utilities::tileBoundingBox31(tileId, zoom);
+
+    QList< std::shared_ptr<const BinaryMapObject> > allMapObjects;
+    QVERIFY(dataInterface->streamBinaryMapObjects(&allMapObjects, 0, zoom, nullptr, &bbox31));
+    if (allMapObjects.size() < 10)
+        QSKIP("At least 10 map objects are needed");
+
+    QList< std::shared_ptr<const BinaryMapObject> > mapObjects;
+    ObfDataInterface_Metrics::Metric_streamQuery metric;
+    QVERIFY(dataInterface->streamBinaryMapObjects(&mapObjects, 10, zoom, &nearestTo31, &bbox31, nullptr, nullptr, nullptr,
+        &metric));
+    QCOMPARE(mapObjects.size(), 10);
+    QCOMPARE(metric.acceptedResults, 10u);
+
+    // Those are 10 nearest of all map objects in the tile
+    QVector<double> expectedDistances;
+    for (const auto& mapObject : constOf(allMapObjects))
+        expectedDistances.push_back(distanceToMapObject(nearestTo31, mapObject));
+    std::sort(expectedDistances.begin(), expectedDistances.end());
+    for (auto mapObjectIndex = 0; mapObjectIndex < mapObjects.size(); mapObjectIndex++)
+        QCOMPARE(distanceToMapObject(nearestTo31, mapObjects[mapObjectIndex]), expectedDistances[mapObjectIndex]);
+}
+
+QTEST_MAIN(TestObfDataInterface)
+#include "TestObfDataInterface.moc"
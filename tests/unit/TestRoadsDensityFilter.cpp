@@ -0,0 +1,181 @@
+#include "RoadsDensityFilter.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QHash>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+Q_DECLARE_METATYPE(OsmAnd::AreaI)
+
+using namespace OsmAnd;
+
+// RoadsDensityFilter has to accept exactly same roads as counting cells of each point in a hash does
+class TestRoadsDensityFilter : public QObject
+{
+    Q_OBJECT
+
+private:
+    static std::vector<uint8_t> filterUsingHash(
+        const QList< QVector<PointI> >& roads,
+        const ZoomLevel zoom,
+        const unsigned int densityZoom,
+        const unsigned int densityLimit);
+    static std::vector<uint8_t> filter(
+        const QList< QVector<PointI> >& roads,
+        const ZoomLevel zoom,
+        const unsigned int densityZoom,
+        const unsigned int densityLimit);
+    static QList< QVector<PointI> > generateRoads(
+        const int roadsCount,
+        const AreaI& area31,
+        const int32_t maxStep31,
+        const unsigned int seed);
+private slots:
+    void acceptedSetIsUnchanged_data();
+    void acceptedSetIsUnchanged();
+    void emptyRoadIsRejected();
+};
+
+std::vector<uint8_t> TestRoadsDensityFilter::filterUsingHash(
+    const QList< QVector<PointI> >& roads,
+    const ZoomLevel zoom,
+    const unsigned int densityZoom,
+    const unsigned int densityLimit)
+{
+    const auto dZ = zoom + densityZoom;
+    QHash<uint64_t, uint32_t> densityMap;
+
+    std::vector<uint8_t> rejectFlags(roads.size(), 0);
+    for (auto roadIdx = 0; roadIdx < roads.size(); roadIdx++)
+    {
+        auto accept = false;
+        uint64_t prevId = 0;
+        for (const auto& point : roads[roadIdx])
+        {
+            const auto x = point.x >> (MaxZoomLevel - dZ);
+            const auto y = point.y >> (MaxZoomLevel - dZ);
+            const uint64_t id = (static_cast<uint64_t>(x) << dZ) | y;
+            if (prevId == id)
+                continue;
+            prevId = id;
+
+            auto& count = densityMap[id];
+            if (count < densityLimit)
+            {
+                accept = true;
+                count++;
+            }
+        }
+        if (!accept)
+            rejectFlags[roadIdx] = 1;
+    }
+
+    return rejectFlags;
+}
+
+std::vector<uint8_t> TestRoadsDensityFilter::filter(
+    const QList< QVector<PointI> >& roads,
+    const ZoomLevel zoom,
+    const unsigned int densityZoom,
+    const unsigned int densityLimit)
+{
+    RoadsDensityFilter roadsDensityFilter(zoom, densityZoom, densityLimit);
+    for (const auto& road : roads)
+        roadsDensityFilter.addRoad(road);
+
+    std::vector<uint8_t> rejectFlags;
+    const auto rejectedCount = roadsDensityFilter.filter(rejectFlags);
+    if (rejectedCount != static_cast<int>(std::count(rejectFlags.cbegin(), rejectFlags.cend(), 1)))
+        rejectFlags.clear();
+    return rejectFlags;
+}
+
+QList< QVector<PointI> > TestRoadsDensityFilter::generateRoads(
+    const int roadsCount,
+    const AreaI& area31,
+    const int32_t maxStep31,
+    const unsigned int seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int32_t> xDistribution(area31.left(), area31.right());
+    std::uniform_int_distribution<int32_t> yDistribution(area31.top(), area31.bottom());
+    std::uniform_int_distribution<int32_t> stepDistribution(-maxStep31, maxStep31);
+    std::uniform_int_distribution<int> pointsCountDistribution(2, 40);
+
+    QList< QVector<PointI> > roads;
+    for (auto roadIdx = 0; roadIdx < roadsCount; roadIdx++)
+    {
+        QVector<PointI> road;
+        PointI point(xDistribution(generator), yDistribution(generator));
+        const auto pointsCount = pointsCountDistribution(generator);
+        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++)
+        {
+            road.push_back(point);
+            point.x = qBound(area31.left(), point.x + stepDistribution(generator), area31.right());
+            point.y = qBound(area31.top(), point.y + stepDistribution(generator), area31.bottom());
+        }
+        roads.push_back(road);
+    }
+
+    return roads;
+}
+
+void TestRoadsDensityFilter::acceptedSetIsUnchanged_data()
+{
+    QTest::addColumn<int>("zoom");
+    QTest::addColumn<uint>("densityZoom");
+    QTest::addColumn<uint>("densityLimit");
+    QTest::addColumn<AreaI>("area31");
+    QTest::addColumn<int>("maxStep31");
+
+    const auto tileSize15 = 1 << (MaxZoomLevel - ZoomLevel15);
+    const AreaI tile15(tileSize15 * 100, tileSize15 * 200, tileSize15 * 101, tileSize15 * 201);
+    QTest::newRow("dense tile") << 15 << 3u << 5u << tile15 << tileSize15 / 16;
+    QTest::newRow("single cell") << 15 << 3u << 3u << tile15 << tileSize15 / 64;
+    QTest::newRow("tile with neighbours") << 15 << 2u << 8u << tile15.getEnlargedBy(tileSize15) << tileSize15 / 4;
+    QTest::newRow("low zoom") << 8 << 3u << 5u << AreaI(1 << 28, 1 << 28, (1 << 28) + (1 << 24), (1 << 28) + (1 << 24))
+        << (1 << 21);
+    QTest::newRow("corner of the world") << 15 << 3u << 5u << AreaI(0, 0, tileSize15, tileSize15) << tileSize15 / 8;
+    // Grid over entire world at zoom 18 is too large, so hash is used
+    QTest::newRow("entire world") << 15 << 3u << 2u << AreaI(0, 0, 0x7F000000, 0x7F000000) << (1 << 20);
+    QTest::newRow("max zoom") << 21 << 12u << 4u << tile15 << tileSize15 / 1024;
+}
+
+void TestRoadsDensityFilter::acceptedSetIsUnchanged()
+{
+    QFETCH(int, zoom);
+    QFETCH(uint, densityZoom);
+    QFETCH(uint, densityLimit);
+    QFETCH(AreaI, area31);
+    QFETCH(int, maxStep31);
+
+    // Cells can not be finer than zoom 31
+    const auto effectiveDensityZoom = qMin(densityZoom, static_cast<uint>(MaxZoomLevel - zoom));
+
+    for (auto seed = 1u; seed <= 8u; seed++)
+    {
+        const auto roads = generateRoads(2000, area31, maxStep31, seed);
+        const auto expected = filterUsingHash(roads, static_cast<ZoomLevel>(zoom), effectiveDensityZoom, densityLimit);
+        const auto actual = filter(roads, static_cast<ZoomLevel>(zoom), densityZoom, densityLimit);
+        QCOMPARE(actual.size(), expected.size());
+        QVERIFY(actual == expected);
+    }
+}
+
+void TestRoadsDensityFilter::emptyRoadIsRejected()
+{
+    QList< QVector<PointI> > roads;
+    roads.push_back(QVector<PointI>());
+    roads.push_back(QVector<PointI>() << PointI(1000, 1000) << PointI(2000, 2000));
+
+    const auto rejectFlags = filter(roads, ZoomLevel15, 3, 5);
+    QCOMPARE(rejectFlags.size(), size_t(2));
+    QCOMPARE(rejectFlags[0], uint8_t(1));
+    QCOMPARE(rejectFlags[1], uint8_t(0));
+}
+
+QTEST_MAIN(TestRoadsDensityFilter)
+#include "TestRoadsDensityFilter.moc"
@@ -0,0 +1,153 @@
+#include <OsmAndCore/SharedResourcesContainer.h>
+#include <OsmAndCore/SharedByZoomResourcesContainer.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <memory>
+
+using namespace OsmAnd;
+
+class TestSharedResourcesContainer : public QObject
+{
+    Q_OBJECT
+
+private:
+    typedef SharedResourcesContainer<int, const QByteArray> Container;
+    typedef SharedByZoomResourcesContainer<int, const QByteArray> ByZoomContainer;
+
+    static void insertAndRelease(Container& container, const int key, const int size = 1);
+private slots:
+    void releasedResourceIsDroppedWithoutRetention();
+    void releasedResourceIsRetained();
+    void leastRecentlyReleasedIsEvicted();
+    void budgetIsMeasuredByEstimator();
+    void evictionRemovesAllZoomLevels();
+};
+
+void TestSharedResourcesContainer::insertAndRelease(Container& container, const int key, const int size /*= 1*/)
+{
+    Container::ResourcePtr resource(new QByteArray(size, 'x'));
+    container.insertAndReference(key, resource);
+    QVERIFY(container.releaseReference(key, resource));
+}
+
+void TestSharedResourcesContainer::releasedResourceIsDroppedWithoutRetention()
+{
+    Container container;
+    insertAndRelease(container, 1);
+
+    Container::ResourcePtr resource;
+    QVERIFY(!container.obtainReference(1, resource));
+
+    const auto statistics = container.getRetentionStatistics();
+    QCOMPARE(statistics.hits, uintmax_t(0));
+    QCOMPARE(statistics.misses, uintmax_t(1));
+    QCOMPARE(statistics.retainedCount, uintmax_t(0));
+}
+
+void TestSharedResourcesContainer::releasedResourceIsRetained()
+{
+    Container container;
+    container.setRetentionBudget(2);
+    insertAndRelease(container, 1);
+    QCOMPARE(container.getRetentionStatistics().retainedCount, uintmax_t(1));
+
+    // Obtaining a reference stops retention, releasing it retains resource again
+    Container::ResourcePtr resource;
+    QVERIFY(container.obtainReference(1, resource));
+    QVERIFY(resource);
+    QCOMPARE(container.getReferencesCount(1), uintmax_t(1));
+    QCOMPARE(container.getRetentionStatistics().retainedCount, uintmax_t(0));
+    QVERIFY(container.releaseReference(1, resource));
+
+    const auto statistics = container.getRetentionStatistics();
+    QCOMPARE(statistics.hits, uintmax_t(1));
+    QCOMPARE(statistics.misses, uintmax_t(0));
+    QCOMPARE(statistics.retainedCount, uintmax_t(1));
+
+    // New resource replaces retained one
+    insertAndRelease(container, 1);
+    QCOMPARE(container.getRetentionStatistics().retainedCount, uintmax_t(1));
+}
+
+void TestSharedResourcesContainer::leastRecentlyReleasedIsEvicted()
+{
+    Container container;
+    container.setRetentionBudget(2);
+    insertAndRelease(container, 1);
+    insertAndRelease(container, 2);
+
+    // Touch 1, so that 2 becomes least recently released
+    Container::ResourcePtr resource;
+    QVERIFY(container.obtainReference(1, resource));
+    QVERIFY(container.releaseReference(1, resource));
+
+    insertAndRelease(container, 3);
+
+    const auto statistics = container.getRetentionStatistics();
+    QCOMPARE(statistics.evictions, uintmax_t(1));
+    QCOMPARE(statistics.retainedCount, uintmax_t(2));
+    QVERIFY(!container.obtainReference(2, resource));
+    QVERIFY(container.obtainReference(1, resource));
+    QVERIFY(container.releaseReference(1, resource));
+    QVERIFY(container.obtainReference(3, resource));
+    QVERIFY(container.releaseReference(3, resource));
+
+    container.clearRetained();
+    QCOMPARE(container.getRetentionStatistics().retainedCount, uintmax_t(0));
+    QVERIFY(!container.obtainReference(1, resource));
+}
+
+void TestSharedResourcesContainer::budgetIsMeasuredByEstimator()
+{
+    Container container;
+    container.setRetentionBudget(100,
+        []
+        (const Container::ResourcePtr& resource) -> size_t
+        {
+            return static_cast<size_t>(resource->size());
+        });
+
+    // Resource that alone exceeds budget is never retained
+    insertAndRelease(container, 1, 101);
+    QCOMPARE(container.getRetentionStatistics().retainedCount, uintmax_t(0));
+
+    insertAndRelease(container, 2, 60);
+    insertAndRelease(container, 3, 30);
+    QCOMPARE(container.getRetentionStatistics().retainedSize, uintmax_t(90));
+
+    insertAndRelease(container, 4, 20);
+    const auto statistics = container.getRetentionStatistics();
+    QCOMPARE(statistics.evictions, uintmax_t(1));
+    QCOMPARE(statistics.retainedCount, uintmax_t(2));
+    QCOMPARE(statistics.retainedSize, uintmax_t(50));
+}
+
+void TestSharedResourcesContainer::evictionRemovesAllZoomLevels()
+{
+    ByZoomContainer container;
+    container.setRetentionBudget(1);
+
+    const QSet<ZoomLevel> levels = QSet<ZoomLevel>() << ZoomLevel10 << ZoomLevel11;
+    ByZoomContainer::ResourcePtr resource(new QByteArray(1, 'x'));
+    container.insertAndReference(1, levels, resource);
+    QVERIFY(container.releaseReference(1, ZoomLevel10, resource));
+
+    // Retained resource is available at all its zoom levels
+    QVERIFY(container.obtainReference(1, ZoomLevel11, resource));
+    QVERIFY(container.releaseReference(1, ZoomLevel11, resource));
+
+    resource.reset(new QByteArray(1, 'y'));
+    container.insertAndReference(2, levels, resource);
+    QVERIFY(container.releaseReference(2, ZoomLevel11, resource));
+
+    QCOMPARE(container.getRetentionStatistics().evictions, uintmax_t(1));
+    QVERIFY(!container.obtainReference(1, ZoomLevel10, resource));
+    QVERIFY(!container.obtainReference(1, ZoomLevel11, resource));
+    QVERIFY(container.obtainReference(2, ZoomLevel10, resource));
+    QCOMPARE(*resource, QByteArray(1, 'y'));
+}
+
+QTEST_MAIN(TestSharedResourcesContainer)
+#include "TestSharedResourcesContainer.moc"
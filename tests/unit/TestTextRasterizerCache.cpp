@@ -0,0 +1,226 @@
+#include <OsmAndCore.h>
+#include <OsmAndCore/CoreResourcesEmbeddedBundle.h>
+#include <OsmAndCore/TextRasterizer.h>
+
+#include <SkBitmap.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <cstring>
+#include <memory>
+
+using namespace OsmAnd;
+
+// Texts obtained through caches of TextRasterizer have to be exactly same as texts rasterized without them
+class TestTextRasterizerCache : public QObject
+{
+    Q_OBJECT
+
+private:
+    static bool equalBitmaps(const SkBitmap& l, const SkBitmap& r);
+    static TextRasterizer::Style makeStyle(const int variant);
+
+    bool coreInitialized = false;
+    std::shared_ptr<const TextRasterizer> uncachedRasterizer;
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void cachedTextIsUnchanged_data();
+    void cachedTextIsUnchanged();
+    void textWithBackgroundIsNotShared();
+    void textLargerThanLimitIsNotCached();
+};
+
+void TestTextRasterizerCache::initTestCase()
+{
+    coreInitialized = InitializeCore(CoreResourcesEmbeddedBundle::loadFromCurrentExecutable());
+    QVERIFY(coreInitialized);
+
+    uncachedRasterizer.reset(new TextRasterizer(TextRasterizer::getDefault()->fontFinder, 0, 0));
+}
+
+void TestTextRasterizerCache::cleanupTestCase()
+{
+    uncachedRasterizer.reset();
+
+    if (coreInitialized)
+        ReleaseCore();
+}
+
+bool TestTextRasterizerCache::equalBitmaps(const SkBitmap& l, const SkBitmap& r)
+{
+    if (l.width() != r.width() || l.height() != r.height() || l.colorType() != r.colorType())
+        return false;
+
+    SkAutoLockPixels lLock(l);
+    SkAutoLockPixels rLock(r);
+    const auto rowSize = static_cast<size_t>(l.width()) * l.bytesPerPixel();
+    for (auto y = 0; y < l.height(); y++)
+    {
+        if (std::memcmp(l.getAddr(0, y), r.getAddr(0, y), rowSize) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+TextRasterizer::Style TestTextRasterizerCache::makeStyle(const int variant)
+{
+    TextRasterizer::Style style;
+    style
+        .setSize(14.0f + variant)
+        .setBold((variant & 1) != 0)
+        .setColor(ColorARGB(0xFF000000u | static_cast<uint32_t>(variant) * 0x102030u));
+    if ((variant & 2) != 0)
+        style.setHaloRadius(2).setHaloColor(ColorARGB(0xFFFFFFFFu));
+    if ((variant & 4) != 0)
+        style.setWrapWidth(10).setTextAlignment(TextRasterizer::Style::TextAlignment::Left);
+
+    return style;
+}
+
+void TestTextRasterizerCache::cachedTextIsUnchanged_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("variant");
+    QTest::addColumn<bool>("withGlyphWidths");
+
+    QTest::newRow("plain") << QString::fromUtf8("Main Street") << 0 << false;
+    QTest::newRow("bold on path") << QString::fromUtf8("Main Street") << 1 << true;
+    QTest::newRow("halo on path") << QString::fromUtf8("Rue de la Paix") << 2 << true;
+    QTest::newRow("wrapped") << QString::fromUtf8("Museum of Natural History") << 4 << false;
+    QTest::newRow("wrapped with halo") << QString::fromUtf8("Museum of Natural History") << 6 << false;
+    QTest::newRow("mixed scripts") << QString::fromUtf8("Straße Улица שדרות") << 3 << true;
+}
+
+void TestTextRasterizerCache::cachedTextIsUnchanged()
+{
+    QFETCH(QString, text);
+    QFETCH(int, variant);
+    QFETCH(bool, withGlyphWidths);
+
+    const auto style = makeStyle(variant);
+    const std::shared_ptr<const TextRasterizer> rasterizer(new TextRasterizer(
+        TextRasterizer::getDefault()->fontFinder));
+
+    QVector<SkScalar> expectedGlyphWidths;
+    float expectedExtraTopSpace = 0.0f;
+    float expectedExtraBottomSpace = 0.0f;
+    float expectedLineSpacing = 0.0f;
+    auto cacheLookup = TextRasterizer::CacheLookup::Miss;
+    const auto expected = uncachedRasterizer->obtainRasterized(
+        text,
+        style,
+        withGlyphWidths ? &expectedGlyphWidths : nullptr,
+        &expectedExtraTopSpace,
+        &expectedExtraBottomSpace,
+        &expectedLineSpacing,
+        &cacheLookup);
+    QVERIFY(expected);
+    QCOMPARE(cacheLookup, TextRasterizer::CacheLookup::Bypass);
+
+    const TextRasterizer::CacheLookup expectedLookups[] = {
+        TextRasterizer::CacheLookup::Miss,
+        TextRasterizer::CacheLookup::BitmapHit,
+    };
+    std::shared_ptr<const SkBitmap> previous;
+    for (const auto expectedLookup : expectedLookups)
+    {
+        QVector<SkScalar> glyphWidths;
+        float extraTopSpace = 0.0f;
+        float extraBottomSpace = 0.0f;
+        float lineSpacing = 0.0f;
+        const auto actual = rasterizer->obtainRasterized(
+            text,
+            style,
+            withGlyphWidths ? &glyphWidths : nullptr,
+            &extraTopSpace,
+            &extraBottomSpace,
+            &lineSpacing,
+            &cacheLookup);
+        QVERIFY(actual);
+        QCOMPARE(cacheLookup, expectedLookup);
+        QVERIFY(equalBitmaps(*actual, *expected));
+        QCOMPARE(glyphWidths, expectedGlyphWidths);
+        QCOMPARE(extraTopSpace, expectedExtraTopSpace);
+        QCOMPARE(extraBottomSpace, expectedExtraBottomSpace);
+        QCOMPARE(lineSpacing, expectedLineSpacing);
+
+        if (previous)
+            QCOMPARE(actual.get(), previous.get());
+        previous = actual;
+    }
+
+    // Glyph widths are measured for shaped text that was cached without them
+    QVector<SkScalar> glyphWidths;
+    const auto bitmap = rasterizer->rasterize(text, style, &glyphWidths);
+    QVERIFY(bitmap);
+    QVERIFY(equalBitmaps(*bitmap, *expected));
+    QVector<SkScalar> uncachedGlyphWidths;
+    uncachedRasterizer->rasterize(text, style, &uncachedGlyphWidths);
+    QCOMPARE(glyphWidths, uncachedGlyphWidths);
+
+    // Any difference in style is a different text
+    rasterizer->obtainRasterized(text, makeStyle(variant + 8), nullptr, nullptr, nullptr, nullptr, &cacheLookup);
+    QCOMPARE(cacheLookup, TextRasterizer::CacheLookup::Miss);
+
+    rasterizer->clearCaches();
+    rasterizer->obtainRasterized(text, style, nullptr, nullptr, nullptr, nullptr, &cacheLookup);
+    QCOMPARE(cacheLookup, TextRasterizer::CacheLookup::Miss);
+}
+
+void TestTextRasterizerCache::textWithBackgroundIsNotShared()
+{
+    const std::shared_ptr<SkBitmap> background(new SkBitmap());
+    QVERIFY(background->tryAllocPixels(SkImageInfo::MakeN32Premul(200, 40)));
+    background->eraseColor(SK_ColorYELLOW);
+
+    auto style = makeStyle(0);
+    style.setBackgroundBitmap(background);
+
+    const std::shared_ptr<const TextRasterizer> rasterizer(new TextRasterizer(
+        TextRasterizer::getDefault()->fontFinder));
+    const auto text = QString::fromUtf8("A1");
+
+    float expectedExtraTopSpace = -1.0f;
+    const auto expected = uncachedRasterizer->obtainRasterized(text, style, nullptr, &expectedExtraTopSpace);
+    QVERIFY(expected);
+    QCOMPARE(expectedExtraTopSpace, 0.0f);
+
+    auto cacheLookup = TextRasterizer::CacheLookup::Bypass;
+    const auto first = rasterizer->obtainRasterized(text, style, nullptr, nullptr, nullptr, nullptr, &cacheLookup);
+    QVERIFY(first);
+    QCOMPARE(cacheLookup, TextRasterizer::CacheLookup::Miss);
+    QVERIFY(equalBitmaps(*first, *expected));
+
+    float extraTopSpace = -1.0f;
+    const auto second = rasterizer->obtainRasterized(text, style, nullptr, &extraTopSpace, nullptr, nullptr, &cacheLookup);
+    QVERIFY(second);
+    QCOMPARE(cacheLookup, TextRasterizer::CacheLookup::ShapedTextHit);
+    QVERIFY(second.get() != first.get());
+    QVERIFY(equalBitmaps(*second, *expected));
+    QCOMPARE(extraTopSpace, 0.0f);
+}
+
+void TestTextRasterizerCache::textLargerThanLimitIsNotCached()
+{
+    const std::shared_ptr<const TextRasterizer> rasterizer(new TextRasterizer(
+        TextRasterizer::getDefault()->fontFinder,
+        0,
+        64));
+    const auto text = QString::fromUtf8("Main Street");
+
+    auto cacheLookup = TextRasterizer::CacheLookup::Bypass;
+    const auto first = rasterizer->obtainRasterized(text, makeStyle(0), nullptr, nullptr, nullptr, nullptr, &cacheLookup);
+    QVERIFY(first);
+    QCOMPARE(cacheLookup, TextRasterizer::CacheLookup::Miss);
+
+    const auto second = rasterizer->obtainRasterized(text, makeStyle(0), nullptr, nullptr, nullptr, nullptr, &cacheLookup);
+    QVERIFY(second);
+    QCOMPARE(cacheLookup, TextRasterizer::CacheLookup::Miss);
+    QVERIFY(second.get() != first.get());
+}
+
+QTEST_MAIN(TestTextRasterizerCache)
+#include "TestTextRasterizerCache.moc"
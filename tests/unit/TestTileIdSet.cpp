@@ -0,0 +1,119 @@
+#include "TileIdSet.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QSet>
+
+#include <algorithm>
+
+using namespace OsmAnd;
+
+// Difference of two TileIdSets has to match one computed by QSet
+class TestTileIdSet : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QVector<TileId> makeTiles(const int x0, const int y0, const int width, const int height);
+    static QSet<TileId> toSet(const QVector<TileId>& tiles);
+private slots:
+    void diffAsQSet_data();
+    void diffAsQSet();
+    void equalSetsHaveNoDiff();
+    void duplicatesAreMerged();
+};
+
+QVector<TileId> TestTileIdSet::makeTiles(const int x0, const int y0, const int width, const int height)
+{
+    QVector<TileId> tiles;
+    for (auto y = y0; y < y0 + height; y++)
+    {
+        for (auto x = x0; x < x0 + width; x++)
+            tiles.push_back(TileId::fromXY(x, y));
+    }
+    return tiles;
+}
+
+QSet<TileId> TestTileIdSet::toSet(const QVector<TileId>& tiles)
+{
+    QSet<TileId> result;
+    for (const auto& tileId : tiles)
+        result.insert(tileId);
+    return result;
+}
+
+void TestTileIdSet::diffAsQSet_data()
+{
+    QTest::addColumn<int>("dx");
+    QTest::addColumn<int>("dy");
+    QTest::addColumn<int>("dWidth");
+
+    QTest::newRow("pan right") << 1 << 0 << 0;
+    QTest::newRow("pan diagonally") << 3 << -2 << 0;
+    QTest::newRow("pan away") << 100 << 100 << 0;
+    QTest::newRow("grow") << 0 << 0 << 4;
+    QTest::newRow("shrink") << 0 << 0 << -4;
+}
+
+void TestTileIdSet::diffAsQSet()
+{
+    QFETCH(int, dx);
+    QFETCH(int, dy);
+    QFETCH(int, dWidth);
+
+    const auto previousTiles = makeTiles(10, 20, 16, 12);
+    const auto currentTiles = makeTiles(10 + dx, 20 + dy, 16 + dWidth, 12);
+    const TileIdSet previous(previousTiles);
+    const TileIdSet current(currentTiles);
+
+    QVector<TileId> added;
+    QVector<TileId> removed;
+    QVERIFY(current.diff(previous, &added, &removed));
+    QVERIFY(current.diff(previous));
+    QVERIFY(current != previous);
+
+    QCOMPARE(toSet(added), toSet(currentTiles) - toSet(previousTiles));
+    QCOMPARE(toSet(removed), toSet(previousTiles) - toSet(currentTiles));
+    QCOMPARE(added.size(), toSet(added).size());
+    QCOMPARE(removed.size(), toSet(removed).size());
+}
+
+void TestTileIdSet::equalSetsHaveNoDiff()
+{
+    const auto tiles = makeTiles(0, 0, 8, 8);
+    auto reversedTiles = tiles;
+    std::reverse(reversedTiles.begin(), reversedTiles.end());
+    const TileIdSet set(tiles);
+    const TileIdSet reversedSet(reversedTiles);
+
+    QVector<TileId> added;
+    QVector<TileId> removed;
+    QVERIFY(!set.diff(reversedSet, &added, &removed));
+    QVERIFY(added.isEmpty());
+    QVERIFY(removed.isEmpty());
+    QVERIFY(set == reversedSet);
+    QCOMPARE(toSet(set.toVector()), toSet(tiles));
+}
+
+void TestTileIdSet::duplicatesAreMerged()
+{
+    auto tiles = makeTiles(5, 5, 4, 4);
+    tiles += tiles;
+    TileIdSet set(tiles);
+    QCOMPARE(set.size(), 16);
+
+    QVERIFY(set.contains(TileId::fromXY(5, 5)));
+    QVERIFY(!set.contains(TileId::fromXY(9, 5)));
+    QVERIFY(set.remove(TileId::fromXY(5, 5)));
+    QVERIFY(!set.contains(TileId::fromXY(5, 5)));
+
+    // Removing a tile makes sets differ even though nothing was added
+    const TileIdSet original(tiles);
+    QVector<TileId> removed;
+    QVERIFY(set.diff(original, nullptr, &removed));
+    QCOMPARE(removed.size(), 1);
+    QCOMPARE(removed.first().id, TileId::fromXY(5, 5).id);
+}
+
+QTEST_MAIN(TestTileIdSet)
+#include "TestTileIdSet.moc"
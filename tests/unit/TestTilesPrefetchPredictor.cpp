@@ -0,0 +1,151 @@
+#include "TilesPrefetchPredictor.h"
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+using namespace OsmAnd;
+
+// Prediction is made from velocity of samples, which are fed with fake time
+class TestTilesPrefetchPredictor : public QObject
+{
+    Q_OBJECT
+
+private:
+    static const ZoomLevel zoomLevel = ZoomLevel10;
+
+    static TileId centerTileId();
+    static PointI centerTarget31();
+    static TileIdSet makeActiveTiles();
+    static TilesPrefetchPredictor::PrefetchTiles predict(const TilesPrefetchPredictor& predictor, const float zoom);
+private slots:
+    void stillMapPredictsNothing();
+    void panningPredictsTilesAhead();
+    void pauseResetsVelocity();
+    void predictionExpires();
+    void zoomingInPredictsChildren();
+    void zoomingOutPredictsParents();
+};
+
+TileId TestTilesPrefetchPredictor::centerTileId()
+{
+    return TileId::fromXY(500, 300);
+}
+
+PointI TestTilesPrefetchPredictor::centerTarget31()
+{
+    const auto tileSize31 = 1 << (ZoomLevel31 - zoomLevel);
+    return PointI(centerTileId().x * tileSize31 + tileSize31 / 2, centerTileId().y * tileSize31 + tileSize31 / 2);
+}
+
+TileIdSet TestTilesPrefetchPredictor::makeActiveTiles()
+{
+    TileIdSet tiles;
+    for (auto dY = -1; dY <= 1; dY++)
+    {
+        for (auto dX = -1; dX <= 1; dX++)
+            tiles.insert(centerTileId() + TileId::fromXY(dX, dY));
+    }
+    return tiles;
+}
+
+TilesPrefetchPredictor::PrefetchTiles TestTilesPrefetchPredictor::predict(
+    const TilesPrefetchPredictor& predictor,
+    const float zoom)
+{
+    return predictor.predict(centerTileId(), makeActiveTiles(), zoomLevel, zoom, MinZoomLevel, MaxZoomLevel);
+}
+
+void TestTilesPrefetchPredictor::stillMapPredictsNothing()
+{
+    TilesPrefetchPredictor predictor;
+    QVERIFY(predict(predictor, zoomLevel).isEmpty());
+
+    predictor.addSample(0, centerTarget31(), zoomLevel);
+    predictor.addSample(16, centerTarget31(), zoomLevel);
+    predictor.addSample(32, centerTarget31(), zoomLevel);
+    QCOMPARE(predictor.getTarget31Velocity(), PointD());
+    QCOMPARE(predictor.getZoomVelocity(), 0.0);
+    QVERIFY(predict(predictor, zoomLevel).isEmpty());
+}
+
+void TestTilesPrefetchPredictor::panningPredictsTilesAhead()
+{
+    // 2 tiles per 100ms to the east is 20 tiles per second, smoothed to 10 tiles per second, so in 500ms target
+    // moves by 5 tiles
+    const auto tileSize31 = 1 << (ZoomLevel31 - zoomLevel);
+    TilesPrefetchPredictor predictor;
+    predictor.addSample(0, centerTarget31(), zoomLevel);
+    predictor.addSample(100, centerTarget31() + PointI(2 * tileSize31, 0), zoomLevel);
+    QCOMPARE(predictor.getTarget31Velocity().x, 10.0 * tileSize31);
+    QCOMPARE(predictor.getTarget31Velocity().y, 0.0);
+
+    const auto prefetchTiles = predict(predictor, zoomLevel);
+    QCOMPARE(prefetchTiles.size(), 1);
+    const auto& prefetchTilesAtZoom = prefetchTiles[ZoomLevel10];
+    QCOMPARE(prefetchTilesAtZoom.size(), 5 * 3);
+    for (const auto& tileId : prefetchTilesAtZoom)
+    {
+        QVERIFY(tileId.x >= centerTileId().x + 2);
+        QVERIFY(tileId.x <= centerTileId().x + 6);
+        QVERIFY(qAbs(static_cast<int>(tileId.y) - static_cast<int>(centerTileId().y)) <= 1);
+    }
+}
+
+void TestTilesPrefetchPredictor::pauseResetsVelocity()
+{
+    const auto tileSize31 = 1 << (ZoomLevel31 - zoomLevel);
+    TilesPrefetchPredictor predictor;
+    predictor.addSample(0, centerTarget31(), zoomLevel);
+    predictor.addSample(100, centerTarget31() + PointI(2 * tileSize31, 0), zoomLevel);
+    QVERIFY(!predict(predictor, zoomLevel).isEmpty());
+
+    // Sample after a pause longer than allowed interval doesn't continue previous motion, even if target jumped
+    const auto pausedSampleTime = 100 + TilesPrefetchPredictor::MaxMotionSampleIntervalMsecs + 1;
+    predictor.addSample(pausedSampleTime, centerTarget31() + PointI(50 * tileSize31, 0), zoomLevel);
+    QCOMPARE(predictor.getTarget31Velocity(), PointD());
+    QVERIFY(predict(predictor, zoomLevel).isEmpty());
+}
+
+void TestTilesPrefetchPredictor::predictionExpires()
+{
+    const qint64 predictionTime = 1000;
+    const auto maxInterval = static_cast<qint64>(TilesPrefetchPredictor::MaxMotionSampleIntervalMsecs);
+
+    QVERIFY(!TilesPrefetchPredictor::isPredictionExpired(predictionTime, predictionTime));
+    QVERIFY(!TilesPrefetchPredictor::isPredictionExpired(predictionTime, predictionTime + maxInterval));
+    QVERIFY(TilesPrefetchPredictor::isPredictionExpired(predictionTime, predictionTime + maxInterval + 1));
+
+    // Nothing was predicted yet
+    QVERIFY(TilesPrefetchPredictor::isPredictionExpired(-1, 0));
+}
+
+void TestTilesPrefetchPredictor::zoomingInPredictsChildren()
+{
+    // 0.4 zoom levels per 100ms is smoothed to 2 zoom levels per second, so zoom reaches 11.4 in 500ms
+    TilesPrefetchPredictor predictor;
+    predictor.addSample(0, centerTarget31(), 10.0f);
+    predictor.addSample(100, centerTarget31(), 10.4f);
+
+    const auto prefetchTiles = predict(predictor, 10.4f);
+    QCOMPARE(prefetchTiles.size(), 1);
+    const auto& prefetchTilesAtZoom = prefetchTiles[ZoomLevel11];
+    QCOMPARE(prefetchTilesAtZoom.size(), 9 * 4);
+    for (const auto& childTileId : Utilities::getTileIdsUnderscaledByZoomShift(centerTileId(), 1))
+        QVERIFY(prefetchTilesAtZoom.contains(childTileId));
+}
+
+void TestTilesPrefetchPredictor::zoomingOutPredictsParents()
+{
+    TilesPrefetchPredictor predictor;
+    predictor.addSample(0, centerTarget31(), 10.0f);
+    predictor.addSample(100, centerTarget31(), 9.6f);
+
+    const auto prefetchTiles = predict(predictor, 9.6f);
+    QCOMPARE(prefetchTiles.size(), 1);
+    const auto& prefetchTilesAtZoom = prefetchTiles[ZoomLevel9];
+    QVERIFY(prefetchTilesAtZoom.contains(Utilities::getTileIdOverscaledByZoomShift(centerTileId(), 1)));
+    QVERIFY(prefetchTilesAtZoom.size() <= static_cast<int>(TilesPrefetchPredictor::MaxPrefetchTilesCount));
+}
+
+QTEST_MAIN(TestTilesPrefetchPredictor)
+#include "TestTilesPrefetchPredictor.moc"
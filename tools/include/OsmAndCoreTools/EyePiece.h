@@ -56,6 +56,16 @@ namespace OsmAndTools
             float mapScale;
             float symbolsScale;
             QString locale;
+            // If set, all tiles of given area and zoom range are rendered into '<path>/<zoom>/<x>/<y>.<format>'
+            // instead of a single image
+            QString outputTilesPath;
+            OsmAnd::AreaI tilesBBox31;
+            OsmAnd::ZoomLevel tilesMinZoom;
+            OsmAnd::ZoomLevel tilesMaxZoom;
+            // Number of tiles along each side of a metatile, that is rendered at once and sliced into tiles
+            unsigned int metatileSize;
+            // 0 means as many as CPU cores
+            unsigned int tilesThreadsCount;
             bool verbose;
 #if defined(OSMAND_TARGET_OS_linux)
             bool useLegacyContext;
@@ -79,6 +89,12 @@ namespace OsmAndTools
 #else
         bool rasterize(std::ostream& output);
 #endif
+
+#if defined(_UNICODE) || defined(UNICODE)
+        bool rasterizeTiles(std::wostream& output);
+#else
+        bool rasterizeTiles(std::ostream& output);
+#endif
     protected:
     public:
         EyePiece(const Configuration& configuration);
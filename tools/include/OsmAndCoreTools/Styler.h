@@ -22,6 +22,7 @@
 #include <OsmAndCore/Data/BinaryMapObject.h>
 #include <OsmAndCore/Map/IMapStylesCollection.h>
 #include <OsmAndCore/Map/MapPrimitiviser.h>
+#include <OsmAndCore/Map/MapPresentationEnvironment.h>
 
 #include <OsmAndCoreTools.h>
 
@@ -47,6 +48,7 @@ namespace OsmAndTools
             float symbolsScale;
             QString locale;
             bool metrics;
+            unsigned int benchmarkIterations;
             bool verbose;
 
             static bool parseFromCommandLineArguments(
@@ -62,8 +64,16 @@ namespace OsmAndTools
     private:
 #if defined(_UNICODE) || defined(UNICODE)
         bool evaluate(EvaluatedMapObjects& outEvaluatedMapObjects, std::wostream& output);
+        void benchmarkEvaluation(
+            const QList< std::shared_ptr<const OsmAnd::MapObject> >& mapObjects,
+            const std::shared_ptr<const OsmAnd::MapPresentationEnvironment>& mapPresentationEnvironment,
+            std::wostream& output);
 #else
         bool evaluate(EvaluatedMapObjects& outEvaluatedMapObjects, std::ostream& output);
+        void benchmarkEvaluation(
+            const QList< std::shared_ptr<const OsmAnd::MapObject> >& mapObjects,
+            const std::shared_ptr<const OsmAnd::MapPresentationEnvironment>& mapPresentationEnvironment,
+            std::ostream& output);
 #endif
     protected:
     public:
@@ -5,6 +5,14 @@
 #include <iomanip>
 #include <OsmAndCore/restore_internal_warnings.h>
 
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <OsmAndCore/restore_internal_warnings.h>
+
 #include <OsmAndCore.h>
 #include <OsmAndCore/ObfsCollection.h>
 #include <OsmAndCore/Stopwatch.h>
@@ -15,10 +23,14 @@
 #include <OsmAndCore/Map/MapStylesCollection.h>
 #include <OsmAndCore/Map/MapPresentationEnvironment.h>
 #include <OsmAndCore/Map/MapPrimitiviser.h>
+#include <OsmAndCore/Data/MapObject.h>
 #include <OsmAndCore/Map/ObfMapObjectsProvider.h>
 #include <OsmAndCore/Map/MapPrimitivesProvider.h>
 #include <OsmAndCore/Map/MapObjectsSymbolsProvider.h>
 #include <OsmAndCore/Map/MapRasterLayerProvider_Software.h>
+#include <OsmAndCore/Map/MapRasterizer.h>
+#include <OsmAndCore/Concurrent/WorkerPool.h>
+#include <OsmAndCore/QRunnableFunctor.h>
 
 #include <OsmAndCore/ignore_warnings_on_external_includes.h>
 #if defined(OSMAND_TARGET_OS_windows)
@@ -47,6 +59,8 @@
 
 #include <OsmAndCore/ignore_warnings_on_external_includes.h>
 #include <SkBitmap.h>
+#include <SkBitmapDevice.h>
+#include <SkCanvas.h>
 #include <SkImageEncoder.h>
 #include <SkData.h>
 #include <OsmAndCore/restore_internal_warnings.h>
@@ -84,6 +98,9 @@ bool OsmAndTools::EyePiece::rasterize(std::wostream& output)
 bool OsmAndTools::EyePiece::rasterize(std::ostream& output)
 #endif
 {
+    if (!configuration.outputTilesPath.isEmpty())
+        return rasterizeTiles(output);
+
     if (configuration.outputImageWidth == 0)
         return false;
     if (configuration.outputImageHeight == 0)
@@ -1142,6 +1159,284 @@ bool OsmAndTools::EyePiece::rasterize(std::ostream& output)
     return success;
 }
 
+#if defined(_UNICODE) || defined(UNICODE)
+bool OsmAndTools::EyePiece::rasterizeTiles(std::wostream& output)
+#else
+bool OsmAndTools::EyePiece::rasterizeTiles(std::ostream& output)
+#endif
+{
+    if (configuration.referenceTileSize == 0 || configuration.metatileSize == 0)
+        return false;
+    if (configuration.tilesMinZoom == OsmAnd::InvalidZoomLevel || configuration.tilesMaxZoom == OsmAnd::InvalidZoomLevel)
+        return false;
+
+    OsmAnd::Stopwatch rasterizationStopwatch(true);
+
+    // Find style
+    if (configuration.verbose)
+        output << xT("Resolving style '") << QStringToStlString(configuration.styleName) << xT("'...") << std::endl;
+    const auto mapStyle = configuration.stylesCollection->getResolvedStyleByName(configuration.styleName);
+    if (!mapStyle)
+    {
+        output << xT("Failed to resolve style '") << QStringToStlString(configuration.styleName) << xT("' from collection") << std::endl;
+        return false;
+    }
+
+    // All tiles are rendered using same map objects provider and primitiviser cache, so that data blocks and
+    // groups of objects that neighbouring tiles have in common are read and evaluated only once
+    if (configuration.verbose)
+        output << xT("Creating map presentation environment, primitiviser and map objects provider...") << std::endl;
+    const std::shared_ptr<OsmAnd::MapPresentationEnvironment> mapPresentationEnvironment(new OsmAnd::MapPresentationEnvironment(
+        mapStyle,
+        configuration.displayDensityFactor,
+        configuration.mapScale,
+        configuration.symbolsScale,
+        configuration.locale));
+    mapPresentationEnvironment->setSettings(configuration.styleSettings);
+    const std::shared_ptr<OsmAnd::MapPrimitiviser> primitiviser(new OsmAnd::MapPrimitiviser(
+        mapPresentationEnvironment));
+    const auto retainedPrimitivisedGroupsPerZoom = 16384u;
+    const std::shared_ptr<OsmAnd::MapPrimitiviser::Cache> primitiviserCache(new OsmAnd::MapPrimitiviser::Cache(
+        retainedPrimitivisedGroupsPerZoom));
+    const std::shared_ptr<OsmAnd::ObfMapObjectsProvider> mapObjectsProvider(new OsmAnd::ObfMapObjectsProvider(
+        configuration.obfsCollection));
+
+    // Enumerate metatiles of all zoom levels. Metatiles are aligned to grid of metatile size, and go row by row,
+    // so that metatiles that are rendered at same time are neighbours
+    struct Metatile
+    {
+        OsmAnd::TileId tileId;
+        OsmAnd::ZoomLevel zoom;
+        int size;
+    };
+    QVector<Metatile> metatiles;
+    int64_t tilesCount = 0;
+    for (int zoom = configuration.tilesMinZoom; zoom <= configuration.tilesMaxZoom; zoom++)
+    {
+        const auto zoomShift = OsmAnd::ZoomLevel31 - zoom;
+        const auto metatileSize = static_cast<int>(qMin<int64_t>(configuration.metatileSize, INT64_C(1) << zoom));
+        const auto top = configuration.tilesBBox31.top() >> zoomShift;
+        const auto left = configuration.tilesBBox31.left() >> zoomShift;
+        const auto bottom = configuration.tilesBBox31.bottom() >> zoomShift;
+        const auto right = configuration.tilesBBox31.right() >> zoomShift;
+        tilesCount += static_cast<int64_t>(bottom - top + 1) * static_cast<int64_t>(right - left + 1);
+
+        for (auto y = (top / metatileSize) * metatileSize; y <= bottom; y += metatileSize)
+        {
+            for (auto x = (left / metatileSize) * metatileSize; x <= right; x += metatileSize)
+            {
+                Metatile metatile;
+                metatile.tileId = OsmAnd::TileId::fromXY(x, y);
+                metatile.zoom = static_cast<OsmAnd::ZoomLevel>(zoom);
+                metatile.size = metatileSize;
+                metatiles.push_back(metatile);
+            }
+        }
+    }
+    if (configuration.verbose)
+        output << xT("Going to render ") << tilesCount << xT(" tiles as ") << metatiles.size() << xT(" metatiles") << std::endl;
+
+    QMutex outputMutex;
+    const auto tileSize = static_cast<int>(configuration.referenceTileSize);
+    const auto renderMetatile =
+        [this, tileSize, mapObjectsProvider, primitiviser, primitiviserCache, &outputMutex, &output]
+        (const Metatile& metatile, OsmAnd::MapRasterizer& rasterizer, int& outSavedTilesCount) -> bool
+        {
+            // Collect map objects of all tiles of metatile, since objects that cross tiles are shared
+            // each of them is taken only once
+            QList< std::shared_ptr<const OsmAnd::MapObject> > mapObjects;
+            QSet<const OsmAnd::MapObject*> mapObjectsSet;
+            QList< std::shared_ptr<OsmAnd::IMapObjectsProvider::Data> > tilesData;
+            auto surfaceType = OsmAnd::MapSurfaceType::Undefined;
+            for (auto dy = 0; dy < metatile.size; dy++)
+            {
+                for (auto dx = 0; dx < metatile.size; dx++)
+                {
+                    OsmAnd::IMapTiledDataProvider::Request request;
+                    request.tileId = OsmAnd::TileId::fromXY(metatile.tileId.x + dx, metatile.tileId.y + dy);
+                    request.zoom = metatile.zoom;
+
+                    std::shared_ptr<OsmAnd::IMapObjectsProvider::Data> tileData;
+                    if (!mapObjectsProvider->obtainTiledMapObjects(request, tileData))
+                        return false;
+                    if (!tileData)
+                        continue;
+
+                    if (surfaceType == OsmAnd::MapSurfaceType::Undefined)
+                        surfaceType = tileData->tileSurfaceType;
+                    else if (surfaceType != tileData->tileSurfaceType)
+                        surfaceType = OsmAnd::MapSurfaceType::Mixed;
+                    for (const auto& mapObject : OsmAnd::constOf(tileData->mapObjects))
+                    {
+                        if (mapObjectsSet.contains(mapObject.get()))
+                            continue;
+                        mapObjectsSet.insert(mapObject.get());
+                        mapObjects.push_back(mapObject);
+                    }
+                    tilesData.push_back(tileData);
+                }
+            }
+
+            // Primitivise and rasterize entire metatile at once, so that edges of tiles are not drawn separately.
+            // Metatile without any data is rendered as well, so that its tiles are filled with background instead of
+            // being missing from output
+            const auto lastTileId = OsmAnd::TileId::fromXY(
+                metatile.tileId.x + metatile.size - 1,
+                metatile.tileId.y + metatile.size - 1);
+            const OsmAnd::AreaI metatileBBox31(
+                OsmAnd::Utilities::tileBoundingBox31(metatile.tileId, metatile.zoom).topLeft,
+                OsmAnd::Utilities::tileBoundingBox31(lastTileId, metatile.zoom).bottomRight);
+            const auto metatileSizeInPixels = metatile.size * tileSize;
+            const auto primitivisedObjects = primitiviser->primitiviseWithSurface(
+                metatileBBox31,
+                OsmAnd::PointI(metatileSizeInPixels, metatileSizeInPixels),
+                metatile.zoom,
+                surfaceType,
+                mapObjects,
+                primitiviserCache);
+
+            SkBitmap metatileBitmap;
+            if (!metatileBitmap.tryAllocPixels(SkImageInfo::MakeN32Premul(metatileSizeInPixels, metatileSizeInPixels)))
+            {
+                QMutexLocker scopedLocker(&outputMutex);
+                output << xT("Failed to allocate metatile ") << metatileSizeInPixels << xT("x") << metatileSizeInPixels << std::endl;
+                return false;
+            }
+            {
+                SkBitmapDevice rasterizationTarget(metatileBitmap);
+                SkCanvas canvas(&rasterizationTarget);
+                rasterizer.rasterize(metatileBBox31, primitivisedObjects, canvas);
+                canvas.flush();
+            }
+
+            // Slice metatile into tiles, skipping ones outside of requested area
+            const auto outputFileExtension = (configuration.outputImageFormat == ImageFormat::JPEG)
+                ? QLatin1String("jpg")
+                : QLatin1String("png");
+            for (auto dx = 0; dx < metatile.size; dx++)
+            {
+                const auto tileX = metatile.tileId.x + dx;
+                const auto tileDirectory = QString(QLatin1String("%1/%2/%3"))
+                    .arg(configuration.outputTilesPath)
+                    .arg(metatile.zoom)
+                    .arg(tileX);
+                auto tileDirectoryCreated = false;
+
+                for (auto dy = 0; dy < metatile.size; dy++)
+                {
+                    const auto tileId = OsmAnd::TileId::fromXY(tileX, metatile.tileId.y + dy);
+                    if (!OsmAnd::Utilities::tileBoundingBox31(tileId, metatile.zoom).intersects(configuration.tilesBBox31))
+                        continue;
+
+                    SkBitmap tileBitmap;
+                    const auto tileRect = SkIRect::MakeXYWH(dx * tileSize, dy * tileSize, tileSize, tileSize);
+                    if (!metatileBitmap.extractSubset(&tileBitmap, tileRect))
+                    {
+                        QMutexLocker scopedLocker(&outputMutex);
+                        output << xT("Failed to extract tile ") << tileId.x << xT("x") << tileId.y << xT("@") << metatile.zoom << xT(" from metatile") << std::endl;
+                        return false;
+                    }
+
+                    std::unique_ptr<SkImageEncoder> imageEncoder;
+                    switch (configuration.outputImageFormat)
+                    {
+                        case ImageFormat::PNG:
+                            imageEncoder.reset(CreatePNGImageEncoder());
+                            break;
+
+                        case ImageFormat::JPEG:
+                            imageEncoder.reset(CreateJPEGImageEncoder());
+                            break;
+                    }
+                    const auto imageData = imageEncoder->encodeData(tileBitmap, 100);
+                    if (!imageData)
+                    {
+                        QMutexLocker scopedLocker(&outputMutex);
+                        output << xT("Failed to encode tile ") << tileId.x << xT("x") << tileId.y << xT("@") << metatile.zoom << std::endl;
+                        return false;
+                    }
+
+                    if (!tileDirectoryCreated)
+                        tileDirectoryCreated = QDir().mkpath(tileDirectory);
+                    const auto tileFilename = QString(QLatin1String("%1/%2.%3"))
+                        .arg(tileDirectory)
+                        .arg(tileId.y)
+                        .arg(outputFileExtension);
+                    QFile tileFile(tileFilename);
+                    const auto saved = tileFile.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+                        tileFile.write(reinterpret_cast<const char*>(imageData->bytes()), imageData->size()) == imageData->size();
+                    tileFile.close();
+                    imageData->unref();
+                    if (!saved)
+                    {
+                        QMutexLocker scopedLocker(&outputMutex);
+                        output << xT("Failed to write tile to '") << QStringToStlString(tileFilename) << xT("'") << std::endl;
+                        return false;
+                    }
+
+                    outSavedTilesCount++;
+                }
+            }
+
+            return true;
+        };
+
+    // Each worker takes next metatile once it's done with previous one
+    const auto threadsCount = configuration.tilesThreadsCount > 0
+        ? static_cast<int>(configuration.tilesThreadsCount)
+        : QThread::idealThreadCount();
+    if (configuration.verbose)
+        output << xT("Rendering tiles using ") << threadsCount << xT(" threads...") << std::endl;
+    OsmAnd::Concurrent::WorkerPool workerPool(OsmAnd::Concurrent::WorkerPool::Order::FIFO, threadsCount);
+    QAtomicInt nextMetatileIndex(0);
+    QAtomicInt savedTilesCount(0);
+    QAtomicInt failedMetatilesCount(0);
+    OsmAnd::Stopwatch renderingStopwatch(true);
+    for (auto threadIndex = 0; threadIndex < threadsCount; threadIndex++)
+    {
+        workerPool.enqueue(new OsmAnd::QRunnableFunctor(
+            [this, &metatiles, &renderMetatile, mapPresentationEnvironment, &nextMetatileIndex, &savedTilesCount,
+                &failedMetatilesCount, &outputMutex, &output]
+            (const OsmAnd::QRunnableFunctor* const runnable)
+            {
+                OsmAnd::MapRasterizer rasterizer(mapPresentationEnvironment);
+                for (;;)
+                {
+                    const auto metatileIndex = nextMetatileIndex.fetchAndAddOrdered(1);
+                    if (metatileIndex >= metatiles.size())
+                        break;
+                    const auto& metatile = metatiles[metatileIndex];
+
+                    auto metatileSavedTilesCount = 0;
+                    const auto ok = renderMetatile(metatile, rasterizer, metatileSavedTilesCount);
+                    savedTilesCount.fetchAndAddOrdered(metatileSavedTilesCount);
+                    if (!ok)
+                        failedMetatilesCount.fetchAndAddOrdered(1);
+
+                    if (!ok || configuration.verbose)
+                    {
+                        QMutexLocker scopedLocker(&outputMutex);
+                        output
+                            << (ok ? xT("Rendered") : xT("Failed to render"))
+                            << xT(" metatile ") << metatile.tileId.x << xT("x") << metatile.tileId.y << xT("@") << metatile.zoom
+                            << xT(" (") << (metatileIndex + 1) << xT("/") << metatiles.size() << xT(")") << std::endl;
+                    }
+                }
+            }));
+    }
+    workerPool.waitForDone();
+    const auto timeElapsedOnRendering = renderingStopwatch.elapsed();
+
+    output
+        << xT("Rendered ") << savedTilesCount.loadAcquire() << xT(" tiles in ") << timeElapsedOnRendering << xT("s (")
+        << (timeElapsedOnRendering > 0.0 ? savedTilesCount.loadAcquire() / timeElapsedOnRendering : 0.0)
+        << xT(" tiles/s)") << std::endl;
+    if (configuration.verbose)
+        output << xT("Rasterization took ") << rasterizationStopwatch.elapsed() << xT("s") << std::endl;
+
+    return failedMetatilesCount.loadAcquire() == 0;
+}
+
 bool OsmAndTools::EyePiece::rasterize(QString *pLog /*= nullptr*/)
 {
     if (pLog != nullptr)
@@ -1182,6 +1477,10 @@ OsmAndTools::EyePiece::Configuration::Configuration()
     , mapScale(1.0f)
     , symbolsScale(1.0f)
     , locale(QLatin1String("en"))
+    , tilesMinZoom(OsmAnd::InvalidZoomLevel)
+    , tilesMaxZoom(OsmAnd::InvalidZoomLevel)
+    , metatileSize(1)
+    , tilesThreadsCount(0)
     , verbose(false)
 #if defined(OSMAND_TARGET_OS_linux)
     , useLegacyContext(false)
@@ -1478,6 +1777,86 @@ bool OsmAndTools::EyePiece::Configuration::parseFromCommandLineArguments(
 
             outConfiguration.locale = value;
         }
+        else if (arg.startsWith(QLatin1String("-outputTilesPath=")))
+        {
+            outConfiguration.outputTilesPath = Utilities::resolvePath(arg.mid(strlen("-outputTilesPath=")));
+        }
+        else if (arg.startsWith(QLatin1String("-bbox=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-bbox=")));
+            const auto bboxValues = value.split(QLatin1Char(';'));
+            if (bboxValues.size() != 4)
+            {
+                outError = QString("'%1' can not be parsed as top latitude, left longitude, bottom latitude and right longitude").arg(value);
+                return false;
+            }
+
+            double bboxCoordinates[4];
+            for (auto coordinateIdx = 0; coordinateIdx < 4; coordinateIdx++)
+            {
+                bool ok = false;
+                bboxCoordinates[coordinateIdx] = bboxValues[coordinateIdx].toDouble(&ok);
+                if (!ok)
+                {
+                    outError = QString("'%1' can not be parsed as bbox coordinate").arg(bboxValues[coordinateIdx]);
+                    return false;
+                }
+            }
+
+            outConfiguration.tilesBBox31 = OsmAnd::Utilities::boundingBox31FromLatLon(
+                OsmAnd::LatLon(bboxCoordinates[0], bboxCoordinates[1]),
+                OsmAnd::LatLon(bboxCoordinates[2], bboxCoordinates[3]));
+        }
+        else if (arg.startsWith(QLatin1String("-tilesMinZoom=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-tilesMinZoom=")));
+
+            bool ok = false;
+            const auto zoom = value.toUInt(&ok);
+            if (!ok || zoom > OsmAnd::MaxZoomLevel)
+            {
+                outError = QString("'%1' can not be parsed as minimal zoom of tiles").arg(value);
+                return false;
+            }
+            outConfiguration.tilesMinZoom = static_cast<OsmAnd::ZoomLevel>(zoom);
+        }
+        else if (arg.startsWith(QLatin1String("-tilesMaxZoom=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-tilesMaxZoom=")));
+
+            bool ok = false;
+            const auto zoom = value.toUInt(&ok);
+            if (!ok || zoom > OsmAnd::MaxZoomLevel)
+            {
+                outError = QString("'%1' can not be parsed as maximal zoom of tiles").arg(value);
+                return false;
+            }
+            outConfiguration.tilesMaxZoom = static_cast<OsmAnd::ZoomLevel>(zoom);
+        }
+        else if (arg.startsWith(QLatin1String("-metatileSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-metatileSize=")));
+
+            bool ok = false;
+            outConfiguration.metatileSize = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as metatile size in tiles").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-tilesThreads=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-tilesThreads=")));
+
+            bool ok = false;
+            outConfiguration.tilesThreadsCount = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as number of threads").arg(value);
+                return false;
+            }
+        }
         else if (arg == QLatin1String("-verbose"))
         {
             outConfiguration.verbose = true;
@@ -1501,6 +1880,28 @@ bool OsmAndTools::EyePiece::Configuration::parseFromCommandLineArguments(
         outError = QLatin1String("'styleName' can not be empty");
         return false;
     }
+    if (!outConfiguration.outputTilesPath.isEmpty())
+    {
+        if (outConfiguration.tilesBBox31.width() <= 0 || outConfiguration.tilesBBox31.height() <= 0)
+        {
+            outError = QLatin1String("'bbox' has to be set and have top-left corner above and to the left of bottom-right one");
+            return false;
+        }
+        if (outConfiguration.tilesMinZoom == OsmAnd::InvalidZoomLevel ||
+            outConfiguration.tilesMaxZoom == OsmAnd::InvalidZoomLevel ||
+            outConfiguration.tilesMinZoom > outConfiguration.tilesMaxZoom)
+        {
+            outError = QLatin1String("'tilesMinZoom' and 'tilesMaxZoom' have to be set and form a valid range");
+            return false;
+        }
+        if (outConfiguration.metatileSize == 0 || (outConfiguration.metatileSize & (outConfiguration.metatileSize - 1)) != 0)
+        {
+            outError = QLatin1String("'metatileSize' has to be a power of 2");
+            return false;
+        }
+
+        return true;
+    }
     if (outConfiguration.outputImageWidth == 0)
     {
         outError = QLatin1String("'outputImageWidth' can not be 0");
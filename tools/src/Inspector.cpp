@@ -241,10 +241,11 @@ void printMapDetailInfo(std::ostream& output, const OsmAndTools::Inspector::Conf
         {
             auto mapObject = *itMapObject;
             output << xT("\t\t") << mapObject->id << std::endl;
-            if (mapObject->captions.count() > 0)
+            const auto& captions = mapObject->getCaptions();
+            if (captions.count() > 0)
             {
                 output << xT("\t\t\tNames:") << std::endl;
-                for (auto itCaption = mapObject->captions.cbegin(); itCaption != mapObject->captions.cend(); ++itCaption)
+                for (auto itCaption = captions.cbegin(); itCaption != captions.cend(); ++itCaption)
                 {
                     const auto& attribute = mapObject->attributeMapping->decodeMap[itCaption.key()];
                     output
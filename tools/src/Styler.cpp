@@ -20,6 +20,8 @@
 #include <OsmAndCore/Map/MapPresentationEnvironment.h>
 #include <OsmAndCore/Map/MapPrimitiviser.h>
 #include <OsmAndCore/Map/MapStyleEvaluationResult.h>
+#include <OsmAndCore/Map/MapStyleEvaluator.h>
+#include <OsmAndCore/Map/MapStyleBuiltinValueDefinitions.h>
 
 #include <OsmAndCore/QtExtensions.h>
 #include <OsmAndCore/ignore_warnings_on_external_includes.h>
@@ -236,9 +238,10 @@ bool OsmAndTools::Styler::evaluate(EvaluatedMapObjects& outEvaluatedMapObjects,
                 }
             }
 
+            const auto& captions = mapObject->getCaptions();
             for (const auto& captionAttributeId : OsmAnd::constOf(mapObject->captionsOrder))
             {
-                const auto& captionValue = mapObject->captions[captionAttributeId];
+                const auto captionValue = captions[captionAttributeId];
 
                 if (attributeMapping->nativeNameAttributeId == captionAttributeId)
                     output << xT("\tCaption: ") << QStringToStlString(captionValue) << std::endl;
@@ -519,12 +522,92 @@ bool OsmAndTools::Styler::evaluate(EvaluatedMapObjects& outEvaluatedMapObjects,
                 << std::endl;
         }
 
+        if (configuration.benchmarkIterations > 0)
+            benchmarkEvaluation(mapObjects, mapPresentationEnvironment, output);
+
         break;
     }
 
     return success;
 }
 
+#if defined(_UNICODE) || defined(UNICODE)
+void OsmAndTools::Styler::benchmarkEvaluation(
+    const QList< std::shared_ptr<const OsmAnd::MapObject> >& mapObjects,
+    const std::shared_ptr<const OsmAnd::MapPresentationEnvironment>& mapPresentationEnvironment,
+    std::wostream& output)
+#else
+void OsmAndTools::Styler::benchmarkEvaluation(
+    const QList< std::shared_ptr<const OsmAnd::MapObject> >& mapObjects,
+    const std::shared_ptr<const OsmAnd::MapPresentationEnvironment>& mapPresentationEnvironment,
+    std::ostream& output)
+#endif
+{
+    const auto& env = mapPresentationEnvironment;
+    const auto& builtinValueDefs = env->styleBuiltinValueDefs;
+    const auto zoom = configuration.zoom;
+    const OsmAnd::MapStyleRulesetType rulesetTypes[] = {
+        OsmAnd::MapStyleRulesetType::Order,
+        OsmAnd::MapStyleRulesetType::Polygon,
+        OsmAnd::MapStyleRulesetType::Polyline,
+        OsmAnd::MapStyleRulesetType::Point,
+    };
+
+    // Each map object is evaluated against all rulesets same way as primitiviser does it: once per each attribute.
+    // Interpreting rule nodes is measured first, so that both runs start with same state of caches
+    double objectsPerSecond[2] = { 0.0, 0.0 };
+    for (auto useCompiledProgram : { false, true })
+    {
+        OsmAnd::MapStyleEvaluator evaluator(
+            env->mapStyle,
+            env->displayDensityFactor * env->mapScaleFactor,
+            useCompiledProgram);
+        env->applyTo(evaluator);
+        evaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, zoom);
+        evaluator.setIntegerValue(builtinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+        OsmAnd::MapStyleEvaluationResult evaluationResult(env->mapStyle->getValueDefinitionsCount());
+        unsigned int matchesCount = 0;
+        const OsmAnd::Stopwatch stopwatch(true);
+        for (auto iteration = 0u; iteration < configuration.benchmarkIterations; iteration++)
+        {
+            for (const auto& mapObject : OsmAnd::constOf(mapObjects))
+            {
+                evaluator.setIntegerValue(builtinValueDefs->id_INPUT_LAYER, static_cast<int>(mapObject->getLayerType()));
+                evaluator.setBooleanValue(builtinValueDefs->id_INPUT_AREA, mapObject->isArea);
+                evaluator.setBooleanValue(builtinValueDefs->id_INPUT_POINT, mapObject->points31.size() == 1);
+                evaluator.setBooleanValue(builtinValueDefs->id_INPUT_CYCLE, mapObject->isClosedFigure());
+
+                for (const auto attributeId : OsmAnd::constOf(mapObject->attributeIds))
+                {
+                    const auto& decodedAttribute = mapObject->attributeMapping->decodeMap[attributeId];
+                    evaluator.setStringValue(builtinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
+                    evaluator.setStringValue(builtinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
+
+                    for (const auto rulesetType : rulesetTypes)
+                    {
+                        evaluationResult.clear();
+                        if (evaluator.evaluate(mapObject, rulesetType, &evaluationResult))
+                            matchesCount++;
+                    }
+                }
+            }
+        }
+        const auto elapsed = stopwatch.elapsed();
+
+        const auto evaluatedObjectsCount = static_cast<double>(mapObjects.size()) * configuration.benchmarkIterations;
+        objectsPerSecond[useCompiledProgram ? 1 : 0] = elapsed > 0.0f ? evaluatedObjectsCount / elapsed : 0.0;
+        output
+            << (useCompiledProgram ? xT("Compiled program: ") : xT("Rule nodes: "))
+            << evaluatedObjectsCount << xT(" objects evaluated in ") << elapsed << xT("s (")
+            << static_cast<uint64_t>(objectsPerSecond[useCompiledProgram ? 1 : 0]) << xT(" objects/s, ")
+            << matchesCount << xT(" matches)") << std::endl;
+    }
+
+    if (objectsPerSecond[0] > 0.0)
+        output << xT("Speedup: ") << objectsPerSecond[1] / objectsPerSecond[0] << xT("x") << std::endl;
+}
+
 bool OsmAndTools::Styler::evaluate(EvaluatedMapObjects& outEvaluatedMapObjects, QString *pLog /*= nullptr*/)
 {
     if (pLog != nullptr)
@@ -559,6 +642,7 @@ OsmAndTools::Styler::Configuration::Configuration()
     , symbolsScale(1.0f)
     , locale(QLatin1String("en"))
     , metrics(false)
+    , benchmarkIterations(0)
     , verbose(false)
 {
 }
@@ -733,6 +817,18 @@ bool OsmAndTools::Styler::Configuration::parseFromCommandLineArguments(
         {
             outConfiguration.metrics = true;
         }
+        else if (arg.startsWith(QLatin1String("-benchmark=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-benchmark=")));
+
+            bool ok = false;
+            outConfiguration.benchmarkIterations = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as benchmark iterations count").arg(value);
+                return false;
+            }
+        }
         else if (arg == QLatin1String("-verbose"))
         {
             outConfiguration.verbose = true;